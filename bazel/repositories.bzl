@@ -157,12 +157,14 @@ def envoy_dependencies(skip_targets = []):
     _com_github_libevent_libevent()
     _com_github_luajit_luajit()
     _com_github_madler_zlib()
+    _com_github_facebook_zstd()
     _com_github_nanopb_nanopb()
     _com_github_nghttp2_nghttp2()
     _com_github_nodejs_http_parser()
     _com_github_tencent_rapidjson()
     _com_google_googletest()
     _com_google_protobuf()
+    _org_brotli()
     _com_github_envoyproxy_sqlparser()
     _com_googlesource_quiche()
 
@@ -330,6 +332,32 @@ def _com_github_madler_zlib():
         actual = "@envoy//bazel/foreign_cc:zlib",
     )
 
+def _com_github_facebook_zstd():
+    _repository_impl(
+        name = "com_github_facebook_zstd",
+        build_file = "@envoy//bazel/external:zstd.BUILD",
+    )
+    native.bind(
+        name = "zstd",
+        actual = "@com_github_facebook_zstd//:zstd",
+    )
+
+def _org_brotli():
+    # Brotli ships its own BUILD file, with separate encoder and decoder libraries.
+    location = REPOSITORY_LOCATIONS["org_brotli"]
+    http_archive(
+        name = "org_brotli",
+        **location
+    )
+    native.bind(
+        name = "brotlienc",
+        actual = "@org_brotli//:brotlienc",
+    )
+    native.bind(
+        name = "brotlidec",
+        actual = "@org_brotli//:brotlidec",
+    )
+
 def _com_github_nghttp2_nghttp2():
     location = REPOSITORY_LOCATIONS["com_github_nghttp2_nghttp2"]
     http_archive(
@@ -142,6 +142,11 @@ REPOSITORY_LOCATIONS = dict(
         strip_prefix = "zlib-1.2.11",
         urls = ["https://github.com/madler/zlib/archive/v1.2.11.tar.gz"],
     ),
+    com_github_facebook_zstd = dict(
+        sha256 = "98e91c7c6bf162bf90e4e70fdbc41a8188b9fa8de5ad840c401198014406ce9e",
+        strip_prefix = "zstd-1.4.5",
+        urls = ["https://github.com/facebook/zstd/releases/download/v1.4.5/zstd-1.4.5.tar.gz"],
+    ),
     com_github_jbeder_yaml_cpp = dict(
         sha256 = "53dcffd55f3433b379fcc694f45c54898711c0e29159a7bd02e82a3e0253bac3",
         strip_prefix = "yaml-cpp-0f9a586ca1dc29c2ecb8dd715a315b93e3f40f79",
@@ -205,6 +210,11 @@ REPOSITORY_LOCATIONS = dict(
         strip_prefix = "protobuf-3.7.0",
         urls = ["https://github.com/protocolbuffers/protobuf/releases/download/v3.7.0/protobuf-all-3.7.0.tar.gz"],
     ),
+    org_brotli = dict(
+        sha256 = "f9e8d81d0405ba66d181529af42a3354f838c939095ff99930da6aa9cdf6fe46",
+        strip_prefix = "brotli-1.0.9",
+        urls = ["https://github.com/google/brotli/archive/v1.0.9.tar.gz"],
+    ),
     grpc_httpjson_transcoding = dict(
         sha256 = "dedd76b0169eb8c72e479529301a1d9b914a4ccb4d2b5ddb4ebe92d63a7b2152",
         strip_prefix = "grpc-httpjson-transcoding-64d6ac985360b624d8e95105701b64a3814794cd",
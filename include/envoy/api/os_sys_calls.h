@@ -85,6 +85,16 @@ public:
    */
   virtual SysCallIntResult stat(const char* pathname, struct stat* buf) PURE;
 
+  /**
+   * @see man 2 unlink
+   */
+  virtual SysCallIntResult unlink(const char* pathname) PURE;
+
+  /**
+   * @see man 2 rename
+   */
+  virtual SysCallIntResult rename(const char* oldpath, const char* newpath) PURE;
+
   /**
    * @see man 2 setsockopt
    */
@@ -5,6 +5,7 @@
 #endif
 
 #include <sched.h>
+#include <sys/socket.h>
 
 #include "envoy/api/os_sys_calls_common.h"
 #include "envoy/common/pure.h"
@@ -20,6 +21,12 @@ public:
    * @see sched_getaffinity (man 2 sched_getaffinity)
    */
   virtual SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) PURE;
+
+  /**
+   * @see recvmmsg (man 2 recvmmsg)
+   */
+  virtual SysCallIntResult recvmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen,
+                                    int flags, struct timespec* timeout) PURE;
 };
 
 typedef std::unique_ptr<LinuxOsSysCalls> LinuxOsSysCallsPtr;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/listen_socket.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A connection handler that is balanced. Typically implemented by individual listeners depending
+ * on their balancing configuration.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return the number of active connections within the handler. This may be called from any
+   *         thread.
+   */
+  virtual uint64_t numConnections() const PURE;
+
+  /**
+   * Increment the number of active connections within the handler. This is used to account for a
+   * socket that has been balanced to the handler but has not arrived yet. This may be called from
+   * any thread.
+   */
+  virtual void incNumConnections() PURE;
+
+  /**
+   * Post a connected socket to this connection handler. This is used for cross-thread connection
+   * transfer during the balancing process. This may be called from any thread.
+   */
+  virtual void post(ConnectionSocketPtr&& socket) PURE;
+};
+
+/**
+ * An implementation of a connection balancer. This abstracts the underlying policy (e.g., exact,
+ * fuzzy, etc.).
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Register a new handler with the balancer that is available for balancing.
+   */
+  virtual void registerHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregister a handler with the balancer that is no longer available for balancing.
+   */
+  virtual void unregisterHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Pick a target handler to send a connection to.
+   * @param current_handler supplies the currently executing connection handler.
+   * @return current_handler if the connection should stay bound to the current handler, or a
+   *         different handler if the connection should be rebalanced. A different handler has
+   *         already had incNumConnections() called on it and the caller must post() the socket to
+   *         it.
+   *
+   * NOTE: It is the responsibility of the caller to make sure that handlers are not unregistered
+   *       while a connection may still be accepted by any of the registered handlers.
+   */
+  virtual BalancedConnectionHandler&
+  pickTargetHandler(BalancedConnectionHandler& current_handler) PURE;
+};
+
+typedef std::unique_ptr<ConnectionBalancer> ConnectionBalancerPtr;
+
+} // namespace Network
+} // namespace Envoy
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
@@ -30,6 +31,22 @@ public:
    */
   virtual void addListener(ListenerConfig& config) PURE;
 
+  /**
+   * Replaces the configuration of a listener in place. The listener keeps its listen socket and
+   * its connections, and new connections are handled according to the new configuration.
+   * @param listener_tag supplies the tag of the listener to update.
+   * @param config supplies the new listener configuration. If there is no listener with
+   *        listener_tag, config is added as a new listener.
+   */
+  virtual void updateListener(uint64_t listener_tag, ListenerConfig& config) PURE;
+
+  /**
+   * Close the connections that were created from any of the given filter chains, across all
+   * listeners. This is used once the filter chains removed by a listener update have drained.
+   * @param filter_chains supplies the filter chains whose connections to close.
+   */
+  virtual void removeFilterChains(const std::vector<const FilterChain*>& filter_chains) PURE;
+
   /**
    * Find a listener based on the provided listener address value.
    * @param address supplies the address value.
@@ -6,6 +6,7 @@
 
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/stats/scope.h"
 
@@ -38,6 +39,14 @@ public:
   virtual Socket& socket() PURE;
   virtual const Socket& socket() const PURE;
 
+  /**
+   * @param worker_index supplies the index of the worker that listens on the socket.
+   * @return Socket& the listen socket used by the given worker. This is socket() unless the
+   *         listener uses a separate SO_REUSEPORT socket for each worker.
+   * @throw EnvoyException if the listener has a socket for each worker, but none for this one.
+   */
+  virtual Socket& workerSocket(uint32_t worker_index) PURE;
+
   /**
    * @return bool specifies whether the listener should actually listen on the port.
    *         A listener that doesn't listen on a port can only receive connections
@@ -80,6 +89,11 @@ public:
    * @return const std::string& the listener's name.
    */
   virtual const std::string& name() const PURE;
+
+  /**
+   * @return ConnectionBalancer& the connection balancer to use for the listener.
+   */
+  virtual ConnectionBalancer& connectionBalancer() PURE;
 };
 
 /**
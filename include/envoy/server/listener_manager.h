@@ -47,12 +47,15 @@ public:
    * @param socket_type the type of socket (stream or datagram) to create.
    * @param options to be set on the created socket just before calling 'bind()'.
    * @param bind_to_port supplies whether to actually bind the socket.
+   * @param worker_index supplies the index of the worker the socket is created for. This is
+   *        always 0 unless the listener uses a separate SO_REUSEPORT socket for each worker.
    * @return Network::SocketSharedPtr an initialized and potentially bound socket.
    */
   virtual Network::SocketSharedPtr
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
                      Network::Address::SocketType socket_type,
-                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
+                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port,
+                     uint32_t worker_index) PURE;
 
   /**
    * Creates a list of filter factories.
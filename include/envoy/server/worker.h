@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 #include "envoy/server/guarddog.h"
 #include "envoy/server/overload_manager.h"
@@ -32,6 +33,26 @@ public:
   virtual void addListener(Network::ListenerConfig& listener,
                            AddListenerCompletion completion) PURE;
 
+  /**
+   * Replace a listener of the worker with a new version of its configuration, keeping its socket
+   * and connections. If the worker has no listener with the given tag, the new version is added.
+   * @param overridden_listener_tag supplies the tag of the listener to replace.
+   * @param listener supplies the new version of the listener.
+   * @param completion supplies the completion to call when the listener has been updated (or not)
+   *                   on the worker.
+   */
+  virtual void updateListener(uint64_t overridden_listener_tag, Network::ListenerConfig& listener,
+                              AddListenerCompletion completion) PURE;
+
+  /**
+   * Close the connections that were created from any of the given filter chains.
+   * @param filter_chains supplies the filter chains that are being removed.
+   * @param completion supplies the completion to be called once the connections are closed. This
+   *        completion is called on the worker thread. No locking is performed by the worker.
+   */
+  virtual void removeFilterChains(const std::vector<const Network::FilterChain*>& filter_chains,
+                                  std::function<void()> completion) PURE;
+
   /**
    * @return uint64_t the number of connections across all listeners that the worker owns.
    */
@@ -91,9 +112,11 @@ public:
   virtual ~WorkerFactory() {}
 
   /**
+   * @param index supplies the index of the new worker among all workers.
+   * @param overload_manager supplies the server's overload manager.
    * @return WorkerPtr a new worker.
    */
-  virtual WorkerPtr createWorker(OverloadManager& overload_manager) PURE;
+  virtual WorkerPtr createWorker(uint32_t index, OverloadManager& overload_manager) PURE;
 };
 
 } // namespace Server
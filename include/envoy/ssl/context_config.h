@@ -1,13 +1,17 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <string>
 #include <vector>
 
 #include "envoy/common/pure.h"
 #include "envoy/ssl/certificate_validation_context_config.h"
+#include "envoy/ssl/private_key.h"
 #include "envoy/ssl/tls_certificate_config.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Ssl {
 
@@ -57,6 +61,18 @@ public:
    */
   virtual unsigned maxProtocolVersion() const PURE;
 
+  /**
+   * @return true if the transmit side of established connections should be offloaded to kernel
+   *         TLS when the negotiated parameters allow it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
+  /**
+   * @return the provider that performs the private key operations of handshakes, or nullptr if
+   *         they are performed synchronously by BoringSSL.
+   */
+  virtual PrivateKeyMethodProviderSharedPtr privateKeyMethodProvider() const PURE;
+
   /**
    * @return true if the ContextConfig is able to provide secrets to create SSL context,
    * and false if dynamic secrets are expected but are not downloaded from SDS server yet.
@@ -108,6 +124,14 @@ public:
     std::array<uint8_t, 256 / 8> aes_key_; // AES256 key size, in bytes
   };
 
+  struct SessionTicketKeyRotation {
+    // Secret from which the key of every rotation period is derived.
+    std::string seed_;
+    std::chrono::milliseconds rotation_interval_;
+    // Number of keys of periods before the current one that are accepted for decryption.
+    uint32_t accepted_previous_keys_;
+  };
+
   /**
    * @return True if client certificate is required, false otherwise.
    */
@@ -119,6 +143,25 @@ public:
    * are candidates for decrypting received tickets.
    */
   virtual const std::vector<SessionTicketKey>& sessionTicketKeys() const PURE;
+
+  /**
+   * @return the configuration for automatically rotated session ticket keys, if enabled. This is
+   *         mutually exclusive with sessionTicketKeys().
+   */
+  virtual const absl::optional<SessionTicketKeyRotation>& sessionTicketKeyRotation() const PURE;
+
+  /**
+   * @return true if the context should only be created once the first connection needs it,
+   *         rather than when the configuration is loaded.
+   */
+  virtual bool lazyLoadCertificates() const PURE;
+
+  /**
+   * @return the deterministically serialized configuration of the context. Together with the
+   *         certificates, keys and validation context, which may be loaded from files or SDS, this
+   *         identifies contexts that are interchangeable.
+   */
+  virtual const std::string& serializedConfig() const PURE;
 };
 
 typedef std::unique_ptr<ServerContextConfig> ServerContextConfigPtr;
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Callbacks of a TLS connection whose handshake waits for an asynchronous private key operation.
+ */
+class PrivateKeyConnectionCallbacks {
+public:
+  virtual ~PrivateKeyConnectionCallbacks() {}
+
+  /**
+   * Called on the connection's dispatcher thread once the pending private key operation has
+   * completed, successfully or not. The handshake should be resumed, which picks up the result.
+   */
+  virtual void onPrivateKeyMethodComplete() PURE;
+};
+
+/**
+ * Performs the private key operations of TLS handshakes, possibly asynchronously. While an
+ * operation is pending, the handshake returns SSL_ERROR_WANT_PRIVATE_KEY_OPERATION and the
+ * worker thread is free to serve other connections.
+ */
+class PrivateKeyMethodProvider {
+public:
+  virtual ~PrivateKeyMethodProvider() {}
+
+  /**
+   * Associates a connection with the provider. Must be called before the handshake starts, on the
+   * thread that runs dispatcher.
+   * @param ssl the connection.
+   * @param callbacks notified on dispatcher when an asynchronous operation completes.
+   * @param dispatcher the dispatcher of the connection.
+   */
+  virtual void registerPrivateKeyMethod(SSL* ssl, PrivateKeyConnectionCallbacks& callbacks,
+                                        Event::Dispatcher& dispatcher) PURE;
+
+  /**
+   * Disassociates a connection from the provider. Any pending operation is abandoned and the
+   * callbacks are not invoked afterwards. Must be called on the connection's dispatcher thread
+   * before the SSL object is freed.
+   * @param ssl the connection.
+   */
+  virtual void unregisterPrivateKeyMethod(SSL* ssl) PURE;
+
+  /**
+   * @return the BoringSSL private key method to install on the SSL_CTX of the TLS context.
+   */
+  virtual const SSL_PRIVATE_KEY_METHOD* getBoringSslPrivateKeyMethod() const PURE;
+};
+
+typedef std::shared_ptr<PrivateKeyMethodProvider> PrivateKeyMethodProviderSharedPtr;
+
+} // namespace Ssl
+} // namespace Envoy
@@ -7,6 +7,7 @@
 #include "envoy/network/address.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/upstream/health_check_host_monitor.h"
+#include "envoy/upstream/latency_host_monitor.h"
 #include "envoy/upstream/outlier_detection.h"
 
 namespace Envoy {
@@ -82,6 +83,11 @@ public:
    */
   virtual HealthCheckHostMonitor& healthChecker() const PURE;
 
+  /**
+   * @return the host's response latency monitor.
+   */
+  virtual LatencyHostMonitor& latencyMonitor() const PURE;
+
   /**
    * @return the hostname associated with the host if any.
    * Empty string "" indicates that hostname is not a DNS name.
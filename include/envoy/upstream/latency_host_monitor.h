@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * A monitor for upstream response latency that might be fed from every thread. Latency aware load
+ * balancers use the resulting estimate to steer traffic away from slow hosts.
+ */
+class LatencyHostMonitor {
+public:
+  virtual ~LatencyHostMonitor() {}
+
+  /**
+   * Record an observed upstream response time.
+   * @param response_time supplies the time between the request being sent and the response
+   *        headers being received.
+   * @param now supplies the monotonic time at which the response was received.
+   */
+  virtual void putResponseTime(std::chrono::microseconds response_time, MonotonicTime now) PURE;
+
+  /**
+   * Record a request which failed without a response, i.e. timed out or was reset. A failure is
+   * recorded as a response at least as slow as the current estimate, so that hosts which fail fast
+   * do not appear faster than hosts which respond.
+   * @param elapsed supplies the time between the request being sent, if it was, and the failure.
+   * @param now supplies the monotonic time at which the request failed.
+   */
+  virtual void putFailure(std::chrono::microseconds elapsed, MonotonicTime now) PURE;
+
+  /**
+   * @param now supplies the current monotonic time.
+   * @return double the current latency estimate in microseconds, or 0 if no estimate is
+   *         available. Implementations may decay the estimate while no responses are recorded.
+   */
+  virtual double latencyEstimate(MonotonicTime now) const PURE;
+};
+
+typedef std::unique_ptr<LatencyHostMonitor> LatencyHostMonitorPtr;
+
+} // namespace Upstream
+} // namespace Envoy
@@ -488,6 +488,9 @@ public:
   COUNTER  (upstream_cx_max_requests)                                                              \
   COUNTER  (upstream_cx_none_healthy)                                                              \
   COUNTER  (upstream_cx_pool_overflow)                                                             \
+  COUNTER  (upstream_cx_prefetch_total)                                                            \
+  COUNTER  (upstream_cx_prefetch_used)                                                             \
+  COUNTER  (upstream_cx_prefetch_unused)                                                           \
   COUNTER  (upstream_rq_total)                                                                     \
   GAUGE    (upstream_rq_active)                                                                    \
   COUNTER  (upstream_rq_completed)                                                                 \
@@ -675,6 +678,12 @@ public:
   virtual const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>&
   lbLeastRequestConfig() const PURE;
 
+  /**
+   * @return configuration for peak EWMA load balancing, only used if LB type is peak EWMA.
+   */
+  virtual const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>&
+  lbPeakEwmaConfig() const PURE;
+
   /**
    * @return configuration for ring hash load balancing, only used if type is set to ring_hash_lb.
    */
@@ -704,6 +713,13 @@ public:
    */
   virtual uint64_t maxRequestsPerConnection() const PURE;
 
+  /**
+   * @return float the number of connections a connection pool keeps per expected stream, relative
+   *         to its current load. Values above 1.0 cause connections to be established ahead of
+   *         the streams that will use them. 1.0 disables prefetching.
+   */
+  virtual float perUpstreamPrefetchRatio() const PURE;
+
   /**
    * @return the human readable name of the cluster.
    */
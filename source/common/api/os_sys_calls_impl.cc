@@ -2,6 +2,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -70,6 +71,16 @@ SysCallIntResult OsSysCallsImpl::stat(const char* pathname, struct stat* buf) {
   return {rc, errno};
 }
 
+SysCallIntResult OsSysCallsImpl::unlink(const char* pathname) {
+  const int rc = ::unlink(pathname);
+  return {rc, errno};
+}
+
+SysCallIntResult OsSysCallsImpl::rename(const char* oldpath, const char* newpath) {
+  const int rc = ::rename(oldpath, newpath);
+  return {rc, errno};
+}
+
 SysCallIntResult OsSysCallsImpl::setsockopt(int sockfd, int level, int optname, const void* optval,
                                             socklen_t optlen) {
   const int rc = ::setsockopt(sockfd, level, optname, optval, optlen);
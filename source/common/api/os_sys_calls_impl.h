@@ -24,6 +24,8 @@ public:
   SysCallPtrResult mmap(void* addr, size_t length, int prot, int flags, int fd,
                         off_t offset) override;
   SysCallIntResult stat(const char* pathname, struct stat* buf) override;
+  SysCallIntResult unlink(const char* pathname) override;
+  SysCallIntResult rename(const char* oldpath, const char* newpath) override;
   SysCallIntResult setsockopt(int sockfd, int level, int optname, const void* optval,
                               socklen_t optlen) override;
   SysCallIntResult getsockopt(int sockfd, int level, int optname, void* optval,
@@ -16,5 +16,12 @@ SysCallIntResult LinuxOsSysCallsImpl::sched_getaffinity(pid_t pid, size_t cpuset
   return {rc, errno};
 }
 
+SysCallIntResult LinuxOsSysCallsImpl::recvmmsg(int sockfd, struct mmsghdr* msgvec,
+                                               unsigned int vlen, int flags,
+                                               struct timespec* timeout) {
+  const int rc = ::recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+  return {rc, errno};
+}
+
 } // namespace Api
 } // namespace Envoy
@@ -15,6 +15,8 @@ class LinuxOsSysCallsImpl : public LinuxOsSysCalls {
 public:
   // Api::LinuxOsSysCalls
   SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) override;
+  SysCallIntResult recvmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags,
+                            struct timespec* timeout) override;
 };
 
 typedef ThreadSafeSingleton<LinuxOsSysCallsImpl> LinuxOsSysCallsSingleton;
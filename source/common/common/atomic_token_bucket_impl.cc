@@ -0,0 +1,61 @@
+#include "common/common/atomic_token_bucket_impl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+AtomicTokenBucketImpl::AtomicTokenBucketImpl(uint64_t max_tokens, TimeSource& time_source,
+                                             double fill_rate)
+    : max_tokens_(max_tokens), token_interval_ns_(1e9 / std::abs(fill_rate)),
+      time_source_(time_source), full_time_ns_(nowNs()) {}
+
+int64_t AtomicTokenBucketImpl::nowNs() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             time_source_.monotonicTime().time_since_epoch())
+      .count();
+}
+
+uint64_t AtomicTokenBucketImpl::consume(uint64_t tokens, bool allow_partial) {
+  const int64_t now = nowNs();
+  int64_t full_time = full_time_ns_.load();
+  while (true) {
+    // A bucket that was full at some point in the past is full now.
+    const int64_t base = std::max(full_time, now);
+    const double available = max_tokens_ - (base - now) / token_interval_ns_;
+    uint64_t consumed = tokens;
+    if (allow_partial) {
+      consumed = std::min(tokens, static_cast<uint64_t>(std::max(0.0, std::floor(available))));
+    }
+    if (consumed == 0 || available < consumed) {
+      return 0;
+    }
+    // On failure, full_time is updated with the time set by another thread, and the tokens are
+    // counted again.
+    if (full_time_ns_.compare_exchange_weak(
+            full_time, base + static_cast<int64_t>(consumed * token_interval_ns_))) {
+      return consumed;
+    }
+  }
+}
+
+std::chrono::milliseconds AtomicTokenBucketImpl::nextTokenAvailable() {
+  const int64_t now = nowNs();
+  // The next token is available once the bucket is max_tokens - 1 tokens away from being full.
+  const double wait_ns = full_time_ns_.load() - now - (max_tokens_ - 1) * token_interval_ns_;
+  if (wait_ns <= 0) {
+    return std::chrono::milliseconds(0);
+  }
+  return std::chrono::milliseconds(static_cast<uint64_t>(std::ceil(wait_ns / 1e6)));
+}
+
+void AtomicTokenBucketImpl::reset(uint64_t num_tokens) {
+  ASSERT(num_tokens <= max_tokens_);
+  full_time_ns_.store(nowNs() +
+                      static_cast<int64_t>((max_tokens_ - num_tokens) * token_interval_ns_));
+}
+
+} // namespace Envoy
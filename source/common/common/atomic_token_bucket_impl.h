@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+
+namespace Envoy {
+
+/**
+ * A token bucket that can be shared by several threads without locking.
+ *
+ * Rather than a number of tokens and the time of the last refill, which would have to be updated
+ * together, the state of the bucket is the single time at which it will be full again: the bucket
+ * holds max_tokens - (full_time - now) * fill_rate tokens, and consuming tokens pushes that time
+ * back by the time it takes to refill them. Consuming is then a compare-and-swap of that time.
+ * This is also known as the generic cell rate algorithm.
+ */
+class AtomicTokenBucketImpl : public TokenBucket {
+public:
+  /**
+   * @param max_tokens supplies the maximum number of tokens in the bucket.
+   * @param time_source supplies the time source, which must be thread-safe.
+   * @param fill_rate supplies the number of tokens that will return to the bucket on each second.
+   * The default is 1.
+   */
+  explicit AtomicTokenBucketImpl(uint64_t max_tokens, TimeSource& time_source,
+                                 double fill_rate = 1);
+
+  // TokenBucket
+  uint64_t consume(uint64_t tokens, bool allow_partial) override;
+  std::chrono::milliseconds nextTokenAvailable() override;
+  void reset(uint64_t num_tokens) override;
+
+private:
+  int64_t nowNs() const;
+
+  const double max_tokens_;
+  // Time to refill one token.
+  const double token_interval_ns_;
+  TimeSource& time_source_;
+  // Monotonic time in nanoseconds at which the bucket will be full.
+  std::atomic<int64_t> full_time_ns_;
+};
+
+} // namespace Envoy
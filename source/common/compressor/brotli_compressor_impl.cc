@@ -0,0 +1,60 @@
+#include "common/compressor/brotli_compressor_impl.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/stack_array.h"
+
+namespace Envoy {
+namespace Compressor {
+
+BrotliCompressorImpl::BrotliCompressorImpl(uint32_t quality, uint64_t chunk_size)
+    : chunk_size_{chunk_size}, chunk_ptr_(new uint8_t[chunk_size]),
+      state_ptr_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr),
+                 &BrotliEncoderDestroyInstance) {
+  RELEASE_ASSERT(state_ptr_ != nullptr, "");
+  RELEASE_ASSERT(BrotliEncoderSetParameter(state_ptr_.get(), BROTLI_PARAM_QUALITY, quality), "");
+}
+
+void BrotliCompressorImpl::compress(Buffer::Instance& buffer, State state) {
+  // The compressed data is collected separately, so that adding it never touches the slices that
+  // are still being read. It replaces the input at the end.
+  Buffer::OwnedImpl output_buffer;
+
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  buffer.getRawSlices(slices.begin(), num_slices);
+
+  for (const Buffer::RawSlice& input_slice : slices) {
+    size_t avail_in = input_slice.len_;
+    const uint8_t* next_in = static_cast<const uint8_t*>(input_slice.mem_);
+    process(output_buffer, BROTLI_OPERATION_PROCESS, avail_in, next_in);
+  }
+  buffer.drain(buffer.length());
+
+  size_t avail_in = 0;
+  const uint8_t* next_in = nullptr;
+  process(output_buffer,
+          state == State::Finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH, avail_in,
+          next_in);
+  buffer.move(output_buffer);
+}
+
+void BrotliCompressorImpl::process(Buffer::Instance& output_buffer,
+                                   BrotliEncoderOperation operation, size_t& avail_in,
+                                   const uint8_t*& next_in) {
+  do {
+    size_t avail_out = chunk_size_;
+    uint8_t* next_out = chunk_ptr_.get();
+    const bool result = BrotliEncoderCompressStream(state_ptr_.get(), operation, &avail_in,
+                                                    &next_in, &avail_out, &next_out, nullptr);
+    RELEASE_ASSERT(result, "");
+    const uint64_t n_output = chunk_size_ - avail_out;
+    if (n_output > 0) {
+      output_buffer.add(static_cast<void*>(chunk_ptr_.get()), n_output);
+    }
+  } while (avail_in > 0 || BrotliEncoderHasMoreOutput(state_ptr_.get()) ||
+           (operation == BROTLI_OPERATION_FINISH && !BrotliEncoderIsFinished(state_ptr_.get())));
+}
+
+} // namespace Compressor
+} // namespace Envoy
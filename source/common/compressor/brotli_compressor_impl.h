@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/compressor/compressor.h"
+
+#include "brotli/encode.h"
+
+namespace Envoy {
+namespace Compressor {
+
+/**
+ * Implementation of compressor's interface that writes a brotli stream. @see RFC 7932
+ */
+class BrotliCompressorImpl : public Compressor {
+public:
+  /**
+   * @param quality sets the compression quality, from 0 (fastest) to 11 (best compression).
+   * @param chunk_size amount of memory reserved for the compressor output.
+   */
+  BrotliCompressorImpl(uint32_t quality, uint64_t chunk_size = 4096);
+
+  // Compressor
+  void compress(Buffer::Instance& buffer, State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, BrotliEncoderOperation operation,
+               size_t& avail_in, const uint8_t*& next_in);
+
+  const uint64_t chunk_size_;
+  std::unique_ptr<uint8_t[]> chunk_ptr_;
+  std::unique_ptr<BrotliEncoderState, decltype(&BrotliEncoderDestroyInstance)> state_ptr_;
+};
+
+} // namespace Compressor
+} // namespace Envoy
@@ -2,6 +2,8 @@
 
 #include "envoy/compressor/compressor.h"
 
+#include "absl/strings/string_view.h"
+
 #include "zlib.h"
 
 namespace Envoy {
@@ -64,6 +66,22 @@ public:
   void init(CompressionLevel level, CompressionStrategy strategy, int64_t window_bits,
             uint64_t memory_level);
 
+  /**
+   * Sets a preset dictionary, which improves the compression of small payloads that share strings
+   * with it. It must be called after init() and before compressing any data. Only zlib and raw
+   * deflate streams support dictionaries, gzip streams do not. The decompressor must be given the
+   * same dictionary.
+   * @param dictionary supplies the dictionary.
+   */
+  void setDictionary(absl::string_view dictionary);
+
+  /**
+   * Resets the compressor so that it can compress a new stream with the parameters given to init(),
+   * reusing the memory zlib allocated for them. Any output of the current stream that was not
+   * flushed is discarded, as is the dictionary, which must be set again if needed.
+   */
+  void reset();
+
   /**
    * It returns the checksum of all output produced so far. Compressor's checksum at the end of the
    * stream has to match decompressor's checksum produced at the end of the decompression.
@@ -0,0 +1,52 @@
+#include "common/compressor/zstd_compressor_impl.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/stack_array.h"
+
+namespace Envoy {
+namespace Compressor {
+
+ZstdCompressorImpl::ZstdCompressorImpl(int level, uint64_t chunk_size)
+    : chunk_size_{chunk_size}, chunk_ptr_(new uint8_t[chunk_size]),
+      cctx_ptr_(ZSTD_createCCtx(), &ZSTD_freeCCtx) {
+  RELEASE_ASSERT(cctx_ptr_ != nullptr, "");
+  const size_t result = ZSTD_CCtx_setParameter(cctx_ptr_.get(), ZSTD_c_compressionLevel, level);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+}
+
+void ZstdCompressorImpl::compress(Buffer::Instance& buffer, State state) {
+  Buffer::OwnedImpl output_buffer;
+
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  buffer.getRawSlices(slices.begin(), num_slices);
+
+  for (const Buffer::RawSlice& input_slice : slices) {
+    ZSTD_inBuffer input = {input_slice.mem_, input_slice.len_, 0};
+    process(output_buffer, input, ZSTD_e_continue);
+  }
+  buffer.drain(buffer.length());
+
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  process(output_buffer, input, state == State::Finish ? ZSTD_e_end : ZSTD_e_flush);
+  buffer.move(output_buffer);
+}
+
+void ZstdCompressorImpl::process(Buffer::Instance& output_buffer, ZSTD_inBuffer& input,
+                                 ZSTD_EndDirective mode) {
+  size_t remaining;
+  do {
+    ZSTD_outBuffer output = {chunk_ptr_.get(), chunk_size_, 0};
+    remaining = ZSTD_compressStream2(cctx_ptr_.get(), &output, &input, mode);
+    RELEASE_ASSERT(!ZSTD_isError(remaining), ZSTD_getErrorName(remaining));
+    if (output.pos > 0) {
+      output_buffer.add(static_cast<void*>(chunk_ptr_.get()), output.pos);
+    }
+    // While continuing, zstd only has to take all of the input. A flush or the end of the frame
+    // is done when zstd has nothing left to write.
+  } while (mode == ZSTD_e_continue ? input.pos < input.size : remaining > 0);
+}
+
+} // namespace Compressor
+} // namespace Envoy
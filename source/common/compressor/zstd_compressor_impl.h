@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/compressor/compressor.h"
+
+#include "zstd.h"
+
+namespace Envoy {
+namespace Compressor {
+
+/**
+ * Implementation of compressor's interface that writes a zstd frame. @see RFC 8478
+ */
+class ZstdCompressorImpl : public Compressor {
+public:
+  /**
+   * @param level sets the compression level, from 1 (fastest) to 22 (best compression).
+   * @param chunk_size amount of memory reserved for the compressor output.
+   */
+  ZstdCompressorImpl(int level, uint64_t chunk_size = 4096);
+
+  // Compressor
+  void compress(Buffer::Instance& buffer, State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, ZSTD_inBuffer& input, ZSTD_EndDirective mode);
+
+  const uint64_t chunk_size_;
+  std::unique_ptr<uint8_t[]> chunk_ptr_;
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx_ptr_;
+};
+
+} // namespace Compressor
+} // namespace Envoy
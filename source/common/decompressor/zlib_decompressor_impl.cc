@@ -73,6 +73,13 @@ bool ZlibDecompressorImpl::inflateNext() {
     return false; // This means that zlib needs more input, so stop here.
   }
 
+  if (result == Z_NEED_DICT && !dictionary_.empty()) {
+    const int dictionary_result = inflateSetDictionary(
+        zstream_ptr_.get(), reinterpret_cast<const Bytef*>(dictionary_.data()), dictionary_.size());
+    RELEASE_ASSERT(dictionary_result == Z_OK, "");
+    return true;
+  }
+
   RELEASE_ASSERT(result == Z_OK, "");
   return true;
 }
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <string>
+
 #include "envoy/decompressor/decompressor.h"
 
+#include "absl/strings/string_view.h"
+
 #include "zlib.h"
 
 namespace Envoy {
@@ -32,6 +36,15 @@ public:
    */
   void init(int64_t window_bits);
 
+  /**
+   * Sets the preset dictionary that the data was compressed with, if any. It is handed to zlib
+   * when the stream asks for it.
+   * @param dictionary supplies the dictionary.
+   */
+  void setDictionary(absl::string_view dictionary) {
+    dictionary_.assign(dictionary.data(), dictionary.size());
+  }
+
   /**
    * It returns the checksum of all output produced so far. Decompressor's checksum at the end of
    * the stream has to match compressor's checksum produced at the end of the compression.
@@ -48,6 +61,7 @@ private:
 
   const uint64_t chunk_size_;
   bool initialized_;
+  std::string dictionary_;
 
   std::unique_ptr<unsigned char[]> chunk_char_ptr_;
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
@@ -218,13 +218,17 @@ public:
   } ProtocolStrings;
 
   struct {
+    const std::string Deflate{"deflate"};
     const std::string Gzip{"gzip"};
     const std::string Identity{"identity"};
     const std::string Wildcard{"*"};
   } AcceptEncodingValues;
 
   struct {
+    const std::string Brotli{"br"};
+    const std::string Deflate{"deflate"};
     const std::string Gzip{"gzip"};
+    const std::string Zstd{"zstd"};
   } ContentEncodingValues;
 
   struct {
@@ -66,6 +66,10 @@ bool ConnPoolImpl::hasActiveConnections() const {
 void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) {
   ASSERT(!client.stream_wrapper_);
+  if (client.prefetched_) {
+    host_->cluster().stats().upstream_cx_prefetch_used_.inc();
+    client.prefetched_ = false;
+  }
   host_->cluster().stats().upstream_rq_total_.inc();
   host_->stats().rq_total_.inc();
   client.stream_wrapper_ = std::make_unique<StreamWrapper>(response_decoder, client);
@@ -90,12 +94,32 @@ void ConnPoolImpl::createNewConnection() {
   client->moveIntoList(std::move(client), busy_clients_);
 }
 
+void ConnPoolImpl::maybePrefetch() {
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio <= 1.0 || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  // Each connection serves a single stream, so keep enough connections, busy, connecting or
+  // ready, to serve the current load scaled by the prefetch ratio.
+  const uint64_t active_streams = busy_clients_.size() - connecting_clients_;
+  const double anticipated_streams = (pending_requests_.size() + active_streams) * ratio;
+  while (anticipated_streams > ready_clients_.size() + busy_clients_.size() &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a new connection");
+    createNewConnection();
+    busy_clients_.front()->prefetched_ = true;
+    host_->cluster().stats().upstream_cx_prefetch_total_.inc();
+  }
+}
+
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
                                                      ConnectionPool::Callbacks& callbacks) {
   if (!ready_clients_.empty()) {
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    maybePrefetch();
     return nullptr;
   }
 
@@ -106,12 +130,20 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
 
+    // When prefetching, a connection that is still being established and is not claimed by an
+    // earlier pending request will serve this one.
+    const bool unclaimed_connection = host_->cluster().perUpstreamPrefetchRatio() > 1.0 &&
+                                      connecting_clients_ > pending_requests_.size();
+
     // If we have no connections at all, make one no matter what so we don't starve.
-    if ((ready_clients_.empty() && busy_clients_.empty()) || can_create_connection) {
+    if ((ready_clients_.empty() && busy_clients_.empty()) ||
+        (can_create_connection && !unclaimed_connection)) {
       createNewConnection();
     }
 
-    return newPendingRequest(response_decoder, callbacks);
+    ConnectionPool::Cancellable* pending = newPendingRequest(response_decoder, callbacks);
+    maybePrefetch();
+    return pending;
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, absl::string_view(),
@@ -155,6 +187,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       host_->stats().cx_connect_fail_.inc();
 
       removed = client.removeFromList(busy_clients_);
+      connecting_clients_--;
 
       // Raw connect failures should never happen under normal circumstances. If we have an upstream
       // that is behaving badly, requests can get stuck here in the pending state. If we see a
@@ -189,6 +222,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   // whether the client is in the ready list (connected) or the busy list (failed to connect).
   if (event == Network::ConnectionEvent::Connected) {
     conn_connect_ms_->complete();
+    connecting_clients_--;
     processIdleClient(client, false);
   }
 }
@@ -293,6 +327,7 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })),
       remaining_requests_(parent_.host_->cluster().maxRequestsPerConnection()) {
 
+  parent_.connecting_clients_++;
   parent_.conn_connect_ms_ = std::make_unique<Stats::Timespan>(
       parent_.host_->cluster().stats().upstream_cx_connect_ms_, parent_.dispatcher_.timeSource());
   Upstream::Host::CreateConnectionData data =
@@ -320,6 +355,9 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
 }
 
 ConnPoolImpl::ActiveClient::~ActiveClient() {
+  if (prefetched_) {
+    parent_.host_->cluster().stats().upstream_cx_prefetch_unused_.inc();
+  }
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   parent_.host_->stats().cx_active_.dec();
   conn_length_->complete();
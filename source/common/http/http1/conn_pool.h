@@ -101,6 +101,8 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    // Set for connections established ahead of demand until they serve their first request.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -109,6 +111,7 @@ protected:
                              ConnectionPool::Callbacks& callbacks);
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   void createNewConnection();
+  void maybePrefetch();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onDownstreamReset(ActiveClient& client);
   void onResponseComplete(ActiveClient& client);
@@ -123,6 +126,8 @@ protected:
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
+  // Clients in busy_clients_ that have not connected yet.
+  uint64_t connecting_clients_{};
 };
 
 /**
@@ -264,9 +264,9 @@ int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
   // https://nghttp2.org/documentation/types.html#c.nghttp2_send_data_callback
   static const uint64_t FRAME_HEADER_SIZE = 9;
 
-  Buffer::OwnedImpl output(framehd, FRAME_HEADER_SIZE);
-  output.move(pending_send_data_, length);
-  parent_.connection_.write(output, false);
+  // The body is moved into the output buffer, which sendPendingFrames() writes to the connection.
+  parent_.pending_output_.add(framehd, FRAME_HEADER_SIZE);
+  parent_.pending_output_.move(pending_send_data_, length);
   return 0;
 }
 
@@ -569,8 +569,7 @@ int ConnectionImpl::onInvalidFrame(int32_t stream_id, int error_code) {
 
 ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
-  Buffer::OwnedImpl buffer(data, length);
-  connection_.write(buffer, false);
+  pending_output_.add(data, length);
   return length;
 }
 
@@ -673,6 +672,14 @@ void ConnectionImpl::sendPendingFrames() {
   }
 
   int rc = nghttp2_session_send(session_);
+  // The frames serialized by nghttp2 are written to the connection at once, so that they only go
+  // through the write filters once. They are moved out of the output buffer first, since writing
+  // may reenter the codec.
+  if (pending_output_.length() > 0) {
+    Buffer::OwnedImpl output;
+    output.move(pending_output_);
+    connection_.write(output, false);
+  }
   if (rc != 0) {
     ASSERT(rc == NGHTTP2_ERR_CALLBACK_FAILURE);
     throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
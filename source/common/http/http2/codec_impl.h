@@ -294,6 +294,8 @@ protected:
   const uint32_t max_request_headers_kb_;
   uint32_t per_stream_buffer_limit_;
   bool allow_metadata_;
+  // The frames serialized during nghttp2_session_send(), which sendPendingFrames() writes.
+  Buffer::OwnedImpl pending_output_;
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
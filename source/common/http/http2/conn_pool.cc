@@ -1,5 +1,6 @@
 #include "common/http/http2/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
@@ -30,6 +31,10 @@ ConnPoolImpl::~ConnPoolImpl() {
     draining_client_->client_->close();
   }
 
+  if (prefetched_client_) {
+    closePrefetchedClient();
+  }
+
   // Make sure all clients are destroyed before we are destroyed.
   dispatcher_.clearDeferredDeleteList();
 }
@@ -38,6 +43,20 @@ void ConnPoolImpl::ConnPoolImpl::drainConnections() {
   if (primary_client_ != nullptr) {
     movePrimaryClientToDraining();
   }
+
+  if (prefetched_client_ != nullptr) {
+    closePrefetchedClient();
+  }
+}
+
+void ConnPoolImpl::closePrefetchedClient() {
+  // The pool closes the client on purpose, so it is not counted as a connect failure if it is still
+  // connecting.
+  if (prefetched_client_->connect_timer_) {
+    prefetched_client_->connect_timer_->disableTimer();
+    prefetched_client_->connect_timer_.reset();
+  }
+  prefetched_client_->client_->close();
 }
 
 void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
@@ -62,6 +81,11 @@ void ConnPoolImpl::checkForDrained() {
     return;
   }
 
+  if (prefetched_client_) {
+    closePrefetchedClient();
+    ASSERT(!prefetched_client_);
+  }
+
   bool drained = true;
   if (primary_client_) {
     if (primary_client_->client_->numActiveRequests() == 0) {
@@ -120,7 +144,13 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
   }
 
   if (!primary_client_) {
-    primary_client_ = std::make_unique<ActiveClient>(*this);
+    if (prefetched_client_) {
+      ENVOY_CONN_LOG(debug, "promoting prefetched client to primary", *prefetched_client_->client_);
+      host_->cluster().stats().upstream_cx_prefetch_used_.inc();
+      primary_client_ = std::move(prefetched_client_);
+    } else {
+      primary_client_ = std::make_unique<ActiveClient>(*this);
+    }
   }
 
   // If the primary client is not connected yet, queue up the request.
@@ -134,15 +164,38 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
       return nullptr;
     }
 
-    return newPendingRequest(response_decoder, callbacks);
+    ConnectionPool::Cancellable* pending = newPendingRequest(response_decoder, callbacks);
+    maybePrefetch(max_streams);
+    return pending;
   }
 
   // We already have an active client that's connected to upstream, so attempt to establish a
   // new stream.
   newClientStream(response_decoder, callbacks);
+  maybePrefetch(max_streams);
   return nullptr;
 }
 
+void ConnPoolImpl::maybePrefetch(uint64_t max_streams) {
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio <= 1.0 || prefetched_client_ || !primary_client_) {
+    return;
+  }
+
+  // A single connection multiplexes all streams, so the only connection worth establishing early
+  // is the one that replaces the primary client once it runs out of streams. Do so when the
+  // primary's remaining stream budget no longer covers the current load scaled by the ratio.
+  const uint64_t remaining_streams =
+      max_streams - std::min(max_streams, primary_client_->total_streams_);
+  const double anticipated_streams =
+      (primary_client_->client_->numActiveRequests() + pending_requests_.size()) * ratio;
+  if (anticipated_streams > remaining_streams) {
+    ENVOY_LOG(debug, "prefetching a new connection");
+    prefetched_client_ = std::make_unique<ActiveClient>(*this);
+    host_->cluster().stats().upstream_cx_prefetch_total_.inc();
+  }
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -160,7 +213,11 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     if (client.connect_timer_) {
       host_->cluster().stats().upstream_cx_connect_fail_.inc();
       host_->stats().cx_connect_fail_.inc();
+    }
 
+    // Pending requests are only waiting on the primary client, so a prefetched client failing to
+    // connect does not affect them.
+    if (client.connect_timer_ && &client != prefetched_client_.get()) {
       // Raw connect failures should never happen under normal circumstances. If we have an upstream
       // that is behaving badly, requests can get stuck here in the pending state. If we see a
       // connect failure, we purge all pending requests so that calling code can determine what to
@@ -174,6 +231,10 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     if (&client == primary_client_.get()) {
       ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
       dispatcher_.deferredDelete(std::move(primary_client_));
+    } else if (&client == prefetched_client_.get()) {
+      ENVOY_CONN_LOG(debug, "destroying prefetched client", *client.client_);
+      host_->cluster().stats().upstream_cx_prefetch_unused_.inc();
+      dispatcher_.deferredDelete(std::move(prefetched_client_));
     } else {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
       dispatcher_.deferredDelete(std::move(draining_client_));
@@ -188,7 +249,9 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     conn_connect_ms_->complete();
 
     client.upstream_ready_ = true;
-    onUpstreamReady();
+    if (&client == primary_client_.get()) {
+      onUpstreamReady();
+    }
   }
 
   if (client.connect_timer_) {
@@ -229,6 +292,9 @@ void ConnPoolImpl::onGoAway(ActiveClient& client) {
   host_->cluster().stats().upstream_cx_close_notify_.inc();
   if (&client == primary_client_.get()) {
     movePrimaryClientToDraining();
+  } else if (&client == prefetched_client_.get()) {
+    // The prefetched client has no streams yet and can no longer take any.
+    client.client_->close();
   }
 }
 
@@ -80,6 +80,8 @@ protected:
 
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
+  void maybePrefetch(uint64_t max_streams);
+  void closePrefetchedClient();
   void movePrimaryClientToDraining();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
@@ -93,6 +95,8 @@ protected:
   Event::Dispatcher& dispatcher_;
   ActiveClientPtr primary_client_;
   ActiveClientPtr draining_client_;
+  // Replacement for the primary client, established ahead of the primary reaching its stream limit.
+  ActiveClientPtr prefetched_client_;
   std::list<DrainedCb> drained_callbacks_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
 };
@@ -0,0 +1,43 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+void ExactConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(&lock_);
+  handlers_.push_back(&handler);
+}
+
+void ExactConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(&lock_);
+  // This could be made more efficient in various ways, but the number of listeners is generally
+  // small and this is a rare operation so we can start with this and optimize later if this
+  // becomes a perf bottleneck.
+  auto it = std::find(handlers_.begin(), handlers_.end(), &handler);
+  ASSERT(it != handlers_.end());
+  handlers_.erase(it);
+}
+
+BalancedConnectionHandler&
+ExactConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current_handler) {
+  absl::MutexLock lock(&lock_);
+  BalancedConnectionHandler* min_connection_handler = &current_handler;
+  for (BalancedConnectionHandler* handler : handlers_) {
+    if (handler->numConnections() < min_connection_handler->numConnections()) {
+      min_connection_handler = handler;
+    }
+  }
+
+  // Account for the socket in flight so that concurrent accepts on other workers see it.
+  if (min_connection_handler != &current_handler) {
+    min_connection_handler->incNumConnections();
+  }
+  return *min_connection_handler;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "envoy/network/connection_balancer.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Implementation of connection balancer that does exact balancing. This means that a lock is held
+ * during balancing so that connection counts are nearly exactly balanced between handlers. This
+ * is "nearly" exact in the sense that a handler may have closed connections that have not yet
+ * been accounted for. This balancer is intended for workloads with a small number of long lived
+ * connections, e.g. HTTP/2 or gRPC clients, where an imbalance at accept time persists for the
+ * lifetime of the connections. The lock makes it a poor fit for very high connection rates.
+ */
+class ExactConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override;
+
+private:
+  absl::Mutex lock_;
+  std::vector<BalancedConnectionHandler*> handlers_ GUARDED_BY(lock_);
+};
+
+/**
+ * A NOP connection balancer implementation that always keeps connections on the handler that
+ * accepted them.
+ */
+class NopConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler&) override {}
+  void unregisterHandler(BalancedConnectionHandler&) override {}
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override {
+    return current_handler;
+  }
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -1,11 +1,15 @@
 #include "common/network/udp_listener_impl.h"
 
+#include <netinet/udp.h>
 #include <sys/un.h>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/exception.h"
 
 #include "common/api/os_sys_calls_impl.h"
+#if defined(__linux__)
+#include "common/api/os_sys_calls_impl_linux.h"
+#endif
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
@@ -17,6 +21,15 @@
 namespace Envoy {
 namespace Network {
 
+namespace {
+// Receive size for a single datagram.
+constexpr uint64_t MaxDatagramSize = 16384;
+#if defined(__linux__) && defined(UDP_GRO)
+// Receive size when the kernel may coalesce several datagrams from the same flow into one read.
+constexpr uint64_t MaxGroPayloadSize = 65536;
+#endif
+} // namespace
+
 UdpListenerImpl::UdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket,
                                  UdpListenerCallbacks& cb)
     : BaseListenerImpl(dispatcher, socket), cb_(cb) {
@@ -31,6 +44,21 @@ UdpListenerImpl::UdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& sock
     throw CreateListenerException(fmt::format("cannot set post-bound socket option on socket: {}",
                                               socket.localAddress()->asString()));
   }
+
+#if defined(__linux__)
+  slot_size_ = MaxDatagramSize;
+#if defined(UDP_GRO)
+  // GRO is best effort: older kernels reject the option and we fall back to one datagram per slot.
+  const int enable = 1;
+  gro_enabled_ = Api::OsSysCallsSingleton::get()
+                     .setsockopt(socket.ioHandle().fd(), SOL_UDP, UDP_GRO, &enable, sizeof(enable))
+                     .rc_ == 0;
+  if (gro_enabled_) {
+    slot_size_ = MaxGroPayloadSize;
+  }
+#endif
+  slab_ = std::make_unique<uint8_t[]>(RecvBatchSize * slot_size_);
+#endif
 }
 
 UdpListenerImpl::~UdpListenerImpl() {
@@ -44,9 +72,90 @@ void UdpListenerImpl::enable() {
   file_event_->setEnabled(Event::FileReadyType::Read | Event::FileReadyType::Write);
 }
 
+#if defined(__linux__)
+Api::SysCallIntResult UdpListenerImpl::fillReceiveRing() {
+  for (uint32_t i = 0; i < RecvBatchSize; ++i) {
+    iovs_[i].iov_base = slab_.get() + i * slot_size_;
+    iovs_[i].iov_len = slot_size_;
+
+    // The kernel overwrites the lengths on every call so the headers are rebuilt each time.
+    struct msghdr& hdr = msgs_[i].msg_hdr;
+    hdr.msg_name = &peer_addrs_[i];
+    hdr.msg_namelen = sizeof(sockaddr_storage);
+    hdr.msg_iov = &iovs_[i];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = gro_enabled_ ? cmsgs_[i].data() : nullptr;
+    hdr.msg_controllen = gro_enabled_ ? cmsgs_[i].size() : 0;
+    hdr.msg_flags = 0;
+    msgs_[i].msg_len = 0;
+  }
+
+  const Api::SysCallIntResult result = Api::LinuxOsSysCallsSingleton::get().recvmmsg(
+      socket_.ioHandle().fd(), msgs_.data(), RecvBatchSize, 0, nullptr);
+  ring_count_ = result.rc_ > 0 ? result.rc_ : 0;
+  ring_index_ = 0;
+  ring_offset_ = 0;
+  return result;
+}
+
+uint64_t UdpListenerImpl::groSegmentSize(const struct mmsghdr& msg) const {
+#if defined(UDP_GRO)
+  if (!gro_enabled_) {
+    return 0;
+  }
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg.msg_hdr); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&msg.msg_hdr), cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int segment_size;
+      memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+      return segment_size > 0 ? segment_size : 0;
+    }
+  }
+#else
+  UNREFERENCED_PARAMETER(msg);
+#endif
+  return 0;
+}
+
 UdpListenerImpl::ReceiveResult UdpListenerImpl::doRecvFrom(sockaddr_storage& peer_addr,
                                                            socklen_t& addr_len) {
-  constexpr uint64_t const read_length = 16384;
+  if (ring_index_ == ring_count_) {
+    const Api::SysCallIntResult result = fillReceiveRing();
+    if (result.rc_ <= 0) {
+      return ReceiveResult{result, nullptr};
+    }
+    return doRecvFrom(peer_addr, addr_len);
+  }
+
+  const struct mmsghdr& msg = msgs_[ring_index_];
+  addr_len = msg.msg_hdr.msg_namelen;
+  memcpy(&peer_addr, &peer_addrs_[ring_index_], addr_len);
+
+  // A GRO coalesced read carries several datagrams of segment size bytes each, except for the
+  // last one which may be shorter. Each is delivered separately. An empty datagram is delivered
+  // as an empty buffer.
+  uint64_t length = msg.msg_len - ring_offset_;
+  const uint64_t segment_size = groSegmentSize(msg);
+  if (segment_size > 0) {
+    length = std::min(length, segment_size);
+  }
+
+  // Copy the payload into an exactly sized buffer so the slot can be reused by the next read.
+  Buffer::InstancePtr buffer = std::make_unique<Buffer::OwnedImpl>(
+      slab_.get() + ring_index_ * slot_size_ + ring_offset_, length);
+
+  ring_offset_ += length;
+  if (ring_offset_ >= msg.msg_len) {
+    ++ring_index_;
+    ring_offset_ = 0;
+  }
+
+  return ReceiveResult{Api::SysCallIntResult{static_cast<int>(length), 0}, std::move(buffer)};
+}
+#else
+UdpListenerImpl::ReceiveResult UdpListenerImpl::doRecvFrom(sockaddr_storage& peer_addr,
+                                                           socklen_t& addr_len) {
+  constexpr uint64_t const read_length = MaxDatagramSize;
 
   Buffer::InstancePtr buffer = std::make_unique<Buffer::OwnedImpl>();
 
@@ -71,6 +180,7 @@ UdpListenerImpl::ReceiveResult UdpListenerImpl::doRecvFrom(sockaddr_storage& pee
 
   return ReceiveResult{Api::SysCallIntResult{static_cast<int>(result.rc_), 0}, std::move(buffer)};
 }
+#endif
 
 void UdpListenerImpl::onSocketEvent(short flags) {
   ASSERT((flags & (Event::FileReadyType::Read | Event::FileReadyType::Write)));
@@ -97,8 +207,9 @@ void UdpListenerImpl::handleReadCallback() {
       return;
     }
 
-    if (recv_result.result_.rc_ == 0) {
-      // TODO(conqerAtapple): Is zero length packet interesting?
+    // A zero length datagram is a valid datagram, e.g. a keepalive, and is delivered with an
+    // empty buffer. Only the absence of a buffer means that nothing was read.
+    if (recv_result.buffer_ == nullptr) {
       return;
     }
 
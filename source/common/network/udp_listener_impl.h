@@ -1,5 +1,8 @@
 #pragma once
 
+#include <sys/socket.h>
+
+#include <array>
 #include <atomic>
 
 #include "common/buffer/buffer_impl.h"
@@ -40,6 +43,38 @@ protected:
 private:
   void onSocketEvent(short flags);
   Event::FileEventPtr file_event_;
+
+#if defined(__linux__)
+  // Maximum number of datagrams read by a single recvmmsg() call.
+  static constexpr uint32_t RecvBatchSize = 16;
+
+  /**
+   * Refills the receive ring with up to RecvBatchSize datagrams using a single recvmmsg() call.
+   * @return the syscall result; rc_ is the number of datagrams received on success.
+   */
+  Api::SysCallIntResult fillReceiveRing();
+
+  /**
+   * @return the segment size of a GRO coalesced datagram in the ring, or 0 if the datagram was
+   *         not coalesced by the kernel.
+   */
+  uint64_t groSegmentSize(const struct mmsghdr& msg) const;
+
+  // Receive storage preallocated once and reused by every recvmmsg() call. Payloads land in a
+  // single contiguous slab of RecvBatchSize slots of slot_size_ bytes each.
+  bool gro_enabled_{false};
+  uint64_t slot_size_;
+  std::unique_ptr<uint8_t[]> slab_;
+  std::array<struct mmsghdr, RecvBatchSize> msgs_;
+  std::array<struct iovec, RecvBatchSize> iovs_;
+  std::array<sockaddr_storage, RecvBatchSize> peer_addrs_;
+  std::array<std::array<uint8_t, CMSG_SPACE(sizeof(int))>, RecvBatchSize> cmsgs_;
+  // Read cursor into the ring: number of datagrams received, the datagram currently being
+  // consumed and the offset of the next GRO segment within it.
+  uint32_t ring_count_{0};
+  uint32_t ring_index_{0};
+  uint64_t ring_offset_{0};
+#endif
 };
 
 } // namespace Network
@@ -557,6 +557,7 @@ void Filter::onResponseTimeout() {
       upstream_requests_.front()->upstream_host_->stats().rq_timeout_.inc();
     }
 
+    upstream_requests_.front()->recordFailedAttempt();
     updateOutlierDetection(timeout_response_code_, *upstream_requests_.front().get());
     upstream_requests_.front()->resetStream();
   }
@@ -1053,6 +1054,17 @@ void Filter::UpstreamRequest::decodeHeaders(Http::HeaderMapPtr&& headers, bool e
   upstream_timing_.onFirstUpstreamRxByteReceived(parent_.callbacks_->dispatcher().timeSource());
   maybeEndDecode(end_stream);
 
+  // Feed latency aware load balancing with the time taken by this attempt alone, so that a host is
+  // not charged for the time spent on previous attempts against other hosts.
+  if (upstream_timing_.first_upstream_tx_byte_sent_) {
+    const MonotonicTime response_received_time =
+        upstream_timing_.first_upstream_rx_byte_received_.value();
+    upstream_host_->latencyMonitor().putResponseTime(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            response_received_time - upstream_timing_.first_upstream_tx_byte_sent_.value()),
+        response_received_time);
+  }
+
   upstream_headers_ = headers.get();
   const uint64_t response_code = Http::Utility::getResponseStatus(*headers);
   stream_info_.response_code_ = static_cast<uint32_t>(response_code);
@@ -1136,6 +1148,10 @@ void Filter::UpstreamRequest::onResetStream(Http::StreamResetReason reason,
                                             absl::string_view transport_failure_reason) {
   clearRequestEncoder();
   if (!calling_encode_headers_) {
+    // Overflow is a local circuit breaker decision rather than a failure of the host.
+    if (reason != Http::StreamResetReason::Overflow) {
+      recordFailedAttempt();
+    }
     stream_info_.setResponseFlag(parent_.streamResetReasonToResponseFlag(reason));
     parent_.onUpstreamReset(reason, transport_failure_reason, *this);
   } else {
@@ -1176,6 +1192,7 @@ void Filter::UpstreamRequest::onPerTryTimeout() {
     if (upstream_host_) {
       upstream_host_->stats().rq_timeout_.inc();
     }
+    recordFailedAttempt();
     resetStream();
     stream_info_.setResponseFlag(StreamInfo::ResponseFlag::UpstreamRequestTimeout);
     parent_.onPerTryTimeout(*this);
@@ -1186,6 +1203,21 @@ void Filter::UpstreamRequest::onPerTryTimeout() {
   }
 }
 
+void Filter::UpstreamRequest::recordFailedAttempt() {
+  // Attempts which time out or are reset before the response headers arrive are charged to the
+  // host's latency estimate, otherwise a host failing fast would look like the fastest one.
+  if (upstream_host_ == nullptr || upstream_timing_.first_upstream_rx_byte_received_) {
+    return;
+  }
+  const MonotonicTime now = parent_.callbacks_->dispatcher().timeSource().monotonicTime();
+  std::chrono::microseconds elapsed(0);
+  if (upstream_timing_.first_upstream_tx_byte_sent_) {
+    elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        now - upstream_timing_.first_upstream_tx_byte_sent_.value());
+  }
+  upstream_host_->latencyMonitor().putFailure(elapsed, now);
+}
+
 void Filter::UpstreamRequest::onPoolFailure(Http::ConnectionPool::PoolFailureReason reason,
                                             absl::string_view transport_failure_reason,
                                             Upstream::HostDescriptionConstSharedPtr host) {
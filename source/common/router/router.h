@@ -282,6 +282,7 @@ private:
     void setupPerTryTimeout();
     void onPerTryTimeout();
     void maybeEndDecode(bool end_stream);
+    void recordFailedAttempt();
 
     void onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host) {
       stream_info_.onUpstreamHostSelected(host);
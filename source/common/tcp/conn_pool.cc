@@ -57,6 +57,10 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 
 void ConnPoolImpl::assignConnection(ActiveConn& conn, ConnectionPool::Callbacks& callbacks) {
   ASSERT(conn.wrapper_ == nullptr);
+  if (conn.prefetched_) {
+    host_->cluster().stats().upstream_cx_prefetch_used_.inc();
+    conn.prefetched_ = false;
+  }
   conn.wrapper_ = std::make_shared<ConnectionWrapper>(conn);
 
   callbacks.onPoolReady(std::make_unique<ConnectionDataImpl>(conn.wrapper_),
@@ -82,11 +86,30 @@ void ConnPoolImpl::createNewConnection() {
   conn->moveIntoList(std::move(conn), pending_conns_);
 }
 
+void ConnPoolImpl::maybePrefetch() {
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio <= 1.0 || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  // Each connection is assigned to a single caller at a time, so keep enough connections to
+  // serve the current load scaled by the prefetch ratio.
+  const double anticipated_conns = (pending_requests_.size() + busy_conns_.size()) * ratio;
+  while (anticipated_conns > ready_conns_.size() + busy_conns_.size() + pending_conns_.size() &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a new connection");
+    createNewConnection();
+    pending_conns_.front()->prefetched_ = true;
+    host_->cluster().stats().upstream_cx_prefetch_total_.inc();
+  }
+}
+
 ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbacks& callbacks) {
   if (!ready_conns_.empty()) {
     ready_conns_.front()->moveBetweenLists(ready_conns_, busy_conns_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_conns_.front()->conn_);
     assignConnection(*busy_conns_.front(), callbacks);
+    maybePrefetch();
     return nullptr;
   }
 
@@ -97,15 +120,21 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
 
+    // When prefetching, a connection that is still being established and is not claimed by an
+    // earlier pending request will serve this one.
+    const bool unclaimed_connection = host_->cluster().perUpstreamPrefetchRatio() > 1.0 &&
+                                      pending_conns_.size() > pending_requests_.size();
+
     // If we have no connections at all, make one no matter what so we don't starve.
     if ((ready_conns_.empty() && busy_conns_.empty() && pending_conns_.empty()) ||
-        can_create_connection) {
+        (can_create_connection && !unclaimed_connection)) {
       createNewConnection();
     }
 
     ENVOY_LOG(debug, "queueing request due to no available connections");
     PendingRequestPtr pending_request(new PendingRequest(*this, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    maybePrefetch();
     return pending_requests_.front().get();
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
@@ -397,6 +426,10 @@ ConnPoolImpl::ActiveConn::~ActiveConn() {
     wrapper_->invalidate();
   }
 
+  if (prefetched_) {
+    parent_.host_->cluster().stats().upstream_cx_prefetch_unused_.inc();
+  }
+
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   parent_.host_->stats().cx_active_.dec();
   conn_length_->complete();
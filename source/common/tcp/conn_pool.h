@@ -116,6 +116,8 @@ protected:
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
     bool timed_out_;
+    // Set for connections established ahead of demand until they are first assigned.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveConn> ActiveConnPtr;
@@ -137,6 +139,7 @@ protected:
 
   void assignConnection(ActiveConn& conn, ConnectionPool::Callbacks& callbacks);
   void createNewConnection();
+  void maybePrefetch();
   void onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent event);
   void onPendingRequestCancel(PendingRequest& request, ConnectionPool::CancelPolicy cancel_policy);
   virtual void onConnReleased(ActiveConn& conn);
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+// Alias table (https://en.wikipedia.org/wiki/Alias_method) used for weighted random sampling.
+// The table is built in O(n) time using Vose's algorithm and each pick is O(1), consuming a single
+// 64-bit random value: the low 32 bits select a column and the high 32 bits are used as the biased
+// coin flip between the column and its alias. Unlike the EdfScheduler, picks do not mutate the
+// table, so the cost of a pick does not depend on the number of entries.
+class AliasTable {
+public:
+  AliasTable() = default;
+
+  /**
+   * Build the table for the given weights. The index of each weight is the value returned by
+   * pick().
+   * @param weights vector of non-negative weights, at least one of which must be positive.
+   */
+  explicit AliasTable(const std::vector<double>& weights)
+      : threshold_(weights.size()), alias_(weights.size()) {
+    const uint32_t size = weights.size();
+    double total_weight = 0;
+    for (const double weight : weights) {
+      ASSERT(weight >= 0);
+      total_weight += weight;
+    }
+    if (size == 0 || total_weight <= 0) {
+      threshold_.clear();
+      alias_.clear();
+      return;
+    }
+
+    // Scale the weights so that the average weight is 1, then pair each under-full column with an
+    // over-full column which donates the remainder of its probability mass.
+    std::vector<double> scaled(size);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < size; ++i) {
+      scaled[i] = weights[i] * size / total_weight;
+      (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+      const uint32_t less = small.back();
+      small.pop_back();
+      const uint32_t more = large.back();
+      large.pop_back();
+
+      threshold_[less] = toThreshold(scaled[less]);
+      alias_[less] = more;
+      scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+      (scaled[more] < 1.0 ? small : large).push_back(more);
+    }
+
+    // Whatever remains is full up to floating point rounding error.
+    for (const uint32_t i : large) {
+      threshold_[i] = FullThreshold;
+      alias_[i] = i;
+    }
+    for (const uint32_t i : small) {
+      threshold_[i] = FullThreshold;
+      alias_[i] = i;
+    }
+  }
+
+  /**
+   * Pick an entry with probability proportional to its weight.
+   * @param random a uniformly distributed 64-bit random value.
+   * @return uint32_t the index of the picked entry. The table must not be empty.
+   */
+  uint32_t pick(uint64_t random) const {
+    ASSERT(!empty());
+    const uint32_t column = static_cast<uint32_t>(random) % threshold_.size();
+    const uint64_t coin = random >> 32;
+    return coin < threshold_[column] ? column : alias_[column];
+  }
+
+  /**
+   * @return bool whether the table has no entries.
+   */
+  bool empty() const { return threshold_.empty(); }
+
+  /**
+   * @return size_t the number of entries in the table.
+   */
+  size_t size() const { return threshold_.size(); }
+
+private:
+  // A column with this threshold never defers to its alias.
+  static constexpr uint64_t FullThreshold = 1ULL << 32;
+
+  static uint64_t toThreshold(double probability) {
+    const uint64_t threshold = static_cast<uint64_t>(probability * FullThreshold);
+    if (threshold > FullThreshold) {
+      return FullThreshold;
+    }
+    return threshold;
+  }
+
+  // Probability (scaled to 2^32) of keeping the column rather than its alias.
+  std::vector<uint64_t> threshold_;
+  // Alias for each column.
+  std::vector<uint32_t> alias_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -622,7 +622,7 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
   const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
     // Nuke existing scheduler if it exists.
     auto& scheduler = scheduler_[source] = Scheduler{};
-    refreshHostSource(source);
+    refreshHostSource(source, hosts);
 
     // Populate scheduler with host list.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
@@ -699,6 +699,66 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   }
 }
 
+void LeastRequestLoadBalancer::refreshHostSource(const HostsSource& source,
+                                                 const HostVector& hosts) {
+  if (!weighted_p2c_) {
+    return;
+  }
+
+  // The sampling weights are captured here, so like the EDF schedule they may be stale if only
+  // host weights change. The live weight is still used when comparing candidates in
+  // weightedHostPick().
+  std::vector<double> weights;
+  weights.reserve(hosts.size());
+  for (const auto& host : hosts) {
+    weights.push_back(host->weight());
+  }
+  alias_tables_[source] = AliasTable(weights);
+}
+
+HostConstSharedPtr LeastRequestLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
+  if (!weighted_p2c_ || stats_.max_host_weight_.value() == 1) {
+    return EdfLoadBalancerBase::chooseHostOnce(context);
+  }
+
+  const HostsSource hosts_source = hostSourceToUse(context);
+  const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
+  if (hosts_to_use.empty()) {
+    return nullptr;
+  }
+
+  auto alias_table_it = alias_tables_.find(hosts_source);
+  // We should always have an alias table for any return value from hostSourceToUse() via the
+  // construction in refreshHostSource().
+  ASSERT(alias_table_it != alias_tables_.end());
+  ASSERT(alias_table_it->second.size() == hosts_to_use.size());
+  return weightedHostPick(hosts_to_use, alias_table_it->second);
+}
+
+HostConstSharedPtr LeastRequestLoadBalancer::weightedHostPick(const HostVector& hosts_to_use,
+                                                              const AliasTable& alias_table) {
+  HostSharedPtr candidate_host = nullptr;
+  uint64_t candidate_active_rq = 0;
+  uint64_t candidate_weight = 0;
+  for (uint32_t choice_idx = 0; choice_idx < choice_count_; ++choice_idx) {
+    const HostSharedPtr& sampled_host = hosts_to_use[alias_table.pick(random_.random())];
+    // Add 1 to the active requests so that weight is still taken into account for idle hosts.
+    const uint64_t sampled_active_rq = sampled_host->stats().rq_active_.value() + 1;
+    const uint64_t sampled_weight = sampled_host->weight();
+
+    // Compare active requests normalized by weight, i.e. sampled_active_rq / sampled_weight <
+    // candidate_active_rq / candidate_weight, without doing floating point division.
+    if (candidate_host == nullptr ||
+        sampled_active_rq * candidate_weight < candidate_active_rq * sampled_weight) {
+      candidate_host = sampled_host;
+      candidate_active_rq = sampled_active_rq;
+      candidate_weight = sampled_weight;
+    }
+  }
+
+  return candidate_host;
+}
+
 HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector& hosts_to_use,
                                                                 const HostsSource&) {
   HostSharedPtr candidate_host = nullptr;
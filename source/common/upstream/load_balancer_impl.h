@@ -11,6 +11,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/protobuf/utility.h"
+#include "common/upstream/alias_table.h"
 #include "common/upstream/edf_scheduler.h"
 
 namespace Envoy {
@@ -359,7 +360,7 @@ protected:
 
 private:
   void refresh(uint32_t priority);
-  virtual void refreshHostSource(const HostsSource& source) PURE;
+  virtual void refreshHostSource(const HostsSource& source, const HostVector& hosts) PURE;
   virtual double hostWeight(const Host& host) PURE;
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                                 const HostsSource& source) PURE;
@@ -384,7 +385,7 @@ public:
   }
 
 private:
-  void refreshHostSource(const HostsSource& source) override {
+  void refreshHostSource(const HostsSource& source, const HostVector&) override {
     // insert() is used here on purpose so that we don't overwrite the index if the host source
     // already exists. Note that host sources will never be removed, but given how uncommon this
     // is it probably doesn't matter.
@@ -411,14 +412,19 @@ private:
  * is based on http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf and is known as P2C
  * (power of two choices).
  *
- * When any hosts have a weight that is not 1, an RR EDF schedule is used. Host weight is scaled
- * by the number of active requests at pick/insert time. Thus, hosts will never fully drain as
+ * When any hosts have a weight that is not 1, an RR EDF schedule is used by default. Host weight is
+ * scaled by the number of active requests at pick/insert time. Thus, hosts will never fully drain as
  * they would in normal P2C, though they will get picked less and less often. In the future, we
  * can consider two alternate algorithms:
  * 1) Expand out all hosts by weight (using more memory) and do standard P2C.
  * 2) Use a weighted Maglev table, and perform P2C on two random hosts selected from the table.
  *    The benefit of the Maglev table is at the expense of resolution, memory usage is capped.
  *    Additionally, the Maglev table can be shared amongst all threads.
+ *
+ * When weighted_p2c is configured, weighted hosts instead use P2C: N candidates are sampled
+ * proportionally to their weight from an alias table built on host set refresh, and the candidate
+ * with the fewest active requests per unit of weight is chosen. Both sampling and comparison are
+ * O(1), so pick time does not depend on the number of hosts.
  */
 class LeastRequestLoadBalancer : public EdfLoadBalancerBase {
 public:
@@ -432,12 +438,17 @@ public:
         choice_count_(
             least_request_config.has_value()
                 ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(least_request_config.value(), choice_count, 2)
-                : 2) {
+                : 2),
+        weighted_p2c_(least_request_config.has_value() &&
+                      least_request_config.value().weighted_p2c()) {
     initialize();
   }
 
+  // Upstream::LoadBalancerBase
+  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+
 private:
-  void refreshHostSource(const HostsSource&) override {}
+  void refreshHostSource(const HostsSource& source, const HostVector& hosts) override;
   double hostWeight(const Host& host) override {
     // Here we scale host weight by the number of active requests at the time we do the pick. We
     // always add 1 to avoid division by 0. Note that if all weights are 1, the EDF schedule is
@@ -453,7 +464,13 @@ private:
   }
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                         const HostsSource& source) override;
+  HostConstSharedPtr weightedHostPick(const HostVector& hosts_to_use,
+                                      const AliasTable& alias_table);
+
   const uint32_t choice_count_;
+  const bool weighted_p2c_;
+  // Alias table for each valid HostsSource, only populated when weighted_p2c_ is set.
+  std::unordered_map<HostsSource, AliasTable, HostsSourceHash> alias_tables_;
 };
 
 /**
@@ -140,8 +140,8 @@ DetectorImpl::DetectorImpl(const Cluster& cluster,
 }
 
 DetectorImpl::~DetectorImpl() {
-  for (auto host : host_monitors_) {
-    if (host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+  for (const auto& slot : host_monitors_) {
+    if (slot.host_->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
       ASSERT(stats_.ejections_active_.value() > 0);
       stats_.ejections_active_.dec();
     }
@@ -172,13 +172,12 @@ void DetectorImpl::initialize(const Cluster& cluster) {
         }
 
         for (const HostSharedPtr& host : hosts_removed) {
-          ASSERT(host_monitors_.count(host) == 1);
           if (host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
             ASSERT(stats_.ejections_active_.value() > 0);
             stats_.ejections_active_.dec();
           }
 
-          host_monitors_.erase(host);
+          removeHostMonitor(host);
         }
       });
 
@@ -186,12 +185,32 @@ void DetectorImpl::initialize(const Cluster& cluster) {
 }
 
 void DetectorImpl::addHostMonitor(HostSharedPtr host) {
-  ASSERT(host_monitors_.count(host) == 0);
+  ASSERT(host_slots_.count(host) == 0);
   DetectorHostMonitorImpl* monitor = new DetectorHostMonitorImpl(shared_from_this(), host);
-  host_monitors_[host] = monitor;
+  host_slots_[host] = host_monitors_.size();
+  host_monitors_.push_back({host, monitor});
   host->setOutlierDetector(DetectorHostMonitorPtr{monitor});
 }
 
+void DetectorImpl::removeHostMonitor(const HostSharedPtr& host) {
+  const auto it = host_slots_.find(host);
+  ASSERT(it != host_slots_.end());
+  const uint32_t slot = it->second;
+  host_slots_.erase(it);
+
+  // Move the last slot into the vacated one to keep the monitors contiguous.
+  if (slot != host_monitors_.size() - 1) {
+    host_monitors_[slot] = std::move(host_monitors_.back());
+    host_slots_[host_monitors_[slot].host_] = slot;
+  }
+  host_monitors_.pop_back();
+}
+
+DetectorHostMonitorImpl& DetectorImpl::hostMonitor(const HostSharedPtr& host) {
+  ASSERT(host_slots_.count(host) == 1);
+  return *host_monitors_[host_slots_[host]].monitor_;
+}
+
 void DetectorImpl::armIntervalTimer() {
   interval_timer_->enableTimer(std::chrono::milliseconds(
       runtime_.snapshot().getInteger("outlier_detection.interval_ms", config_.intervalMs())));
@@ -212,8 +231,8 @@ void DetectorImpl::checkHostForUneject(HostSharedPtr host, DetectorHostMonitorIm
     host->healthFlagClear(Host::HealthFlag::FAILED_OUTLIER_CHECK);
     // Reset the consecutive failure counters to avoid re-ejection on very few new errors due
     // to the non-triggering counter being close to its trigger value.
-    host_monitors_[host]->resetConsecutive5xx();
-    host_monitors_[host]->resetConsecutiveGatewayFailure();
+    monitor->resetConsecutive5xx();
+    monitor->resetConsecutiveGatewayFailure();
     monitor->uneject(now);
     runCallbacks(host);
 
@@ -279,7 +298,7 @@ void DetectorImpl::ejectHost(HostSharedPtr host,
     if (enforceEjection(type)) {
       stats_.ejections_active_.inc();
       updateEnforcedEjectionStats(type);
-      host_monitors_[host]->eject(time_source_.monotonicTime());
+      hostMonitor(host).eject(time_source_.monotonicTime());
       runCallbacks(host);
       if (event_logger_) {
         event_logger_->logEject(host, *this, type, true);
@@ -335,7 +354,7 @@ void DetectorImpl::onConsecutiveErrorWorker(
     HostSharedPtr host, envoy::data::cluster::v2alpha::OutlierEjectionType type) {
   // Ejections come in cross thread. There is a chance that the host has already been removed from
   // the set. If so, just ignore it.
-  if (host_monitors_.count(host) == 0) {
+  if (host_slots_.count(host) == 0) {
     return;
   }
   if (host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
@@ -349,13 +368,13 @@ void DetectorImpl::onConsecutiveErrorWorker(
     stats_.ejections_consecutive_5xx_.inc(); // Deprecated
     stats_.ejections_detected_consecutive_5xx_.inc();
     ejectHost(host, envoy::data::cluster::v2alpha::OutlierEjectionType::CONSECUTIVE_5XX);
-    host_monitors_[host]->resetConsecutive5xx();
+    hostMonitor(host).resetConsecutive5xx();
     break;
   case envoy::data::cluster::v2alpha::OutlierEjectionType::CONSECUTIVE_GATEWAY_FAILURE:
     stats_.ejections_detected_consecutive_gateway_failure_.inc();
     ejectHost(host,
               envoy::data::cluster::v2alpha::OutlierEjectionType::CONSECUTIVE_GATEWAY_FAILURE);
-    host_monitors_[host]->resetConsecutiveGatewayFailure();
+    hostMonitor(host).resetConsecutiveGatewayFailure();
     break;
   default:
     // Checked by schema.
@@ -363,9 +382,10 @@ void DetectorImpl::onConsecutiveErrorWorker(
   }
 }
 
-Utility::EjectionPair Utility::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-    double success_rate_stdev_factor) {
+Utility::EjectionPair
+Utility::successRateEjectionThreshold(double success_rate_sum,
+                                      const std::vector<double>& success_rates,
+                                      double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
   // number of data points. Then variance is calculated by taking the mean of the
@@ -381,88 +401,92 @@ Utility::EjectionPair Utility::successRateEjectionThreshold(
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
+  const double mean = success_rate_sum / success_rates.size();
+  // The success rates are contiguous, so this is a tight loop without branches or indirection.
   double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  for (const double success_rate : success_rates) {
+    const double deviation = success_rate - mean;
+    variance += deviation * deviation;
+  }
+  variance /= success_rates.size();
+  const double stdev = std::sqrt(variance);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
 
-void DetectorImpl::processSuccessRateEjections() {
-  uint64_t success_rate_minimum_hosts = runtime_.snapshot().getInteger(
-      "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
-  uint64_t success_rate_request_volume = runtime_.snapshot().getInteger(
-      "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  double success_rate_sum = 0;
-
+void DetectorImpl::processSuccessRateEjections(uint64_t success_rate_minimum_hosts) {
   // Reset the Detector's success rate mean and stdev.
   success_rate_average_ = -1;
   success_rate_ejection_threshold_ = -1;
 
-  // Exit early if there are not enough hosts.
-  if (host_monitors_.size() < success_rate_minimum_hosts) {
+  if (success_rates_.empty() || success_rates_.size() < success_rate_minimum_hosts) {
     return;
   }
 
-  // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-
-  for (const auto& host : host_monitors_) {
-    // Don't do work if the host is already ejected.
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-      absl::optional<double> host_success_rate =
-          host.second->successRateAccumulator().getSuccessRate(success_rate_request_volume);
-
-      if (host_success_rate) {
-        valid_success_rate_hosts.emplace_back(
-            HostSuccessRatePair(host.first, host_success_rate.value()));
-        success_rate_sum += host_success_rate.value();
-        host.second->successRate(host_success_rate.value());
-      }
-    }
+  double success_rate_sum = 0;
+  for (const double success_rate : success_rates_) {
+    success_rate_sum += success_rate;
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
-    double success_rate_stdev_factor =
-        runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
-                                       config_.successRateStdevFactor()) /
-        1000.0;
-    Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
-    success_rate_average_ = ejection_pair.success_rate_average_;
-    success_rate_ejection_threshold_ = ejection_pair.ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold_) {
-        stats_.ejections_success_rate_.inc(); // Deprecated.
-        stats_.ejections_detected_success_rate_.inc();
-        ejectHost(host_success_rate_pair.host_,
-                  envoy::data::cluster::v2alpha::OutlierEjectionType::SUCCESS_RATE);
-      }
+  double success_rate_stdev_factor =
+      runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
+                                     config_.successRateStdevFactor()) /
+      1000.0;
+  Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(
+      success_rate_sum, success_rates_, success_rate_stdev_factor);
+  success_rate_average_ = ejection_pair.success_rate_average_;
+  success_rate_ejection_threshold_ = ejection_pair.ejection_threshold_;
+  for (uint32_t i = 0; i < success_rates_.size(); ++i) {
+    if (success_rates_[i] < success_rate_ejection_threshold_) {
+      stats_.ejections_success_rate_.inc(); // Deprecated.
+      stats_.ejections_detected_success_rate_.inc();
+      // Copy the host since ejecting it runs callbacks.
+      const HostSharedPtr host = host_monitors_[success_rate_slots_[i]].host_;
+      ejectHost(host, envoy::data::cluster::v2alpha::OutlierEjectionType::SUCCESS_RATE);
     }
   }
 }
 
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
+  const uint64_t success_rate_minimum_hosts = runtime_.snapshot().getInteger(
+      "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
+  const uint64_t success_rate_request_volume = runtime_.snapshot().getInteger(
+      "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
+  // Don't compute success rates if there are not enough hosts.
+  const bool collect_success_rates = host_monitors_.size() >= success_rate_minimum_hosts;
 
-  for (auto host : host_monitors_) {
-    checkHostForUneject(host.first, host.second, now);
+  success_rates_.clear();
+  success_rate_slots_.clear();
+  success_rates_.reserve(host_monitors_.size());
+  success_rate_slots_.reserve(host_monitors_.size());
+
+  // A single pass over all hosts unejects hosts, rotates their success rate buckets, and collects
+  // the success rates of the last interval.
+  for (uint32_t slot = 0; slot < host_monitors_.size(); ++slot) {
+    const HostSharedPtr host = host_monitors_[slot].host_;
+    DetectorHostMonitorImpl* monitor = host_monitors_[slot].monitor_;
+    checkHostForUneject(host, monitor, now);
 
     // Need to update the writer bucket to keep the data valid.
-    host.second->updateCurrentSuccessRateBucket();
+    monitor->updateCurrentSuccessRateBucket();
     // Refresh host success rate stat for the /clusters endpoint. If there is a new valid value, it
-    // will get updated in processSuccessRateEjections().
-    host.second->successRate(-1);
+    // is set below.
+    monitor->successRate(-1);
+
+    // Don't do work if the host is already ejected.
+    if (collect_success_rates && !host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+      const absl::optional<double> host_success_rate =
+          monitor->successRateAccumulator().getSuccessRate(success_rate_request_volume);
+      if (host_success_rate) {
+        success_rates_.push_back(host_success_rate.value());
+        success_rate_slots_.push_back(slot);
+        monitor->successRate(host_success_rate.value());
+      }
+    }
   }
 
-  processSuccessRateEjections();
+  processSuccessRateEjections(success_rate_minimum_hosts);
 
   armIntervalTimer();
 }
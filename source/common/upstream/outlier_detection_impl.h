@@ -52,16 +52,6 @@ public:
                                             EventLoggerSharedPtr event_logger);
 };
 
-/**
- * Thin struct to facilitate calculations for success rate outlier detection.
- */
-struct HostSuccessRatePair {
-  HostSuccessRatePair(HostSharedPtr host, double success_rate)
-      : host_(host), success_rate_(success_rate) {}
-  HostSharedPtr host_;
-  double success_rate_;
-};
-
 struct SuccessRateAccumulatorBucket {
   std::atomic<uint64_t> success_request_counter_;
   std::atomic<uint64_t> total_request_counter_;
@@ -233,6 +223,8 @@ private:
                EventLoggerSharedPtr event_logger);
 
   void addHostMonitor(HostSharedPtr host);
+  void removeHostMonitor(const HostSharedPtr& host);
+  DetectorHostMonitorImpl& hostMonitor(const HostSharedPtr& host);
   void armIntervalTimer();
   void checkHostForUneject(HostSharedPtr host, DetectorHostMonitorImpl* monitor, MonotonicTime now);
   void ejectHost(HostSharedPtr host, envoy::data::cluster::v2alpha::OutlierEjectionType type);
@@ -246,7 +238,7 @@ private:
   void runCallbacks(HostSharedPtr host);
   bool enforceEjection(envoy::data::cluster::v2alpha::OutlierEjectionType type);
   void updateEnforcedEjectionStats(envoy::data::cluster::v2alpha::OutlierEjectionType type);
-  void processSuccessRateEjections();
+  void processSuccessRateEjections(uint64_t success_rate_minimum_hosts);
 
   DetectorConfig config_;
   Event::Dispatcher& dispatcher_;
@@ -255,7 +247,18 @@ private:
   DetectionStats stats_;
   Event::TimerPtr interval_timer_;
   std::list<ChangeStateCb> callbacks_;
-  std::unordered_map<HostSharedPtr, DetectorHostMonitorImpl*> host_monitors_;
+  // Host monitors are stored contiguously so that the interval processing is a single linear pass
+  // over all hosts. host_slots_ maps each host to its index in host_monitors_.
+  struct HostMonitorSlot {
+    HostSharedPtr host_;
+    DetectorHostMonitorImpl* monitor_;
+  };
+  std::vector<HostMonitorSlot> host_monitors_;
+  std::unordered_map<HostSharedPtr, uint32_t> host_slots_;
+  // Success rates of the hosts eligible for success rate ejection in the current interval and
+  // their slots. Kept as members to avoid reallocating them on each interval.
+  std::vector<double> success_rates_;
+  std::vector<uint32_t> success_rate_slots_;
   EventLoggerSharedPtr event_logger_;
   double success_rate_average_;
   double success_rate_ejection_threshold_;
@@ -296,15 +299,13 @@ public:
    * This function returns an EjectionPair for success rate outlier detection. The pair contains
    * the average success rate of all valid hosts in the cluster and the ejection threshold.
    * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * @param success_rate_sum is the sum of the data in the success_rates vector.
+   * @param success_rates is the vector containing the individual success rate data points.
    * @return EjectionPair.
    */
-  static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-                               double success_rate_stdev_factor);
+  static EjectionPair successRateEjectionThreshold(double success_rate_sum,
+                                                   const std::vector<double>& success_rates,
+                                                   double success_rate_stdev_factor);
 };
 
 } // namespace Outlier
@@ -0,0 +1,129 @@
+#include "common/upstream/peak_ewma_lb.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Upstream {
+
+namespace {
+// The cost of a host with active requests but no latency estimate. This is larger than any
+// realistic latency based cost so that such hosts are only picked when all candidates are in the
+// same situation, in which case the one with the fewest active requests wins.
+constexpr double UnknownLatencyPenalty = 1e12;
+constexpr uint64_t DefaultDecayTimeMs = 10000;
+// A failed request is recorded as a response taking at least this long, and at least
+// FailurePenaltyFactor times the current estimate.
+constexpr double MinFailurePenaltyUs = 1000000;
+constexpr double FailurePenaltyFactor = 2;
+} // namespace
+
+PeakEwmaHostMonitorImpl::PeakEwmaHostMonitorImpl(std::chrono::milliseconds decay_time)
+    : decay_time_us_(std::chrono::duration_cast<std::chrono::microseconds>(decay_time).count()) {
+  ASSERT(decay_time_us_ > 0);
+}
+
+std::chrono::milliseconds PeakEwmaHostMonitorImpl::decayTime(
+    const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>& config) {
+  return std::chrono::milliseconds(
+      config.has_value() ? PROTOBUF_GET_MS_OR_DEFAULT(config.value(), decay_time, DefaultDecayTimeMs)
+                         : DefaultDecayTimeMs);
+}
+
+double PeakEwmaHostMonitorImpl::decayFactor(int64_t last_update_ns, MonotonicTime now) const {
+  const int64_t now_ns = toNanoseconds(now);
+  if (now_ns <= last_update_ns) {
+    return 1.0;
+  }
+  const double elapsed_us = (now_ns - last_update_ns) / 1000.0;
+  return std::exp(-elapsed_us / decay_time_us_);
+}
+
+void PeakEwmaHostMonitorImpl::putSample(double sample_us, MonotonicTime now) {
+  const double weight = decayFactor(last_update_ns_.load(std::memory_order_relaxed), now);
+  double estimate_us = estimate_us_.load(std::memory_order_relaxed);
+  double new_estimate_us;
+  do {
+    // Track peaks immediately.
+    new_estimate_us = sample_us > estimate_us
+                          ? sample_us
+                          : estimate_us * weight + sample_us * (1.0 - weight);
+  } while (!estimate_us_.compare_exchange_weak(estimate_us, new_estimate_us,
+                                               std::memory_order_relaxed));
+
+  // Only move the time of the last update forwards.
+  const int64_t now_ns = toNanoseconds(now);
+  int64_t last_update_ns = last_update_ns_.load(std::memory_order_relaxed);
+  while (now_ns > last_update_ns &&
+         !last_update_ns_.compare_exchange_weak(last_update_ns, now_ns,
+                                                std::memory_order_relaxed)) {
+  }
+}
+
+void PeakEwmaHostMonitorImpl::putResponseTime(std::chrono::microseconds response_time,
+                                              MonotonicTime now) {
+  putSample(response_time.count(), now);
+}
+
+void PeakEwmaHostMonitorImpl::putFailure(std::chrono::microseconds elapsed, MonotonicTime now) {
+  const double penalty_us =
+      std::max(MinFailurePenaltyUs, FailurePenaltyFactor * latencyEstimate(now));
+  putSample(std::max<double>(elapsed.count(), penalty_us), now);
+}
+
+double PeakEwmaHostMonitorImpl::latencyEstimate(MonotonicTime now) const {
+  // Decaying towards zero while idle is equivalent to recording a zero latency response now.
+  return estimate_us_.load(std::memory_order_relaxed) *
+         decayFactor(last_update_ns_.load(std::memory_order_relaxed), now);
+}
+
+PeakEwmaLoadBalancer::PeakEwmaLoadBalancer(
+    const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+    Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+    const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+    const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>& config,
+    TimeSource& time_source)
+    : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
+                                common_config),
+      choice_count_(config.has_value()
+                        ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value(), choice_count, 2)
+                        : 2),
+      time_source_(time_source) {}
+
+double PeakEwmaLoadBalancer::hostCost(const Host& host, MonotonicTime now) {
+  const double latency = host.latencyMonitor().latencyEstimate(now);
+  const uint64_t active_rq = host.stats().rq_active_.value();
+  double cost;
+  if (latency == 0 && active_rq > 0) {
+    cost = UnknownLatencyPenalty + active_rq;
+  } else {
+    cost = latency * (active_rq + 1);
+  }
+  return cost / host.weight();
+}
+
+HostConstSharedPtr PeakEwmaLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
+  const HostVector& hosts_to_use = hostSourceToHosts(hostSourceToUse(context));
+  if (hosts_to_use.empty()) {
+    return nullptr;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  HostSharedPtr candidate_host = nullptr;
+  double candidate_cost = 0;
+  for (uint32_t choice_idx = 0; choice_idx < choice_count_; ++choice_idx) {
+    const HostSharedPtr& sampled_host = hosts_to_use[random_.random() % hosts_to_use.size()];
+    const double sampled_cost = hostCost(*sampled_host, now);
+    if (candidate_host == nullptr || sampled_cost < candidate_cost) {
+      candidate_host = sampled_host;
+      candidate_cost = sampled_cost;
+    }
+  }
+
+  return candidate_host;
+}
+
+} // namespace Upstream
+} // namespace Envoy
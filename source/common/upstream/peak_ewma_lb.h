@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/api/v2/cds.pb.h"
+#include "envoy/common/time.h"
+#include "envoy/upstream/latency_host_monitor.h"
+
+#include "common/upstream/load_balancer_impl.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Peak exponentially weighted moving average of host response latency. Observations above the
+ * current estimate replace it immediately, so the estimate reacts to latency spikes at once while
+ * recovering from them gradually. The estimate also decays towards zero while no responses are
+ * recorded, so that a host which stopped receiving traffic because it was slow is eventually
+ * retried. Failed requests are recorded as penalty responses.
+ *
+ * Responses are recorded from every worker thread without locking. The estimate and the time of
+ * the last update are separate atomics, so a racing update may be averaged with a slightly stale
+ * timestamp, which is harmless for a load balancing heuristic.
+ */
+class PeakEwmaHostMonitorImpl : public LatencyHostMonitor {
+public:
+  explicit PeakEwmaHostMonitorImpl(std::chrono::milliseconds decay_time);
+
+  static std::chrono::milliseconds
+  decayTime(const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>& config);
+
+  // Upstream::LatencyHostMonitor
+  void putResponseTime(std::chrono::microseconds response_time, MonotonicTime now) override;
+  void putFailure(std::chrono::microseconds elapsed, MonotonicTime now) override;
+  double latencyEstimate(MonotonicTime now) const override;
+
+private:
+  void putSample(double sample_us, MonotonicTime now);
+  double decayFactor(int64_t last_update_ns, MonotonicTime now) const;
+
+  static int64_t toNanoseconds(MonotonicTime time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+  }
+
+  // The decay time constant in microseconds.
+  const double decay_time_us_;
+  std::atomic<double> estimate_us_{0};
+  // The monotonic time of the latest update, in nanoseconds since the clock's epoch.
+  std::atomic<int64_t> last_update_ns_{0};
+};
+
+/**
+ * Latency aware load balancer based on the "peak EWMA" policy. N random available hosts are
+ * selected as specified by the configuration (2 by default) and the host with the lowest cost is
+ * picked, where the cost of a host is its peak EWMA response latency multiplied by its number of
+ * active requests plus one, divided by its weight. Hosts without a latency estimate yet are
+ * preferred while idle and heavily penalized while they have outstanding requests, so new hosts are
+ * probed without being flooded.
+ *
+ * The latency estimate is kept per host and is shared by the load balancers on all workers. It is
+ * fed by the router with the time between sending a request to the host and receiving the response
+ * headers.
+ */
+class PeakEwmaLoadBalancer : public ZoneAwareLoadBalancerBase {
+public:
+  PeakEwmaLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
+                       ClusterStats& stats, Runtime::Loader& runtime,
+                       Runtime::RandomGenerator& random,
+                       const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                       const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>& config,
+                       TimeSource& time_source);
+
+  // Upstream::LoadBalancerBase
+  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+
+private:
+  static double hostCost(const Host& host, MonotonicTime now);
+
+  const uint32_t choice_count_;
+  TimeSource& time_source_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
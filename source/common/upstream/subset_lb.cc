@@ -1,5 +1,6 @@
 #include "common/upstream/subset_lb.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 
@@ -7,11 +8,13 @@
 #include "envoy/runtime/runtime.h"
 
 #include "common/common/assert.h"
+#include "common/common/hash.h"
 #include "common/config/metadata.h"
 #include "common/config/well_known_names.h"
 #include "common/protobuf/utility.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
+#include "common/upstream/peak_ewma_lb.h"
 #include "common/upstream/ring_hash_lb.h"
 
 namespace Envoy {
@@ -23,10 +26,12 @@ SubsetLoadBalancer::SubsetLoadBalancer(
     Runtime::RandomGenerator& random, const LoadBalancerSubsetInfo& subsets,
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
     const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>& least_request_config,
-    const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+    const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>& peak_ewma_config,
+    const envoy::api::v2::Cluster::CommonLbConfig& common_config, TimeSource& time_source)
     : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config),
-      least_request_config_(least_request_config), common_config_(common_config), stats_(stats),
-      scope_(scope), runtime_(runtime), random_(random), fallback_policy_(subsets.fallbackPolicy()),
+      least_request_config_(least_request_config), peak_ewma_config_(peak_ewma_config),
+      common_config_(common_config), stats_(stats), scope_(scope), runtime_(runtime),
+      random_(random), time_source_(time_source), fallback_policy_(subsets.fallbackPolicy()),
       default_subset_metadata_(subsets.defaultSubset().fields().begin(),
                                subsets.defaultSubset().fields().end()),
       subset_keys_(subsets.subsetKeys()), original_priority_set_(priority_set),
@@ -90,7 +95,7 @@ SubsetLoadBalancer::~SubsetLoadBalancer() {
   original_priority_set_callback_handle_->remove();
 
   // Ensure gauges reflect correct values.
-  forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
+  forEachSubset([&](LbSubsetEntryPtr entry) {
     if (entry->initialized() && entry->active()) {
       stats_.lb_subsets_removed_.inc();
       stats_.lb_subsets_active_.dec();
@@ -165,40 +170,30 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   return entry->priority_subset_->lb_->chooseHost(context);
 }
 
-// Iterates over the given metadata match criteria (which must be lexically sorted by key) and find
-// a matching LbSubsetEntryPtr, if any.
+// Finds the LbSubsetEntryPtr matching the given metadata match criteria (which must be lexically
+// sorted by key), if any. The criteria values carry precomputed hashes, so this is a single index
+// lookup regardless of the number of criteria.
 SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findSubset(
     const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
-  const LbSubsetMap* subsets = &subsets_;
-
-  // Because the match_criteria and the host metadata used to populate subsets_ are sorted in the
-  // same order, we can iterate over the criteria and perform a lookup for each key and value,
-  // starting with the root LbSubsetMap and using the previous iteration's LbSubsetMap thereafter
-  // (tracked in subsets). If ever a criterion's key or value is not found, there is no subset for
-  // this criteria. If we reach the last criterion, we've found the LbSubsetEntry for the criteria,
-  // which may or may not have a subset attached to it.
-  for (uint32_t i = 0; i < match_criteria.size(); i++) {
-    const Router::MetadataMatchCriterion& match_criterion = *match_criteria[i];
-    const auto& subset_it = subsets->find(match_criterion.name());
-    if (subset_it == subsets->end()) {
-      // No subsets with this key (at this level in the hierarchy).
-      break;
-    }
+  if (match_criteria.empty()) {
+    return nullptr;
+  }
 
-    const ValueSubsetMap& vs_map = subset_it->second;
-    const auto& vs_it = vs_map.find(match_criterion.value());
-    if (vs_it == vs_map.end()) {
-      // No subsets with this value.
-      break;
+  const auto range = subsets_.equal_range(subsetHash(match_criteria));
+  for (auto it = range.first; it != range.second; ++it) {
+    const SubsetMetadata& kvs = it->second->kvs_;
+    if (kvs.size() != match_criteria.size()) {
+      continue;
     }
 
-    const LbSubsetEntryPtr& entry = vs_it->second;
-    if (i + 1 == match_criteria.size()) {
-      // We've reached the end of the criteria, and they all matched.
-      return entry;
+    bool matches = true;
+    for (uint32_t i = 0; i < kvs.size() && matches; i++) {
+      matches = kvs[i].first == match_criteria[i]->name() &&
+                ValueUtil::equal(kvs[i].second, match_criteria[i]->value().value());
+    }
+    if (matches) {
+      return it->second;
     }
-
-    subsets = &entry->children_;
   }
 
   return nullptr;
@@ -237,33 +232,31 @@ void SubsetLoadBalancer::processSubsets(
     const bool adding_hosts = step.second;
 
     for (const auto& host : hosts) {
-      for (const auto& keys : subset_keys_) {
-        // For each host, for each subset key, attempt to extract the metadata corresponding to the
-        // key from the host.
-        SubsetMetadata kvs = extractSubsetMetadata(keys, *host);
-        if (!kvs.empty()) {
-          // The host has metadata for each key, find or create its subset.
-          LbSubsetEntryPtr entry = findOrCreateSubset(subsets_, kvs, 0);
-          if (subsets_modified.find(entry) != subsets_modified.end()) {
-            // We've already invoked the callback for this entry.
-            continue;
-          }
-          subsets_modified.emplace(entry);
-
-          if (entry->initialized()) {
-            update_cb(entry);
-          } else {
-            HostPredicate predicate = [this, kvs](const Host& host) -> bool {
-              return hostMatches(kvs, host);
-            };
-            new_cb(entry, predicate, kvs, adding_hosts);
-          }
+      // For each host, find or create the subset for each subset key the host has metadata for.
+      // The vector is copied since creating a subset below may update the cached host subsets.
+      const std::vector<LbSubsetEntryPtr> entries = hostSubsets(*host);
+      for (const LbSubsetEntryPtr& entry : entries) {
+        if (subsets_modified.find(entry) != subsets_modified.end()) {
+          // We've already invoked the callback for this entry.
+          continue;
+        }
+        subsets_modified.emplace(entry);
+
+        if (entry->initialized()) {
+          update_cb(entry);
+        } else {
+          // The entry is owned by subsets_ and outlives its priority subset.
+          const LbSubsetEntry* raw_entry = entry.get();
+          HostPredicate predicate = [this, raw_entry](const Host& host) -> bool {
+            return hostInSubset(host, *raw_entry);
+          };
+          new_cb(entry, predicate, entry->kvs_, adding_hosts);
         }
       }
     }
   }
 
-  forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
+  forEachSubset([&](LbSubsetEntryPtr entry) {
     if (subsets_modified.find(entry) != subsets_modified.end()) {
       // Already handled due to hosts being added or removed.
       return;
@@ -310,6 +303,12 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
           stats_.lb_subsets_created_.inc();
         }
       });
+
+  // Removed hosts have been filtered out of their subsets, so their cached subsets are no longer
+  // needed. If a host moved to another priority, its subsets are recomputed on the next lookup.
+  for (const auto& host : hosts_removed) {
+    host_subsets_.erase(host.get());
+  }
 }
 
 bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host) {
@@ -338,14 +337,51 @@ bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host
   return true;
 }
 
-// Iterates over subset_keys looking up values from the given host's metadata. Each key-value pair
+bool SubsetLoadBalancer::hostInSubset(const Host& host, const LbSubsetEntry& entry) {
+  const std::vector<LbSubsetEntryPtr>& subsets = hostSubsets(host);
+  return std::any_of(subsets.begin(), subsets.end(),
+                     [&entry](const LbSubsetEntryPtr& subset) { return subset.get() == &entry; });
+}
+
+// Returns the subsets the given host belongs to, creating uninitialized entries for any subsets not
+// seen before. The result is cached per host and only recomputed when the host's metadata is
+// replaced, so hosts are matched against subsets by pointer comparison rather than by comparing
+// their metadata on every update.
+const std::vector<SubsetLoadBalancer::LbSubsetEntryPtr>&
+SubsetLoadBalancer::hostSubsets(const Host& host) {
+  const std::shared_ptr<const envoy::api::v2::core::Metadata> metadata = host.metadata();
+  HostSubsets& host_subsets = host_subsets_[&host];
+  if (host_subsets.metadata_ == metadata && metadata != nullptr) {
+    return host_subsets.subsets_;
+  }
+
+  // Holding on to the metadata guarantees that a change is detected even if the host is destroyed
+  // and another one is allocated at the same address.
+  host_subsets.metadata_ = metadata;
+  host_subsets.subsets_.clear();
+  if (metadata == nullptr) {
+    return host_subsets.subsets_;
+  }
+
+  for (const auto& keys : subset_keys_) {
+    // For each subset key, attempt to extract the metadata corresponding to the key from the host.
+    SubsetMetadata kvs = extractSubsetMetadata(keys, *metadata);
+    if (!kvs.empty()) {
+      // The host has metadata for each key, find or create its subset.
+      host_subsets.subsets_.emplace_back(findOrCreateSubset(kvs));
+    }
+  }
+
+  return host_subsets.subsets_;
+}
+
+// Iterates over subset_keys looking up values from the given host metadata. Each key-value pair
 // is appended to kvs. Returns a non-empty value if the host has a value for each key.
 SubsetLoadBalancer::SubsetMetadata
 SubsetLoadBalancer::extractSubsetMetadata(const std::set<std::string>& subset_keys,
-                                          const Host& host) {
+                                          const envoy::api::v2::core::Metadata& metadata) {
   SubsetMetadata kvs;
 
-  const envoy::api::v2::core::Metadata& metadata = *host.metadata();
   const auto& filter_it = metadata.filter_metadata().find(Config::MetadataFilters::get().ENVOY_LB);
   if (filter_it == metadata.filter_metadata().end()) {
     return kvs;
@@ -387,57 +423,60 @@ std::string SubsetLoadBalancer::describeMetadata(const SubsetLoadBalancer::Subse
   return buf.str();
 }
 
-// Given a vector of key-values (from extractSubsetMetadata), recursively finds the matching
-// LbSubsetEntryPtr.
-SubsetLoadBalancer::LbSubsetEntryPtr
-SubsetLoadBalancer::findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                       uint32_t idx) {
-  ASSERT(idx < kvs.size());
-
-  const std::string& name = kvs[idx].first;
-  const ProtobufWkt::Value& pb_value = kvs[idx].second;
-  const HashedValue value(pb_value);
-  LbSubsetEntryPtr entry;
-
-  const auto& kv_it = subsets.find(name);
-  if (kv_it != subsets.end()) {
-    ValueSubsetMap& value_subset_map = kv_it->second;
-    const auto vs_it = value_subset_map.find(value);
-    if (vs_it != value_subset_map.end()) {
-      entry = vs_it->second;
-    }
+// Combines the hash of each key and value in order. The route metadata match criteria and the
+// subset key-values must produce the same hash for the same (lexically sorted) key-values.
+uint64_t SubsetLoadBalancer::subsetHash(const SubsetMetadata& kvs) {
+  uint64_t hash = 0;
+  for (const auto& kv : kvs) {
+    hash = HashUtil::xxHash64(kv.first, hash ^ ValueUtil::hash(kv.second));
   }
+  return hash;
+}
 
-  if (!entry) {
-    // Not found. Create an uninitialized entry.
-    entry.reset(new LbSubsetEntry());
-    if (kv_it != subsets.end()) {
-      ValueSubsetMap& value_subset_map = kv_it->second;
-      value_subset_map.emplace(value, entry);
-    } else {
-      ValueSubsetMap value_subset_map = {{value, entry}};
-      subsets.emplace(name, value_subset_map);
-    }
+uint64_t SubsetLoadBalancer::subsetHash(
+    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
+  uint64_t hash = 0;
+  for (const auto& match_criterion : match_criteria) {
+    hash = HashUtil::xxHash64(match_criterion->name(), hash ^ match_criterion->value().hash());
   }
+  return hash;
+}
 
-  idx++;
-  if (idx == kvs.size()) {
-    // We've matched all the key-values, return the entry.
-    return entry;
+// Given a vector of key-values (from extractSubsetMetadata), finds the matching LbSubsetEntryPtr,
+// creating an uninitialized entry if there is none yet.
+SubsetLoadBalancer::LbSubsetEntryPtr
+SubsetLoadBalancer::findOrCreateSubset(const SubsetMetadata& kvs) {
+  ASSERT(!kvs.empty());
+
+  const uint64_t hash = subsetHash(kvs);
+  const auto range = subsets_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const SubsetMetadata& entry_kvs = it->second->kvs_;
+    if (std::equal(entry_kvs.begin(), entry_kvs.end(), kvs.begin(), kvs.end(),
+                   [](const auto& lhs, const auto& rhs) {
+                     return lhs.first == rhs.first && ValueUtil::equal(lhs.second, rhs.second);
+                   })) {
+      return it->second;
+    }
   }
 
-  return findOrCreateSubset(entry->children_, kvs, idx);
+  // Not found. Create an uninitialized entry.
+  LbSubsetEntryPtr entry = std::make_shared<LbSubsetEntry>(kvs);
+  subsets_.emplace(hash, entry);
+  return entry;
 }
 
-// Invokes cb for each LbSubsetEntryPtr in subsets.
-void SubsetLoadBalancer::forEachSubset(LbSubsetMap& subsets,
-                                       std::function<void(LbSubsetEntryPtr)> cb) {
-  for (auto& vsm : subsets) {
-    for (auto& em : vsm.second) {
-      LbSubsetEntryPtr entry = em.second;
-      cb(entry);
-      forEachSubset(entry->children_, cb);
-    }
+// Invokes cb for each LbSubsetEntryPtr. The entries are copied first since cb may create new
+// subsets while matching hosts.
+void SubsetLoadBalancer::forEachSubset(std::function<void(LbSubsetEntryPtr)> cb) {
+  std::vector<LbSubsetEntryPtr> entries;
+  entries.reserve(subsets_.size());
+  for (const auto& it : subsets_) {
+    entries.push_back(it.second);
+  }
+
+  for (const LbSubsetEntryPtr& entry : entries) {
+    cb(entry);
   }
 }
 
@@ -466,6 +505,13 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
         subset_lb.random_, subset_lb.common_config_, subset_lb.least_request_config_);
     break;
 
+  case LoadBalancerType::PeakEwma:
+    lb_ = std::make_unique<PeakEwmaLoadBalancer>(
+        *this, subset_lb.original_local_priority_set_, subset_lb.stats_, subset_lb.runtime_,
+        subset_lb.random_, subset_lb.common_config_, subset_lb.peak_ewma_config_,
+        subset_lb.time_source_);
+    break;
+
   case LoadBalancerType::Random:
     lb_ = std::make_unique<RandomLoadBalancer>(*this, subset_lb.original_local_priority_set_,
                                                subset_lb.stats_, subset_lb.runtime_,
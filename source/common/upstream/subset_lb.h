@@ -28,7 +28,8 @@ public:
       Runtime::RandomGenerator& random, const LoadBalancerSubsetInfo& subsets,
       const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
       const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>& least_request_config,
-      const envoy::api::v2::Cluster::CommonLbConfig& common_config);
+      const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>& peak_ewma_config,
+      const envoy::api::v2::Cluster::CommonLbConfig& common_config, TimeSource& time_source);
   ~SubsetLoadBalancer();
 
   // Upstream::LoadBalancer
@@ -112,23 +113,32 @@ private:
 
   class LbSubsetEntry;
   typedef std::shared_ptr<LbSubsetEntry> LbSubsetEntryPtr;
-  typedef std::unordered_map<HashedValue, LbSubsetEntryPtr> ValueSubsetMap;
-  typedef std::unordered_map<std::string, ValueSubsetMap> LbSubsetMap;
+  // Subsets keyed by the hash of their key-values (see subsetHash()). Entries with colliding
+  // hashes are told apart by comparing their key-values.
+  typedef std::unordered_multimap<uint64_t, LbSubsetEntryPtr> LbSubsetMap;
 
-  // Entry in the subset hierarchy.
+  // Entry in the subset index.
   class LbSubsetEntry {
   public:
     LbSubsetEntry() {}
+    LbSubsetEntry(const SubsetMetadata& kvs) : kvs_(kvs) {}
 
     bool initialized() const { return priority_subset_ != nullptr; }
     bool active() const { return initialized() && !priority_subset_->empty(); }
 
-    LbSubsetMap children_;
+    // Lexically sorted key-values shared by the hosts in this subset.
+    const SubsetMetadata kvs_;
 
-    // Only initialized if a match exists at this level.
+    // Only initialized if a host with these key-values has been added.
     PrioritySubsetImplPtr priority_subset_;
   };
 
+  // The subsets a host belongs to, valid for as long as the host's metadata is unchanged.
+  struct HostSubsets {
+    std::shared_ptr<const envoy::api::v2::core::Metadata> metadata_;
+    std::vector<LbSubsetEntryPtr> subsets_;
+  };
+
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
   void refreshSubsets();
   void refreshSubsets(uint32_t priority);
@@ -146,25 +156,33 @@ private:
   HostConstSharedPtr tryChooseHostFromContext(LoadBalancerContext* context, bool& host_chosen);
 
   bool hostMatches(const SubsetMetadata& kvs, const Host& host);
+  bool hostInSubset(const Host& host, const LbSubsetEntry& entry);
+  const std::vector<LbSubsetEntryPtr>& hostSubsets(const Host& host);
 
   LbSubsetEntryPtr
   findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
 
-  LbSubsetEntryPtr findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                      uint32_t idx);
-  void forEachSubset(LbSubsetMap& subsets, std::function<void(LbSubsetEntryPtr)> cb);
+  LbSubsetEntryPtr findOrCreateSubset(const SubsetMetadata& kvs);
+  void forEachSubset(std::function<void(LbSubsetEntryPtr)> cb);
 
-  SubsetMetadata extractSubsetMetadata(const std::set<std::string>& subset_keys, const Host& host);
+  static uint64_t subsetHash(const SubsetMetadata& kvs);
+  static uint64_t
+  subsetHash(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria);
+
+  SubsetMetadata extractSubsetMetadata(const std::set<std::string>& subset_keys,
+                                       const envoy::api::v2::core::Metadata& metadata);
   std::string describeMetadata(const SubsetMetadata& kvs);
 
   const LoadBalancerType lb_type_;
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
   const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> least_request_config_;
+  const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig> peak_ewma_config_;
   const envoy::api::v2::Cluster::CommonLbConfig common_config_;
   ClusterStats& stats_;
   Stats::Scope& scope_;
   Runtime::Loader& runtime_;
   Runtime::RandomGenerator& random_;
+  TimeSource& time_source_;
 
   const envoy::api::v2::Cluster::LbSubsetConfig::LbSubsetFallbackPolicy fallback_policy_;
   const SubsetMetadata default_subset_metadata_;
@@ -177,9 +195,14 @@ private:
   LbSubsetEntryPtr fallback_subset_;
   LbSubsetEntryPtr panic_mode_subset_;
 
-  // Forms a trie-like structure. Requires lexically sorted Host and Route metadata.
+  // Index of all subsets by their key-values, so that finding the subset for a route's metadata
+  // match criteria is a single lookup. Requires lexically sorted Host and Route metadata.
   LbSubsetMap subsets_;
 
+  // Caches the subsets of each host so that hosts whose metadata did not change are not matched
+  // against every subset again on each update.
+  std::unordered_map<const Host*, HostSubsets> host_subsets_;
+
   const bool locality_weight_aware_;
   const bool scale_locality_weight_;
 
@@ -39,6 +39,7 @@
 #include "common/stats/isolated_store_impl.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/outlier_detection_impl.h"
+#include "common/upstream/peak_ewma_lb.h"
 #include "common/upstream/resource_manager_impl.h"
 
 #include "absl/synchronization/mutex.h"
@@ -55,6 +56,17 @@ public:
   void setUnhealthy() override {}
 };
 
+/**
+ * Null implementation of LatencyHostMonitor.
+ */
+class LatencyHostMonitorNullImpl : public LatencyHostMonitor {
+public:
+  // Upstream::LatencyHostMonitor
+  void putResponseTime(std::chrono::microseconds, MonotonicTime) override {}
+  void putFailure(std::chrono::microseconds, MonotonicTime) override {}
+  double latencyEstimate(MonotonicTime) const override { return 0; }
+};
+
 /**
  * Implementation of Upstream::HostDescription.
  */
@@ -75,6 +87,12 @@ public:
         locality_(locality), stats_{ALL_HOST_STATS(POOL_COUNTER(stats_store_),
                                                    POOL_GAUGE(stats_store_))},
         priority_(priority) {
+    // Only latency aware load balancers consume the latency estimate, so avoid the cost of
+    // maintaining it otherwise.
+    if (cluster_->lbType() == LoadBalancerType::PeakEwma) {
+      latency_monitor_ = std::make_unique<PeakEwmaHostMonitorImpl>(
+          PeakEwmaHostMonitorImpl::decayTime(cluster_->lbPeakEwmaConfig()));
+    }
     if (health_check_config.port_value() != 0 &&
         dest_address->type() != Network::Address::Type::Ip) {
       // Setting the health check port to non-0 only works for IP-type addresses. Setting the port
@@ -129,6 +147,14 @@ public:
       return *null_outlier_detector;
     }
   }
+  LatencyHostMonitor& latencyMonitor() const override {
+    if (latency_monitor_) {
+      return *latency_monitor_;
+    } else {
+      static LatencyHostMonitorNullImpl* null_latency_monitor = new LatencyHostMonitorNullImpl();
+      return *null_latency_monitor;
+    }
+  }
   const HostStats& stats() const override { return stats_; }
   const std::string& hostname() const override { return hostname_; }
   Network::Address::InstanceConstSharedPtr address() const override { return address_; }
@@ -154,6 +180,7 @@ protected:
   HostStats stats_;
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
+  LatencyHostMonitorPtr latency_monitor_;
   std::atomic<uint32_t> priority_;
 };
 
@@ -518,6 +545,10 @@ public:
   lbLeastRequestConfig() const override {
     return lb_least_request_config_;
   }
+  const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>&
+  lbPeakEwmaConfig() const override {
+    return lb_peak_ewma_config_;
+  }
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>&
   lbRingHashConfig() const override {
     return lb_ring_hash_config_;
@@ -528,6 +559,7 @@ public:
   }
   bool maintenanceMode() const override;
   uint64_t maxRequestsPerConnection() const override { return max_requests_per_connection_; }
+  float perUpstreamPrefetchRatio() const override { return per_upstream_prefetch_ratio_; }
   const std::string& name() const override { return name_; }
   ResourceManager& resourceManager(ResourcePriority priority) const override;
   Network::TransportSocketFactory& transportSocketFactory() const override {
@@ -568,6 +600,7 @@ private:
   const std::string name_;
   const envoy::api::v2::Cluster::DiscoveryType type_;
   const uint64_t max_requests_per_connection_;
+  const float per_upstream_prefetch_ratio_;
   const std::chrono::milliseconds connect_timeout_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
   const uint32_t per_connection_buffer_limit_bytes_;
@@ -584,6 +617,7 @@ private:
   const Network::Address::InstanceConstSharedPtr source_address_;
   LoadBalancerType lb_type_;
   absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> lb_least_request_config_;
+  absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig> lb_peak_ewma_config_;
   absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
   absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
   const bool added_via_api_;
@@ -23,7 +23,9 @@ EXTENSIONS = {
     # HTTP filters
     #
 
+    "envoy.filters.http.adaptive_concurrency":          "//source/extensions/filters/http/adaptive_concurrency:config",
     "envoy.filters.http.buffer":                        "//source/extensions/filters/http/buffer:config",
+    "envoy.filters.http.cache":                         "//source/extensions/filters/http/cache:config",
     "envoy.filters.http.cors":                          "//source/extensions/filters/http/cors:config",
     "envoy.filters.http.csrf":                          "//source/extensions/filters/http/csrf:config",
     "envoy.filters.http.dynamo":                        "//source/extensions/filters/http/dynamo:config",
@@ -38,9 +40,11 @@ EXTENSIONS = {
     "envoy.filters.http.health_check":                  "//source/extensions/filters/http/health_check:config",
     "envoy.filters.http.ip_tagging":                    "//source/extensions/filters/http/ip_tagging:config",
     "envoy.filters.http.jwt_authn":                     "//source/extensions/filters/http/jwt_authn:config",
+    "envoy.filters.http.local_ratelimit":               "//source/extensions/filters/http/local_ratelimit:config",
     "envoy.filters.http.lua":                           "//source/extensions/filters/http/lua:config",
     "envoy.filters.http.ratelimit":                     "//source/extensions/filters/http/ratelimit:config",
     "envoy.filters.http.rbac":                          "//source/extensions/filters/http/rbac:config",
+    "envoy.filters.http.request_coalescing":            "//source/extensions/filters/http/request_coalescing:config",
     "envoy.filters.http.router":                        "//source/extensions/filters/http/router:config",
     "envoy.filters.http.squash":                        "//source/extensions/filters/http/squash:config",
     "envoy.filters.http.tap":                           "//source/extensions/filters/http/tap:config",
@@ -70,6 +74,7 @@ EXTENSIONS = {
     "envoy.filters.network.echo":                       "//source/extensions/filters/network/echo:config",
     "envoy.filters.network.ext_authz":                  "//source/extensions/filters/network/ext_authz:config",
     "envoy.filters.network.http_connection_manager":    "//source/extensions/filters/network/http_connection_manager:config",
+    "envoy.filters.network.local_ratelimit":            "//source/extensions/filters/network/local_ratelimit:config",
     "envoy.filters.network.mongo_proxy":                "//source/extensions/filters/network/mongo_proxy:config",
     "envoy.filters.network.mysql_proxy":                "//source/extensions/filters/network/mysql_proxy:config",
     "envoy.filters.network.ratelimit":                  "//source/extensions/filters/network/ratelimit:config",
@@ -150,7 +155,9 @@ WINDOWS_EXTENSIONS = {
     # HTTP filters
     #
 
+    #"envoy.filters.http.adaptive_concurrency":          "//source/extensions/filters/http/adaptive_concurrency:config",
     #"envoy.filters.http.buffer":                        "//source/extensions/filters/http/buffer:config",
+    #"envoy.filters.http.cache":                         "//source/extensions/filters/http/cache:config",
     #"envoy.filters.http.cors":                          "//source/extensions/filters/http/cors:config",
     #"envoy.filters.http.csrf":                          "//source/extensions/filters/http/csrf:config",
     #"envoy.filters.http.dynamo":                        "//source/extensions/filters/http/dynamo:config",
@@ -162,9 +169,11 @@ WINDOWS_EXTENSIONS = {
     #"envoy.filters.http.gzip":                          "//source/extensions/filters/http/gzip:config",
     #"envoy.filters.http.health_check":                  "//source/extensions/filters/http/health_check:config",
     #"envoy.filters.http.ip_tagging":                    "//source/extensions/filters/http/ip_tagging:config",
+    #"envoy.filters.http.local_ratelimit":               "//source/extensions/filters/http/local_ratelimit:config",
     #"envoy.filters.http.lua":                           "//source/extensions/filters/http/lua:config",
     #"envoy.filters.http.ratelimit":                     "//source/extensions/filters/http/ratelimit:config",
     #"envoy.filters.http.rbac":                          "//source/extensions/filters/http/rbac:config",
+    #"envoy.filters.http.request_coalescing":            "//source/extensions/filters/http/request_coalescing:config",
     #"envoy.filters.http.router":                        "//source/extensions/filters/http/router:config",
     #"envoy.filters.http.squash":                        "//source/extensions/filters/http/squash:config",
 
@@ -190,6 +199,7 @@ WINDOWS_EXTENSIONS = {
     #"envoy.filters.network.echo":                       "//source/extensions/filters/network/echo:config",
     #"envoy.filters.network.ext_authz":                  "//source/extensions/filters/network/ext_authz:config",
     #"envoy.filters.network.http_connection_manager":    "//source/extensions/filters/network/http_connection_manager:config",
+    #"envoy.filters.network.local_ratelimit":            "//source/extensions/filters/network/local_ratelimit:config",
     #"envoy.filters.network.mongo_proxy":                "//source/extensions/filters/network/mongo_proxy:config",
     #"envoy.filters.network.mysql_proxy":                "//source/extensions/filters/network/mysql_proxy:config",
     #"envoy.filters.network.redis_proxy":                "//source/extensions/filters/network/redis_proxy:config",
@@ -0,0 +1,230 @@
+#include "extensions/filters/common/ext_authz/decision_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+
+namespace {
+
+void appendKeyPart(std::string& key, absl::string_view part) {
+  absl::StrAppend(&key, part.size(), ":", part);
+}
+
+} // namespace
+
+DecisionCacheConfig::DecisionCacheConfig(
+    const envoy::config::common::ext_authz::v2alpha::DecisionCache& config,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : source_principal_(config.source_principal()), source_address_(config.source_address()),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 1000)),
+      ttl_(PROTOBUF_GET_MS_REQUIRED(config, ttl)),
+      denied_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, denied_ttl, 0)),
+      ttl_header_(config.ttl_header().empty()
+                      ? absl::nullopt
+                      : absl::make_optional<Http::LowerCaseString>(config.ttl_header())),
+      shared_(config.shared()),
+      stats_{ALL_DECISION_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))} {
+  // Otherwise the decision for one client would be reused for every other client.
+  if (config.headers().empty() && !source_principal_ && !source_address_) {
+    throw EnvoyException(
+        "ext_authz decision cache: the key needs headers, source_principal or source_address");
+  }
+  for (const std::string& header : config.headers()) {
+    headers_.push_back(absl::AsciiStrToLower(header));
+  }
+}
+
+std::string DecisionCacheConfig::key(const envoy::service::auth::v2::CheckRequest& request) const {
+  const auto& attributes = request.attributes();
+  const auto& http = attributes.request().http();
+  std::string key;
+
+  // A decision is never reused for another resource, whichever other attributes are configured.
+  appendKeyPart(key, http.method());
+  appendKeyPart(key, http.host());
+  appendKeyPart(key, http.path());
+
+  const auto& request_headers = http.headers();
+  for (const std::string& header : headers_) {
+    const auto it = request_headers.find(header);
+    // A missing header is told apart from an empty one.
+    if (it == request_headers.end()) {
+      key.push_back('-');
+    } else {
+      appendKeyPart(key, it->second);
+    }
+  }
+  if (source_principal_) {
+    appendKeyPart(key, attributes.source().principal());
+  }
+  if (source_address_) {
+    appendKeyPart(key, attributes.source().address().socket_address().address());
+  }
+
+  // The order of a protobuf map is unspecified.
+  std::vector<std::pair<std::string, std::string>> context_extensions;
+  for (const auto& extension : attributes.context_extensions()) {
+    context_extensions.emplace_back(extension.first, extension.second);
+  }
+  std::sort(context_extensions.begin(), context_extensions.end());
+  for (const auto& extension : context_extensions) {
+    appendKeyPart(key, extension.first);
+    appendKeyPart(key, extension.second);
+  }
+  return key;
+}
+
+std::chrono::milliseconds DecisionCacheConfig::ttl(Response& response) const {
+  std::chrono::milliseconds ttl(0);
+  switch (response.status) {
+  case CheckStatus::OK:
+    ttl = ttl_;
+    break;
+  case CheckStatus::Denied:
+    ttl = denied_ttl_;
+    break;
+  case CheckStatus::Error:
+    return std::chrono::milliseconds(0);
+  }
+
+  if (ttl_header_) {
+    for (Http::HeaderVector* headers : {&response.headers_to_add, &response.headers_to_append}) {
+      for (auto it = headers->begin(); it != headers->end();) {
+        if (it->first.get() != ttl_header_->get()) {
+          ++it;
+          continue;
+        }
+        uint64_t seconds;
+        // The header only sets the TTL of the decisions that are configured to be cached.
+        if (ttl.count() > 0 && absl::SimpleAtoi(it->second, &seconds)) {
+          ttl = std::chrono::seconds(seconds);
+        }
+        it = headers->erase(it);
+      }
+    }
+  }
+  return ttl;
+}
+
+ResponsePtr DecisionCache::lookup(const std::string& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  if (it->second->expiry_ <= time_source_.monotonicTime()) {
+    lru_.erase(it->second);
+    entries_.erase(it);
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return std::make_unique<Response>(it->second->response_);
+}
+
+void DecisionCache::insert(const std::string& key, const Response& response,
+                           std::chrono::milliseconds ttl) {
+  const MonotonicTime expiry = time_source_.monotonicTime() + ttl;
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second->response_ = response;
+    it->second->expiry_ = expiry;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+
+  if (entries_.size() >= config_.maxEntries()) {
+    entries_.erase(lru_.back().key_);
+    lru_.pop_back();
+    config_.stats().cache_evicted_.inc();
+  }
+  lru_.push_front({key, response, expiry});
+  entries_.emplace(key, lru_.begin());
+}
+
+size_t DecisionCache::size() {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+void CachingClient::cancel() {
+  ASSERT(callbacks_ != nullptr);
+  client_->cancel();
+  callbacks_ = nullptr;
+}
+
+void CachingClient::check(RequestCallbacks& callbacks,
+                          const envoy::service::auth::v2::CheckRequest& request,
+                          Tracing::Span& parent_span) {
+  ASSERT(callbacks_ == nullptr);
+  key_ = config_.key(request);
+  ResponsePtr cached = cache_.lookup(key_);
+  if (cached != nullptr) {
+    config_.stats().cache_hit_.inc();
+    callbacks.onComplete(std::move(cached));
+    return;
+  }
+
+  config_.stats().cache_miss_.inc();
+  callbacks_ = &callbacks;
+  client_->check(*this, request, parent_span);
+}
+
+void CachingClient::onComplete(ResponsePtr&& response) {
+  const std::chrono::milliseconds ttl = config_.ttl(*response);
+  if (ttl.count() > 0) {
+    cache_.insert(key_, *response, ttl);
+    config_.stats().cache_insert_.inc();
+  }
+
+  RequestCallbacks* callbacks = callbacks_;
+  callbacks_ = nullptr;
+  callbacks->onComplete(std::move(response));
+}
+
+DecisionCacheProvider::DecisionCacheProvider(
+    const envoy::config::common::ext_authz::v2alpha::DecisionCache& config,
+    const std::string& stats_prefix, Stats::Scope& scope, ThreadLocal::SlotAllocator& tls,
+    TimeSource& time_source)
+    : config_(std::make_shared<const DecisionCacheConfig>(config, stats_prefix, scope)) {
+  if (config_->shared()) {
+    shared_cache_ = std::make_unique<DecisionCache>(*config_, time_source);
+    return;
+  }
+
+  tls_ = tls.allocateSlot();
+  DecisionCacheConfigConstSharedPtr cache_config = config_;
+  tls_->set(
+      [cache_config](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+        return std::make_shared<DecisionCache>(*cache_config, dispatcher.timeSource());
+      });
+}
+
+ClientPtr DecisionCacheProvider::wrap(ClientPtr&& client) {
+  DecisionCache& cache =
+      shared_cache_ != nullptr ? *shared_cache_ : tls_->getTyped<DecisionCache>();
+  return std::make_unique<CachingClient>(std::move(client), cache, *config_);
+}
+
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
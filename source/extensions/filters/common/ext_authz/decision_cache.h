@@ -0,0 +1,174 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/common/ext_authz/v2alpha/decision_cache.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/thread_annotations.h"
+
+#include "extensions/filters/common/ext_authz/ext_authz.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+
+/**
+ * All decision cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DECISION_CACHE_STATS(COUNTER)                                                          \
+  COUNTER(cache_hit)                                                                               \
+  COUNTER(cache_miss)                                                                              \
+  COUNTER(cache_insert)                                                                            \
+  COUNTER(cache_evicted)
+// clang-format on
+
+/**
+ * Struct definition for all decision cache stats. @see stats_macros.h
+ */
+struct DecisionCacheStats {
+  ALL_DECISION_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration of a decision cache: how requests are keyed and how long decisions are kept.
+ */
+class DecisionCacheConfig {
+public:
+  DecisionCacheConfig(const envoy::config::common::ext_authz::v2alpha::DecisionCache& config,
+                      const std::string& stats_prefix, Stats::Scope& scope);
+
+  /**
+   * @return the cache key of a check request, made of the configured attributes and of the
+   *         context extensions of the request.
+   */
+  std::string key(const envoy::service::auth::v2::CheckRequest& request) const;
+
+  /**
+   * Removes the TTL header from a decision, if any.
+   * @return how long the decision can be cached, which is zero if it can not be.
+   */
+  std::chrono::milliseconds ttl(Response& response) const;
+
+  uint32_t maxEntries() const { return max_entries_; }
+  bool shared() const { return shared_; }
+  DecisionCacheStats& stats() const { return stats_; }
+
+private:
+  std::vector<std::string> headers_;
+  const bool source_principal_;
+  const bool source_address_;
+  const uint32_t max_entries_;
+  const std::chrono::milliseconds ttl_;
+  const std::chrono::milliseconds denied_ttl_;
+  const absl::optional<Http::LowerCaseString> ttl_header_;
+  const bool shared_;
+  mutable DecisionCacheStats stats_;
+};
+
+typedef std::shared_ptr<const DecisionCacheConfig> DecisionCacheConfigConstSharedPtr;
+
+/**
+ * A bounded LRU cache of decisions that expire. The cache is locked, so that it can be shared by
+ * the workers; a cache used by a single worker only pays for uncontended locking.
+ */
+class DecisionCache : public ThreadLocal::ThreadLocalObject {
+public:
+  DecisionCache(const DecisionCacheConfig& config, TimeSource& time_source)
+      : config_(config), time_source_(time_source) {}
+
+  /**
+   * @return a copy of the cached decision of a key, or nullptr if there is none or it expired.
+   */
+  ResponsePtr lookup(const std::string& key);
+
+  /**
+   * Caches the decision of a key, evicting the least recently used one if the cache is full.
+   */
+  void insert(const std::string& key, const Response& response, std::chrono::milliseconds ttl);
+
+  size_t size();
+
+private:
+  struct Entry {
+    std::string key_;
+    Response response_;
+    MonotonicTime expiry_;
+  };
+  // Most recently used first.
+  typedef std::list<Entry> LruList;
+
+  const DecisionCacheConfig& config_;
+  TimeSource& time_source_;
+  absl::Mutex mutex_;
+  LruList lru_ GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, LruList::iterator> entries_ GUARDED_BY(mutex_);
+};
+
+/**
+ * A client that answers the requests with a cached decision, or asks the wrapped client and caches
+ * its decision.
+ */
+class CachingClient : public Client, public RequestCallbacks {
+public:
+  CachingClient(ClientPtr&& client, DecisionCache& cache, const DecisionCacheConfig& config)
+      : client_(std::move(client)), cache_(cache), config_(config) {}
+
+  // ExtAuthz::Client
+  void cancel() override;
+  void check(RequestCallbacks& callbacks, const envoy::service::auth::v2::CheckRequest& request,
+             Tracing::Span& parent_span) override;
+
+  // ExtAuthz::RequestCallbacks
+  void onComplete(ResponsePtr&& response) override;
+
+private:
+  ClientPtr client_;
+  DecisionCache& cache_;
+  const DecisionCacheConfig& config_;
+  RequestCallbacks* callbacks_{};
+  std::string key_;
+};
+
+/**
+ * Wraps the clients of a filter with a CachingClient that uses the cache of the worker, or the
+ * cache shared by all workers.
+ */
+class DecisionCacheProvider {
+public:
+  DecisionCacheProvider(const envoy::config::common::ext_authz::v2alpha::DecisionCache& config,
+                        const std::string& stats_prefix, Stats::Scope& scope,
+                        ThreadLocal::SlotAllocator& tls, TimeSource& time_source);
+
+  ClientPtr wrap(ClientPtr&& client);
+
+private:
+  const DecisionCacheConfigConstSharedPtr config_;
+  // Either the cache shared by the workers, or a slot with the cache of each worker.
+  std::unique_ptr<DecisionCache> shared_cache_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<DecisionCacheProvider> DecisionCacheProviderSharedPtr;
+
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
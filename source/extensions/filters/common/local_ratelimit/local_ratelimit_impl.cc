@@ -0,0 +1,24 @@
+#include "extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
+
+#include "common/common/atomic_token_bucket_impl.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace LocalRateLimit {
+
+TokenBucketPtr createTokenBucket(const envoy::type::TokenBucket& proto_config,
+                                 TimeSource& time_source) {
+  const double tokens_per_fill = PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, tokens_per_fill, 1);
+  const double fill_interval_ms = PROTOBUF_GET_MS_REQUIRED(proto_config, fill_interval);
+  return std::make_unique<AtomicTokenBucketImpl>(proto_config.max_tokens(), time_source,
+                                                 tokens_per_fill * 1000 / fill_interval_ms);
+}
+
+} // namespace LocalRateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
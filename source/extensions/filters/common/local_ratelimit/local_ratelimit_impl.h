@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+#include "envoy/type/token_bucket.pb.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace LocalRateLimit {
+
+/**
+ * Creates a token bucket from its configuration. The bucket may be consumed from any thread, so
+ * that it can be shared by the filters of all the workers.
+ * @param proto_config supplies the configuration of the bucket.
+ * @param time_source supplies the time source, which must be thread-safe.
+ */
+TokenBucketPtr createTokenBucket(const envoy::type::TokenBucket& proto_config,
+                                 TimeSource& time_source);
+
+} // namespace LocalRateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
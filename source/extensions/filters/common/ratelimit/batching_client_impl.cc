@@ -0,0 +1,300 @@
+#include "extensions/filters/common/ratelimit/batching_client_impl.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "extensions/filters/common/ratelimit/descriptor_key.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+BatchingConfig::BatchingConfig(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                               std::chrono::milliseconds timeout, Stats::Scope& scope)
+    : timeout_(timeout),
+      batch_window_(PROTOBUF_GET_MS_OR_DEFAULT(config, batch_window, 0)),
+      max_batch_descriptors_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_descriptors, 100)),
+      over_limit_cache_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, over_limit_cache_ttl, 0)),
+      stats_{ALL_RATELIMIT_CLIENT_STATS(POOL_COUNTER_PREFIX(scope, "ratelimit_client."),
+                                        POOL_HISTOGRAM_PREFIX(scope, "ratelimit_client."))} {}
+
+bool BatchingConfig::enabled(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config) {
+  return PROTOBUF_GET_MS_OR_DEFAULT(config, batch_window, 0) > 0 ||
+         PROTOBUF_GET_MS_OR_DEFAULT(config, over_limit_cache_ttl, 0) > 0;
+}
+
+ThreadLocalBatcher::ThreadLocalBatcher(Grpc::AsyncClientPtr&& async_client,
+                                       Event::Dispatcher& dispatcher,
+                                       BatchingConfigConstSharedPtr config)
+    : service_method_(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+          "envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit")),
+      async_client_(std::move(async_client)), dispatcher_(dispatcher),
+      time_source_(dispatcher.timeSource()), config_(std::move(config)) {}
+
+ThreadLocalBatcher::~ThreadLocalBatcher() {
+  for (const BatchPtr& batch : sent_batches_) {
+    if (batch->request_ != nullptr) {
+      batch->request_->cancel();
+    }
+  }
+}
+
+void ThreadLocalBatcher::limit(BatchingClientImpl& client) {
+  if (config_->over_limit_cache_ttl_.count() > 0) {
+    if (cachedOverLimit(client.domain_, client.descriptors_)) {
+      config_->stats_.over_limit_cache_hit_.inc();
+      client.complete(LimitStatus::OverLimit, std::make_unique<Http::HeaderMapImpl>());
+      return;
+    }
+    config_->stats_.over_limit_cache_miss_.inc();
+  }
+
+  BatchPtr& pending = pending_batches_[client.domain_];
+  if (pending == nullptr) {
+    pending = std::make_unique<Batch>(*this, client.domain_);
+    if (config_->batch_window_.count() > 0) {
+      Batch* batch = pending.get();
+      pending->window_timer_ = dispatcher_.createTimer([this, batch]() -> void { send(*batch); });
+      pending->window_timer_->enableTimer(config_->batch_window_);
+    }
+  }
+
+  Batch& batch = *pending;
+  client.batch_ = &batch;
+  client.batch_index_ = batch.entries_.size();
+  batch.entries_.push_back({&client, static_cast<uint32_t>(client.descriptors_.size())});
+  batch.num_descriptors_ += client.descriptors_.size();
+  batch.num_clients_++;
+  if (config_->batch_window_.count() == 0 ||
+      batch.num_descriptors_ >= config_->max_batch_descriptors_) {
+    send(batch);
+  }
+}
+
+void ThreadLocalBatcher::cancel(BatchingClientImpl& client) {
+  Batch& batch = *client.batch_;
+  Batch::Entry& entry = batch.entries_[client.batch_index_];
+  ASSERT(entry.client_ == &client);
+  entry.client_ = nullptr;
+  client.batch_ = nullptr;
+  if (batch.sent_) {
+    // The other clients of the batch still need the response, and the descriptors of this one
+    // still need to be skipped in it.
+    return;
+  }
+
+  batch.num_descriptors_ -= entry.num_descriptors_;
+  entry.num_descriptors_ = 0;
+  if (--batch.num_clients_ == 0) {
+    pending_batches_.erase(batch.domain_);
+  }
+}
+
+void ThreadLocalBatcher::send(Batch& batch) {
+  auto it = pending_batches_.find(batch.domain_);
+  ASSERT(it != pending_batches_.end() && it->second.get() == &batch);
+  BatchPtr owned = std::move(it->second);
+  pending_batches_.erase(it);
+  if (batch.window_timer_ != nullptr) {
+    batch.window_timer_->disableTimer();
+  }
+  batch.moveIntoList(std::move(owned), sent_batches_);
+  batch.sent_ = true;
+
+  envoy::service::ratelimit::v2::RateLimitRequest request;
+  for (const Batch::Entry& entry : batch.entries_) {
+    if (entry.client_ == nullptr) {
+      continue;
+    }
+    GrpcClientImpl::createRequest(request, batch.domain_, entry.client_->descriptors_);
+    if (config_->over_limit_cache_ttl_.count() > 0) {
+      for (const Envoy::RateLimit::Descriptor& descriptor : entry.client_->descriptors_) {
+        batch.cache_keys_.push_back(descriptorKey(batch.domain_, descriptor));
+      }
+    }
+  }
+
+  config_->stats_.batch_rq_total_.inc();
+  config_->stats_.batched_rq_total_.add(batch.num_clients_);
+  config_->stats_.batch_descriptors_.recordValue(batch.num_descriptors_);
+  ENVOY_LOG(debug, "rate limit batch: domain={} requests={} descriptors={}", batch.domain_,
+            batch.num_clients_, batch.num_descriptors_);
+
+  // A batch is made for many streams, so it is not traced as part of any of them.
+  batch.request_ = async_client_->send(service_method_, request, batch,
+                                       Tracing::NullSpan::instance(), config_->timeout_);
+}
+
+void ThreadLocalBatcher::Batch::onSuccess(
+    std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse>&& response, Tracing::Span&) {
+  ASSERT(response->overall_code() != envoy::service::ratelimit::v2::RateLimitResponse_Code_UNKNOWN);
+  request_ = nullptr;
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.sent_batches_));
+
+  // Without a status per descriptor the streams of the batch can only share the overall code, and
+  // nothing is known about individual descriptors.
+  const bool per_descriptor = static_cast<uint32_t>(response->statuses_size()) == num_descriptors_;
+  if (!per_descriptor && entries_.size() > 1) {
+    ENVOY_LOG(debug, "rate limit batch: {} statuses for {} descriptors, using overall code",
+              response->statuses_size(), num_descriptors_);
+  }
+  if (per_descriptor && !cache_keys_.empty()) {
+    for (int i = 0; i < response->statuses_size(); i++) {
+      if (response->statuses(i).code() ==
+          envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT) {
+        parent_.cacheOverLimit(cache_keys_[i]);
+      }
+    }
+  }
+
+  uint32_t offset = 0;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    const uint32_t begin = offset;
+    offset += entries_[i].num_descriptors_;
+    // Completing a stream may cancel the clients of others, so they are read again every time.
+    BatchingClientImpl* client = entries_[i].client_;
+    if (client == nullptr) {
+      continue;
+    }
+
+    bool over_limit = false;
+    if (per_descriptor) {
+      for (uint32_t j = begin; j < offset; j++) {
+        over_limit |= response->statuses(j).code() ==
+                      envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT;
+      }
+    } else {
+      over_limit = response->overall_code() ==
+                   envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT;
+    }
+
+    Http::HeaderMapPtr headers = std::make_unique<Http::HeaderMapImpl>();
+    for (const auto& h : response->headers()) {
+      headers->addCopy(Http::LowerCaseString(h.key()), h.value());
+    }
+    entries_[i].client_ = nullptr;
+    client->complete(over_limit ? LimitStatus::OverLimit : LimitStatus::OK, std::move(headers));
+  }
+}
+
+void ThreadLocalBatcher::Batch::onFailure(Grpc::Status::GrpcStatus status, const std::string&,
+                                          Tracing::Span&) {
+  ASSERT(status != Grpc::Status::GrpcStatus::Ok);
+  request_ = nullptr;
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.sent_batches_));
+
+  for (Entry& entry : entries_) {
+    BatchingClientImpl* client = entry.client_;
+    if (client != nullptr) {
+      entry.client_ = nullptr;
+      client->complete(LimitStatus::Error, nullptr);
+    }
+  }
+}
+
+bool ThreadLocalBatcher::cachedOverLimit(
+    const std::string& domain, const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  if (over_limit_cache_.empty()) {
+    return false;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  for (const Envoy::RateLimit::Descriptor& descriptor : descriptors) {
+    auto it = over_limit_cache_.find(descriptorKey(domain, descriptor));
+    if (it == over_limit_cache_.end()) {
+      continue;
+    }
+    if (it->second > now) {
+      return true;
+    }
+    over_limit_cache_.erase(it);
+  }
+  return false;
+}
+
+void ThreadLocalBatcher::cacheOverLimit(const std::string& key) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (over_limit_cache_.size() >= MaxCachedDescriptors) {
+    for (auto it = over_limit_cache_.begin(); it != over_limit_cache_.end();) {
+      if (it->second <= now) {
+        over_limit_cache_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    if (over_limit_cache_.size() >= MaxCachedDescriptors && over_limit_cache_.count(key) == 0) {
+      return;
+    }
+  }
+  over_limit_cache_[key] = now + config_->over_limit_cache_ttl_;
+}
+
+BatchingClientImpl::~BatchingClientImpl() { ASSERT(!callbacks_); }
+
+void BatchingClientImpl::cancel() {
+  ASSERT(callbacks_ != nullptr);
+  batcher_.cancel(*this);
+  callbacks_ = nullptr;
+  descriptors_.clear();
+}
+
+void BatchingClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
+                               const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                               Tracing::Span&) {
+  ASSERT(callbacks_ == nullptr);
+  callbacks_ = &callbacks;
+  domain_ = domain;
+  descriptors_ = descriptors;
+  batcher_.limit(*this);
+}
+
+void BatchingClientImpl::complete(LimitStatus status, Http::HeaderMapPtr&& headers) {
+  RequestCallbacks* callbacks = callbacks_;
+  callbacks_ = nullptr;
+  batch_ = nullptr;
+  descriptors_.clear();
+  callbacks->complete(status, std::move(headers));
+}
+
+ClientFactory
+rateLimitClientFactory(Server::Configuration::FactoryContext& context,
+                       const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                       const std::chrono::milliseconds timeout) {
+  if (!BatchingConfig::enabled(config)) {
+    const envoy::api::v2::core::GrpcService grpc_service = config.grpc_service();
+    return [&context, grpc_service, timeout]() -> ClientPtr {
+      return rateLimitClient(context, grpc_service, timeout);
+    };
+  }
+
+  BatchingConfigConstSharedPtr batching_config =
+      std::make_shared<const BatchingConfig>(config, timeout, context.scope());
+  std::shared_ptr<Grpc::AsyncClientFactory> async_client_factory =
+      context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
+          config.grpc_service(), context.scope(), true);
+  std::shared_ptr<ThreadLocal::Slot> tls = context.threadLocal().allocateSlot();
+  tls->set([async_client_factory, batching_config](
+               Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalBatcher>(async_client_factory->create(), dispatcher,
+                                                batching_config);
+  });
+  return [tls]() -> ClientPtr {
+    return std::make_unique<BatchingClientImpl>(tls->getTyped<ThreadLocalBatcher>());
+  };
+}
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/ratelimit/v2/rls.pb.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/grpc/async_client.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/server/filter_config.h"
+#include "envoy/service/ratelimit/v2/rls.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+
+#include "extensions/filters/common/ratelimit/ratelimit.h"
+#include "extensions/filters/common/ratelimit/ratelimit_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+/**
+ * All rate limit client stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_RATELIMIT_CLIENT_STATS(COUNTER, HISTOGRAM)                                             \
+  COUNTER(over_limit_cache_hit)                                                                    \
+  COUNTER(over_limit_cache_miss)                                                                   \
+  COUNTER(batch_rq_total)                                                                          \
+  COUNTER(batched_rq_total)                                                                        \
+  HISTOGRAM(batch_descriptors)
+// clang-format on
+
+/**
+ * Struct definition for all rate limit client stats. @see stats_macros.h
+ */
+struct ClientStats {
+  ALL_RATELIMIT_CLIENT_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * Configuration of the batching and caching of rate limit requests, shared by the workers.
+ */
+struct BatchingConfig {
+  BatchingConfig(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                 std::chrono::milliseconds timeout, Stats::Scope& scope);
+
+  /**
+   * @return whether the config asks for batching or caching at all.
+   */
+  static bool enabled(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config);
+
+  const std::chrono::milliseconds timeout_;
+  const std::chrono::milliseconds batch_window_;
+  const uint32_t max_batch_descriptors_;
+  const std::chrono::milliseconds over_limit_cache_ttl_;
+  ClientStats stats_;
+};
+
+typedef std::shared_ptr<const BatchingConfig> BatchingConfigConstSharedPtr;
+
+class BatchingClientImpl;
+
+/**
+ * The per worker state of the rate limit clients of a filter: the batches that are waiting for
+ * their window to end or for their response, and the cache of the descriptors that are over limit.
+ */
+class ThreadLocalBatcher : public ThreadLocal::ThreadLocalObject,
+                           public Logger::Loggable<Logger::Id::filter> {
+public:
+  ThreadLocalBatcher(Grpc::AsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
+                     BatchingConfigConstSharedPtr config);
+  ~ThreadLocalBatcher();
+
+  /**
+   * Rate limits the request of a client, either from the cache or by adding it to a batch.
+   */
+  void limit(BatchingClientImpl& client);
+
+  /**
+   * Removes the request of a client from its batch. The batch is still sent, or its response
+   * still awaited, for the other clients.
+   */
+  void cancel(BatchingClientImpl& client);
+
+  // Once this many descriptors are cached, expired entries are purged before adding more, and new
+  // entries are dropped if that is not enough.
+  static constexpr size_t MaxCachedDescriptors = 10000;
+
+private:
+  struct Batch;
+  typedef std::unique_ptr<Batch> BatchPtr;
+
+  struct Batch : public RateLimitAsyncCallbacks,
+                 public Event::DeferredDeletable,
+                 public LinkedObject<Batch> {
+    Batch(ThreadLocalBatcher& parent, const std::string& domain)
+        : parent_(parent), domain_(domain) {}
+
+    // Grpc::AsyncRequestCallbacks
+    void onCreateInitialMetadata(Http::HeaderMap&) override {}
+    void onSuccess(std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse>&& response,
+                   Tracing::Span& span) override;
+    void onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                   Tracing::Span& span) override;
+
+    struct Entry {
+      // Null once the client is cancelled.
+      BatchingClientImpl* client_;
+      // The descriptors of a client cancelled before the batch is sent are not sent.
+      uint32_t num_descriptors_;
+    };
+
+    ThreadLocalBatcher& parent_;
+    const std::string domain_;
+    std::vector<Entry> entries_;
+    uint32_t num_descriptors_{};
+    uint32_t num_clients_{};
+    bool sent_{};
+    // The cache keys of the descriptors of the request, if over limit decisions are cached.
+    std::vector<std::string> cache_keys_;
+    Event::TimerPtr window_timer_;
+    Grpc::AsyncRequest* request_{};
+  };
+
+  friend class BatchingClientImpl;
+
+  void send(Batch& batch);
+  bool cachedOverLimit(const std::string& domain,
+                       const std::vector<Envoy::RateLimit::Descriptor>& descriptors);
+  void cacheOverLimit(const std::string& key);
+
+  const Protobuf::MethodDescriptor& service_method_;
+  Grpc::AsyncClientPtr async_client_;
+  Event::Dispatcher& dispatcher_;
+  TimeSource& time_source_;
+  const BatchingConfigConstSharedPtr config_;
+  // The batch of each domain that is waiting for its window to end.
+  absl::flat_hash_map<std::string, BatchPtr> pending_batches_;
+  // The batches that were sent and are waiting for their response.
+  std::list<BatchPtr> sent_batches_;
+  // The time at which each cached over limit descriptor expires.
+  absl::flat_hash_map<std::string, MonotonicTime> over_limit_cache_;
+};
+
+/**
+ * A rate limit client that goes through the ThreadLocalBatcher of its worker. A client is used by
+ * a single stream, like GrpcClientImpl.
+ */
+class BatchingClientImpl : public Client {
+public:
+  BatchingClientImpl(ThreadLocalBatcher& batcher) : batcher_(batcher) {}
+  ~BatchingClientImpl();
+
+  // Filters::Common::RateLimit::Client
+  void cancel() override;
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+             Tracing::Span& parent_span) override;
+
+private:
+  friend class ThreadLocalBatcher;
+
+  void complete(LimitStatus status, Http::HeaderMapPtr&& headers);
+
+  ThreadLocalBatcher& batcher_;
+  RequestCallbacks* callbacks_{};
+  std::string domain_;
+  std::vector<Envoy::RateLimit::Descriptor> descriptors_;
+  // The batch of the inflight request, and the index of the client in it.
+  ThreadLocalBatcher::Batch* batch_{};
+  size_t batch_index_{};
+};
+
+/**
+ * Creates a rate limit client for each stream of a filter.
+ */
+typedef std::function<ClientPtr()> ClientFactory;
+
+/**
+ * Builds the factory of the rate limit clients of a filter. If the service config enables
+ * batching or caching, the clients share a ThreadLocalBatcher per worker, otherwise each one is
+ * a GrpcClientImpl.
+ */
+ClientFactory
+rateLimitClientFactory(Server::Configuration::FactoryContext& context,
+                       const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                       const std::chrono::milliseconds timeout);
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
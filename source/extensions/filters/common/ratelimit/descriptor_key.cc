@@ -0,0 +1,26 @@
+#include "extensions/filters/common/ratelimit/descriptor_key.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+std::string descriptorKey(absl::string_view domain,
+                          const Envoy::RateLimit::Descriptor& descriptor) {
+  // Each part is prefixed with its length, so that no part can be mistaken for the next one.
+  std::string key = absl::StrCat(domain.size(), ":", domain);
+  for (const Envoy::RateLimit::DescriptorEntry& entry : descriptor.entries_) {
+    absl::StrAppend(&key, entry.key_.size(), ":", entry.key_, entry.value_.size(), ":",
+                    entry.value_);
+  }
+  return key;
+}
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/ratelimit/ratelimit.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+/**
+ * @return a key that identifies a descriptor of a domain by all its entries. Different domains or
+ *         descriptors give different keys, whatever their entries contain.
+ */
+std::string descriptorKey(absl::string_view domain, const Envoy::RateLimit::Descriptor& descriptor);
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
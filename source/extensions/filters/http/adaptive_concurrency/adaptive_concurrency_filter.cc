@@ -0,0 +1,42 @@
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+#include "envoy/http/codes.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+void AdaptiveConcurrencyFilter::onDestroy() {
+  // The stream ended without a response, e.g. it was reset, so its latency is not meaningful.
+  if (rq_start_time_.has_value()) {
+    controller_->cancelLatencySample();
+    rq_start_time_.reset();
+  }
+}
+
+Http::FilterHeadersStatus AdaptiveConcurrencyFilter::decodeHeaders(Http::HeaderMap&, bool) {
+  if (!controller_->forwardingDecision()) {
+    ENVOY_STREAM_LOG(debug, "reached concurrency limit of {}", *decoder_callbacks_,
+                     controller_->concurrencyLimit());
+    controller_->stats().rq_blocked_.inc();
+    decoder_callbacks_->sendLocalReply(Http::Code::ServiceUnavailable, "reached concurrency limit",
+                                       nullptr, absl::nullopt);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+  rq_start_time_ = time_source_.monotonicTime();
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus AdaptiveConcurrencyFilter::encodeHeaders(Http::HeaderMap&, bool) {
+  if (rq_start_time_.has_value()) {
+    controller_->recordLatencySample(time_source_.monotonicTime() - rq_start_time_.value());
+    rq_start_time_.reset();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/http/filter.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+#include "extensions/filters/http/common/pass_through_filter.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * A filter that limits the number of requests that may be outstanding at the same time to a
+ * limit that the gradient controller adjusts from their latencies. The requests over the limit
+ * are answered with a 503 immediately. The latency of a request is the time from its headers to
+ * the headers of its response, so the filter should be placed before the filters that might
+ * respond locally, e.g. the rate limit or the authorization filters.
+ */
+class AdaptiveConcurrencyFilter : public Http::PassThroughFilter,
+                                  Logger::Loggable<Logger::Id::filter> {
+public:
+  AdaptiveConcurrencyFilter(const GradientControllerSharedPtr& controller, TimeSource& time_source)
+      : controller_(controller), time_source_(time_source) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+
+private:
+  const GradientControllerSharedPtr controller_;
+  TimeSource& time_source_;
+  // Set while the request is outstanding.
+  absl::optional<MonotonicTime> rq_start_time_;
+};
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
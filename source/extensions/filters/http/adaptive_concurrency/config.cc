@@ -0,0 +1,37 @@
+#include "extensions/filters/http/adaptive_concurrency/config.h"
+
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+Http::FilterFactoryCb AdaptiveConcurrencyFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+        proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  // The controller is shared by the workers, and its timers run on the main thread.
+  GradientControllerSharedPtr controller = std::make_shared<GradientController>(
+      GradientControllerConfig(proto_config), context.dispatcher(),
+      stats_prefix + "adaptive_concurrency.", context.scope());
+  return [controller, &context](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(
+        std::make_shared<AdaptiveConcurrencyFilter>(controller, context.timeSource()));
+  };
+}
+
+/**
+ * Static registration for the adaptive concurrency filter. @see NamedHttpFilterConfigFactory.
+ */
+REGISTER_FACTORY(AdaptiveConcurrencyFilterFactory,
+                 Server::Configuration::NamedHttpFilterConfigFactory);
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
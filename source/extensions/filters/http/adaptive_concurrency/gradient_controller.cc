@@ -0,0 +1,158 @@
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+namespace {
+
+const uint64_t DefaultSampleWindowMs = 100;
+const double DefaultSampleAggregatePercent = 50.0;
+const uint64_t DefaultMinRTTCalcIntervalMs = 30000;
+const uint32_t DefaultMinRTTRequestCount = 50;
+const double DefaultMinRTTBufferPercent = 25.0;
+const uint32_t DefaultMinConcurrency = 3;
+const uint32_t DefaultMaxConcurrencyLimit = 1000;
+
+// The limit changes by at most a factor of 2 at every sample window.
+const double MinGradient = 0.5;
+const double MaxGradient = 2.0;
+
+} // namespace
+
+GradientControllerConfig::GradientControllerConfig(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+        proto_config)
+    : sample_window_(
+          PROTOBUF_GET_MS_OR_DEFAULT(proto_config, sample_window, DefaultSampleWindowMs)),
+      sample_aggregate_percentile_((proto_config.has_sample_aggregate_percentile()
+                                        ? proto_config.sample_aggregate_percentile().value()
+                                        : DefaultSampleAggregatePercent) /
+                                   100.0),
+      min_rtt_calc_interval_(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, min_rtt_calc_interval,
+                                                        DefaultMinRTTCalcIntervalMs)),
+      min_rtt_request_count_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, min_rtt_request_count,
+                                                             DefaultMinRTTRequestCount)),
+      min_rtt_buffer_((proto_config.has_min_rtt_buffer() ? proto_config.min_rtt_buffer().value()
+                                                          : DefaultMinRTTBufferPercent) /
+                      100.0),
+      min_concurrency_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, min_concurrency, DefaultMinConcurrency)),
+      max_concurrency_limit_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          proto_config, max_concurrency_limit, DefaultMaxConcurrencyLimit)) {
+  // The minimum concurrency wins over a lower maximum limit.
+  max_concurrency_limit_ = std::max(max_concurrency_limit_, min_concurrency_);
+}
+
+GradientController::GradientController(const GradientControllerConfig& config,
+                                       Event::Dispatcher& dispatcher,
+                                       const std::string& stats_prefix, Stats::Scope& scope)
+    : config_(config), stats_(generateStats(stats_prefix, scope)),
+      deferred_limit_(config_.min_concurrency_), concurrency_limit_(config_.min_concurrency_) {
+  stats_.concurrency_limit_.set(concurrency_limit_.load());
+  min_rtt_calc_timer_ = dispatcher.createTimer([this]() -> void { enterMinRTTSamplingWindow(); });
+  sample_reset_timer_ = dispatcher.createTimer([this]() -> void { resetSampleWindow(); });
+
+  // There is no minimum RTT to compare latencies with until it is first measured.
+  enterMinRTTSamplingWindow();
+  sample_reset_timer_->enableTimer(config_.sample_window_);
+}
+
+bool GradientController::forwardingDecision() {
+  if (num_rq_outstanding_.fetch_add(1) + 1 <= concurrency_limit_.load()) {
+    return true;
+  }
+  num_rq_outstanding_.fetch_sub(1);
+  return false;
+}
+
+void GradientController::recordLatencySample(std::chrono::nanoseconds latency) {
+  num_rq_outstanding_.fetch_sub(1);
+
+  Thread::LockGuard lock(sample_mutex_);
+  latency_samples_.push_back(
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  if (in_min_rtt_sampling_window_ && latency_samples_.size() >= config_.min_rtt_request_count_) {
+    updateMinRTT();
+  }
+}
+
+void GradientController::cancelLatencySample() { num_rq_outstanding_.fetch_sub(1); }
+
+void GradientController::enterMinRTTSamplingWindow() {
+  {
+    Thread::LockGuard lock(sample_mutex_);
+    ENVOY_LOG(debug, "adaptive concurrency: measuring the minimum RTT");
+    // The window may still be open if too few requests completed since the last measurement, in
+    // which case the limit to restore was already saved.
+    if (!in_min_rtt_sampling_window_) {
+      in_min_rtt_sampling_window_ = true;
+      deferred_limit_ = concurrency_limit_.load();
+    }
+    latency_samples_.clear();
+    concurrency_limit_.store(config_.min_concurrency_);
+  }
+  stats_.min_rtt_calculation_active_.set(1);
+  stats_.concurrency_limit_.set(config_.min_concurrency_);
+  min_rtt_calc_timer_->enableTimer(config_.min_rtt_calc_interval_);
+}
+
+void GradientController::updateMinRTT() {
+  min_rtt_ = processLatencySamplesAndClear();
+  in_min_rtt_sampling_window_ = false;
+  concurrency_limit_.store(deferred_limit_);
+
+  // Gauges are atomic, so they can be set from the worker that completes the measurement.
+  stats_.min_rtt_msecs_.set(
+      std::chrono::duration_cast<std::chrono::milliseconds>(min_rtt_).count());
+  stats_.min_rtt_calculation_active_.set(0);
+  stats_.concurrency_limit_.set(deferred_limit_);
+  ENVOY_LOG(debug, "adaptive concurrency: minimum RTT is {}us", min_rtt_.count());
+}
+
+void GradientController::resetSampleWindow() {
+  {
+    Thread::LockGuard lock(sample_mutex_);
+    if (!in_min_rtt_sampling_window_ && !latency_samples_.empty()) {
+      sample_rtt_ = processLatencySamplesAndClear();
+      concurrency_limit_.store(calculateNewLimit());
+      stats_.sample_rtt_msecs_.set(
+          std::chrono::duration_cast<std::chrono::milliseconds>(sample_rtt_).count());
+    }
+  }
+  stats_.concurrency_limit_.set(concurrency_limit_.load());
+  sample_reset_timer_->enableTimer(config_.sample_window_);
+}
+
+uint32_t GradientController::calculateNewLimit() const {
+  // Latencies under a microsecond are rounded up, to keep the gradient defined.
+  const double sample_rtt = std::max<int64_t>(sample_rtt_.count(), 1);
+  const double gradient = std::min(
+      MaxGradient,
+      std::max(MinGradient, min_rtt_.count() * (1.0 + config_.min_rtt_buffer_) / sample_rtt));
+  const double limit = concurrency_limit_.load() * gradient;
+  const double new_limit = limit + std::sqrt(limit);
+  return static_cast<uint32_t>(std::min<double>(
+      config_.max_concurrency_limit_, std::max<double>(config_.min_concurrency_, new_limit)));
+}
+
+std::chrono::microseconds GradientController::processLatencySamplesAndClear() {
+  const size_t index = std::min<size_t>(
+      latency_samples_.size() - 1, latency_samples_.size() * config_.sample_aggregate_percentile_);
+  std::nth_element(latency_samples_.begin(), latency_samples_.begin() + index,
+                   latency_samples_.end());
+  const std::chrono::microseconds percentile(latency_samples_[index]);
+  latency_samples_.clear();
+  return percentile;
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
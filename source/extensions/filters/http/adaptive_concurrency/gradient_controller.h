@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * All adaptive concurrency stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_ADAPTIVE_CONCURRENCY_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(rq_blocked)                                                                              \
+  GAUGE  (concurrency_limit)                                                                       \
+  GAUGE  (min_rtt_msecs)                                                                           \
+  GAUGE  (sample_rtt_msecs)                                                                        \
+  GAUGE  (min_rtt_calculation_active)
+// clang-format on
+
+/**
+ * Struct definition for adaptive concurrency stats. @see stats_macros.h
+ */
+struct AdaptiveConcurrencyStats {
+  ALL_ADAPTIVE_CONCURRENCY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Settings of the gradient controller.
+ */
+struct GradientControllerConfig {
+  GradientControllerConfig(
+      const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+          proto_config);
+
+  std::chrono::milliseconds sample_window_;
+  // In [0, 1].
+  double sample_aggregate_percentile_;
+  std::chrono::milliseconds min_rtt_calc_interval_;
+  uint32_t min_rtt_request_count_;
+  // Fraction of the minimum RTT.
+  double min_rtt_buffer_;
+  uint32_t min_concurrency_;
+  uint32_t max_concurrency_limit_;
+};
+
+/**
+ * Adjusts the number of requests that may be outstanding at the same time from the latencies of
+ * the requests, and decides whether new requests are forwarded or blocked.
+ *
+ * The controller periodically measures the minimum round-trip time (RTT) of the upstream: while it
+ * does, the concurrency limit is pinned to its lowest value, so that requests do not queue, and
+ * the minimum RTT is an aggregate percentile of the latencies of a number of requests. Between
+ * these measurements, the same percentile of the latencies of every sample window is compared with
+ * the minimum RTT, and their ratio, the gradient, scales the limit:
+ *
+ *   gradient = clamp(min_rtt * (1 + buffer) / sample_rtt, 0.5, 2)
+ *   limit = clamp(limit * gradient + sqrt(limit * gradient), min_concurrency, max_limit)
+ *
+ * The square root leaves headroom for the limit to grow when latencies do not change. The
+ * controller is shared by the filters of all the workers: the limit and the number of outstanding
+ * requests are atomics, the latency samples are guarded by a mutex, and the timers that update the
+ * limit and measure the minimum RTT run on the main thread.
+ */
+class GradientController : Logger::Loggable<Logger::Id::filter> {
+public:
+  GradientController(const GradientControllerConfig& config, Event::Dispatcher& dispatcher,
+                     const std::string& stats_prefix, Stats::Scope& scope);
+
+  /**
+   * Must be called when a request starts. If it returns true, the request is outstanding until
+   * recordLatencySample() or cancelLatencySample() is called.
+   * @return whether the request may be forwarded.
+   */
+  bool forwardingDecision();
+
+  /**
+   * Ends an outstanding request and samples its latency.
+   */
+  void recordLatencySample(std::chrono::nanoseconds latency);
+
+  /**
+   * Ends an outstanding request whose latency is not known, e.g. because it was reset.
+   */
+  void cancelLatencySample();
+
+  uint32_t concurrencyLimit() const { return concurrency_limit_.load(); }
+  AdaptiveConcurrencyStats& stats() { return stats_; }
+
+private:
+  static AdaptiveConcurrencyStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return AdaptiveConcurrencyStats{ALL_ADAPTIVE_CONCURRENCY_STATS(
+        POOL_COUNTER_PREFIX(scope, prefix), POOL_GAUGE_PREFIX(scope, prefix))};
+  }
+
+  void enterMinRTTSamplingWindow();
+  void updateMinRTT() EXCLUSIVE_LOCKS_REQUIRED(sample_mutex_);
+  void resetSampleWindow();
+  uint32_t calculateNewLimit() const EXCLUSIVE_LOCKS_REQUIRED(sample_mutex_);
+  // Returns the aggregate percentile of the latency samples, and clears them.
+  std::chrono::microseconds processLatencySamplesAndClear()
+      EXCLUSIVE_LOCKS_REQUIRED(sample_mutex_);
+
+  const GradientControllerConfig config_;
+  AdaptiveConcurrencyStats stats_;
+  Thread::MutexBasicLockable sample_mutex_;
+  // In microseconds.
+  std::vector<uint64_t> latency_samples_ GUARDED_BY(sample_mutex_);
+  bool in_min_rtt_sampling_window_ GUARDED_BY(sample_mutex_){};
+  // The limit to restore once the minimum RTT is measured.
+  uint32_t deferred_limit_ GUARDED_BY(sample_mutex_);
+  std::chrono::microseconds min_rtt_ GUARDED_BY(sample_mutex_){};
+  std::chrono::microseconds sample_rtt_ GUARDED_BY(sample_mutex_){};
+  std::atomic<uint32_t> concurrency_limit_;
+  std::atomic<uint32_t> num_rq_outstanding_{};
+  Event::TimerPtr min_rtt_calc_timer_;
+  Event::TimerPtr sample_reset_timer_;
+};
+
+typedef std::shared_ptr<GradientController> GradientControllerSharedPtr;
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,369 @@
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include "envoy/network/connection.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/enum_to_int.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/file_cache.h"
+#include "extensions/filters/http/cache/memory_cache.h"
+#include "extensions/filters/http/cache/tiered_cache.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+const uint64_t DefaultMemoryMaxSizeBytes = 64 * 1024 * 1024;
+const uint32_t DefaultMemoryShards = 16;
+const uint64_t DefaultFileMaxSizeBytes = 1024 * 1024 * 1024;
+const uint32_t DefaultMaxBodyBytes = 1024 * 1024;
+
+} // namespace
+
+CacheFilterConfig::CacheFilterConfig(
+    const envoy::config::filter::http::cache::v2alpha::Cache& proto_config,
+    const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
+    ThreadLocal::SlotAllocator& tls, Api::Api& api, Runtime::RandomGenerator& random)
+    : stats_(generateStats(stats_prefix + "cache.", scope)), time_source_(time_source),
+      max_body_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_body_bytes, DefaultMaxBodyBytes)),
+      tls_(tls.allocateSlot()) {
+  const auto& memory_storage = proto_config.memory_storage();
+  cache_ = std::make_shared<MemoryCache>(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(memory_storage, max_size_bytes, DefaultMemoryMaxSizeBytes),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(memory_storage, shards, DefaultMemoryShards));
+  if (proto_config.has_file_storage()) {
+    const auto& file_storage = proto_config.file_storage();
+    cache_ = std::make_shared<TieredCache>(
+        cache_, std::make_shared<FileCache>(
+                    api.fileSystem(), api.threadFactory(), file_storage.path(),
+                    PROTOBUF_GET_WRAPPED_OR_DEFAULT(file_storage, max_size_bytes,
+                                                    DefaultFileMaxSizeBytes),
+                    random.uuid()));
+  }
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalFills>();
+  });
+}
+
+std::string CacheFilter::cacheKey(const Http::HeaderMap& request_headers, bool secure) {
+  return absl::StrCat(secure ? "https" : "http", "://",
+                      request_headers.Host()->value().getStringView(),
+                      request_headers.Path()->value().getStringView());
+}
+
+std::string CacheFilter::variantKey(const std::string& key, const VaryValues& vary_values) {
+  // Header values cannot contain newlines, so different values give different keys.
+  std::string variant_key = key;
+  for (const auto& value : vary_values) {
+    absl::StrAppend(&variant_key, "\n", value.first, ":", value.second);
+  }
+  return variant_key;
+}
+
+void CacheFilter::onDestroy() {
+  destroyed_ = true;
+  if (fill_ != nullptr && !filling_) {
+    fill_->waiters_.erase(waiter_);
+    fill_ = nullptr;
+  } else {
+    endFill();
+  }
+}
+
+Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  if (!CacheHeadersUtils::isCacheableRequest(headers)) {
+    config_->stats().uncacheable_.inc();
+    return Http::FilterHeadersStatus::Continue;
+  }
+  request_headers_ = &headers;
+  const Network::Connection* connection = decoder_callbacks_->connection();
+  key_ = cacheKey(headers, connection != nullptr && connection->ssl() != nullptr);
+  request_cache_control_ = CacheHeadersUtils::requestCacheControl(headers);
+  decoding_headers_ = true;
+  lookup(key_);
+  decoding_headers_ = false;
+  return continue_decoding_ ? Http::FilterHeadersStatus::Continue
+                            : Http::FilterHeadersStatus::StopIteration;
+}
+
+void CacheFilter::lookup(const std::string& key) {
+  // The stream may end before the lookup completes.
+  std::weak_ptr<CacheFilter> weak_this = shared_from_this();
+  config_->cache().lookup(key, decoder_callbacks_->dispatcher(),
+                          [weak_this](CachedResponseConstSharedPtr response) -> void {
+                            std::shared_ptr<CacheFilter> filter = weak_this.lock();
+                            if (filter != nullptr && !filter->destroyed_) {
+                              filter->onLookupDone(std::move(response));
+                            }
+                          });
+}
+
+void CacheFilter::onLookupDone(CachedResponseConstSharedPtr response) {
+  if (response != nullptr && !response->varyMatches(*request_headers_)) {
+    if (!looking_up_variant_) {
+      // The latest response was selected with other request header values: look up the one that
+      // was selected with the values of this request.
+      looking_up_variant_ = true;
+      std::vector<std::string> vary_headers;
+      for (const auto& value : response->varyValues()) {
+        vary_headers.push_back(value.first);
+      }
+      lookup(variantKey(key_, CachedResponse::varyValues(vary_headers, *request_headers_)));
+      return;
+    }
+    response = nullptr;
+  }
+  looking_up_variant_ = false;
+  if (response == nullptr || !serveFromCache(std::move(response))) {
+    onMiss();
+  }
+}
+
+void CacheFilter::onMiss() {
+  if (waited_for_fill_) {
+    // The response could not be stored, or cannot be reused for this request: fetch it
+    // independently.
+    config_->stats().miss_.inc();
+    continueDecoding();
+    return;
+  }
+
+  // Only plain misses are coalesced: a validation is cheap for the upstream, and its outcome may
+  // depend on the conditional headers of the request.
+  auto& fills = config_->fills();
+  if (validating_response_ == nullptr) {
+    auto it = fills.find(key_);
+    if (it != fills.end()) {
+      config_->stats().coalesced_.inc();
+      fill_ = it->second;
+      waiter_ = fill_->waiters_.insert(fill_->waiters_.end(), this);
+      return;
+    }
+    fill_ = std::make_shared<Fill>();
+    filling_ = true;
+    fills.emplace(key_, fill_);
+  }
+  config_->stats().miss_.inc();
+  continueDecoding();
+}
+
+void CacheFilter::continueDecoding() {
+  if (decoding_headers_) {
+    continue_decoding_ = true;
+  } else {
+    decoder_callbacks_->continueDecoding();
+  }
+}
+
+bool CacheFilter::serveFromCache(CachedResponseConstSharedPtr response) {
+  const SystemTime now = config_->timeSource().systemTime();
+  if (response->isFresh(request_cache_control_, now)) {
+    config_->stats().hit_.inc();
+    encodeCachedResponse(response, now);
+    return true;
+  }
+
+  // Validate the stale response with a conditional request, unless the client sent its own
+  // conditional headers, in which case its request is forwarded as is.
+  const Http::HeaderEntry* etag = response->headers().Etag();
+  const Http::HeaderEntry* last_modified = response->headers().LastModified();
+  if ((etag != nullptr || last_modified != nullptr) &&
+      request_headers_->get(CacheHeaders::get().IfNoneMatch) == nullptr &&
+      request_headers_->get(CacheHeaders::get().IfModifiedSince) == nullptr) {
+    config_->stats().validate_.inc();
+    if (etag != nullptr) {
+      request_headers_->addCopy(CacheHeaders::get().IfNoneMatch,
+                                std::string(etag->value().getStringView()));
+    }
+    if (last_modified != nullptr) {
+      request_headers_->addCopy(CacheHeaders::get().IfModifiedSince,
+                                std::string(last_modified->value().getStringView()));
+    }
+    validating_response_ = std::move(response);
+  }
+  return false;
+}
+
+void CacheFilter::encodeCachedResponse(const CachedResponseConstSharedPtr& response,
+                                       SystemTime now) {
+  served_ = true;
+  Http::HeaderMapPtr headers = std::make_unique<Http::HeaderMapImpl>(response->headers());
+  headers->remove(CacheHeaders::get().Age);
+  headers->addCopy(CacheHeaders::get().Age, response->age(now).count());
+
+  const Http::HeaderEntry* if_none_match = request_headers_->get(CacheHeaders::get().IfNoneMatch);
+  const Http::HeaderEntry* etag = response->headers().Etag();
+  if (if_none_match != nullptr && etag != nullptr &&
+      CacheHeadersUtils::ifNoneMatch(if_none_match->value().getStringView(),
+                                     etag->value().getStringView())) {
+    headers->Status()->value(enumToInt(Http::Code::NotModified));
+    headers->removeContentLength();
+    decoder_callbacks_->encodeHeaders(std::move(headers), true);
+    return;
+  }
+
+  const std::string& body = response->body();
+  decoder_callbacks_->encodeHeaders(std::move(headers), body.empty());
+  if (destroyed_ || body.empty()) {
+    return;
+  }
+  // The body is sent without copying it, the fragment keeping the response alive until it is
+  // drained.
+  auto* fragment = new Buffer::BufferFragmentImpl(
+      body.data(), body.size(),
+      [response](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+        delete fragment;
+      });
+  Buffer::OwnedImpl data;
+  data.addBufferFragment(*fragment);
+  decoder_callbacks_->encodeData(data, true);
+}
+
+Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::HeaderMap& headers, bool end_stream) {
+  if (request_headers_ == nullptr || served_) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  const uint64_t status = Http::Utility::getResponseStatus(headers);
+
+  if (validating_response_ != nullptr && status == enumToInt(Http::Code::NotModified)) {
+    // The stored response is still valid: refresh its headers with the ones of the 304 response
+    // and send it in place of the 304 response.
+    config_->stats().validated_.inc();
+    const Http::HeaderMap& stored_headers = validating_response_->headers();
+    headers.Status()->value(stored_headers.Status()->value().getStringView());
+    headers.removeContentLength();
+    stored_headers.iterate(
+        [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+          auto* headers = static_cast<Http::HeaderMap*>(context);
+          const Http::LowerCaseString key(std::string(header.key().getStringView()));
+          if (headers->get(key) == nullptr) {
+            headers->addCopy(key, std::string(header.value().getStringView()));
+          }
+          return Http::HeaderMap::Iterate::Continue;
+        },
+        &headers);
+    headers.remove(CacheHeaders::get().Age);
+
+    std::string body = validating_response_->body();
+    VaryValues vary_values = validating_response_->varyValues();
+    auto refreshed = std::make_shared<CachedResponse>(
+        std::make_unique<Http::HeaderMapImpl>(headers), std::move(body),
+        config_->timeSource().systemTime(), std::move(vary_values));
+    storeResponse(refreshed);
+    served_ = true;
+    if (end_stream && !refreshed->body().empty()) {
+      Buffer::OwnedImpl data(refreshed->body());
+      encoder_callbacks_->addEncodedData(data, false);
+    }
+    validating_response_ = refreshed;
+    endFill();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  const absl::optional<std::vector<std::string>> vary_headers =
+      CacheHeadersUtils::varyHeaders(headers);
+  if (!vary_headers.has_value() || !CacheHeadersUtils::isCacheableResponse(headers) ||
+      CacheHeadersUtils::requestCacheControl(*request_headers_).no_store_) {
+    endFill();
+    return Http::FilterHeadersStatus::Continue;
+  }
+  inserting_ = true;
+  response_headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+  response_time_ = config_->timeSource().systemTime();
+  vary_values_ = CachedResponse::varyValues(vary_headers.value(), *request_headers_);
+  if (end_stream) {
+    insertResponse();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (served_ && validating_response_ != nullptr) {
+    // The body of a 304 response that is replaced by the stored response.
+    data.drain(data.length());
+    if (end_stream) {
+      data.add(validating_response_->body());
+    }
+    return Http::FilterDataStatus::Continue;
+  }
+  if (!inserting_) {
+    return Http::FilterDataStatus::Continue;
+  }
+  if (response_body_.size() + data.length() > config_->maxBodyBytes()) {
+    ENVOY_STREAM_LOG(debug, "cache: response body exceeds {} bytes, not storing it",
+                     *encoder_callbacks_, config_->maxBodyBytes());
+    inserting_ = false;
+    response_headers_ = nullptr;
+    response_body_.clear();
+    endFill();
+    return Http::FilterDataStatus::Continue;
+  }
+  response_body_.append(data.toString());
+  if (end_stream) {
+    insertResponse();
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::HeaderMap&) {
+  // Trailers are not stored, so a response that has them is not either.
+  if (inserting_) {
+    inserting_ = false;
+    response_headers_ = nullptr;
+    response_body_.clear();
+    endFill();
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void CacheFilter::insertResponse() {
+  inserting_ = false;
+  storeResponse(std::make_shared<CachedResponse>(std::move(response_headers_),
+                                                 std::move(response_body_), response_time_,
+                                                 std::move(vary_values_)));
+  endFill();
+}
+
+void CacheFilter::storeResponse(const CachedResponseConstSharedPtr& response) {
+  config_->cache().insert(key_, response);
+  if (!response->varyValues().empty()) {
+    config_->cache().insert(variantKey(key_, response->varyValues()), response);
+  }
+  config_->stats().insert_.inc();
+}
+
+void CacheFilter::endFill() {
+  if (!filling_) {
+    return;
+  }
+  filling_ = false;
+  config_->fills().erase(key_);
+  // Waiters may be destroyed, and so removed from the list, while other waiters are resumed.
+  FillSharedPtr fill = std::move(fill_);
+  while (!fill->waiters_.empty()) {
+    CacheFilter* waiter = fill->waiters_.front();
+    fill->waiters_.pop_front();
+    waiter->fill_ = nullptr;
+    waiter->onFillDone();
+  }
+}
+
+void CacheFilter::onFillDone() {
+  waited_for_fill_ = true;
+  lookup(key_);
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/api/api.h"
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/runtime/runtime.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/cache/cache_headers.h"
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All cache filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CACHE_FILTER_STATS(COUNTER)                                                            \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(validate)                                                                                \
+  COUNTER(validated)                                                                               \
+  COUNTER(insert)                                                                                  \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(uncacheable)
+// clang-format on
+
+/**
+ * Struct definition for cache filter stats. @see stats_macros.h
+ */
+struct CacheFilterStats {
+  ALL_CACHE_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+class CacheFilter;
+
+/**
+ * A response that a stream of a worker is fetching from upstream, which the streams of the same
+ * worker that miss on the same key wait for instead of sending their own upstream request.
+ */
+struct Fill {
+  std::list<CacheFilter*> waiters_;
+};
+
+typedef std::shared_ptr<Fill> FillSharedPtr;
+
+/**
+ * The fills in progress on a worker, by key.
+ */
+struct ThreadLocalFills : public ThreadLocal::ThreadLocalObject {
+  absl::flat_hash_map<std::string, FillSharedPtr> fills_;
+};
+
+/**
+ * Configuration for the cache filter. The storage is shared by the filters of all the workers.
+ */
+class CacheFilterConfig {
+public:
+  CacheFilterConfig(const envoy::config::filter::http::cache::v2alpha::Cache& proto_config,
+                    const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
+                    ThreadLocal::SlotAllocator& tls, Api::Api& api,
+                    Runtime::RandomGenerator& random);
+
+  HttpCache& cache() { return *cache_; }
+  CacheFilterStats& stats() { return stats_; }
+  TimeSource& timeSource() { return time_source_; }
+  uint64_t maxBodyBytes() const { return max_body_bytes_; }
+  absl::flat_hash_map<std::string, FillSharedPtr>& fills() {
+    return tls_->getTyped<ThreadLocalFills>().fills_;
+  }
+
+private:
+  static CacheFilterStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return CacheFilterStats{ALL_CACHE_FILTER_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  HttpCacheSharedPtr cache_;
+  CacheFilterStats stats_;
+  TimeSource& time_source_;
+  const uint64_t max_body_bytes_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<CacheFilterConfig> CacheFilterConfigSharedPtr;
+
+/**
+ * A filter that serves GET requests from cached responses, validates stale responses with
+ * conditional upstream requests, and stores the cacheable responses of the other requests.
+ * Responses served from the cache never reach the router, so they send no upstream request.
+ * Lookups may complete asynchronously, so filters must be owned by a shared pointer.
+ */
+class CacheFilter : public Http::StreamFilter,
+                    public std::enable_shared_from_this<CacheFilter>,
+                    Logger::Loggable<Logger::Id::filter> {
+public:
+  CacheFilter(const CacheFilterConfigSharedPtr& config) : config_(config) {}
+
+  /**
+   * @param request_headers supplies the request headers.
+   * @param secure supplies whether the request was received over TLS, which is used rather than
+   *        the x-forwarded-proto header that clients control.
+   * @return the key of the responses to a request.
+   */
+  static std::string cacheKey(const Http::HeaderMap& request_headers, bool secure);
+
+  /**
+   * @return the key of the variant of a response that was selected with vary_values. A response
+   *         is stored under the key of the request and under the key of its variant, so that the
+   *         first tells the names of the headers that select the second.
+   */
+  static std::string variantKey(const std::string& key, const VaryValues& vary_values);
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+  Http::FilterMetadataStatus encodeMetadata(Http::MetadataMap&) override {
+    return Http::FilterMetadataStatus::Continue;
+  }
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  void lookup(const std::string& key);
+  void onLookupDone(CachedResponseConstSharedPtr response);
+  // Serves the request from a fresh response. Otherwise, if the response is stale and can be
+  // validated, makes the upstream request conditional.
+  bool serveFromCache(CachedResponseConstSharedPtr response);
+  // Lets the request go upstream, or waits for the fill of another stream.
+  void onMiss();
+  void continueDecoding();
+  void encodeCachedResponse(const CachedResponseConstSharedPtr& response, SystemTime now);
+  // Called when the fill that this stream waits for ends.
+  void onFillDone();
+  void insertResponse();
+  void storeResponse(const CachedResponseConstSharedPtr& response);
+  // Resumes the streams waiting for the fill of this stream, if any.
+  void endFill();
+
+  const CacheFilterConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+  // Set for cacheable requests only.
+  Http::HeaderMap* request_headers_{};
+  std::string key_;
+  RequestCacheControl request_cache_control_;
+  bool looking_up_variant_{};
+  // Set while decodeHeaders() runs, during which a lookup that completes inline continues
+  // decoding by returning Continue.
+  bool decoding_headers_{};
+  bool continue_decoding_{};
+  // Set once the fill that this stream waited for ended.
+  bool waited_for_fill_{};
+  // The stale response that the upstream request validates.
+  CachedResponseConstSharedPtr validating_response_;
+  // The fill that this stream performs, or waits for.
+  FillSharedPtr fill_;
+  bool filling_{};
+  std::list<CacheFilter*>::iterator waiter_;
+  // Set once the response was served from the cache.
+  bool served_{};
+  bool destroyed_{};
+  // The response being stored.
+  bool inserting_{};
+  Http::HeaderMapPtr response_headers_;
+  std::string response_body_;
+  SystemTime response_time_;
+  VaryValues vary_values_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
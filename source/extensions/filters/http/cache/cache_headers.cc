@@ -0,0 +1,215 @@
+#include "extensions/filters/http/cache/cache_headers.h"
+
+#include <algorithm>
+
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/time/time.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+// Calls cb with the lower case name and the unquoted value of each Cache-Control directive.
+template <class Callback> void parseCacheControl(const Http::HeaderMap& headers, Callback cb) {
+  const Http::HeaderEntry* header = headers.CacheControl();
+  if (header == nullptr) {
+    return;
+  }
+  for (absl::string_view directive :
+       StringUtil::splitToken(header->value().getStringView(), ",", false)) {
+    directive = StringUtil::trim(directive);
+    absl::string_view value;
+    const size_t equals = directive.find('=');
+    if (equals != absl::string_view::npos) {
+      value = StringUtil::trim(directive.substr(equals + 1));
+      directive = StringUtil::rtrim(directive.substr(0, equals));
+      if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+      }
+    }
+    cb(absl::AsciiStrToLower(directive), value);
+  }
+}
+
+// An invalid delta-seconds value is treated as 0, so that the response is stale (RFC 7234 1.2.1).
+std::chrono::seconds deltaSeconds(absl::string_view value) {
+  uint64_t seconds;
+  if (!absl::SimpleAtoi(value, &seconds)) {
+    return std::chrono::seconds(0);
+  }
+  return std::chrono::seconds(std::min<uint64_t>(seconds, INT32_MAX));
+}
+
+bool isCacheableStatus(uint64_t status) {
+  // Status codes that are cacheable by default (RFC 7231 6.1).
+  switch (status) {
+  case 200:
+  case 203:
+  case 204:
+  case 300:
+  case 301:
+  case 404:
+  case 405:
+  case 410:
+  case 414:
+  case 501:
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+RequestCacheControl CacheHeadersUtils::requestCacheControl(const Http::HeaderMap& headers) {
+  RequestCacheControl cache_control;
+  parseCacheControl(headers, [&cache_control](const std::string& directive,
+                                              absl::string_view value) {
+    if (directive == "no-store") {
+      cache_control.no_store_ = true;
+    } else if (directive == "no-cache") {
+      cache_control.no_cache_ = true;
+    } else if (directive == "max-age") {
+      cache_control.max_age_ = deltaSeconds(value);
+    }
+  });
+  if (headers.CacheControl() == nullptr) {
+    const Http::HeaderEntry* pragma = headers.get(CacheHeaders::get().Pragma);
+    cache_control.no_cache_ =
+        pragma != nullptr &&
+        StringUtil::caseFindToken(pragma->value().getStringView(), ",", "no-cache");
+  }
+  return cache_control;
+}
+
+ResponseCacheControl CacheHeadersUtils::responseCacheControl(const Http::HeaderMap& headers) {
+  ResponseCacheControl cache_control;
+  parseCacheControl(headers, [&cache_control](const std::string& directive,
+                                              absl::string_view value) {
+    if (directive == "no-store") {
+      cache_control.no_store_ = true;
+    } else if (directive == "no-cache") {
+      cache_control.no_cache_ = true;
+    } else if (directive == "private") {
+      cache_control.private_ = true;
+    } else if (directive == "max-age") {
+      cache_control.max_age_ = deltaSeconds(value);
+    } else if (directive == "s-maxage") {
+      cache_control.s_maxage_ = deltaSeconds(value);
+    }
+  });
+  return cache_control;
+}
+
+absl::optional<SystemTime> CacheHeadersUtils::httpTime(const Http::HeaderEntry* header) {
+  if (header == nullptr) {
+    return absl::nullopt;
+  }
+  absl::Time time;
+  std::string error;
+  if (!absl::ParseTime("%a, %d %b %Y %H:%M:%S GMT", std::string(header->value().getStringView()),
+                       absl::UTCTimeZone(), &time, &error)) {
+    return absl::nullopt;
+  }
+  return absl::ToChronoTime(time);
+}
+
+bool CacheHeadersUtils::isCacheableRequest(const Http::HeaderMap& headers) {
+  return headers.Method() != nullptr &&
+         headers.Method()->value().getStringView() == Http::Headers::get().MethodValues.Get &&
+         headers.Host() != nullptr && headers.Path() != nullptr &&
+         headers.Authorization() == nullptr && !requestCacheControl(headers).no_store_;
+}
+
+bool CacheHeadersUtils::isCacheableResponse(const Http::HeaderMap& headers) {
+  const ResponseCacheControl cache_control = responseCacheControl(headers);
+  if (cache_control.no_store_ || cache_control.private_ ||
+      !isCacheableStatus(Http::Utility::getResponseStatus(headers)) ||
+      !varyHeaders(headers).has_value()) {
+    return false;
+  }
+  return freshnessLifetime(headers) > std::chrono::seconds(0) || headers.Etag() != nullptr ||
+         headers.LastModified() != nullptr;
+}
+
+std::chrono::seconds CacheHeadersUtils::freshnessLifetime(const Http::HeaderMap& headers) {
+  const ResponseCacheControl cache_control = responseCacheControl(headers);
+  if (cache_control.s_maxage_.has_value()) {
+    return cache_control.s_maxage_.value();
+  }
+  if (cache_control.max_age_.has_value()) {
+    return cache_control.max_age_.value();
+  }
+  // An invalid Expires header, such as "0", means that the response is already expired.
+  const absl::optional<SystemTime> expires = httpTime(headers.get(CacheHeaders::get().Expires));
+  const absl::optional<SystemTime> date = httpTime(headers.Date());
+  if (!expires.has_value() || !date.has_value() || expires.value() <= date.value()) {
+    return std::chrono::seconds(0);
+  }
+  return std::chrono::duration_cast<std::chrono::seconds>(expires.value() - date.value());
+}
+
+std::chrono::seconds CacheHeadersUtils::initialAge(const Http::HeaderMap& headers,
+                                                   SystemTime response_time) {
+  std::chrono::seconds age(0);
+  const Http::HeaderEntry* age_header = headers.get(CacheHeaders::get().Age);
+  if (age_header != nullptr) {
+    age = deltaSeconds(age_header->value().getStringView());
+  }
+  // Corrects for the time the response spent in caches that did not add an Age header.
+  const absl::optional<SystemTime> date = httpTime(headers.Date());
+  if (date.has_value() && response_time > date.value()) {
+    age = std::max(age,
+                   std::chrono::duration_cast<std::chrono::seconds>(response_time - date.value()));
+  }
+  return age;
+}
+
+absl::optional<std::vector<std::string>>
+CacheHeadersUtils::varyHeaders(const Http::HeaderMap& headers) {
+  std::vector<std::string> names;
+  const Http::HeaderEntry* vary = headers.get(Http::Headers::get().Vary);
+  if (vary == nullptr) {
+    return names;
+  }
+  for (absl::string_view name :
+       StringUtil::splitToken(vary->value().getStringView(), ",", false)) {
+    name = StringUtil::trim(name);
+    if (name == "*") {
+      return absl::nullopt;
+    }
+    names.push_back(absl::AsciiStrToLower(name));
+  }
+  return names;
+}
+
+bool CacheHeadersUtils::ifNoneMatch(absl::string_view if_none_match, absl::string_view etag) {
+  const auto strip_weak = [](absl::string_view tag) {
+    tag = StringUtil::trim(tag);
+    if (absl::StartsWith(tag, "W/")) {
+      tag.remove_prefix(2);
+    }
+    return tag;
+  };
+  etag = strip_weak(etag);
+  for (absl::string_view tag : StringUtil::splitToken(if_none_match, ",", false)) {
+    if (StringUtil::trim(tag) == "*" || strip_weak(tag) == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
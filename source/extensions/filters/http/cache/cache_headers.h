@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+
+#include "common/singleton/const_singleton.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Headers used by the cache that are not in Http::Headers.
+ */
+class CacheHeaderValues {
+public:
+  const Http::LowerCaseString Age{"age"};
+  const Http::LowerCaseString Expires{"expires"};
+  const Http::LowerCaseString IfModifiedSince{"if-modified-since"};
+  const Http::LowerCaseString IfNoneMatch{"if-none-match"};
+  const Http::LowerCaseString Pragma{"pragma"};
+};
+
+typedef ConstSingleton<CacheHeaderValues> CacheHeaders;
+
+/**
+ * The Cache-Control directives of a request that the cache supports.
+ */
+struct RequestCacheControl {
+  bool no_store_{};
+  // Also set by "Pragma: no-cache" when the request has no Cache-Control header.
+  bool no_cache_{};
+  absl::optional<std::chrono::seconds> max_age_;
+};
+
+/**
+ * The Cache-Control directives of a response that the cache supports.
+ */
+struct ResponseCacheControl {
+  bool no_store_{};
+  bool no_cache_{};
+  bool private_{};
+  absl::optional<std::chrono::seconds> max_age_;
+  absl::optional<std::chrono::seconds> s_maxage_;
+};
+
+/**
+ * RFC 7234 rules for a shared cache.
+ */
+class CacheHeadersUtils {
+public:
+  static RequestCacheControl requestCacheControl(const Http::HeaderMap& headers);
+  static ResponseCacheControl responseCacheControl(const Http::HeaderMap& headers);
+
+  /**
+   * @return the time in an IMF-fixdate header value, e.g. "Sun, 06 Nov 1994 08:49:37 GMT", or
+   *         nullopt if the header is missing or invalid.
+   */
+  static absl::optional<SystemTime> httpTime(const Http::HeaderEntry* header);
+
+  /**
+   * @return whether the response to a request may be looked up in and stored in the cache. Only
+   *         GET requests without credentials are cached.
+   */
+  static bool isCacheableRequest(const Http::HeaderMap& headers);
+
+  /**
+   * @return whether a response may be stored. It must have a status that is cacheable by default,
+   *         must not be private or no-store, and must either have a freshness lifetime or a
+   *         validator to refresh it with.
+   */
+  static bool isCacheableResponse(const Http::HeaderMap& headers);
+
+  /**
+   * @return how long a response stays fresh after it was generated, from s-maxage, max-age or
+   *         Expires.
+   */
+  static std::chrono::seconds freshnessLifetime(const Http::HeaderMap& headers);
+
+  /**
+   * @return the age of a response when it was received, from its Age and Date headers.
+   */
+  static std::chrono::seconds initialAge(const Http::HeaderMap& headers, SystemTime response_time);
+
+  /**
+   * @return the lower case names of the request headers in the Vary header of a response, or
+   *         nullopt if the response varies on "*" and so can never be reused.
+   */
+  static absl::optional<std::vector<std::string>> varyHeaders(const Http::HeaderMap& headers);
+
+  /**
+   * @return whether an If-None-Match header value matches an entity tag, using the weak
+   *         comparison.
+   */
+  static bool ifNoneMatch(absl::string_view if_none_match, absl::string_view etag);
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,32 @@
+#include "extensions/filters/http/cache/config.h"
+
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+Http::FilterFactoryCb CacheFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::cache::v2alpha::Cache& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  CacheFilterConfigSharedPtr config = std::make_shared<CacheFilterConfig>(
+      proto_config, stats_prefix, context.scope(), context.dispatcher().timeSource(),
+      context.threadLocal(), context.api(), context.random());
+  return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<CacheFilter>(config));
+  };
+}
+
+/**
+ * Static registration for the cache filter. @see NamedHttpFilterConfigFactory.
+ */
+REGISTER_FACTORY(CacheFilterFactory, Server::Configuration::NamedHttpFilterConfigFactory);
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
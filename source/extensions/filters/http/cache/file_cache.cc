@@ -0,0 +1,291 @@
+#include "extensions/filters/http/cache/file_cache.h"
+
+#include <cstring>
+
+#include "envoy/common/exception.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/fmt.h"
+#include "common/common/hash.h"
+#include "common/filesystem/directory.h"
+#include "common/http/header_map_impl.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+// Identifies the format of the files, which is only meant to be read by the same build of Envoy.
+constexpr absl::string_view FileMagic = "envoy-http-cache-1\n";
+constexpr absl::string_view TemporaryFileInfix = ".tmp.";
+
+template <class T> void encodeInt(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void encodeString(std::string& out, absl::string_view value) {
+  encodeInt<uint64_t>(out, value.size());
+  out.append(value.data(), value.size());
+}
+
+// Reads the values written by the functions above, failing on truncated data.
+class Decoder {
+public:
+  Decoder(absl::string_view data) : data_(data) {}
+
+  template <class T> bool decodeInt(T& value) {
+    if (data_.size() < sizeof(value)) {
+      return false;
+    }
+    memcpy(&value, data_.data(), sizeof(value));
+    data_.remove_prefix(sizeof(value));
+    return true;
+  }
+
+  bool decodeString(absl::string_view& value) {
+    uint64_t size;
+    if (!decodeInt(size) || data_.size() < size) {
+      return false;
+    }
+    value = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  bool done() const { return data_.empty(); }
+
+private:
+  absl::string_view data_;
+};
+
+} // namespace
+
+FileCache::FileCache(Filesystem::Instance& file_system, Thread::ThreadFactory& thread_factory,
+                     const std::string& path, uint64_t max_size_bytes,
+                     const std::string& instance_id)
+    : file_system_(file_system), os_sys_calls_(Api::OsSysCallsSingleton::get()), path_(path),
+      max_size_bytes_(max_size_bytes), instance_id_(instance_id) {
+  if (!file_system_.directoryExists(path_)) {
+    throw EnvoyException(fmt::format("cache directory does not exist: {}", path_));
+  }
+  Filesystem::Directory directory(path_);
+  for (const Filesystem::DirectoryEntry& entry : directory) {
+    if (entry.type_ != Filesystem::FileType::Regular) {
+      continue;
+    }
+    if (absl::StrContains(entry.name_, TemporaryFileInfix)) {
+      // Left over by a write that was interrupted by a crash.
+      os_sys_calls_.unlink(filePath(entry.name_).c_str());
+    } else if (entry.name_.size() == 16 &&
+               entry.name_.find_first_not_of("0123456789abcdef") == std::string::npos) {
+      const ssize_t size = file_system_.fileSize(filePath(entry.name_));
+      if (size >= 0) {
+        addFile(entry.name_, size);
+      }
+    }
+  }
+  thread_ = thread_factory.createThread([this]() -> void { threadRoutine(); });
+}
+
+FileCache::~FileCache() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    queue_event_.notifyAll();
+  }
+  thread_->join();
+}
+
+void FileCache::post(Job job) {
+  Thread::LockGuard lock(lock_);
+  queue_.push_back(std::move(job));
+  queue_event_.notifyOne();
+}
+
+void FileCache::threadRoutine() {
+  while (true) {
+    Job job;
+    {
+      Thread::LockGuard lock(lock_);
+      while (queue_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        queue_event_.wait(lock_);
+      }
+      // The queued writes are completed before exiting.
+      if (queue_.empty()) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    job();
+  }
+}
+
+std::string FileCache::fileName(const std::string& key) {
+  return fmt::format("{:016x}", HashUtil::xxHash64(key));
+}
+
+void FileCache::addFile(const std::string& file_name, uint64_t size) {
+  auto it = files_.find(file_name);
+  if (it != files_.end()) {
+    size_bytes_ -= it->second->second;
+    lru_.erase(it->second);
+    files_.erase(it);
+  }
+  lru_.emplace_front(file_name, size);
+  files_.emplace(file_name, lru_.begin());
+  size_bytes_ += size;
+  while (size_bytes_ > max_size_bytes_) {
+    removeFile(lru_.back().first);
+  }
+}
+
+void FileCache::removeFile(const std::string& file_name) {
+  auto it = files_.find(file_name);
+  if (it == files_.end()) {
+    return;
+  }
+  os_sys_calls_.unlink(filePath(file_name).c_str());
+  size_bytes_ -= it->second->second;
+  lru_.erase(it->second);
+  files_.erase(it);
+}
+
+void FileCache::lookup(const std::string& key, Event::Dispatcher& dispatcher,
+                       LookupCallback callback) {
+  post([this, key, &dispatcher, callback]() -> void {
+    CachedResponseConstSharedPtr response = read(key);
+    dispatcher.post([callback, response]() -> void { callback(response); });
+  });
+}
+
+void FileCache::insert(const std::string& key, const CachedResponseConstSharedPtr& response) {
+  post([this, key, response]() -> void { write(key, *response); });
+}
+
+void FileCache::remove(const std::string& key) {
+  post([this, key]() -> void { removeFile(fileName(key)); });
+}
+
+CachedResponseConstSharedPtr FileCache::read(const std::string& key) {
+  const std::string file_name = fileName(key);
+  auto it = files_.find(file_name);
+  if (it == files_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+
+  std::string data;
+  try {
+    data = file_system_.fileReadToEnd(filePath(file_name));
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(debug, "failed to read cached response: {}", e.what());
+    removeFile(file_name);
+    return nullptr;
+  }
+  return decode(data, key);
+}
+
+void FileCache::write(const std::string& key, const CachedResponse& response) {
+  const std::string data = encode(key, response);
+  const std::string file_name = fileName(key);
+  if (data.size() > max_size_bytes_) {
+    removeFile(file_name);
+    return;
+  }
+
+  const std::string temporary_path = filePath(
+      absl::StrCat(file_name, TemporaryFileInfix, instance_id_, ".", next_temporary_file_++));
+  Filesystem::FilePtr file = file_system_.createFile(temporary_path);
+  bool written = file->open().rc_;
+  if (written) {
+    written = file->write(data).rc_ == static_cast<ssize_t>(data.size());
+    written = file->close().rc_ && written;
+  }
+  if (!written ||
+      os_sys_calls_.rename(temporary_path.c_str(), filePath(file_name).c_str()).rc_ != 0) {
+    ENVOY_LOG(debug, "failed to write cached response to {}", temporary_path);
+    os_sys_calls_.unlink(temporary_path.c_str());
+    return;
+  }
+  addFile(file_name, data.size());
+}
+
+std::string FileCache::encode(const std::string& key, const CachedResponse& response) {
+  std::string out(FileMagic.data(), FileMagic.size());
+  encodeString(out, key);
+  encodeInt<int64_t>(out, std::chrono::duration_cast<std::chrono::milliseconds>(
+                              response.responseTime().time_since_epoch())
+                              .count());
+  encodeInt<uint64_t>(out, response.headers().size());
+  response.headers().iterate(
+      [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+        std::string& out = *static_cast<std::string*>(context);
+        encodeString(out, header.key().getStringView());
+        encodeString(out, header.value().getStringView());
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &out);
+  encodeInt<uint64_t>(out, response.varyValues().size());
+  for (const auto& value : response.varyValues()) {
+    encodeString(out, value.first);
+    encodeString(out, value.second);
+  }
+  encodeString(out, response.body());
+  return out;
+}
+
+CachedResponseConstSharedPtr FileCache::decode(absl::string_view data, const std::string& key) {
+  if (!absl::StartsWith(data, FileMagic)) {
+    return nullptr;
+  }
+  Decoder decoder(data.substr(FileMagic.size()));
+  absl::string_view stored_key;
+  int64_t response_time_ms;
+  uint64_t header_count;
+  if (!decoder.decodeString(stored_key) || stored_key != key ||
+      !decoder.decodeInt(response_time_ms) || !decoder.decodeInt(header_count)) {
+    return nullptr;
+  }
+
+  auto headers = std::make_unique<Http::HeaderMapImpl>();
+  for (uint64_t i = 0; i < header_count; i++) {
+    absl::string_view name, value;
+    if (!decoder.decodeString(name) || !decoder.decodeString(value)) {
+      return nullptr;
+    }
+    headers->addCopy(Http::LowerCaseString(std::string(name)), std::string(value));
+  }
+
+  uint64_t vary_count;
+  if (!decoder.decodeInt(vary_count)) {
+    return nullptr;
+  }
+  VaryValues vary_values;
+  for (uint64_t i = 0; i < vary_count; i++) {
+    absl::string_view name, value;
+    if (!decoder.decodeString(name) || !decoder.decodeString(value)) {
+      return nullptr;
+    }
+    vary_values.emplace_back(std::string(name), std::string(value));
+  }
+
+  absl::string_view body;
+  if (!decoder.decodeString(body) || !decoder.done()) {
+    return nullptr;
+  }
+  return std::make_shared<const CachedResponse>(
+      std::move(headers), std::string(body),
+      SystemTime(std::chrono::milliseconds(response_time_ms)), std::move(vary_values));
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
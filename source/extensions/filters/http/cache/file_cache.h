@@ -0,0 +1,106 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <string>
+#include <utility>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/filesystem/filesystem.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Keeps responses in files of a directory, named after the hash of their key. Files are written
+ * to a temporary name and renamed, so readers never see a partially written response. The
+ * least recently used files are deleted once the files reach the maximum total size. Files found
+ * in the directory at startup are kept, so responses survive restarts.
+ *
+ * After startup, the files are only accessed by a dedicated thread, so that workers never block on
+ * the disk. It performs the operations in the order they are requested, and posts the results of
+ * lookups to the dispatchers of the workers that requested them.
+ */
+class FileCache : public HttpCache, Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * @param file_system supplies the file system to read and write files with.
+   * @param thread_factory supplies the factory of the file thread.
+   * @param path supplies the directory of the files.
+   * @param max_size_bytes supplies the maximum total size of the files.
+   * @param instance_id supplies an identifier that is unique among the caches sharing the
+   *        directory, e.g. across a hot restart, which names their temporary files.
+   */
+  FileCache(Filesystem::Instance& file_system, Thread::ThreadFactory& thread_factory,
+            const std::string& path, uint64_t max_size_bytes, const std::string& instance_id);
+  ~FileCache();
+
+  // HttpCache
+  void lookup(const std::string& key, Event::Dispatcher& dispatcher,
+              LookupCallback callback) override;
+  void insert(const std::string& key, const CachedResponseConstSharedPtr& response) override;
+  void remove(const std::string& key) override;
+
+  /**
+   * @return the contents of the file of a response.
+   */
+  static std::string encode(const std::string& key, const CachedResponse& response);
+
+  /**
+   * @return the response in the contents of a file, or nullptr if they are invalid or belong to
+   *         another key whose hash collides with key.
+   */
+  static CachedResponseConstSharedPtr decode(absl::string_view data, const std::string& key);
+
+private:
+  // File names and sizes, most recently used first.
+  typedef std::list<std::pair<std::string, uint64_t>> LruList;
+
+  typedef std::function<void()> Job;
+
+  static std::string fileName(const std::string& key);
+  std::string filePath(const std::string& file_name) const { return path_ + "/" + file_name; }
+  // Queues a job for the file thread.
+  void post(Job job);
+  void threadRoutine();
+
+  // The following run on the file thread, or before it starts.
+  CachedResponseConstSharedPtr read(const std::string& key);
+  void write(const std::string& key, const CachedResponse& response);
+  void addFile(const std::string& file_name, uint64_t size);
+  void removeFile(const std::string& file_name);
+
+  Filesystem::Instance& file_system_;
+  Api::OsSysCalls& os_sys_calls_;
+  const std::string path_;
+  const uint64_t max_size_bytes_;
+  const std::string instance_id_;
+  uint64_t next_temporary_file_{};
+  LruList lru_;
+  absl::flat_hash_map<std::string, LruList::iterator> files_;
+  uint64_t size_bytes_{};
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar queue_event_;
+  std::deque<Job> queue_ GUARDED_BY(lock_);
+  bool exit_ GUARDED_BY(lock_){};
+  Thread::ThreadPtr thread_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
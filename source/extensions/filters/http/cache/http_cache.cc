@@ -0,0 +1,69 @@
+#include "extensions/filters/http/cache/http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+CachedResponse::CachedResponse(Http::HeaderMapPtr&& headers, std::string&& body,
+                               SystemTime response_time, VaryValues&& vary_values)
+    : headers_(std::move(headers)), body_(std::move(body)), response_time_(response_time),
+      vary_values_(std::move(vary_values)),
+      initial_age_(CacheHeadersUtils::initialAge(*headers_, response_time_)),
+      freshness_lifetime_(CacheHeadersUtils::freshnessLifetime(*headers_)),
+      no_cache_(CacheHeadersUtils::responseCacheControl(*headers_).no_cache_),
+      byte_size_([this]() {
+        uint64_t size = sizeof(*this) + headers_->byteSize() + body_.size();
+        for (const auto& value : vary_values_) {
+          size += value.first.size() + value.second.size();
+        }
+        return size;
+      }()) {}
+
+std::chrono::seconds CachedResponse::age(SystemTime now) const {
+  const std::chrono::seconds resident_time =
+      now > response_time_ ? std::chrono::duration_cast<std::chrono::seconds>(now - response_time_)
+                           : std::chrono::seconds(0);
+  return initial_age_ + resident_time;
+}
+
+bool CachedResponse::isFresh(const RequestCacheControl& request_cache_control,
+                             SystemTime now) const {
+  if (no_cache_ || request_cache_control.no_cache_) {
+    return false;
+  }
+  std::chrono::seconds lifetime = freshness_lifetime_;
+  if (request_cache_control.max_age_.has_value()) {
+    lifetime = std::min(lifetime, request_cache_control.max_age_.value());
+  }
+  return age(now) < lifetime;
+}
+
+bool CachedResponse::varyMatches(const Http::HeaderMap& request_headers) const {
+  for (const auto& value : vary_values_) {
+    const Http::HeaderEntry* header = request_headers.get(Http::LowerCaseString(value.first));
+    const absl::string_view request_value =
+        header != nullptr ? header->value().getStringView() : absl::string_view();
+    if (request_value != value.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+VaryValues CachedResponse::varyValues(const std::vector<std::string>& vary_headers,
+                                      const Http::HeaderMap& request_headers) {
+  VaryValues values;
+  values.reserve(vary_headers.size());
+  for (const std::string& name : vary_headers) {
+    const Http::HeaderEntry* header = request_headers.get(Http::LowerCaseString(name));
+    values.emplace_back(name, header != nullptr ? std::string(header->value().getStringView())
+                                                : std::string());
+  }
+  return values;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
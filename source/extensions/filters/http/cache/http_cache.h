@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/header_map.h"
+
+#include "extensions/filters/http/cache/cache_headers.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+// The request header values that a response was selected with, for the header names in its Vary
+// header. A missing header has an empty value.
+typedef std::vector<std::pair<std::string, std::string>> VaryValues;
+
+/**
+ * A stored response. Cached responses are immutable, so they can be shared by the streams of all
+ * the workers.
+ */
+class CachedResponse {
+public:
+  /**
+   * @param headers supplies the response headers.
+   * @param body supplies the response body.
+   * @param response_time supplies the time at which the response was received.
+   * @param vary_values supplies the request header values the response was selected with.
+   */
+  CachedResponse(Http::HeaderMapPtr&& headers, std::string&& body, SystemTime response_time,
+                 VaryValues&& vary_values);
+
+  const Http::HeaderMap& headers() const { return *headers_; }
+  const std::string& body() const { return body_; }
+  SystemTime responseTime() const { return response_time_; }
+  const VaryValues& varyValues() const { return vary_values_; }
+
+  /**
+   * @return the current age of the response (RFC 7234 4.2.3).
+   */
+  std::chrono::seconds age(SystemTime now) const;
+
+  /**
+   * @return whether the response can be served to a request without validating it first.
+   */
+  bool isFresh(const RequestCacheControl& request_cache_control, SystemTime now) const;
+
+  /**
+   * @return whether the response was selected with the same Vary header values as the request.
+   */
+  bool varyMatches(const Http::HeaderMap& request_headers) const;
+
+  /**
+   * @return an approximation of the memory used by the response.
+   */
+  uint64_t byteSize() const { return byte_size_; }
+
+  /**
+   * @return the values of the headers named in a response's Vary header in a request.
+   */
+  static VaryValues varyValues(const std::vector<std::string>& vary_headers,
+                               const Http::HeaderMap& request_headers);
+
+private:
+  const Http::HeaderMapPtr headers_;
+  const std::string body_;
+  const SystemTime response_time_;
+  const VaryValues vary_values_;
+  const std::chrono::seconds initial_age_;
+  const std::chrono::seconds freshness_lifetime_;
+  const bool no_cache_;
+  const uint64_t byte_size_;
+};
+
+typedef std::shared_ptr<const CachedResponse> CachedResponseConstSharedPtr;
+
+/**
+ * Called with the response found by a lookup, or nullptr.
+ */
+typedef std::function<void(CachedResponseConstSharedPtr response)> LookupCallback;
+
+/**
+ * Storage of cached responses, keyed by request URL. Implementations must be thread safe, as one
+ * storage is shared by all the workers.
+ */
+class HttpCache {
+public:
+  virtual ~HttpCache() {}
+
+  /**
+   * Look up the response stored under a key. Storages that need to block, e.g. on disk, must not
+   * do so on the calling thread.
+   * @param key supplies the key.
+   * @param dispatcher supplies the dispatcher of the calling thread, to which the callback is
+   *        posted if the lookup does not complete before this returns.
+   * @param callback supplies the callback, which may be called before this returns.
+   */
+  virtual void lookup(const std::string& key, Event::Dispatcher& dispatcher,
+                      LookupCallback callback) PURE;
+
+  /**
+   * Store a response under a key, replacing any response already stored under it. The storage may
+   * drop the response, e.g. if it is larger than the storage.
+   */
+  virtual void insert(const std::string& key, const CachedResponseConstSharedPtr& response) PURE;
+
+  /**
+   * Remove the response stored under a key, if any.
+   */
+  virtual void remove(const std::string& key) PURE;
+};
+
+typedef std::shared_ptr<HttpCache> HttpCacheSharedPtr;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
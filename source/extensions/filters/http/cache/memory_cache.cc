@@ -0,0 +1,83 @@
+#include "extensions/filters/http/cache/memory_cache.h"
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+MemoryCache::MemoryCache(uint64_t max_size_bytes, uint32_t shards)
+    : max_shard_size_bytes_(max_size_bytes / shards) {
+  ASSERT(shards > 0);
+  for (uint32_t i = 0; i < shards; i++) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+MemoryCache::Shard& MemoryCache::shardFor(const std::string& key) {
+  return *shards_[HashUtil::xxHash64(key) % shards_.size()];
+}
+
+void MemoryCache::removeEntry(Shard& shard, LruList::iterator it) {
+  shard.size_bytes_ -= it->second->byteSize();
+  shard.entries_.erase(it->first);
+  shard.lru_.erase(it);
+}
+
+CachedResponseConstSharedPtr MemoryCache::get(const std::string& key) {
+  Shard& shard = shardFor(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.entries_.find(key);
+  if (it == shard.entries_.end()) {
+    return nullptr;
+  }
+  shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+  return it->second->second;
+}
+
+void MemoryCache::lookup(const std::string& key, Event::Dispatcher&, LookupCallback callback) {
+  callback(get(key));
+}
+
+void MemoryCache::insert(const std::string& key, const CachedResponseConstSharedPtr& response) {
+  Shard& shard = shardFor(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.entries_.find(key);
+  if (it != shard.entries_.end()) {
+    removeEntry(shard, it->second);
+  }
+  if (response->byteSize() > max_shard_size_bytes_) {
+    return;
+  }
+  while (shard.size_bytes_ + response->byteSize() > max_shard_size_bytes_) {
+    removeEntry(shard, std::prev(shard.lru_.end()));
+  }
+  shard.lru_.emplace_front(key, response);
+  shard.entries_.emplace(key, shard.lru_.begin());
+  shard.size_bytes_ += response->byteSize();
+}
+
+void MemoryCache::remove(const std::string& key) {
+  Shard& shard = shardFor(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.entries_.find(key);
+  if (it != shard.entries_.end()) {
+    removeEntry(shard, it->second);
+  }
+}
+
+uint64_t MemoryCache::sizeBytes() {
+  uint64_t size_bytes = 0;
+  for (auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mutex_);
+    size_bytes += shard->size_bytes_;
+  }
+  return size_bytes;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/thread_annotations.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Keeps responses in memory, in shards that each have their own lock and evict their least
+ * recently used responses once they hold their share of the total size.
+ */
+class MemoryCache : public HttpCache {
+public:
+  /**
+   * @param max_size_bytes supplies the maximum total size of the responses.
+   * @param shards supplies the number of shards.
+   */
+  MemoryCache(uint64_t max_size_bytes, uint32_t shards);
+
+  /**
+   * @return the response stored under a key, or nullptr.
+   */
+  CachedResponseConstSharedPtr get(const std::string& key);
+
+  // HttpCache
+  void lookup(const std::string& key, Event::Dispatcher& dispatcher,
+              LookupCallback callback) override;
+  void insert(const std::string& key, const CachedResponseConstSharedPtr& response) override;
+  void remove(const std::string& key) override;
+
+  /**
+   * @return the total size of the responses held, for tests.
+   */
+  uint64_t sizeBytes();
+
+private:
+  typedef std::list<std::pair<std::string, CachedResponseConstSharedPtr>> LruList;
+
+  struct Shard {
+    absl::Mutex mutex_;
+    // Most recently used first.
+    LruList lru_ GUARDED_BY(mutex_);
+    absl::flat_hash_map<std::string, LruList::iterator> entries_ GUARDED_BY(mutex_);
+    uint64_t size_bytes_ GUARDED_BY(mutex_){};
+  };
+
+  Shard& shardFor(const std::string& key);
+  static void removeEntry(Shard& shard, LruList::iterator it)
+      EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const uint64_t max_shard_size_bytes_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,42 @@
+#include "extensions/filters/http/cache/tiered_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+void TieredCache::lookup(const std::string& key, Event::Dispatcher& dispatcher,
+                         LookupCallback callback) {
+  // The callbacks may run after this is destroyed, so they hold on to the storages.
+  HttpCacheSharedPtr fast = fast_;
+  HttpCacheSharedPtr slow = slow_;
+  fast_->lookup(key, dispatcher,
+                [fast, slow, key, &dispatcher, callback](CachedResponseConstSharedPtr response) {
+                  if (response != nullptr) {
+                    callback(std::move(response));
+                    return;
+                  }
+                  slow->lookup(key, dispatcher,
+                               [fast, key, callback](CachedResponseConstSharedPtr response) {
+                                 if (response != nullptr) {
+                                   fast->insert(key, response);
+                                 }
+                                 callback(std::move(response));
+                               });
+                });
+}
+
+void TieredCache::insert(const std::string& key, const CachedResponseConstSharedPtr& response) {
+  fast_->insert(key, response);
+  slow_->insert(key, response);
+}
+
+void TieredCache::remove(const std::string& key) {
+  fast_->remove(key);
+  slow_->remove(key);
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
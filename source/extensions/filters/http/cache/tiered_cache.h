@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Combines a fast storage with a larger, slower one. Responses are written to both, looked up in
+ * the fast storage first, and copied back into it when they are only found in the slow one.
+ */
+class TieredCache : public HttpCache {
+public:
+  TieredCache(HttpCacheSharedPtr fast, HttpCacheSharedPtr slow)
+      : fast_(std::move(fast)), slow_(std::move(slow)) {}
+
+  // HttpCache
+  void lookup(const std::string& key, Event::Dispatcher& dispatcher,
+              LookupCallback callback) override;
+  void insert(const std::string& key, const CachedResponseConstSharedPtr& response) override;
+  void remove(const std::string& key) override;
+
+private:
+  const HttpCacheSharedPtr fast_;
+  const HttpCacheSharedPtr slow_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
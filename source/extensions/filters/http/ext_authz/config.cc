@@ -8,6 +8,7 @@
 
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ext_authz/decision_cache.h"
 #include "extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "extensions/filters/common/ext_authz/ext_authz_http_impl.h"
 #include "extensions/filters/http/ext_authz/ext_authz.h"
@@ -18,10 +19,16 @@ namespace HttpFilters {
 namespace ExtAuthz {
 
 Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
-    const envoy::config::filter::http::ext_authz::v2::ExtAuthz& proto_config, const std::string&,
-    Server::Configuration::FactoryContext& context) {
+    const envoy::config::filter::http::ext_authz::v2::ExtAuthz& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   const auto filter_config = std::make_shared<FilterConfig>(
       proto_config, context.localInfo(), context.scope(), context.runtime(), context.httpContext());
+  Filters::Common::ExtAuthz::DecisionCacheProviderSharedPtr cache_provider;
+  if (proto_config.has_decision_cache()) {
+    cache_provider = std::make_shared<Filters::Common::ExtAuthz::DecisionCacheProvider>(
+        proto_config.decision_cache(), stats_prefix + "ext_authz.", context.scope(),
+        context.threadLocal(), context.dispatcher().timeSource());
+  }
   Http::FilterFactoryCb callback;
 
   if (proto_config.has_http_service()) {
@@ -31,10 +38,14 @@ Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
     const auto client_config =
         std::make_shared<Extensions::Filters::Common::ExtAuthz::ClientConfig>(
             proto_config, timeout_ms, proto_config.http_service().path_prefix());
-    callback = [filter_config, client_config,
+    callback = [filter_config, client_config, cache_provider,
                 &context](Http::FilterChainFactoryCallbacks& callbacks) {
-      auto client = std::make_unique<Extensions::Filters::Common::ExtAuthz::RawHttpClientImpl>(
-          context.clusterManager(), client_config);
+      Filters::Common::ExtAuthz::ClientPtr client =
+          std::make_unique<Extensions::Filters::Common::ExtAuthz::RawHttpClientImpl>(
+              context.clusterManager(), client_config);
+      if (cache_provider != nullptr) {
+        client = cache_provider->wrap(std::move(client));
+      }
       callbacks.addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr{
           std::make_shared<Filter>(filter_config, std::move(client))});
     };
@@ -43,13 +54,17 @@ Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
     const uint32_t timeout_ms =
         PROTOBUF_GET_MS_OR_DEFAULT(proto_config.grpc_service(), timeout, DefaultTimeout);
     callback = [grpc_service = proto_config.grpc_service(), &context, filter_config, timeout_ms,
-                use_alpha =
-                    proto_config.use_alpha()](Http::FilterChainFactoryCallbacks& callbacks) {
+                use_alpha = proto_config.use_alpha(),
+                cache_provider](Http::FilterChainFactoryCallbacks& callbacks) {
       const auto async_client_factory =
           context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
               grpc_service, context.scope(), true);
-      auto client = std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
-          async_client_factory->create(), std::chrono::milliseconds(timeout_ms), use_alpha);
+      Filters::Common::ExtAuthz::ClientPtr client =
+          std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
+              async_client_factory->create(), std::chrono::milliseconds(timeout_ms), use_alpha);
+      if (cache_provider != nullptr) {
+        client = cache_provider->wrap(std::move(client));
+      }
       callbacks.addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr{
           std::make_shared<Filter>(filter_config, std::move(client))});
     };
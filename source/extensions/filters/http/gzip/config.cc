@@ -14,12 +14,20 @@ Http::FilterFactoryCb GzipFilterFactory::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::http::gzip::v2::Gzip& proto_config,
     const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   GzipFilterConfigSharedPtr config = std::make_shared<GzipFilterConfig>(
-      proto_config, stats_prefix, context.scope(), context.runtime());
+      proto_config, stats_prefix, context.scope(), context.runtime(), context.api(),
+      context.threadLocal());
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<GzipFilter>(config));
   };
 }
 
+Router::RouteSpecificFilterConfigConstSharedPtr
+GzipFilterFactory::createRouteSpecificFilterConfigTyped(
+    const envoy::config::filter::http::gzip::v2::GzipPerRoute& proto_config,
+    Server::Configuration::FactoryContext&) {
+  return std::make_shared<const GzipRouteConfig>(proto_config);
+}
+
 /**
  * Static registration for the gzip filter. @see NamedHttpFilterConfigFactory.
  */
@@ -14,7 +14,9 @@ namespace Gzip {
 /**
  * Config registration for the gzip filter. @see NamedHttpFilterConfigFactory.
  */
-class GzipFilterFactory : public Common::FactoryBase<envoy::config::filter::http::gzip::v2::Gzip> {
+class GzipFilterFactory
+    : public Common::FactoryBase<envoy::config::filter::http::gzip::v2::Gzip,
+                                 envoy::config::filter::http::gzip::v2::GzipPerRoute> {
 public:
   GzipFilterFactory() : FactoryBase(HttpFilterNames::get().EnvoyGzip) {}
 
@@ -23,6 +25,10 @@ private:
   createFilterFactoryFromProtoTyped(const envoy::config::filter::http::gzip::v2::Gzip& config,
                                     const std::string& stats_prefix,
                                     Server::Configuration::FactoryContext& context) override;
+
+  Router::RouteSpecificFilterConfigConstSharedPtr createRouteSpecificFilterConfigTyped(
+      const envoy::config::filter::http::gzip::v2::GzipPerRoute& proto_config,
+      Server::Configuration::FactoryContext&) override;
 };
 
 } // namespace Gzip
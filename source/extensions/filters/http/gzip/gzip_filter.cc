@@ -1,9 +1,20 @@
 #include "extensions/filters/http/gzip/gzip_filter.h"
 
+#include <algorithm>
+
+#include "envoy/common/exception.h"
 #include "envoy/stats/scope.h"
 
+#include "common/common/fmt.h"
 #include "common/common/macros.h"
+#include "common/config/datasource.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/well_known_names.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
@@ -26,8 +37,32 @@ const uint64_t MinimumContentLength = 30;
 // When summed to window bits, this sets a gzip header and trailer around the compressed data.
 const uint64_t GzipHeaderValue = 16;
 
-// Used for verifying accept-encoding values.
-const char ZeroQvalueString[] = "q=0";
+// Default maximum number of idle compressors per worker, coding and compressor parameters.
+const uint32_t DefaultCompressorPoolSize = 16;
+
+// Default and maximum brotli quality. Higher qualities are meant for static content that is
+// compressed once.
+const uint32_t DefaultBrotliQuality = 5;
+const uint32_t MaxBrotliQuality = 11;
+
+// Default, minimum and maximum zstd level. The levels above 19 need much larger windows.
+const uint32_t DefaultZstdLevel = 3;
+const uint32_t MinZstdLevel = 1;
+const uint32_t MaxZstdLevel = 19;
+
+// Returns the q-value in the parameters of an accept-encoding coding, e.g. "q=0.5". A coding
+// without a valid q-value is preferred as much as the ones with "q=1".
+double qValue(absl::string_view parameters) {
+  for (const absl::string_view parameter : StringUtil::splitToken(parameters, ";", false)) {
+    const absl::string_view name = StringUtil::trim(StringUtil::cropRight(parameter, "="));
+    double q;
+    if (StringUtil::caseCompare(name, "q") &&
+        absl::SimpleAtod(StringUtil::trim(StringUtil::cropLeft(parameter, "=")), &q)) {
+      return std::max(0.0, std::min(1.0, q));
+    }
+  }
+  return 1.0;
+}
 
 // Default content types will be used if any is provided by the user.
 const std::vector<std::string>& defaultContentEncoding() {
@@ -41,7 +76,8 @@ const std::vector<std::string>& defaultContentEncoding() {
 
 GzipFilterConfig::GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
                                    const std::string& stats_prefix, Stats::Scope& scope,
-                                   Runtime::Loader& runtime)
+                                   Runtime::Loader& runtime, Api::Api& api,
+                                   ThreadLocal::SlotAllocator& tls)
     : compression_level_(compressionLevelEnum(gzip.compression_level())),
       compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
       content_length_(contentLengthUint(gzip.content_length().value())),
@@ -50,7 +86,193 @@ GzipFilterConfig::GzipFilterConfig(const envoy::config::filter::http::gzip::v2::
       content_type_values_(contentTypeSet(gzip.content_type())),
       disable_on_etag_header_(gzip.disable_on_etag_header()),
       remove_accept_encoding_header_(gzip.remove_accept_encoding_header()),
-      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime) {}
+      length_from_first_data_frame_(gzip.length_from_first_data_frame()),
+      compressor_parameters_{compression_level_, compression_strategy_,
+                             static_cast<int64_t>(window_bits_ & ~GzipHeaderValue),
+                             static_cast<uint64_t>(memory_level_)},
+      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime),
+      codecs_(createCodecs(gzip, stats_prefix + "gzip.", scope, api, tls)) {}
+
+std::vector<CodecPtr>
+GzipFilterConfig::createCodecs(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
+                               const std::string& stats_prefix, Stats::Scope& scope,
+                               Api::Api& api, ThreadLocal::SlotAllocator& tls) const {
+  const uint32_t pool_size =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, compressor_pool_size, DefaultCompressorPoolSize);
+  std::vector<CodecPtr> codecs;
+  if (gzip.codecs().empty()) {
+    codecs.push_back(std::make_unique<ZlibCodec>(Http::Headers::get().ContentEncodingValues.Gzip,
+                                                 true, "", pool_size, stats_prefix, scope, tls));
+    return codecs;
+  }
+  for (const auto& codec : gzip.codecs()) {
+    std::string dictionary = Config::DataSource::read(codec.dictionary(), true, api);
+    std::string content_coding = absl::AsciiStrToLower(codec.content_coding());
+    switch (codec.type()) {
+    case envoy::config::filter::http::gzip::v2::Gzip_Codec_Type_BROTLI: {
+      if (!dictionary.empty()) {
+        throw EnvoyException("gzip filter: the br content-coding does not support dictionaries");
+      }
+      const uint32_t quality = PROTOBUF_GET_WRAPPED_OR_DEFAULT(codec, level, DefaultBrotliQuality);
+      if (quality > MaxBrotliQuality) {
+        throw EnvoyException(fmt::format(
+            "gzip filter: the br content-coding takes a level from 0 to {}", MaxBrotliQuality));
+      }
+      if (content_coding.empty()) {
+        content_coding = Http::Headers::get().ContentEncodingValues.Brotli;
+      }
+      codecs.push_back(std::make_unique<BrotliCodec>(content_coding, quality, stats_prefix, scope));
+      break;
+    }
+    case envoy::config::filter::http::gzip::v2::Gzip_Codec_Type_ZSTD: {
+      if (!dictionary.empty()) {
+        throw EnvoyException("gzip filter: the zstd content-coding does not support dictionaries");
+      }
+      const uint32_t level = PROTOBUF_GET_WRAPPED_OR_DEFAULT(codec, level, DefaultZstdLevel);
+      if (level < MinZstdLevel || level > MaxZstdLevel) {
+        throw EnvoyException(
+            fmt::format("gzip filter: the zstd content-coding takes a level from {} to {}",
+                        MinZstdLevel, MaxZstdLevel));
+      }
+      if (content_coding.empty()) {
+        content_coding = Http::Headers::get().ContentEncodingValues.Zstd;
+      }
+      codecs.push_back(std::make_unique<ZstdCodec>(content_coding, level, stats_prefix, scope));
+      break;
+    }
+    case envoy::config::filter::http::gzip::v2::Gzip_Codec_Type_DEFLATE:
+      if (codec.has_level()) {
+        throw EnvoyException("gzip filter: the deflate content-coding takes its level from "
+                             "compression_level");
+      }
+      if (content_coding.empty()) {
+        content_coding = Http::Headers::get().ContentEncodingValues.Deflate;
+      }
+      // Standard clients can't inflate a stream primed with a dictionary they don't have.
+      if (!dictionary.empty() &&
+          (content_coding == Http::Headers::get().ContentEncodingValues.Deflate ||
+           content_coding == Http::Headers::get().ContentEncodingValues.Gzip)) {
+        throw EnvoyException(
+            fmt::format("gzip filter: a codec with a dictionary can't use the standard '{}' "
+                        "content-coding, set a content_coding of its own",
+                        content_coding));
+      }
+      codecs.push_back(std::make_unique<ZlibCodec>(content_coding, false, std::move(dictionary),
+                                                   pool_size, stats_prefix, scope, tls));
+      break;
+    default:
+      if (!dictionary.empty()) {
+        throw EnvoyException("gzip filter: the gzip content-coding does not support dictionaries");
+      }
+      if (codec.has_level()) {
+        throw EnvoyException("gzip filter: the gzip content-coding takes its level from "
+                             "compression_level");
+      }
+      if (content_coding.empty()) {
+        content_coding = Http::Headers::get().ContentEncodingValues.Gzip;
+      }
+      codecs.push_back(std::make_unique<ZlibCodec>(content_coding, true, "", pool_size,
+                                                   stats_prefix, scope, tls));
+      break;
+    }
+  }
+  return codecs;
+}
+
+BrotliCodec::BrotliCodec(const std::string& name, uint32_t quality,
+                         const std::string& stats_prefix, Stats::Scope& scope)
+    : Codec(name, stats_prefix, scope), quality_(quality) {}
+
+Compressor::CompressorPtr BrotliCodec::createCompressor(const CompressorParameters&) {
+  stats().compressor_created_.inc();
+  return std::make_unique<Compressor::BrotliCompressorImpl>(quality_);
+}
+
+ZstdCodec::ZstdCodec(const std::string& name, uint32_t level, const std::string& stats_prefix,
+                     Stats::Scope& scope)
+    : Codec(name, stats_prefix, scope), level_(level) {}
+
+Compressor::CompressorPtr ZstdCodec::createCompressor(const CompressorParameters&) {
+  stats().compressor_created_.inc();
+  return std::make_unique<Compressor::ZstdCompressorImpl>(level_);
+}
+
+ZlibCodec::ZlibCodec(const std::string& name, bool gzip_header, std::string&& dictionary,
+                     uint32_t pool_size, const std::string& stats_prefix, Stats::Scope& scope,
+                     ThreadLocal::SlotAllocator& tls)
+    : Codec(name, stats_prefix, scope), gzip_header_(gzip_header),
+      dictionary_(std::move(dictionary)) {
+  if (pool_size > 0) {
+    tls_slot_ = tls.allocateSlot();
+    tls_slot_->set([pool_size](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+      return std::make_shared<CompressorPool>(pool_size);
+    });
+  }
+}
+
+Compressor::CompressorPtr ZlibCodec::createCompressor(const CompressorParameters& parameters) {
+  CompressorPoolSharedPtr pool;
+  std::vector<ZlibCompressorPtr>* idle = nullptr;
+  const uint64_t key = poolKey(parameters);
+  if (tls_slot_ != nullptr) {
+    pool = std::static_pointer_cast<CompressorPool>(tls_slot_->get());
+    idle = &pool->idle_[key];
+  }
+
+  ZlibCompressorPtr compressor;
+  if (idle != nullptr && !idle->empty()) {
+    compressor = std::move(idle->back());
+    idle->pop_back();
+    stats().compressor_reused_.inc();
+  } else {
+    compressor = std::make_unique<Compressor::ZlibCompressorImpl>();
+    compressor->init(parameters.level_, parameters.strategy_,
+                     parameters.window_bits_ | (gzip_header_ ? GzipHeaderValue : 0),
+                     parameters.memory_level_);
+    stats().compressor_created_.inc();
+  }
+  if (!dictionary_.empty()) {
+    compressor->setDictionary(dictionary_);
+  }
+
+  if (pool == nullptr) {
+    return std::move(compressor);
+  }
+  return std::make_unique<PooledCompressor>(std::move(compressor), pool, key);
+}
+
+uint64_t ZlibCodec::poolKey(const CompressorParameters& parameters) {
+  // The compression level is -1 for the standard level, and up to 9. The other parameters are
+  // less than 16.
+  return (static_cast<uint64_t>(static_cast<int64_t>(parameters.level_) + 1) << 24) |
+         (static_cast<uint64_t>(parameters.strategy_) << 16) |
+         (static_cast<uint64_t>(parameters.window_bits_) << 8) | parameters.memory_level_;
+}
+
+ZlibCodec::PooledCompressor::~PooledCompressor() {
+  std::vector<ZlibCompressorPtr>& idle = pool_->idle_[key_];
+  if (idle.size() < pool_->max_idle_) {
+    compressor_->reset();
+    idle.push_back(std::move(compressor_));
+  }
+}
+
+GzipRouteConfig::GzipRouteConfig(const envoy::config::filter::http::gzip::v2::GzipPerRoute& gzip)
+    : disabled_(gzip.disabled()),
+      memory_level_(gzip.has_memory_level()
+                        ? absl::optional<uint64_t>(gzip.memory_level().value())
+                        : absl::nullopt),
+      window_bits_(gzip.has_window_bits() ? absl::optional<int64_t>(gzip.window_bits().value())
+                                          : absl::nullopt) {}
+
+void GzipRouteConfig::apply(CompressorParameters& parameters) const {
+  if (memory_level_.has_value()) {
+    parameters.memory_level_ = memory_level_.value();
+  }
+  if (window_bits_.has_value()) {
+    parameters.window_bits_ = window_bits_.value();
+  }
+}
 
 Compressor::ZlibCompressorImpl::CompressionLevel GzipFilterConfig::compressionLevelEnum(
     envoy::config::filter::http::gzip::v2::Gzip_CompressionLevel_Enum compression_level) {
@@ -103,11 +325,14 @@ uint64_t GzipFilterConfig::windowBitsUint(Protobuf::uint32 window_bits) {
 }
 
 GzipFilter::GzipFilter(const GzipFilterConfigSharedPtr& config)
-    : skip_compression_{true}, compressed_data_(), compressor_(), config_(config) {}
+    : skip_compression_{true}, compressed_data_(), config_(config) {}
 
 Http::FilterHeadersStatus GzipFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
-  if (config_->runtime().snapshot().featureEnabled("gzip.filter_enabled", 100) &&
-      isAcceptEncodingAllowed(headers)) {
+  route_config_ = Http::Utility::resolveMostSpecificPerFilterConfig<GzipRouteConfig>(
+      HttpFilterNames::get().EnvoyGzip, decoder_callbacks_->route());
+  if ((route_config_ == nullptr || !route_config_->disabled()) &&
+      config_->runtime().snapshot().featureEnabled("gzip.filter_enabled", 100) &&
+      (codec_ = negotiateCodec(headers)) != nullptr) {
     skip_compression_ = false;
     if (config_->removeAcceptEncodingHeader()) {
       headers.removeAcceptEncoding();
@@ -123,29 +348,69 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
   if (!end_stream && !skip_compression_ && isMinimumContentLength(headers) &&
       isContentTypeAllowed(headers) && !hasCacheControlNoTransform(headers) &&
       isEtagAllowed(headers) && isTransferEncodingAllowed(headers) && !headers.ContentEncoding()) {
-    sanitizeEtagHeader(headers);
-    insertVaryHeader(headers);
-    headers.removeContentLength();
-    headers.insertContentEncoding().value(Http::Headers::get().ContentEncodingValues.Gzip);
-    compressor_.init(config_->compressionLevel(), config_->compressionStrategy(),
-                     config_->windowBits(), config_->memoryLevel());
-    config_->stats().compressed_.inc();
+    if (config_->lengthFromFirstDataFrame() && !headers.ContentLength()) {
+      held_headers_ = &headers;
+      return Http::FilterHeadersStatus::StopIteration;
+    }
+    startCompression(headers);
   } else if (!skip_compression_) {
-    skip_compression_ = true;
-    config_->stats().not_compressed_.inc();
+    skipCompression();
   }
   return Http::FilterHeadersStatus::Continue;
 }
 
 Http::FilterDataStatus GzipFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (held_headers_ != nullptr) {
+    // Only a response whose whole body is in its first data frame has a known length.
+    if (end_stream && data.length() < config_->minimumLength()) {
+      config_->stats().content_length_too_small_.inc();
+      skipCompression();
+    } else {
+      startCompression(*held_headers_);
+    }
+    held_headers_ = nullptr;
+  }
+
   if (!skip_compression_) {
     config_->stats().total_uncompressed_bytes_.add(data.length());
-    compressor_.compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
+    codec_->stats().total_uncompressed_bytes_.add(data.length());
+    compressor_->compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
     config_->stats().total_compressed_bytes_.add(data.length());
+    codec_->stats().total_compressed_bytes_.add(data.length());
   }
   return Http::FilterDataStatus::Continue;
 }
 
+Http::FilterTrailersStatus GzipFilter::encodeTrailers(Http::HeaderMap&) {
+  if (held_headers_ != nullptr) {
+    // The response has no body.
+    held_headers_ = nullptr;
+    skipCompression();
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void GzipFilter::startCompression(Http::HeaderMap& headers) {
+  sanitizeEtagHeader(headers);
+  insertVaryHeader(headers);
+  headers.removeContentLength();
+  headers.insertContentEncoding().value(codec_->name());
+  if (route_config_ == nullptr) {
+    compressor_ = codec_->createCompressor(config_->compressorParameters());
+  } else {
+    CompressorParameters parameters = config_->compressorParameters();
+    route_config_->apply(parameters);
+    compressor_ = codec_->createCompressor(parameters);
+  }
+  config_->stats().compressed_.inc();
+  codec_->stats().compressed_.inc();
+}
+
+void GzipFilter::skipCompression() {
+  skip_compression_ = true;
+  config_->stats().not_compressed_.inc();
+}
+
 bool GzipFilter::hasCacheControlNoTransform(Http::HeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.CacheControl();
   if (cache_control) {
@@ -156,56 +421,67 @@ bool GzipFilter::hasCacheControlNoTransform(Http::HeaderMap& headers) const {
   return false;
 }
 
-// TODO(gsagula): Since gzip is the only available content-encoding in Envoy at the moment,
-// order/priority of preferred server encodings is disregarded (RFC2616-14.3). Replace this
-// with a data structure that parses Accept-Encoding values and allows fast lookup of
-// key/priority. Also, this should be part of some utility library.
-// https://www.w3.org/Protocols/rfc2616/rfc2616-sec14.html
-bool GzipFilter::isAcceptEncodingAllowed(Http::HeaderMap& headers) const {
+// Implements the content negotiation of RFC 7231 5.3.4: the coding with the highest q-value is
+// selected, a coding that is not listed takes the q-value of the wildcard if any, and codings with
+// a q-value of 0 are not acceptable. Ties are broken by the order of the configured codings.
+Codec* GzipFilter::negotiateCodec(Http::HeaderMap& headers) const {
   const Http::HeaderEntry* accept_encoding = headers.AcceptEncoding();
+  if (accept_encoding == nullptr) {
+    config_->stats().no_accept_header_.inc();
+    return nullptr;
+  }
 
-  if (accept_encoding) {
-    bool is_wildcard = false; // true if found and not followed by `q=0`.
-    for (const auto token : StringUtil::splitToken(
-             headers.AcceptEncoding()->value().getStringView(), ",", false /* keep_empty */)) {
-      const auto value = StringUtil::trim(StringUtil::cropRight(token, ";"));
-      const auto q_value = StringUtil::trim(StringUtil::cropLeft(token, ";"));
-      // If value is the gzip coding, check the qvalue and return.
-      if (value == Http::Headers::get().AcceptEncodingValues.Gzip) {
-        const bool is_gzip = !StringUtil::caseCompare(q_value, ZeroQvalueString);
-        if (is_gzip) {
-          config_->stats().header_gzip_.inc();
-          return true;
+  const std::vector<CodecPtr>& codecs = config_->codecs();
+  // The q-value of each configured coding in the header, or -1 if it is not listed.
+  std::vector<double> q_values(codecs.size(), -1.0);
+  double wildcard_q_value = 0.0;
+  bool has_identity = false;
+  for (const absl::string_view token :
+       StringUtil::splitToken(accept_encoding->value().getStringView(), ",", false)) {
+    const absl::string_view coding = StringUtil::trim(StringUtil::cropRight(token, ";"));
+    const absl::string_view::size_type parameters = token.find(';');
+    const double q_value =
+        parameters == absl::string_view::npos ? 1.0 : qValue(token.substr(parameters + 1));
+    if (coding == Http::Headers::get().AcceptEncodingValues.Wildcard) {
+      wildcard_q_value = q_value;
+    } else if (StringUtil::caseCompare(coding,
+                                       Http::Headers::get().AcceptEncodingValues.Identity)) {
+      has_identity = true;
+    } else {
+      for (size_t i = 0; i < codecs.size(); i++) {
+        if (StringUtil::caseCompare(coding, codecs[i]->name())) {
+          q_values[i] = q_value;
         }
-        config_->stats().header_not_valid_.inc();
-        return false;
-      }
-      // If value is the identity coding, return false. The data should
-      // not be transformed in this case.
-      // https://www.w3.org/Protocols/rfc2616/rfc2616-sec3.html#sec3.5.
-      if (value == Http::Headers::get().AcceptEncodingValues.Identity) {
-        config_->stats().header_identity_.inc();
-        return false;
-      }
-      // Otherwise, check if the header contains the wildcard. If so,
-      // mark as true. Use this as the very last resort, as gzip or
-      // identity is weighted higher. Note that this filter disregards
-      // order/priority at this time.
-      if (value == Http::Headers::get().AcceptEncodingValues.Wildcard) {
-        is_wildcard = !StringUtil::caseCompare(q_value, ZeroQvalueString);
       }
     }
-    // If neither identity nor gzip codings are present, return the result of the wildcard.
-    if (is_wildcard) {
+  }
+
+  Codec* selected = nullptr;
+  double selected_q_value = 0.0;
+  bool from_wildcard = false;
+  for (size_t i = 0; i < codecs.size(); i++) {
+    const double q_value = q_values[i] >= 0.0
+                               ? q_values[i]
+                               : (codecs[i]->matchesWildcard() ? wildcard_q_value : 0.0);
+    if (q_value > selected_q_value) {
+      selected = codecs[i].get();
+      selected_q_value = q_value;
+      from_wildcard = q_values[i] < 0.0;
+    }
+  }
+
+  if (selected != nullptr) {
+    if (from_wildcard) {
       config_->stats().header_wildcard_.inc();
-      return true;
+    } else if (selected->name() == Http::Headers::get().AcceptEncodingValues.Gzip) {
+      config_->stats().header_gzip_.inc();
     }
+  } else if (has_identity) {
+    config_->stats().header_identity_.inc();
+  } else {
     config_->stats().header_not_valid_.inc();
-    return false;
   }
-  config_->stats().no_accept_header_.inc();
-  // If no accept-encoding header is present, return false.
-  return false;
+  return selected;
 }
 
 bool GzipFilter::isContentTypeAllowed(Http::HeaderMap& headers) const {
@@ -240,6 +516,11 @@ bool GzipFilter::isMinimumContentLength(Http::HeaderMap& headers) const {
     return is_minimum_content_length;
   }
 
+  // The length is then checked against the first data frame.
+  if (config_->lengthFromFirstDataFrame()) {
+    return true;
+  }
+
   const Http::HeaderEntry* transfer_encoding = headers.TransferEncoding();
   return (transfer_encoding &&
           StringUtil::caseFindToken(transfer_encoding->value().getStringView(), ",",
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/compressor/compressor.h"
 #include "envoy/config/filter/http/gzip/v2/gzip.pb.h"
 #include "envoy/http/filter.h"
 #include "envoy/http/header_map.h"
@@ -7,14 +13,20 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/compressor/brotli_compressor_impl.h"
 #include "common/compressor/zlib_compressor_impl.h"
+#include "common/compressor/zstd_compressor_impl.h"
 #include "common/http/header_map_impl.h"
 #include "common/json/config_schemas.h"
 #include "common/json/json_validator.h"
 #include "common/protobuf/protobuf.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -52,6 +64,191 @@ struct GzipStats {
   ALL_GZIP_STATS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * All stats of a content-coding, rooted at <stat_prefix>.gzip.<coding>. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GZIP_CODEC_STATS(COUNTER)    \
+  COUNTER(compressed)                    \
+  COUNTER(total_uncompressed_bytes)      \
+  COUNTER(total_compressed_bytes)        \
+  COUNTER(compressor_created)            \
+  COUNTER(compressor_reused)             \
+// clang-format on
+
+/**
+ * Struct definition for content-coding stats. @see stats_macros.h
+ */
+struct GzipCodecStats {
+  ALL_GZIP_CODEC_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Settings that a response is compressed with. Routes can override some of them.
+ */
+struct CompressorParameters {
+  Compressor::ZlibCompressorImpl::CompressionLevel level_;
+  Compressor::ZlibCompressorImpl::CompressionStrategy strategy_;
+  // Base two logarithm of the window size, without the gzip header flag.
+  int64_t window_bits_;
+  uint64_t memory_level_;
+};
+
+/**
+ * A content-coding that the filter can compress responses with.
+ */
+class Codec {
+public:
+  virtual ~Codec() {}
+
+  /**
+   * @return the name of the content-coding, as used in accept-encoding and content-encoding.
+   */
+  const std::string& name() const { return name_; }
+
+  GzipCodecStats& stats() { return stats_; }
+
+  /**
+   * @return whether the coding can be selected by the "*" wildcard of accept-encoding. Codings
+   *         that clients can only decode with out of band data must be listed explicitly.
+   */
+  virtual bool matchesWildcard() const { return true; }
+
+  /**
+   * Must be called on a worker thread.
+   * @param parameters supplies the settings that the response is compressed with.
+   * @return a compressor, ready to compress a response.
+   */
+  virtual Compressor::CompressorPtr createCompressor(const CompressorParameters& parameters) PURE;
+
+protected:
+  Codec(const std::string& name, const std::string& stats_prefix, Stats::Scope& scope)
+      : name_(name), stats_{ALL_GZIP_CODEC_STATS(
+                         POOL_COUNTER_PREFIX(scope, stats_prefix + name + "."))} {}
+
+private:
+  const std::string name_;
+  GzipCodecStats stats_;
+};
+
+typedef std::unique_ptr<Codec> CodecPtr;
+
+/**
+ * The gzip and deflate content-codings, which are both zlib streams. Initializing a zlib
+ * compressor allocates a few hundred kilobytes, so each worker keeps the compressors of finished
+ * responses in a pool, and resets them to compress later responses with the same settings.
+ */
+class ZlibCodec : public Codec {
+public:
+  /**
+   * @param gzip_header whether the compressed data is wrapped in a gzip header and trailer.
+   * @param pool_size supplies the maximum number of idle compressors of a worker for every set of
+   *        compressor parameters, or 0 to create a new compressor for every response.
+   */
+  ZlibCodec(const std::string& name, bool gzip_header, std::string&& dictionary,
+            uint32_t pool_size, const std::string& stats_prefix, Stats::Scope& scope,
+            ThreadLocal::SlotAllocator& tls);
+
+  // Codec
+  bool matchesWildcard() const override { return dictionary_.empty(); }
+  Compressor::CompressorPtr createCompressor(const CompressorParameters& parameters) override;
+
+private:
+  typedef std::unique_ptr<Compressor::ZlibCompressorImpl> ZlibCompressorPtr;
+
+  // The idle compressors of a worker, keyed by their parameters.
+  struct CompressorPool : public ThreadLocal::ThreadLocalObject {
+    CompressorPool(uint32_t max_idle) : max_idle_(max_idle) {}
+
+    const uint32_t max_idle_;
+    absl::flat_hash_map<uint64_t, std::vector<ZlibCompressorPtr>> idle_;
+  };
+  typedef std::shared_ptr<CompressorPool> CompressorPoolSharedPtr;
+
+  // Returns its compressor to the pool it was taken from once the response is done.
+  class PooledCompressor : public Compressor::Compressor {
+  public:
+    PooledCompressor(ZlibCompressorPtr&& compressor, const CompressorPoolSharedPtr& pool,
+                     uint64_t key)
+        : compressor_(std::move(compressor)), pool_(pool), key_(key) {}
+    ~PooledCompressor();
+
+    // Compressor::Compressor
+    void compress(Buffer::Instance& buffer, ::Envoy::Compressor::State state) override {
+      compressor_->compress(buffer, state);
+    }
+
+  private:
+    ZlibCompressorPtr compressor_;
+    const CompressorPoolSharedPtr pool_;
+    const uint64_t key_;
+  };
+
+  static uint64_t poolKey(const CompressorParameters& parameters);
+
+  const bool gzip_header_;
+  const std::string dictionary_;
+  ThreadLocal::SlotPtr tls_slot_;
+};
+
+/**
+ * The br content-coding. The zlib parameters of the filter and routes do not apply to it, and a new
+ * compressor is created for every response.
+ */
+class BrotliCodec : public Codec {
+public:
+  /**
+   * @param quality supplies the brotli quality, from 0 to 11.
+   */
+  BrotliCodec(const std::string& name, uint32_t quality, const std::string& stats_prefix,
+              Stats::Scope& scope);
+
+  // Codec
+  Compressor::CompressorPtr createCompressor(const CompressorParameters& parameters) override;
+
+private:
+  const uint32_t quality_;
+};
+
+/**
+ * The zstd content-coding. The zlib parameters of the filter and routes do not apply to it, and a
+ * new compressor is created for every response.
+ */
+class ZstdCodec : public Codec {
+public:
+  /**
+   * @param level supplies the zstd compression level, from 1 to 19.
+   */
+  ZstdCodec(const std::string& name, uint32_t level, const std::string& stats_prefix,
+            Stats::Scope& scope);
+
+  // Codec
+  Compressor::CompressorPtr createCompressor(const CompressorParameters& parameters) override;
+
+private:
+  const uint32_t level_;
+};
+
+/**
+ * Per-route configuration of the gzip filter.
+ */
+class GzipRouteConfig : public Router::RouteSpecificFilterConfig {
+public:
+  GzipRouteConfig(const envoy::config::filter::http::gzip::v2::GzipPerRoute& gzip);
+
+  bool disabled() const { return disabled_; }
+
+  /**
+   * Applies the settings that the route overrides to the parameters of the filter.
+   */
+  void apply(CompressorParameters& parameters) const;
+
+private:
+  const bool disabled_;
+  const absl::optional<uint64_t> memory_level_;
+  const absl::optional<int64_t> window_bits_;
+};
+
 /**
  * Configuration for the gzip filter.
  */
@@ -59,8 +256,8 @@ class GzipFilterConfig {
 
 public:
   GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
-                   const std::string& stats_prefix,
-                   Stats::Scope& scope, Runtime::Loader& runtime);
+                   const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
+                   Api::Api& api, ThreadLocal::SlotAllocator& tls);
 
   Compressor::ZlibCompressorImpl::CompressionLevel compressionLevel() const {
     return compression_level_;
@@ -77,6 +274,11 @@ public:
   uint64_t memoryLevel() const { return memory_level_; }
   uint64_t minimumLength() const { return content_length_; }
   uint64_t windowBits() const { return window_bits_; }
+  bool lengthFromFirstDataFrame() const { return length_from_first_data_frame_; }
+  // Compression settings of the responses of routes that do not override them.
+  const CompressorParameters& compressorParameters() const { return compressor_parameters_; }
+  // Content-codings in order of preference.
+  const std::vector<CodecPtr>& codecs() const { return codecs_; }
 
 private:
   static Compressor::ZlibCompressorImpl::CompressionLevel compressionLevelEnum(
@@ -90,6 +292,10 @@ private:
   static uint64_t memoryLevelUint(Protobuf::uint32 level);
   static uint64_t windowBitsUint(Protobuf::uint32 window_bits);
 
+  std::vector<CodecPtr> createCodecs(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
+                                     const std::string& stats_prefix, Stats::Scope& scope,
+                                     Api::Api& api, ThreadLocal::SlotAllocator& tls) const;
+
   static GzipStats generateStats(const std::string& prefix, Stats::Scope& scope) {
     return GzipStats{ALL_GZIP_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
   }
@@ -104,8 +310,11 @@ private:
   StringUtil::CaseUnorderedSet content_type_values_;
   bool disable_on_etag_header_;
   bool remove_accept_encoding_header_;
+  const bool length_from_first_data_frame_;
+  const CompressorParameters compressor_parameters_;
   GzipStats stats_;
   Runtime::Loader& runtime_;
+  const std::vector<CodecPtr> codecs_;
 };
 typedef std::shared_ptr<GzipFilterConfig> GzipFilterConfigSharedPtr;
 
@@ -137,9 +346,7 @@ public:
   }
   Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
   Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
-  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override {
-    return Http::FilterTrailersStatus::Continue;
-  }
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override;
   Http::FilterMetadataStatus encodeMetadata(Http::MetadataMap&) override {
     return Http::FilterMetadataStatus::Continue;
   }
@@ -153,7 +360,12 @@ private:
   friend class GzipFilterTest;
 
   bool hasCacheControlNoTransform(Http::HeaderMap& headers) const;
-  bool isAcceptEncodingAllowed(Http::HeaderMap& headers) const;
+  // Selects the content-coding with the highest q-value in the accept-encoding header, or nullptr
+  // if the response must not be compressed.
+  Codec* negotiateCodec(Http::HeaderMap& headers) const;
+  bool isAcceptEncodingAllowed(Http::HeaderMap& headers) const {
+    return negotiateCodec(headers) != nullptr;
+  }
   bool isContentTypeAllowed(Http::HeaderMap& headers) const;
   bool isEtagAllowed(Http::HeaderMap& headers) const;
   bool isMinimumContentLength(Http::HeaderMap& headers) const;
@@ -161,10 +373,17 @@ private:
 
   void sanitizeEtagHeader(Http::HeaderMap& headers);
   void insertVaryHeader(Http::HeaderMap& headers);
+  void startCompression(Http::HeaderMap& headers);
+  void skipCompression();
 
   bool skip_compression_;
   Buffer::OwnedImpl compressed_data_;
-  Compressor::ZlibCompressorImpl compressor_;
+  Codec* codec_{};
+  const GzipRouteConfig* route_config_{};
+  // Response headers without a content-length, held until the first data frame tells whether the
+  // response is long enough to be compressed.
+  Http::HeaderMap* held_headers_{};
+  Compressor::CompressorPtr compressor_;
   GzipFilterConfigSharedPtr config_;
 
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{nullptr};
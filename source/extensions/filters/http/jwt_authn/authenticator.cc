@@ -31,9 +31,10 @@ class AuthenticatorImpl : public Logger::Loggable<Logger::Id::filter>,
 public:
   AuthenticatorImpl(const CheckAudience* check_audience,
                     const absl::optional<std::string>& provider, bool allow_failed,
-                    JwksCache& jwks_cache, Upstream::ClusterManager& cluster_manager,
+                    JwksCache& jwks_cache, JwtCache* jwt_cache,
+                    Upstream::ClusterManager& cluster_manager,
                     CreateJwksFetcherCb create_jwks_fetcher_cb, TimeSource& time_source)
-      : jwks_cache_(jwks_cache), cm_(cluster_manager),
+      : jwks_cache_(jwks_cache), jwt_cache_(jwt_cache), cm_(cluster_manager),
         create_jwks_fetcher_cb_(create_jwks_fetcher_cb), check_audience_(check_audience),
         provider_(provider), is_allow_failed_(allow_failed), time_source_(time_source) {}
 
@@ -51,6 +52,9 @@ private:
   // Verify with a specific public key.
   void verifyKey();
 
+  // Forwards the payload of a verified JWT.
+  void handleGoodJwt();
+
   // Calls the callback with status.
   void doneWithStatus(const Status& status);
 
@@ -60,6 +64,8 @@ private:
 
   // The jwks cache object.
   JwksCache& jwks_cache_;
+  // The cache of verified JWTs, or nullptr if it is not configured.
+  JwtCache* jwt_cache_;
   // the cluster manager object.
   Upstream::ClusterManager& cm_;
 
@@ -72,8 +78,12 @@ private:
   // The token data
   std::vector<JwtLocationConstPtr> tokens_;
   JwtLocationConstPtr curr_token_;
-  // The JWT object.
-  std::unique_ptr<::google::jwt_verify::Jwt> jwt_;
+  // The JWT object, which is either owned_jwt_ or a verified JWT of the cache.
+  const ::google::jwt_verify::Jwt* jwt_{};
+  std::unique_ptr<::google::jwt_verify::Jwt> owned_jwt_;
+  // The JWKS data that verified the cached JWT, if any, and the generation of its keys then.
+  const JwksCache::JwksData* cached_jwks_data_{};
+  uint64_t cached_jwks_generation_{};
   // The JWKS data object
   JwksCache::JwksData* jwks_data_{};
 
@@ -112,11 +122,32 @@ void AuthenticatorImpl::startVerify() {
   ASSERT(!tokens_.empty());
   curr_token_ = std::move(tokens_.back());
   tokens_.pop_back();
-  jwt_ = std::make_unique<::google::jwt_verify::Jwt>();
-  const Status status = jwt_->parseFromString(curr_token_->token());
-  if (status != Status::Ok) {
-    doneWithStatus(status);
-    return;
+
+  // TODO(qiwzhang): Cross-platform-wise the below unix_timestamp code is wrong as the
+  // epoch is not guaranteed to be defined as the unix epoch. We should use
+  // the abseil time functionality instead or use the jwt_verify_lib to check
+  // the validity of a JWT.
+  const uint64_t unix_timestamp =
+      std::chrono::duration_cast<std::chrono::seconds>(timeSource().systemTime().time_since_epoch())
+          .count();
+
+  // A cached JWT was already parsed and verified, but its claims are checked again below.
+  const JwtCache::Entry* cached =
+      jwt_cache_ != nullptr ? jwt_cache_->lookup(curr_token_->token(), unix_timestamp) : nullptr;
+  if (cached != nullptr) {
+    owned_jwt_.reset();
+    jwt_ = cached->jwt_.get();
+    cached_jwks_data_ = cached->jwks_data_;
+    cached_jwks_generation_ = cached->jwks_generation_;
+  } else {
+    owned_jwt_ = std::make_unique<::google::jwt_verify::Jwt>();
+    jwt_ = owned_jwt_.get();
+    cached_jwks_data_ = nullptr;
+    const Status status = owned_jwt_->parseFromString(curr_token_->token());
+    if (status != Status::Ok) {
+      doneWithStatus(status);
+      return;
+    }
   }
 
   // Check if token extracted from the location contains the issuer specified by config.
@@ -126,14 +157,6 @@ void AuthenticatorImpl::startVerify() {
     return;
   }
 
-  // TODO(qiwzhang): Cross-platform-wise the below unix_timestamp code is wrong as the
-  // epoch is not guaranteed to be defined as the unix epoch. We should use
-  // the abseil time functionality instead or use the jwt_verify_lib to check
-  // the validity of a JWT.
-  // Check "exp" claim.
-  const uint64_t unix_timestamp =
-      std::chrono::duration_cast<std::chrono::seconds>(timeSource().systemTime().time_since_epoch())
-          .count();
   // If the nbf claim does *not* appear in the JWT, then the nbf field is defaulted
   // to 0.
   if (jwt_->nbf_ > unix_timestamp) {
@@ -162,7 +185,26 @@ void AuthenticatorImpl::startVerify() {
   }
 
   auto jwks_obj = jwks_data_->getJwksObj();
-  if (jwks_obj != nullptr && !jwks_data_->isExpired()) {
+  const bool has_valid_keys = jwks_obj != nullptr && !jwks_data_->isExpired();
+
+  // The JWT is only trusted by the provider whose keys verified it, as long as these keys are
+  // still the current ones: once they expire or are rotated, it is verified again.
+  if (jwt_cache_ != nullptr) {
+    if (cached_jwks_data_ == jwks_data_ &&
+        cached_jwks_generation_ == jwks_data_->getJwksGeneration() && has_valid_keys) {
+      jwt_cache_->stats().jwt_cache_hit_.inc();
+      handleGoodJwt();
+      return;
+    }
+    jwt_cache_->stats().jwt_cache_miss_.inc();
+    if (owned_jwt_ == nullptr) {
+      // The token was verified by another provider or with other keys, so verify it again.
+      owned_jwt_ = std::make_unique<::google::jwt_verify::Jwt>(*jwt_);
+      jwt_ = owned_jwt_.get();
+    }
+  }
+
+  if (has_valid_keys) {
     // TODO(qiwzhang): It would seem there's a window of error whereby if the JWT issuer
     // has started signing with a new key that's not in our cache, then the
     // verification will fail even though the JWT is valid. A simple fix
@@ -216,6 +258,10 @@ void AuthenticatorImpl::verifyKey() {
     return;
   }
 
+  handleGoodJwt();
+}
+
+void AuthenticatorImpl::handleGoodJwt() {
   // Forward the payload
   const auto& provider = jwks_data_->getJwtProvider();
   if (!provider.forward_payload_header().empty()) {
@@ -232,6 +278,12 @@ void AuthenticatorImpl::verifyKey() {
     set_payload_cb_(provider.payload_in_metadata(), jwt_->payload_pb_);
   }
 
+  // The JWT is not used after it is cached: caching it may evict the JWT of another token.
+  if (jwt_cache_ != nullptr && owned_jwt_ != nullptr) {
+    jwt_cache_->insert(curr_token_->token(), std::move(owned_jwt_), *jwks_data_);
+    jwt_ = nullptr;
+  }
+
   doneWithStatus(Status::Ok);
 }
 
@@ -253,11 +305,13 @@ void AuthenticatorImpl::doneWithStatus(const Status& status) {
 AuthenticatorPtr Authenticator::create(const CheckAudience* check_audience,
                                        const absl::optional<std::string>& provider,
                                        bool allow_failed, JwksCache& jwks_cache,
+                                       JwtCache* jwt_cache,
                                        Upstream::ClusterManager& cluster_manager,
                                        CreateJwksFetcherCb create_jwks_fetcher_cb,
                                        TimeSource& time_source) {
   return std::make_unique<AuthenticatorImpl>(check_audience, provider, allow_failed, jwks_cache,
-                                             cluster_manager, create_jwks_fetcher_cb, time_source);
+                                             jwt_cache, cluster_manager, create_jwks_fetcher_cb,
+                                             time_source);
 }
 
 } // namespace JwtAuthn
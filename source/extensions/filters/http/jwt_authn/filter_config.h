@@ -7,6 +7,7 @@
 #include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "extensions/filters/http/jwt_authn/jwt_cache.h"
 #include "extensions/filters/http/jwt_authn/matcher.h"
 #include "extensions/filters/http/jwt_authn/verifier.h"
 
@@ -19,24 +20,29 @@ namespace JwtAuthn {
 
 /**
  * Making cache as a thread local object, its read/write operations don't need to be protected.
- * Now it only has jwks_cache, but in the future, it will have token cache: to cache the tokens
- * with their verification results.
+ * It has the jwks_cache, and the jwt_cache of verified tokens if it is configured.
  */
 class ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
 public:
   // Load the config from envoy config.
   ThreadLocalCache(
       const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
-      TimeSource& time_source, Api::Api& api) {
+      TimeSource& time_source, Api::Api& api, JwtCacheStats& jwt_cache_stats) {
     jwks_cache_ = JwksCache::create(config, time_source, api);
+    jwt_cache_ = JwtCache::create(config, jwt_cache_stats);
   }
 
   // Get the JwksCache object.
   JwksCache& getJwksCache() { return *jwks_cache_; }
 
+  // Get the JwtCache object, or nullptr if it is not configured.
+  JwtCache* getJwtCache() { return jwt_cache_.get(); }
+
 private:
   // The JwksCache object.
   JwksCachePtr jwks_cache_;
+  // The JwtCache object.
+  JwtCachePtr jwt_cache_;
 };
 
 /**
@@ -67,11 +73,13 @@ public:
       const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& proto_config,
       const std::string& stats_prefix, Server::Configuration::FactoryContext& context)
       : proto_config_(proto_config), stats_(generateStats(stats_prefix, context.scope())),
+        jwt_cache_stats_(JwtCache::generateStats(stats_prefix + "jwt_authn.", context.scope())),
         tls_(context.threadLocal().allocateSlot()), cm_(context.clusterManager()),
         time_source_(context.dispatcher().timeSource()), api_(context.api()) {
     ENVOY_LOG(info, "Loaded JwtAuthConfig: {}", proto_config_.DebugString());
     tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-      return std::make_shared<ThreadLocalCache>(proto_config_, time_source_, api_);
+      return std::make_shared<ThreadLocalCache>(proto_config_, time_source_, api_,
+                                                jwt_cache_stats_);
     });
     extractor_ = Extractor::create(proto_config_);
 
@@ -133,7 +141,8 @@ public:
                           const absl::optional<std::string>& provider,
                           bool allow_failed) const override {
     return Authenticator::create(check_audience, provider, allow_failed, getCache().getJwksCache(),
-                                 cm(), Common::JwksFetcher::create, timeSource());
+                                 getCache().getJwtCache(), cm(), Common::JwksFetcher::create,
+                                 timeSource());
   }
 
 private:
@@ -153,6 +162,8 @@ private:
   ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication proto_config_;
   // The stats for the filter.
   JwtAuthnFilterStats stats_;
+  // The stats for the JWT caches of the workers.
+  JwtCacheStats jwt_cache_stats_;
   // Thread local slot to store per-thread auth store
   ThreadLocal::SlotPtr tls_;
   // the cluster manager object.
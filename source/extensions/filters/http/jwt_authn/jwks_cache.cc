@@ -58,6 +58,8 @@ public:
 
   bool isExpired() const override { return time_source_.monotonicTime() >= expiration_time_; }
 
+  uint64_t getJwksGeneration() const override { return jwks_generation_; }
+
   const ::google::jwt_verify::Jwks* setRemoteJwks(::google::jwt_verify::JwksPtr&& jwks) override {
     return setKey(std::move(jwks), getRemoteJwksExpirationTime());
   }
@@ -78,6 +80,7 @@ private:
   const ::google::jwt_verify::Jwks* setKey(::google::jwt_verify::JwksPtr&& jwks,
                                            MonotonicTime expire) {
     jwks_obj_ = std::move(jwks);
+    ++jwks_generation_;
     expiration_time_ = expire;
     return jwks_obj_.get();
   }
@@ -88,6 +91,8 @@ private:
   ::google::jwt_verify::CheckAudiencePtr audiences_;
   // The generated jwks object.
   ::google::jwt_verify::JwksPtr jwks_obj_;
+  // Incremented whenever the jwks object is replaced, e.g. when the remote keys are rotated.
+  uint64_t jwks_generation_{};
   TimeSource& time_source_;
   // The pubkey expiration time.
   MonotonicTime expiration_time_;
@@ -55,6 +55,9 @@ public:
     // Return true if jwks object is expired.
     virtual bool isExpired() const PURE;
 
+    // Get the generation of the Jwks object, which changes whenever it is replaced.
+    virtual uint64_t getJwksGeneration() const PURE;
+
     // Set a remote Jwks.
     virtual const ::google::jwt_verify::Jwks*
     setRemoteJwks(::google::jwt_verify::JwksPtr&& jwks) PURE;
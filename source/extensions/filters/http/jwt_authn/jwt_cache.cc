@@ -0,0 +1,66 @@
+#include "extensions/filters/http/jwt_authn/jwt_cache.h"
+
+#include "common/protobuf/utility.h"
+
+using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+// The default number of JWTs cached by each worker.
+constexpr uint32_t DefaultJwtCacheSize = 100;
+
+} // namespace
+
+const JwtCache::Entry* JwtCache::lookup(absl::string_view token, uint64_t unix_timestamp) {
+  auto it = entries_.find(token);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  const auto& jwt = *it->second->jwt_;
+  // If the exp claim does *not* appear in the JWT then the exp field is defaulted to 0.
+  if (jwt.exp_ > 0 && jwt.exp_ < unix_timestamp) {
+    lru_.erase(it->second);
+    entries_.erase(it);
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return &*it->second;
+}
+
+void JwtCache::insert(const std::string& token, std::unique_ptr<::google::jwt_verify::Jwt>&& jwt,
+                      const JwksCache::JwksData& jwks_data) {
+  auto it = entries_.find(token);
+  if (it != entries_.end()) {
+    it->second->jwt_ = std::move(jwt);
+    it->second->jwks_data_ = &jwks_data;
+    it->second->jwks_generation_ = jwks_data.getJwksGeneration();
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+
+  if (entries_.size() >= max_entries_) {
+    entries_.erase(lru_.back().token_);
+    lru_.pop_back();
+  }
+  lru_.push_front({token, std::move(jwt), &jwks_data, jwks_data.getJwksGeneration()});
+  entries_.emplace(lru_.front().token_, lru_.begin());
+}
+
+JwtCachePtr JwtCache::create(const JwtAuthentication& config, JwtCacheStats& stats) {
+  if (!config.has_jwt_cache_config()) {
+    return nullptr;
+  }
+  return std::make_unique<JwtCache>(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.jwt_cache_config(), jwt_cache_size,
+                                      DefaultJwtCacheSize),
+      stats);
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
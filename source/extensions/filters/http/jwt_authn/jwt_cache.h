@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/config/filter/http/jwt_authn/v2alpha/config.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "extensions/filters/http/jwt_authn/jwks_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "jwt_verify_lib/jwt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+/**
+ * All stats for the JWT cache. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_JWT_CACHE_STATS(COUNTER)                                                               \
+  COUNTER(jwt_cache_hit)                                                                           \
+  COUNTER(jwt_cache_miss)
+// clang-format on
+
+/**
+ * Wrapper struct for JWT cache stats. @see stats_macros.h
+ */
+struct JwtCacheStats {
+  ALL_JWT_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+class JwtCache;
+typedef std::unique_ptr<JwtCache> JwtCachePtr;
+
+/**
+ * A bounded LRU cache of the JWTs whose signature was verified, keyed by their token. It is a
+ * thread local object, so its operations don't need to be protected.
+ */
+class JwtCache {
+public:
+  JwtCache(uint32_t max_entries, JwtCacheStats& stats) : max_entries_(max_entries), stats_(stats) {}
+
+  struct Entry {
+    std::string token_;
+    std::unique_ptr<::google::jwt_verify::Jwt> jwt_;
+    // The JWKS data whose keys verified the signature of the JWT.
+    const JwksCache::JwksData* jwks_data_;
+    // The generation of the keys of the JWKS data that verified it.
+    uint64_t jwks_generation_;
+  };
+
+  /**
+   * @param token the token to look up.
+   * @param unix_timestamp the current time, in seconds since the epoch.
+   * @return the entry of a verified token, or nullptr if it is not cached or it expired.
+   */
+  const Entry* lookup(absl::string_view token, uint64_t unix_timestamp);
+
+  /**
+   * Caches a verified JWT, evicting the least recently used one if the cache is full.
+   */
+  void insert(const std::string& token, std::unique_ptr<::google::jwt_verify::Jwt>&& jwt,
+              const JwksCache::JwksData& jwks_data);
+
+  size_t size() const { return entries_.size(); }
+  JwtCacheStats& stats() { return stats_; }
+
+  // Factory function to create an instance, or nullptr if the cache is not configured.
+  static JwtCachePtr
+  create(const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
+         JwtCacheStats& stats);
+
+  static JwtCacheStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return {ALL_JWT_CACHE_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+private:
+  // Most recently used first.
+  typedef std::list<Entry> LruList;
+
+  const uint32_t max_entries_;
+  JwtCacheStats& stats_;
+  LruList lru_;
+  // The keys are the tokens of the entries of the list, which don't move.
+  absl::flat_hash_map<absl::string_view, LruList::iterator> entries_;
+};
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
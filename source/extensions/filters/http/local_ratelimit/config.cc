@@ -0,0 +1,31 @@
+#include "extensions/filters/http/local_ratelimit/config.h"
+
+#include "envoy/config/filter/http/local_rate_limit/v2alpha/local_rate_limit.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/local_ratelimit/local_ratelimit.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace LocalRateLimitFilter {
+
+Http::FilterFactoryCb LocalRateLimitFilterConfig::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::local_rate_limit::v2alpha::LocalRateLimit& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  FilterConfigSharedPtr filter_config = std::make_shared<FilterConfig>(
+      proto_config, context.localInfo(), stats_prefix, context.scope(), context.timeSource());
+  return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamDecoderFilter(std::make_shared<Filter>(filter_config));
+  };
+}
+
+/**
+ * Static registration for the local rate limit filter. @see RegisterFactory.
+ */
+REGISTER_FACTORY(LocalRateLimitFilterConfig, Server::Configuration::NamedHttpFilterConfigFactory);
+
+} // namespace LocalRateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,115 @@
+#include "extensions/filters/http/local_ratelimit/local_ratelimit.h"
+
+#include "envoy/common/exception.h"
+#include "envoy/http/codes.h"
+
+#include "common/http/headers.h"
+
+#include "extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
+#include "extensions/filters/common/ratelimit/descriptor_key.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace LocalRateLimitFilter {
+
+FilterConfig::FilterConfig(
+    const envoy::config::filter::http::local_rate_limit::v2alpha::LocalRateLimit& config,
+    const LocalInfo::LocalInfo& local_info, const std::string& stats_prefix, Stats::Scope& scope,
+    TimeSource& time_source)
+    : local_info_(local_info),
+      stats_(generateStats(absl::StrCat(stats_prefix, "local_rate_limit.", config.stat_prefix(),
+                                        "."),
+                           scope)),
+      stage_(config.stage()) {
+  if (config.has_token_bucket()) {
+    token_bucket_ =
+        Filters::Common::LocalRateLimit::createTokenBucket(config.token_bucket(), time_source);
+  }
+  for (const auto& descriptor_config : config.descriptors()) {
+    RateLimit::Descriptor descriptor;
+    for (const auto& entry : descriptor_config.entries()) {
+      descriptor.entries_.push_back({entry.key(), entry.value()});
+    }
+    if (!descriptors_
+             .emplace(Filters::Common::RateLimit::descriptorKey("", descriptor),
+                      Filters::Common::LocalRateLimit::createTokenBucket(
+                          descriptor_config.token_bucket(), time_source))
+             .second) {
+      throw EnvoyException("local rate limit: duplicate descriptor");
+    }
+  }
+}
+
+bool FilterConfig::requestAllowed(
+    const std::vector<RateLimit::Descriptor>& request_descriptors) const {
+  if (token_bucket_ != nullptr && token_bucket_->consume(1, false) == 0) {
+    return false;
+  }
+  // The tokens already consumed from other buckets are not returned when a bucket is empty, which
+  // errs on the side of limiting.
+  for (const RateLimit::Descriptor& descriptor : request_descriptors) {
+    auto it = descriptors_.find(Filters::Common::RateLimit::descriptorKey("", descriptor));
+    if (it != descriptors_.end() && it->second->consume(1, false) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  if (config_->requestAllowed(requestDescriptors(headers))) {
+    config_->stats().ok_.inc();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  ENVOY_STREAM_LOG(debug, "local rate limit exceeded", *decoder_callbacks_);
+  config_->stats().rate_limited_.inc();
+  decoder_callbacks_->sendLocalReply(
+      Http::Code::TooManyRequests, "",
+      [](Http::HeaderMap& headers) {
+        headers.insertEnvoyRateLimited().value(Http::Headers::get().EnvoyRateLimitedValues.True);
+      },
+      absl::nullopt);
+  decoder_callbacks_->streamInfo().setResponseFlag(StreamInfo::ResponseFlag::RateLimited);
+  return Http::FilterHeadersStatus::StopIteration;
+}
+
+std::vector<RateLimit::Descriptor>
+Filter::requestDescriptors(const Http::HeaderMap& headers) const {
+  std::vector<RateLimit::Descriptor> descriptors;
+  if (!config_->hasDescriptors()) {
+    return descriptors;
+  }
+  Router::RouteConstSharedPtr route = decoder_callbacks_->route();
+  if (!route || !route->routeEntry()) {
+    return descriptors;
+  }
+
+  const Router::RouteEntry& route_entry = *route->routeEntry();
+  populateRateLimitDescriptors(route_entry.rateLimitPolicy(), descriptors, route_entry, headers);
+  if (route_entry.includeVirtualHostRateLimits()) {
+    populateRateLimitDescriptors(route_entry.virtualHost().rateLimitPolicy(), descriptors,
+                                 route_entry, headers);
+  }
+  return descriptors;
+}
+
+void Filter::populateRateLimitDescriptors(const Router::RateLimitPolicy& rate_limit_policy,
+                                          std::vector<RateLimit::Descriptor>& descriptors,
+                                          const Router::RouteEntry& route_entry,
+                                          const Http::HeaderMap& headers) const {
+  for (const Router::RateLimitPolicyEntry& rate_limit :
+       rate_limit_policy.getApplicableRateLimit(config_->stage())) {
+    rate_limit.populateDescriptors(route_entry, descriptors, config_->localInfo().clusterName(),
+                                   headers,
+                                   *decoder_callbacks_->streamInfo().downstreamRemoteAddress());
+  }
+}
+
+} // namespace LocalRateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
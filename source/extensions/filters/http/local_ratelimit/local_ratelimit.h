@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+#include "envoy/config/filter/http/local_rate_limit/v2alpha/local_rate_limit.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/local_info/local_info.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/router/router.h"
+#include "envoy/router/router_ratelimit.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/common/pass_through_filter.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace LocalRateLimitFilter {
+
+/**
+ * All local rate limit stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LOCAL_RATE_LIMIT_STATS(COUNTER)                                                        \
+  COUNTER(ok)                                                                                      \
+  COUNTER(rate_limited)
+// clang-format on
+
+/**
+ * Struct definition for local rate limit stats. @see stats_macros.h
+ */
+struct LocalRateLimitStats {
+  ALL_LOCAL_RATE_LIMIT_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Global configuration for the HTTP local rate limit filter. Its token buckets are shared by the
+ * filters of all the workers, and consumed from without locking.
+ */
+class FilterConfig {
+public:
+  FilterConfig(const envoy::config::filter::http::local_rate_limit::v2alpha::LocalRateLimit& config,
+               const LocalInfo::LocalInfo& local_info, const std::string& stats_prefix,
+               Stats::Scope& scope, TimeSource& time_source);
+
+  const LocalInfo::LocalInfo& localInfo() const { return local_info_; }
+  LocalRateLimitStats& stats() { return stats_; }
+  uint64_t stage() const { return stage_; }
+  bool hasDescriptors() const { return !descriptors_.empty(); }
+
+  /**
+   * Consumes a token from the bucket of the filter, and from the buckets of the descriptors of a
+   * request that are configured.
+   * @return whether the request is allowed, i.e. none of the buckets was empty.
+   */
+  bool requestAllowed(const std::vector<RateLimit::Descriptor>& request_descriptors) const;
+
+private:
+  static LocalRateLimitStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return LocalRateLimitStats{ALL_LOCAL_RATE_LIMIT_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  const LocalInfo::LocalInfo& local_info_;
+  LocalRateLimitStats stats_;
+  const uint64_t stage_;
+  TokenBucketPtr token_bucket_;
+  absl::flat_hash_map<std::string, TokenBucketPtr> descriptors_;
+};
+
+typedef std::shared_ptr<FilterConfig> FilterConfigSharedPtr;
+
+/**
+ * HTTP local rate limit filter. Depending on its token buckets, which the requests of all the
+ * workers consume from, the filter either continues the request or answers it with a 429 right
+ * away, without calling a rate limit service.
+ */
+class Filter : public Http::PassThroughDecoderFilter, Logger::Loggable<Logger::Id::filter> {
+public:
+  Filter(const FilterConfigSharedPtr& config) : config_(config) {}
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+
+private:
+  std::vector<RateLimit::Descriptor> requestDescriptors(const Http::HeaderMap& headers) const;
+  void populateRateLimitDescriptors(const Router::RateLimitPolicy& rate_limit_policy,
+                                    std::vector<RateLimit::Descriptor>& descriptors,
+                                    const Router::RouteEntry& route_entry,
+                                    const Http::HeaderMap& headers) const;
+
+  const FilterConfigSharedPtr config_;
+};
+
+} // namespace LocalRateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,279 @@
+#include "extensions/filters/http/request_coalescing/request_coalescing_filter.h"
+
+#include <algorithm>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/well_known_names.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+namespace {
+
+const uint32_t DefaultMaxBodyBytes = 1024 * 1024;
+const uint32_t DefaultMaxWaiters = 1024;
+
+// Whether the Cache-Control header has a directive, whatever its argument, e.g.
+// private="set-cookie".
+bool hasCacheDirective(const Http::HeaderMap& headers, absl::string_view directive) {
+  const Http::HeaderEntry* cache_control = headers.CacheControl();
+  if (cache_control == nullptr) {
+    return false;
+  }
+  for (const absl::string_view token :
+       StringUtil::splitToken(cache_control->value().getStringView(), ",", false)) {
+    if (absl::EqualsIgnoreCase(StringUtil::trim(StringUtil::cropRight(token, "=")), directive)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+RequestCoalescingConfig::RequestCoalescingConfig(
+    const envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing&
+        proto_config,
+    const std::string& stats_prefix, Stats::Scope& scope, ThreadLocal::SlotAllocator& tls)
+    : stats_(generateStats(stats_prefix + "request_coalescing.", scope)),
+      max_body_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_body_bytes, DefaultMaxBodyBytes)),
+      max_waiters_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_waiters, DefaultMaxWaiters)),
+      tls_(tls.allocateSlot()) {
+  for (const std::string& header : proto_config.key_headers()) {
+    key_headers_.emplace_back(header);
+  }
+  for (const Http::LowerCaseString& header :
+       {Http::Headers::get().Authorization, Http::Headers::get().Cookie}) {
+    if (std::find(key_headers_.begin(), key_headers_.end(), header) == key_headers_.end()) {
+      unkeyed_credential_headers_.push_back(header);
+    }
+  }
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalFlights>();
+  });
+}
+
+bool RequestCoalescingConfig::varyHeaderKeyed(absl::string_view header) const {
+  // Coalesced requests don't have the credential headers that are not part of the key, so they
+  // don't differ in them either.
+  for (const auto* headers : {&key_headers_, &unkeyed_credential_headers_}) {
+    for (const Http::LowerCaseString& key_header : *headers) {
+      if (absl::EqualsIgnoreCase(header, key_header.get())) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::string RequestCoalescingFilter::requestKey(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* method = headers.Method();
+  if (method == nullptr || headers.Host() == nullptr || headers.Path() == nullptr ||
+      (method->value().getStringView() != Http::Headers::get().MethodValues.Get &&
+       method->value().getStringView() != Http::Headers::get().MethodValues.Head)) {
+    return "";
+  }
+  for (const Http::LowerCaseString& header : config_->unkeyedCredentialHeaders()) {
+    if (headers.get(header) != nullptr) {
+      return "";
+    }
+  }
+
+  // Header values cannot contain new lines, which makes them safe separators.
+  std::string key = absl::StrCat(method->value().getStringView(), "\n",
+                                 headers.Host()->value().getStringView(),
+                                 headers.Path()->value().getStringView());
+  for (const Http::LowerCaseString& header : config_->keyHeaders()) {
+    const Http::HeaderEntry* entry = headers.get(header);
+    // An absent header is distinct from an empty one.
+    absl::StrAppend(&key, entry != nullptr ? "\n=" : "\n",
+                    entry != nullptr ? entry->value().getStringView() : "");
+  }
+  return key;
+}
+
+void RequestCoalescingFilter::onDestroy() {
+  destroyed_ = true;
+  if (flight_ == nullptr) {
+    return;
+  }
+  if (leading_) {
+    config_->stats().leader_reset_.inc();
+    endFlight(false);
+  } else {
+    flight_->waiters_.erase(waiter_);
+    flight_ = nullptr;
+  }
+}
+
+Http::FilterHeadersStatus RequestCoalescingFilter::decodeHeaders(Http::HeaderMap& headers,
+                                                                bool end_stream) {
+  const auto* route_config =
+      Http::Utility::resolveMostSpecificPerFilterConfig<RequestCoalescingRouteConfig>(
+          HttpFilterNames::get().RequestCoalescing, decoder_callbacks_->route());
+  // Only the requests without a body of the routes that enable coalescing are coalesced.
+  if (!end_stream || route_config == nullptr || !route_config->enabled()) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  key_ = requestKey(headers);
+  if (key_.empty()) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  authorized_ = headers.Authorization() != nullptr;
+
+  auto& flights = config_->flights();
+  auto it = flights.find(key_);
+  if (it == flights.end()) {
+    config_->stats().upstream_.inc();
+    flight_ = std::make_shared<Flight>();
+    leading_ = true;
+    flights.emplace(key_, flight_);
+    return Http::FilterHeadersStatus::Continue;
+  }
+  if (it->second->waiters_.size() >= config_->maxWaiters()) {
+    config_->stats().too_many_waiters_.inc();
+    return Http::FilterHeadersStatus::Continue;
+  }
+  ENVOY_STREAM_LOG(debug, "waiting for an identical request in flight", *decoder_callbacks_);
+  config_->stats().coalesced_.inc();
+  flight_ = it->second;
+  waiter_ = flight_->waiters_.insert(flight_->waiters_.end(), this);
+  return Http::FilterHeadersStatus::StopIteration;
+}
+
+Http::FilterHeadersStatus RequestCoalescingFilter::encodeHeaders(Http::HeaderMap& headers,
+                                                                bool end_stream) {
+  if (!leading_) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  if (!responseShareable(headers)) {
+    config_->stats().not_shareable_.inc();
+    endFlight(false);
+    return Http::FilterHeadersStatus::Continue;
+  }
+  flight_->headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+  if (end_stream) {
+    endFlight(true);
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus RequestCoalescingFilter::encodeData(Buffer::Instance& data,
+                                                           bool end_stream) {
+  if (!leading_) {
+    return Http::FilterDataStatus::Continue;
+  }
+  if (flight_->body_.size() + data.length() > config_->maxBodyBytes()) {
+    config_->stats().body_too_large_.inc();
+    endFlight(false);
+    return Http::FilterDataStatus::Continue;
+  }
+  flight_->body_.append(data.toString());
+  if (end_stream) {
+    endFlight(true);
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus RequestCoalescingFilter::encodeTrailers(Http::HeaderMap& trailers) {
+  if (leading_) {
+    flight_->trailers_ = std::make_unique<Http::HeaderMapImpl>(trailers);
+    endFlight(true);
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+bool RequestCoalescingFilter::responseShareable(const Http::HeaderMap& headers) const {
+  // A response that sets cookies starts a session of its own client, and one that is private or
+  // must not be stored is meant for a single client only.
+  if (headers.get(Http::Headers::get().SetCookie) != nullptr ||
+      hasCacheDirective(headers, "private") || hasCacheDirective(headers, "no-store")) {
+    return false;
+  }
+  // As for shared caches, a response to a request with credentials is only shared if it
+  // explicitly allows it (RFC 7234 3.2), even though the waiters have the same credentials.
+  if (authorized_ && !hasCacheDirective(headers, "public") &&
+      !hasCacheDirective(headers, "s-maxage") && !hasCacheDirective(headers, "must-revalidate")) {
+    return false;
+  }
+  // The waiters only have the same values as this request for the headers of the key.
+  const Http::HeaderEntry* vary = headers.get(Http::Headers::get().Vary);
+  if (vary != nullptr) {
+    for (const absl::string_view token :
+         StringUtil::splitToken(vary->value().getStringView(), ",", false)) {
+      if (!config_->varyHeaderKeyed(StringUtil::trim(token))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void RequestCoalescingFilter::endFlight(bool complete) {
+  // Requests that arrive from now on are not coalesced with this one.
+  auto& flights = config_->flights();
+  auto it = flights.find(key_);
+  if (it != flights.end() && it->second == flight_) {
+    flights.erase(it);
+  }
+  const FlightSharedPtr flight = std::move(flight_);
+  flight_ = nullptr;
+  leading_ = false;
+
+  // A waiting stream that is served may cause others to be destroyed, which remove themselves from
+  // the waiters, so the waiters are only taken out of the list one at a time.
+  while (!flight->waiters_.empty()) {
+    RequestCoalescingFilter* waiter = flight->waiters_.front();
+    flight->waiters_.pop_front();
+    waiter->flight_ = nullptr;
+    if (complete) {
+      waiter->encodeFlightResponse(flight);
+    } else {
+      waiter->decoder_callbacks_->continueDecoding();
+    }
+  }
+}
+
+void RequestCoalescingFilter::encodeFlightResponse(const FlightSharedPtr& flight) {
+  const bool has_body = !flight->body_.empty();
+  const bool has_trailers = flight->trailers_ != nullptr;
+  decoder_callbacks_->encodeHeaders(std::make_unique<Http::HeaderMapImpl>(*flight->headers_),
+                                    !has_body && !has_trailers);
+  if (destroyed_) {
+    return;
+  }
+  if (has_body) {
+    // The body is sent without copying it, the fragment keeping the flight alive until it is
+    // drained.
+    auto* fragment = new Buffer::BufferFragmentImpl(
+        flight->body_.data(), flight->body_.size(),
+        [flight](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        });
+    Buffer::OwnedImpl data;
+    data.addBufferFragment(*fragment);
+    decoder_callbacks_->encodeData(data, !has_trailers);
+    if (destroyed_) {
+      return;
+    }
+  }
+  if (has_trailers) {
+    decoder_callbacks_->encodeTrailers(std::make_unique<Http::HeaderMapImpl>(*flight->trailers_));
+  }
+}
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/filter/http/request_coalescing/v2alpha/request_coalescing.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/router/router.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+#include "common/http/header_map_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+/**
+ * All request coalescing filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_REQUEST_COALESCING_STATS(COUNTER)                                                      \
+  COUNTER(upstream)                                                                                \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(too_many_waiters)                                                                        \
+  COUNTER(body_too_large)                                                                          \
+  COUNTER(not_shareable)                                                                           \
+  COUNTER(leader_reset)
+// clang-format on
+
+/**
+ * Struct definition for request coalescing stats. @see stats_macros.h
+ */
+struct RequestCoalescingStats {
+  ALL_REQUEST_COALESCING_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+class RequestCoalescingFilter;
+
+/**
+ * A request that a stream of a worker sent upstream, which the identical requests of other streams
+ * of the same worker wait for. Its response is kept until it is complete, and then sent to all of
+ * them.
+ */
+struct Flight {
+  std::list<RequestCoalescingFilter*> waiters_;
+  Http::HeaderMapPtr headers_;
+  std::string body_;
+  Http::HeaderMapPtr trailers_;
+};
+
+typedef std::shared_ptr<Flight> FlightSharedPtr;
+
+/**
+ * The requests in flight of a worker, by key.
+ */
+struct ThreadLocalFlights : public ThreadLocal::ThreadLocalObject {
+  absl::flat_hash_map<std::string, FlightSharedPtr> flights_;
+};
+
+/**
+ * Configuration for the request coalescing filter.
+ */
+class RequestCoalescingConfig {
+public:
+  RequestCoalescingConfig(
+      const envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing&
+          proto_config,
+      const std::string& stats_prefix, Stats::Scope& scope, ThreadLocal::SlotAllocator& tls);
+
+  RequestCoalescingStats& stats() { return stats_; }
+  const std::vector<Http::LowerCaseString>& keyHeaders() const { return key_headers_; }
+  // Credential headers that are not part of the key, which prevent coalescing requests.
+  const std::vector<Http::LowerCaseString>& unkeyedCredentialHeaders() const {
+    return unkeyed_credential_headers_;
+  }
+  // Whether the requests that are coalesced have the same value for a header that a response
+  // varies on, which is the case for the headers of the key.
+  bool varyHeaderKeyed(absl::string_view header) const;
+  uint64_t maxBodyBytes() const { return max_body_bytes_; }
+  uint32_t maxWaiters() const { return max_waiters_; }
+  absl::flat_hash_map<std::string, FlightSharedPtr>& flights() {
+    return tls_->getTyped<ThreadLocalFlights>().flights_;
+  }
+
+private:
+  static RequestCoalescingStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return RequestCoalescingStats{
+        ALL_REQUEST_COALESCING_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  RequestCoalescingStats stats_;
+  std::vector<Http::LowerCaseString> key_headers_;
+  std::vector<Http::LowerCaseString> unkeyed_credential_headers_;
+  const uint64_t max_body_bytes_;
+  const uint32_t max_waiters_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<RequestCoalescingConfig> RequestCoalescingConfigSharedPtr;
+
+/**
+ * Per-route configuration of the request coalescing filter.
+ */
+class RequestCoalescingRouteConfig : public Router::RouteSpecificFilterConfig {
+public:
+  RequestCoalescingRouteConfig(
+      const envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescingPerRoute&
+          proto_config)
+      : enabled_(proto_config.enabled()) {}
+
+  bool enabled() const { return enabled_; }
+
+private:
+  const bool enabled_;
+};
+
+/**
+ * A filter that sends only one of the identical GET and HEAD requests that a worker receives at
+ * the same time upstream. The other ones wait for its response, and are answered with copies of
+ * it. It should be the last filter before the router, so that the response it copies has not
+ * been transformed by other filters yet.
+ */
+class RequestCoalescingFilter : public Http::StreamFilter, Logger::Loggable<Logger::Id::filter> {
+public:
+  RequestCoalescingFilter(const RequestCoalescingConfigSharedPtr& config) : config_(config) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+  Http::FilterMetadataStatus encodeMetadata(Http::MetadataMap&) override {
+    return Http::FilterMetadataStatus::Continue;
+  }
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  // Returns the key of the request, or an empty string if it must not be coalesced.
+  std::string requestKey(const Http::HeaderMap& headers) const;
+  // Whether the response to the request that this stream leads can be sent to other clients.
+  bool responseShareable(const Http::HeaderMap& headers) const;
+  // Ends the flight that this stream leads. If the response is complete, it is sent to the waiting
+  // streams, otherwise they send their own requests upstream.
+  void endFlight(bool complete);
+  // Answers the request of this stream with the complete response of the flight it waited for.
+  void encodeFlightResponse(const FlightSharedPtr& flight);
+
+  const RequestCoalescingConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+  std::string key_;
+  // The flight that this stream leads, or waits for.
+  FlightSharedPtr flight_;
+  bool leading_{};
+  // Whether the request that this stream leads has an authorization header.
+  bool authorized_{};
+  std::list<RequestCoalescingFilter*>::iterator waiter_;
+  bool destroyed_{};
+};
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
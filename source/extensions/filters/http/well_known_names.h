@@ -12,8 +12,12 @@ namespace HttpFilters {
  */
 class HttpFilterNameValues {
 public:
+  // Adaptive concurrency filter
+  const std::string AdaptiveConcurrency = "envoy.filters.http.adaptive_concurrency";
   // Buffer filter
   const std::string Buffer = "envoy.buffer";
+  // HTTP cache filter
+  const std::string Cache = "envoy.filters.http.cache";
   // CORS filter
   const std::string Cors = "envoy.cors";
   // CSRF filter
@@ -34,8 +38,12 @@ public:
   const std::string EnvoyGzip = "envoy.gzip";
   // IP tagging filter
   const std::string IpTagging = "envoy.ip_tagging";
+  // Local rate limit filter
+  const std::string LocalRateLimit = "envoy.filters.http.local_ratelimit";
   // Rate limit filter
   const std::string RateLimit = "envoy.rate_limit";
+  // Request coalescing filter
+  const std::string RequestCoalescing = "envoy.filters.http.request_coalescing";
   // Router filter
   const std::string Router = "envoy.router";
   // Health checking filter
@@ -3,12 +3,14 @@
 #include <chrono>
 #include <string>
 
+#include "envoy/common/exception.h"
 #include "envoy/config/filter/network/ext_authz/v2/ext_authz.pb.validate.h"
 #include "envoy/network/connection.h"
 #include "envoy/registry/registry.h"
 
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ext_authz/decision_cache.h"
 #include "extensions/filters/common/ext_authz/ext_authz.h"
 #include "extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "extensions/filters/network/ext_authz/ext_authz.h"
@@ -23,15 +25,31 @@ Network::FilterFactoryCb ExtAuthzConfigFactory::createFilterFactoryFromProtoType
     Server::Configuration::FactoryContext& context) {
   ConfigSharedPtr ext_authz_config(new Config(proto_config, context.scope()));
   const uint32_t timeout_ms = PROTOBUF_GET_MS_OR_DEFAULT(proto_config.grpc_service(), timeout, 200);
+  Filters::Common::ExtAuthz::DecisionCacheProviderSharedPtr cache_provider;
+  if (proto_config.has_decision_cache()) {
+    // Connections have no headers, so only the peer tells them apart.
+    const auto& decision_cache = proto_config.decision_cache();
+    if (!decision_cache.source_principal() && !decision_cache.source_address()) {
+      throw EnvoyException(
+          "ext_authz decision cache: the key needs source_principal or source_address");
+    }
+    cache_provider = std::make_shared<Filters::Common::ExtAuthz::DecisionCacheProvider>(
+        proto_config.decision_cache(), "ext_authz." + proto_config.stat_prefix() + ".",
+        context.scope(), context.threadLocal(), context.dispatcher().timeSource());
+  }
 
-  return [grpc_service = proto_config.grpc_service(), &context, ext_authz_config,
-          timeout_ms](Network::FilterManager& filter_manager) -> void {
+  return [grpc_service = proto_config.grpc_service(), &context, ext_authz_config, timeout_ms,
+          cache_provider](Network::FilterManager& filter_manager) -> void {
     auto async_client_factory =
         context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
             grpc_service, context.scope(), true);
 
-    auto client = std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
-        async_client_factory->create(), std::chrono::milliseconds(timeout_ms), false);
+    Filters::Common::ExtAuthz::ClientPtr client =
+        std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
+            async_client_factory->create(), std::chrono::milliseconds(timeout_ms), false);
+    if (cache_provider != nullptr) {
+      client = cache_provider->wrap(std::move(client));
+    }
     filter_manager.addReadFilter(Network::ReadFilterSharedPtr{
         std::make_shared<Filter>(ext_authz_config, std::move(client))});
   };
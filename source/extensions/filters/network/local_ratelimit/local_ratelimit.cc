@@ -0,0 +1,34 @@
+#include "extensions/filters/network/local_ratelimit/local_ratelimit.h"
+
+#include "envoy/network/connection.h"
+
+#include "extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace LocalRateLimitFilter {
+
+Config::Config(
+    const envoy::config::filter::network::local_rate_limit::v2alpha::LocalRateLimit& config,
+    Stats::Scope& scope, TimeSource& time_source)
+    : token_bucket_(Filters::Common::LocalRateLimit::createTokenBucket(config.token_bucket(),
+                                                                         time_source)),
+      stats_(generateStats(absl::StrCat("local_rate_limit.", config.stat_prefix(), "."), scope)) {}
+
+Network::FilterStatus Filter::onNewConnection() {
+  if (config_->canCreateConnection()) {
+    return Network::FilterStatus::Continue;
+  }
+  ENVOY_CONN_LOG(trace, "local rate limit: closing connection", read_callbacks_->connection());
+  config_->stats().rate_limited_.inc();
+  read_callbacks_->connection().close(Network::ConnectionCloseType::NoFlush);
+  return Network::FilterStatus::StopIteration;
+}
+
+} // namespace LocalRateLimitFilter
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
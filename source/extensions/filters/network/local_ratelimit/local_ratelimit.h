@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+#include "envoy/config/filter/network/local_rate_limit/v2alpha/local_rate_limit.pb.h"
+#include "envoy/network/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace LocalRateLimitFilter {
+
+/**
+ * All local rate limit stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LOCAL_RATE_LIMIT_STATS(COUNTER)                                                        \
+  COUNTER(rate_limited)
+// clang-format on
+
+/**
+ * Struct definition for all local rate limit stats. @see stats_macros.h
+ */
+struct LocalRateLimitStats {
+  ALL_LOCAL_RATE_LIMIT_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the local rate limit filter. Its token bucket is shared by the filters of all
+ * the workers, and consumed from without locking.
+ */
+class Config {
+public:
+  Config(const envoy::config::filter::network::local_rate_limit::v2alpha::LocalRateLimit& config,
+         Stats::Scope& scope, TimeSource& time_source);
+
+  // Consumes a token for a new connection, and returns whether the connection is allowed.
+  bool canCreateConnection() { return token_bucket_->consume(1, false) > 0; }
+  LocalRateLimitStats& stats() { return stats_; }
+
+private:
+  static LocalRateLimitStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return LocalRateLimitStats{ALL_LOCAL_RATE_LIMIT_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  const TokenBucketPtr token_bucket_;
+  LocalRateLimitStats stats_;
+};
+
+typedef std::shared_ptr<Config> ConfigSharedPtr;
+
+/**
+ * Local rate limit filter. New connections consume a token from the bucket of the filter, and
+ * are closed right away if it is empty, without calling a rate limit service.
+ */
+class Filter : public Network::ReadFilter, Logger::Loggable<Logger::Id::filter> {
+public:
+  Filter(const ConfigSharedPtr& config) : config_(config) {}
+
+  // Network::ReadFilter
+  Network::FilterStatus onData(Buffer::Instance&, bool) override {
+    return Network::FilterStatus::Continue;
+  }
+  Network::FilterStatus onNewConnection() override;
+  void initializeReadFilterCallbacks(Network::ReadFilterCallbacks& callbacks) override {
+    read_callbacks_ = &callbacks;
+  }
+
+private:
+  const ConfigSharedPtr config_;
+  Network::ReadFilterCallbacks* read_callbacks_{};
+};
+
+} // namespace LocalRateLimitFilter
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -9,7 +9,7 @@
 #include "common/config/filter_json.h"
 #include "common/protobuf/utility.h"
 
-#include "extensions/filters/common/ratelimit/ratelimit_impl.h"
+#include "extensions/filters/common/ratelimit/batching_client_impl.h"
 #include "extensions/filters/network/ratelimit/ratelimit.h"
 
 namespace Envoy {
@@ -29,13 +29,12 @@ Network::FilterFactoryCb RateLimitConfigFactory::createFilterFactoryFromProtoTyp
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
 
-  return [proto_config, &context, timeout,
-          filter_config](Network::FilterManager& filter_manager) -> void {
-    filter_manager.addReadFilter(std::make_shared<Filter>(
-        filter_config,
+  const Filters::Common::RateLimit::ClientFactory client_factory =
+      Filters::Common::RateLimit::rateLimitClientFactory(
+          context, proto_config.rate_limit_service(), timeout);
 
-        Filters::Common::RateLimit::rateLimitClient(
-            context, proto_config.rate_limit_service().grpc_service(), timeout)));
+  return [client_factory, filter_config](Network::FilterManager& filter_manager) -> void {
+    filter_manager.addReadFilter(std::make_shared<Filter>(filter_config, client_factory()));
   };
 }
 
@@ -8,7 +8,7 @@
 
 #include "common/protobuf/utility.h"
 
-#include "extensions/filters/common/ratelimit/ratelimit_impl.h"
+#include "extensions/filters/common/ratelimit/batching_client_impl.h"
 #include "extensions/filters/network/thrift_proxy/filters/ratelimit/ratelimit.h"
 
 namespace Envoy {
@@ -28,11 +28,13 @@ RateLimitFilterConfig::createFilterFactoryFromProtoTyped(
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
 
-  return [proto_config, &context, timeout,
+  const Filters::Common::RateLimit::ClientFactory client_factory =
+      Filters::Common::RateLimit::rateLimitClientFactory(
+          context, proto_config.rate_limit_service(), timeout);
+
+  return [client_factory,
           config](ThriftProxy::ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addDecoderFilter(std::make_shared<Filter>(
-        config, Filters::Common::RateLimit::rateLimitClient(
-                    context, proto_config.rate_limit_service().grpc_service(), timeout)));
+    callbacks.addDecoderFilter(std::make_shared<Filter>(config, client_factory()));
   };
 }
 
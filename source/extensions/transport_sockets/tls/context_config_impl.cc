@@ -3,6 +3,8 @@
 #include <memory>
 #include <string>
 
+#include "envoy/singleton/manager.h"
+
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/config/datasource.h"
@@ -11,6 +13,8 @@
 #include "common/secret/sds_api.h"
 #include "common/ssl/certificate_validation_context_config_impl.h"
 
+#include "extensions/transport_sockets/tls/thread_pool_private_key_provider.h"
+
 #include "openssl/ssl.h"
 
 namespace Envoy {
@@ -18,8 +22,14 @@ namespace Extensions {
 namespace TransportSockets {
 namespace Tls {
 
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(thread_pool_private_key_method_provider_manager);
+
 namespace {
 
+// Minimum size of the secret from which rotated session ticket keys are derived.
+constexpr size_t MinSessionTicketKeySeedSize = 32;
+
 std::vector<Secret::TlsCertificateConfigProviderSharedPtr> getTlsCertificateConfigProviders(
     const envoy::api::v2::auth::CommonTlsContext& config,
     Server::Configuration::TransportSocketFactoryContext& factory_context) {
@@ -104,6 +114,43 @@ getCertificateValidationContextConfigProvider(
   }
 }
 
+Ssl::PrivateKeyMethodProviderSharedPtr
+getPrivateKeyMethodProvider(const envoy::api::v2::auth::CommonTlsContext& config,
+                            Server::Configuration::TransportSocketFactoryContext& factory_context,
+                            Singleton::InstanceSharedPtr* provider_manager) {
+  switch (config.private_key_provider().provider_type_case()) {
+  case envoy::api::v2::auth::PrivateKeyProvider::kThreadPool: {
+    // Contexts with the same thread pool configuration share the threads. The pool outlives the
+    // listeners and clusters that use it, so its stats are in the server's store.
+    auto manager =
+        factory_context.singletonManager().getTyped<ThreadPoolPrivateKeyMethodProviderManager>(
+            SINGLETON_MANAGER_REGISTERED_NAME(thread_pool_private_key_method_provider_manager),
+            [&factory_context] {
+              return std::make_shared<ThreadPoolPrivateKeyMethodProviderManager>(
+                  factory_context.api().threadFactory(), factory_context.api().timeSource(),
+                  factory_context.stats());
+            });
+    *provider_manager = manager;
+    return manager->getProvider(config.private_key_provider().thread_pool());
+  }
+  default:
+    return nullptr;
+  }
+}
+
+// Serializes map fields, such as those of the private key provider configuration, in a stable
+// order so that equal configurations serialize identically.
+std::string serializeDeterministically(const Protobuf::Message& message) {
+  ProtobufTypes::String text;
+  {
+    Protobuf::io::StringOutputStream string_stream(&text);
+    Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_stream);
+  }
+  return text;
+}
+
 } // namespace
 
 ContextConfigImpl::ContextConfigImpl(
@@ -123,7 +170,10 @@ ContextConfigImpl::ContextConfigImpl(
       min_protocol_version_(tlsVersionFromProto(config.tls_params().tls_minimum_protocol_version(),
                                                 default_min_protocol_version)),
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
-                                                default_max_protocol_version)) {
+                                                default_max_protocol_version)),
+      kernel_tls_offload_(config.kernel_tls_offload()),
+      private_key_method_provider_(getPrivateKeyMethodProvider(
+          config, factory_context, &private_key_method_provider_manager_)) {
   if (default_cvc_ && certificate_validation_context_provider_ != nullptr) {
     // We need to validate combined certificate validation context.
     // The default certificate validation context and dynamic certificate validation
@@ -351,6 +401,7 @@ ServerContextConfigImpl::ServerContextConfigImpl(
         case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeysSdsSecretConfig:
           throw EnvoyException("SDS not supported yet");
           break;
+        case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeyRotation:
         case envoy::api::v2::auth::DownstreamTlsContext::SESSION_TICKET_KEYS_TYPE_NOT_SET:
           break;
         default:
@@ -359,7 +410,10 @@ ServerContextConfigImpl::ServerContextConfigImpl(
         }
 
         return ret;
-      }()) {
+      }()),
+      session_ticket_key_rotation_(sessionTicketKeyRotationFromProto(config, api_)),
+      lazy_load_certificates_(config.lazy_load_certificates()),
+      serialized_config_(serializeDeterministically(config)) {
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) == 0) {
     throw EnvoyException("No TLS certificates found for server context");
@@ -407,6 +461,28 @@ void ServerContextConfigImpl::validateAndAppendKey(
   ASSERT(key_data.begin() + pos == key_data.end());
 }
 
+absl::optional<ServerContextConfig::SessionTicketKeyRotation>
+ServerContextConfigImpl::sessionTicketKeyRotationFromProto(
+    const envoy::api::v2::auth::DownstreamTlsContext& config, Api::Api& api) {
+  if (!config.has_session_ticket_key_rotation()) {
+    return absl::nullopt;
+  }
+
+  const auto& rotation_config = config.session_ticket_key_rotation();
+  SessionTicketKeyRotation rotation;
+  rotation.seed_ = Config::DataSource::read(rotation_config.seed(), false, api);
+  if (rotation.seed_.size() < MinSessionTicketKeySeedSize) {
+    throw EnvoyException(fmt::format("TLS session ticket key seed is too short. "
+                                     "Length {}, expected at least {}.",
+                                     rotation.seed_.size(), MinSessionTicketKeySeedSize));
+  }
+  rotation.rotation_interval_ = std::chrono::milliseconds(
+      PROTOBUF_GET_MS_OR_DEFAULT(rotation_config, rotation_interval, 3600000));
+  rotation.accepted_previous_keys_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(rotation_config, accepted_previous_keys, 2);
+  return rotation;
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
@@ -7,6 +7,7 @@
 #include "envoy/secret/secret_callbacks.h"
 #include "envoy/secret/secret_provider.h"
 #include "envoy/server/transport_socket_config.h"
+#include "envoy/singleton/instance.h"
 #include "envoy/ssl/context_config.h"
 
 #include "common/common/empty_string.h"
@@ -43,6 +44,10 @@ public:
   }
   unsigned minProtocolVersion() const override { return min_protocol_version_; };
   unsigned maxProtocolVersion() const override { return max_protocol_version_; };
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
+  Ssl::PrivateKeyMethodProviderSharedPtr privateKeyMethodProvider() const override {
+    return private_key_method_provider_;
+  }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -92,6 +97,10 @@ private:
   Common::CallbackHandle* cvc_validation_callback_handle_{};
   const unsigned min_protocol_version_;
   const unsigned max_protocol_version_;
+  const bool kernel_tls_offload_;
+  // Keeps the manager sharing private key providers between contexts alive, if a provider is used.
+  Singleton::InstanceSharedPtr private_key_method_provider_manager_;
+  const Ssl::PrivateKeyMethodProviderSharedPtr private_key_method_provider_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public Envoy::Ssl::ClientContextConfig {
@@ -139,6 +148,11 @@ public:
   const std::vector<SessionTicketKey>& sessionTicketKeys() const override {
     return session_ticket_keys_;
   }
+  const absl::optional<SessionTicketKeyRotation>& sessionTicketKeyRotation() const override {
+    return session_ticket_key_rotation_;
+  }
+  bool lazyLoadCertificates() const override { return lazy_load_certificates_; }
+  const std::string& serializedConfig() const override { return serialized_config_; }
 
 private:
   static const unsigned DEFAULT_MIN_VERSION;
@@ -148,9 +162,15 @@ private:
 
   const bool require_client_certificate_;
   const std::vector<SessionTicketKey> session_ticket_keys_;
+  const absl::optional<SessionTicketKeyRotation> session_ticket_key_rotation_;
+  const bool lazy_load_certificates_;
+  const std::string serialized_config_;
 
   static void validateAndAppendKey(std::vector<ServerContextConfig::SessionTicketKey>& keys,
                                    const std::string& key_data);
+  static absl::optional<SessionTicketKeyRotation>
+  sessionTicketKeyRotationFromProto(const envoy::api::v2::auth::DownstreamTlsContext& config,
+                                    Api::Api& api);
 };
 
 } // namespace Tls
@@ -1,6 +1,8 @@
 #include "extensions/transport_sockets/tls/context_impl.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,7 +20,9 @@
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "openssl/evp.h"
+#include "openssl/hkdf.h"
 #include "openssl/hmac.h"
+#include "openssl/mem.h"
 #include "openssl/rand.h"
 #include "openssl/x509v3.h"
 
@@ -48,7 +52,9 @@ bool cbsContainsU16(CBS& cbs, uint16_t n) {
 ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& config,
                          TimeSource& time_source)
     : scope_(scope), stats_(generateStats(scope)), time_source_(time_source),
-      tls_max_version_(config.maxProtocolVersion()) {
+      tls_max_version_(config.maxProtocolVersion()),
+      kernel_tls_offload_(config.kernelTlsOffload()),
+      private_key_method_provider_(config.privateKeyMethodProvider()) {
   const auto tls_certificates = config.tlsCertificates();
   tls_contexts_.resize(std::max(1UL, tls_certificates.size()));
 
@@ -315,6 +321,13 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
           fmt::format("Failed to load private key from {}", tls_certificate.privateKeyPath()));
     }
 
+    // The key stays loaded so that the provider can look it up with SSL_get_privatekey(), but
+    // BoringSSL hands the operations to the provider instead of using it directly.
+    if (private_key_method_provider_ != nullptr) {
+      SSL_CTX_set_private_key_method(ctx.ssl_ctx_.get(),
+                                     private_key_method_provider_->getBoringSslPrivateKeyMethod());
+    }
+
 #ifdef BORINGSSL_FIPS
     // Verify that private keys are passing FIPS pairwise consistency tests.
     switch (pkey_id) {
@@ -633,6 +646,11 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
       max_session_keys_(config.maxSessionKeys()) {
   // This should be guaranteed during configuration ingestion for client contexts.
   ASSERT(tls_contexts_.size() == 1);
+  // A renegotiation handshake would need to write records after the keys were handed to the
+  // kernel.
+  if (allow_renegotiation_) {
+    kernel_tls_offload_ = false;
+  }
   if (!parsed_alpn_protocols_.empty()) {
     for (auto& ctx : tls_contexts_) {
       int rc = SSL_CTX_set_alpn_protos(ctx.ssl_ctx_.get(), &parsed_alpn_protocols_[0],
@@ -739,7 +757,8 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
                                      TimeSource& time_source)
-    : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()) {
+    : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()),
+      session_ticket_key_rotation_(config.sessionTicketKeyRotation()) {
   if (config.tlsCertificates().empty()) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
@@ -776,7 +795,7 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
           this);
     }
 
-    if (!session_ticket_keys_.empty()) {
+    if (!session_ticket_keys_.empty() || session_ticket_key_rotation_.has_value()) {
       SSL_CTX_set_tlsext_ticket_key_cb(
           ctx.ssl_ctx_.get(),
           [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
@@ -888,6 +907,48 @@ void ServerContextImpl::generateHashForSessionContexId(const std::vector<std::st
   RELEASE_ASSERT(rc == 1, "");
 }
 
+uint64_t ServerContextImpl::currentTicketKeyPeriod() const {
+  ASSERT(session_ticket_key_rotation_.has_value());
+  // Wall clock time, so that all hosts sharing the seed agree on the current period.
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      time_source_.systemTime().time_since_epoch());
+  return now.count() / session_ticket_key_rotation_->rotation_interval_.count();
+}
+
+Envoy::Ssl::ServerContextConfig::SessionTicketKey
+ServerContextImpl::deriveTicketKey(uint64_t period) const {
+  ASSERT(session_ticket_key_rotation_.has_value());
+  Envoy::Ssl::ServerContextConfig::SessionTicketKey key;
+
+  // The key name starts with the period so that decryption can derive the right key directly
+  // rather than trying every accepted one. The rest of the name authenticates it.
+  uint8_t period_bytes[sizeof(uint64_t)];
+  for (int i = sizeof(period_bytes) - 1; i >= 0; i--) {
+    period_bytes[i] = period & 0xff;
+    period >>= 8;
+  }
+  std::copy_n(period_bytes, sizeof(period_bytes), key.name_.begin());
+
+  const absl::string_view label = "envoy tls session ticket key";
+  std::vector<uint8_t> info(label.begin(), label.end());
+  info.insert(info.end(), period_bytes, period_bytes + sizeof(period_bytes));
+
+  constexpr size_t name_tag_size = sizeof(key.name_) - sizeof(period_bytes);
+  std::array<uint8_t, name_tag_size + sizeof(key.hmac_key_) + sizeof(key.aes_key_)> derived;
+  const std::string& seed = session_ticket_key_rotation_->seed_;
+  int rc = HKDF(derived.data(), derived.size(), EVP_sha256(),
+                reinterpret_cast<const uint8_t*>(seed.data()), seed.size(), nullptr, 0,
+                info.data(), info.size());
+  RELEASE_ASSERT(rc == 1, "");
+
+  std::copy_n(derived.begin(), name_tag_size, key.name_.begin() + sizeof(period_bytes));
+  std::copy_n(derived.begin() + name_tag_size, key.hmac_key_.size(), key.hmac_key_.begin());
+  std::copy_n(derived.begin() + name_tag_size + key.hmac_key_.size(), key.aes_key_.size(),
+              key.aes_key_.begin());
+  OPENSSL_cleanse(derived.data(), derived.size());
+  return key;
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
@@ -895,12 +956,16 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
 
   if (encrypt == 1) {
     // Encrypt
-    RELEASE_ASSERT(session_ticket_keys_.size() >= 1, "");
-    // TODO(ggreenway): validate in SDS that session_ticket_keys_ cannot be empty,
-    // or if we allow it to be emptied, reconfigure the context so this callback
-    // isn't set.
-
-    const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key = session_ticket_keys_.front();
+    Envoy::Ssl::ServerContextConfig::SessionTicketKey key;
+    if (session_ticket_key_rotation_.has_value()) {
+      key = deriveTicketKey(currentTicketKeyPeriod());
+    } else {
+      RELEASE_ASSERT(session_ticket_keys_.size() >= 1, "");
+      // TODO(ggreenway): validate in SDS that session_ticket_keys_ cannot be empty,
+      // or if we allow it to be emptied, reconfigure the context so this callback
+      // isn't set.
+      key = session_ticket_keys_.front();
+    }
 
     static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                   "Expected key.name length");
@@ -923,28 +988,54 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
     return 1; // success
   } else {
     // Decrypt
-    bool is_enc_key = true; // first element is the encryption key
-    for (const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key : session_ticket_keys_) {
-      static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
-                    "Expected key.name length");
-      if (std::equal(key.name_.begin(), key.name_.end(), key_name)) {
-        if (!HMAC_Init_ex(hmac_ctx, key.hmac_key_.data(), key.hmac_key_.size(), hmac, nullptr)) {
-          return -1;
+    Envoy::Ssl::ServerContextConfig::SessionTicketKey key;
+    bool is_enc_key = false;
+    bool found = false;
+    if (session_ticket_key_rotation_.has_value()) {
+      uint64_t period = 0;
+      for (size_t i = 0; i < sizeof(uint64_t); i++) {
+        period = (period << 8) | key_name[i];
+      }
+      const uint64_t current_period = currentTicketKeyPeriod();
+      // The next period is accepted too, in case the clock of the host that issued the ticket is
+      // slightly ahead of ours.
+      if (period <= current_period + 1 &&
+          period + session_ticket_key_rotation_->accepted_previous_keys_ >= current_period) {
+        key = deriveTicketKey(period);
+        found = CRYPTO_memcmp(key.name_.data(), key_name, key.name_.size()) == 0;
+        is_enc_key = period == current_period;
+      }
+    } else {
+      is_enc_key = true; // first element is the encryption key
+      for (const Envoy::Ssl::ServerContextConfig::SessionTicketKey& candidate :
+           session_ticket_keys_) {
+        static_assert(std::tuple_size<decltype(candidate.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
+                      "Expected key.name length");
+        if (std::equal(candidate.name_.begin(), candidate.name_.end(), key_name)) {
+          key = candidate;
+          found = true;
+          break;
         }
+        is_enc_key = false;
+      }
+    }
 
-        RELEASE_ASSERT(key.aes_key_.size() == EVP_CIPHER_key_length(cipher), "");
-        if (!EVP_DecryptInit_ex(ctx, cipher, nullptr, key.aes_key_.data(), iv)) {
-          return -1;
-        }
+    if (!found) {
+      return 0; // decryption failed
+    }
 
-        // If our current encryption was not the decryption key, renew
-        return is_enc_key ? 1  // success; do not renew
-                          : 2; // success: renew key
-      }
-      is_enc_key = false;
+    if (!HMAC_Init_ex(hmac_ctx, key.hmac_key_.data(), key.hmac_key_.size(), hmac, nullptr)) {
+      return -1;
+    }
+
+    RELEASE_ASSERT(key.aes_key_.size() == EVP_CIPHER_key_length(cipher), "");
+    if (!EVP_DecryptInit_ex(ctx, cipher, nullptr, key.aes_key_.data(), iv)) {
+      return -1;
     }
 
-    return 0; // decryption failed
+    // If our current encryption was not the decryption key, renew
+    return is_enc_key ? 1  // success; do not renew
+                      : 2; // success: renew key
   }
 }
 
@@ -34,7 +34,9 @@ namespace Tls {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(kernel_tls_offload)                                                                      \
+  COUNTER(kernel_tls_offload_unavailable)
 // clang-format on
 
 /**
@@ -73,6 +75,20 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if connections should try to offload their transmit side to kernel TLS once the
+   *         handshake completes.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
+  /**
+   * @return the provider that performs the private key operations of handshakes, or nullptr.
+   *         Connections must register with it before starting their handshake.
+   */
+  const Envoy::Ssl::PrivateKeyMethodProviderSharedPtr& privateKeyMethodProvider() const {
+    return private_key_method_provider_;
+  }
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   Envoy::Ssl::CertificateDetailsPtr getCaCertInformation() const override;
@@ -159,6 +175,8 @@ protected:
   std::string cert_chain_file_path_;
   TimeSource& time_source_;
   const unsigned tls_max_version_;
+  bool kernel_tls_offload_;
+  const Envoy::Ssl::PrivateKeyMethodProviderSharedPtr private_key_method_provider_;
 };
 
 typedef std::shared_ptr<ContextImpl> ContextImplSharedPtr;
@@ -192,6 +210,11 @@ private:
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
                            HMAC_CTX* hmac_ctx, int encrypt);
+  // Returns the rotation period whose key encrypts new session tickets.
+  uint64_t currentTicketKeyPeriod() const;
+  // Derives the session ticket key of a rotation period from the configured seed. This is
+  // stateless, so it needs no synchronization across workers.
+  Envoy::Ssl::ServerContextConfig::SessionTicketKey deriveTicketKey(uint64_t period) const;
   bool isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
   // Select the TLS certificate context in SSL_CTX_set_select_certificate_cb() callback with
   // ClientHello details.
@@ -200,6 +223,8 @@ private:
                                       uint8_t* session_context_buf, unsigned& session_context_len);
 
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
+  const absl::optional<Envoy::Ssl::ServerContextConfig::SessionTicketKeyRotation>
+      session_ticket_key_rotation_;
 };
 
 } // namespace Tls
@@ -1,6 +1,8 @@
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
 
+#include <array>
 #include <functional>
+#include <string>
 
 #include "envoy/stats/scope.h"
 
@@ -8,18 +10,121 @@
 
 #include "extensions/transport_sockets/tls/context_impl.h"
 
+#include "openssl/sha.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace Tls {
 
+namespace {
+
+// Hashes values with their length, so that the concatenation of adjacent fields is unambiguous.
+class KeyHasher {
+public:
+  KeyHasher() { SHA256_Init(&ctx_); }
+
+  void add(absl::string_view value) {
+    add(static_cast<uint64_t>(value.size()));
+    SHA256_Update(&ctx_, value.data(), value.size());
+  }
+  void add(uint64_t value) { SHA256_Update(&ctx_, &value, sizeof(value)); }
+  void add(const std::vector<std::string>& values) {
+    add(static_cast<uint64_t>(values.size()));
+    for (const auto& value : values) {
+      add(value);
+    }
+  }
+  template <size_t N> void add(const std::array<uint8_t, N>& value) {
+    add(absl::string_view(reinterpret_cast<const char*>(value.data()), N));
+  }
+
+  std::string digest() {
+    std::string digest(SHA256_DIGEST_LENGTH, '\0');
+    SHA256_Final(reinterpret_cast<uint8_t*>(&digest[0]), &ctx_);
+    return digest;
+  }
+
+private:
+  SHA256_CTX ctx_;
+};
+
+} // namespace
+
 ContextManagerImpl::~ContextManagerImpl() {
+  absl::MutexLock lock(&mutex_);
   removeEmptyContexts();
   ASSERT(contexts_.empty());
+  ASSERT(server_contexts_.empty());
 }
 
 void ContextManagerImpl::removeEmptyContexts() {
   contexts_.remove_if([](const std::weak_ptr<Envoy::Ssl::Context>& n) { return n.expired(); });
+  for (auto it = server_contexts_.begin(); it != server_contexts_.end();) {
+    if (it->second.expired()) {
+      server_contexts_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+Envoy::Ssl::ServerContextSharedPtr ContextManagerImpl::findServerContext(const std::string& key) {
+  auto it = server_contexts_.find(key);
+  return it != server_contexts_.end() ? it->second.lock() : nullptr;
+}
+
+std::string ContextManagerImpl::serverContextKey(const Stats::Scope& scope,
+                                                 const Envoy::Ssl::ServerContextConfig& config,
+                                                 const std::vector<std::string>& server_names) {
+  KeyHasher hasher;
+  // Contexts hold the scope of their stats. A live context keeps its scope alive, so the address
+  // of a scope cannot be reused while the context is shared.
+  hasher.add(reinterpret_cast<uint64_t>(&scope));
+  // Server names are part of the session ID context.
+  hasher.add(server_names);
+
+  // The serialized configuration covers every setting of the context, including the private key
+  // provider configuration. It only names the certificates, keys and validation context, which are
+  // loaded from files or SDS, so their contents are hashed as well.
+  hasher.add(config.serializedConfig());
+
+  const auto tls_certificates = config.tlsCertificates();
+  hasher.add(static_cast<uint64_t>(tls_certificates.size()));
+  for (const auto& tls_certificate : tls_certificates) {
+    hasher.add(tls_certificate.get().certificateChain());
+    hasher.add(tls_certificate.get().certificateChainPath());
+    hasher.add(tls_certificate.get().privateKey());
+    hasher.add(tls_certificate.get().privateKeyPath());
+    hasher.add(tls_certificate.get().password());
+  }
+
+  const auto* validation_context = config.certificateValidationContext();
+  hasher.add(validation_context != nullptr);
+  if (validation_context != nullptr) {
+    hasher.add(validation_context->caCert());
+    hasher.add(validation_context->caCertPath());
+    hasher.add(validation_context->certificateRevocationList());
+    hasher.add(validation_context->certificateRevocationListPath());
+    hasher.add(validation_context->verifySubjectAltNameList());
+    hasher.add(validation_context->verifyCertificateHashList());
+    hasher.add(validation_context->verifyCertificateSpkiList());
+    hasher.add(validation_context->allowExpiredCertificate());
+  }
+
+  hasher.add(static_cast<uint64_t>(config.sessionTicketKeys().size()));
+  for (const auto& key : config.sessionTicketKeys()) {
+    hasher.add(key.name_);
+    hasher.add(key.hmac_key_);
+    hasher.add(key.aes_key_);
+  }
+  const auto& rotation = config.sessionTicketKeyRotation();
+  hasher.add(rotation.has_value());
+  if (rotation.has_value()) {
+    hasher.add(rotation->seed_);
+  }
+
+  return hasher.digest();
 }
 
 Envoy::Ssl::ClientContextSharedPtr
@@ -31,6 +136,7 @@ ContextManagerImpl::createSslClientContext(Stats::Scope& scope,
 
   Envoy::Ssl::ClientContextSharedPtr context =
       std::make_shared<ClientContextImpl>(scope, config, time_source_);
+  absl::MutexLock lock(&mutex_);
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
@@ -44,15 +150,34 @@ ContextManagerImpl::createSslServerContext(Stats::Scope& scope,
     return nullptr;
   }
 
+  std::string key = serverContextKey(scope, config, server_names);
+  {
+    absl::MutexLock lock(&mutex_);
+    Envoy::Ssl::ServerContextSharedPtr existing_context = findServerContext(key);
+    if (existing_context != nullptr) {
+      return existing_context;
+    }
+  }
+
+  // Parsing certificates and setting up the SSL_CTXs is slow, and lazily loaded contexts are
+  // created on workers, so the context is created without holding the lock. If another thread
+  // created a context with the same key meanwhile, that one is returned and this one discarded.
   Envoy::Ssl::ServerContextSharedPtr context =
       std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_);
+  absl::MutexLock lock(&mutex_);
+  Envoy::Ssl::ServerContextSharedPtr existing_context = findServerContext(key);
+  if (existing_context != nullptr) {
+    return existing_context;
+  }
   removeEmptyContexts();
   contexts_.emplace_back(context);
+  server_contexts_[std::move(key)] = context;
   return context;
 }
 
 size_t ContextManagerImpl::daysUntilFirstCertExpires() const {
   size_t ret = std::numeric_limits<int>::max();
+  absl::MutexLock lock(&mutex_);
   for (const auto& ctx_weak_ptr : contexts_) {
     Envoy::Ssl::ContextSharedPtr context = ctx_weak_ptr.lock();
     if (context) {
@@ -63,6 +188,7 @@ size_t ContextManagerImpl::daysUntilFirstCertExpires() const {
 }
 
 void ContextManagerImpl::iterateContexts(std::function<void(const Envoy::Ssl::Context&)> callback) {
+  absl::MutexLock lock(&mutex_);
   for (const auto& ctx_weak_ptr : contexts_) {
     Envoy::Ssl::ContextSharedPtr context = ctx_weak_ptr.lock();
     if (context) {
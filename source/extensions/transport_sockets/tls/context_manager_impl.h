@@ -2,11 +2,17 @@
 
 #include <functional>
 #include <list>
+#include <string>
 
 #include "envoy/common/time.h"
 #include "envoy/ssl/context_manager.h"
 #include "envoy/stats/scope.h"
 
+#include "common/common/thread_annotations.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
@@ -14,10 +20,15 @@ namespace Tls {
 
 /**
  * The SSL context manager has the following threading model:
- * Contexts can be allocated via any thread (through in practice they are only allocated on the main
- * thread). They can be released from any thread (and in practice are since cluster information can
- * be released from any thread). Context allocation/free is a very uncommon thing so we just do a
- * global lock to protect it all.
+ * Contexts can be allocated via any thread (in practice they are allocated on the main thread, and
+ * on workers for server contexts that load their certificates lazily). They can be released from
+ * any thread (and in practice are since cluster information can be released from any thread).
+ * Context allocation/free is a very uncommon thing so we just do a global lock to protect the
+ * bookkeeping. Contexts themselves are created without holding it.
+ *
+ * Server contexts are shared: a context is only created if no live context was created with the
+ * same configuration, server names and stats scope. Listeners with many filter chains that use the
+ * same certificate then only parse and hold that certificate once.
  */
 class ContextManagerImpl final : public Envoy::Ssl::ContextManager {
 public:
@@ -34,10 +45,23 @@ public:
   size_t daysUntilFirstCertExpires() const override;
   void iterateContexts(std::function<void(const Envoy::Ssl::Context&)> callback) override;
 
+  /**
+   * @return the key under which a server context is shared. Contexts with equal keys are
+   *         interchangeable. The key is a SHA-256 digest, so it does not hold any secret.
+   */
+  static std::string serverContextKey(const Stats::Scope& scope,
+                                      const Envoy::Ssl::ServerContextConfig& config,
+                                      const std::vector<std::string>& server_names);
+
 private:
-  void removeEmptyContexts();
+  void removeEmptyContexts() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  Envoy::Ssl::ServerContextSharedPtr findServerContext(const std::string& key)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   TimeSource& time_source_;
-  std::list<std::weak_ptr<Envoy::Ssl::Context>> contexts_;
+  mutable absl::Mutex mutex_;
+  std::list<std::weak_ptr<Envoy::Ssl::Context>> contexts_ GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::weak_ptr<Envoy::Ssl::ServerContext>>
+      server_contexts_ GUARDED_BY(mutex_);
 };
 
 } // namespace Tls
@@ -0,0 +1,158 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <cstring>
+#include <vector>
+
+#include "common/api/os_sys_calls_impl.h"
+
+#include "openssl/mem.h"
+
+#if defined(__linux__)
+#include <linux/tls.h>
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+#if defined(TLS_TX)
+namespace {
+
+// TLS 1.2 AES-GCM derives a 4 byte implicit nonce (salt) per direction from the key block.
+constexpr size_t GcmSaltLength = 4;
+// TLS record content type of alerts.
+constexpr uint8_t AlertContentType = 21;
+
+void storeBigEndian(uint64_t value, unsigned char* out) {
+  for (int i = 7; i >= 0; i--) {
+    out[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+template <class CryptoInfo>
+bool installTransmitKeys(SSL* ssl, int fd, uint16_t cipher_type,
+                         const std::vector<uint8_t>& key_block) {
+  CryptoInfo info;
+  static_assert(sizeof(info.salt) == GcmSaltLength, "unexpected kTLS salt size");
+  static_assert(sizeof(info.iv) == sizeof(uint64_t), "unexpected kTLS IV size");
+  static_assert(sizeof(info.rec_seq) == sizeof(uint64_t), "unexpected kTLS sequence size");
+  constexpr size_t key_length = sizeof(info.key);
+  if (key_block.size() != 2 * (key_length + GcmSaltLength)) {
+    return false;
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.info.version = TLS_1_2_VERSION;
+  info.info.cipher_type = cipher_type;
+
+  // The key block holds the client and server write keys followed by the client and server salts.
+  const bool is_server = SSL_is_server(ssl);
+  memcpy(info.key, key_block.data() + (is_server ? key_length : 0), key_length);
+  memcpy(info.salt, key_block.data() + 2 * key_length + (is_server ? GcmSaltLength : 0),
+         GcmSaltLength);
+  // BoringSSL uses the record sequence number as the explicit nonce, so both continue from the
+  // current write sequence number.
+  const uint64_t write_sequence = SSL_get_write_sequence(ssl);
+  storeBigEndian(write_sequence, info.iv);
+  storeBigEndian(write_sequence, info.rec_seq);
+
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  const bool installed = os_sys_calls.setsockopt(fd, SOL_TLS, TLS_TX, &info, sizeof(info)).rc_ == 0;
+  OPENSSL_cleanse(&info, sizeof(info));
+  return installed;
+}
+
+} // namespace
+
+bool enableTransmitOffload(SSL* ssl, int fd) {
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return false;
+  }
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return false;
+  }
+  const int nid = SSL_CIPHER_get_cipher_nid(cipher);
+  bool supported = nid == NID_aes_128_gcm;
+#if defined(TLS_CIPHER_AES_GCM_256)
+  supported = supported || nid == NID_aes_256_gcm;
+#endif
+  if (!supported) {
+    return false;
+  }
+
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (!SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+
+  // Attaching the ULP without installing keys leaves the socket behaving as plain TCP, so a
+  // failure to install the keys below does not need to be undone.
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  bool offloaded = false;
+  if (os_sys_calls.setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")).rc_ == 0) {
+    if (nid == NID_aes_128_gcm) {
+      offloaded = installTransmitKeys<tls12_crypto_info_aes_gcm_128>(
+          ssl, fd, TLS_CIPHER_AES_GCM_128, key_block);
+    }
+#if defined(TLS_CIPHER_AES_GCM_256)
+    else {
+      offloaded = installTransmitKeys<tls12_crypto_info_aes_gcm_256>(
+          ssl, fd, TLS_CIPHER_AES_GCM_256, key_block);
+    }
+#endif
+  }
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+  return offloaded;
+}
+
+bool sendCloseNotify(int fd) {
+  uint8_t alert[2] = {SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY};
+  struct iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+
+  // The record type of everything written through the ULP defaults to application data, alerts
+  // have to be tagged explicitly.
+  uint8_t control[CMSG_SPACE(sizeof(uint8_t))];
+  memset(control, 0, sizeof(control));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = AlertContentType;
+
+  return ::sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(alert);
+}
+#else
+bool enableTransmitOffload(SSL*, int) { return false; }
+
+bool sendCloseNotify(int) { return false; }
+#endif
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+/**
+ * Installs the transmit keys of an established TLS session into the kernel TLS (kTLS) layer of
+ * its socket. Afterwards plain writes to the socket are sent as encrypted application data
+ * records and SSL_write() must no longer be used on the session. Only TLS 1.2 sessions using
+ * AES-GCM are supported.
+ * @param ssl supplies a session that has completed its handshake and flushed all its records.
+ * @param fd supplies the connected socket of the session.
+ * @return true if the kernel now encrypts outgoing records. If false, the session is unchanged
+ *         and must keep using user space TLS.
+ */
+bool enableTransmitOffload(SSL* ssl, int fd);
+
+/**
+ * Sends a close_notify alert on a socket whose transmit side was offloaded with
+ * enableTransmitOffload().
+ * @param fd supplies the socket.
+ * @return true if the alert was written.
+ */
+bool sendCloseNotify(int fd);
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "extensions/transport_sockets/tls/ssl_socket.h"
 
+#include "envoy/common/exception.h"
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
@@ -7,6 +8,7 @@
 #include "common/common/hex.h"
 #include "common/http/headers.h"
 
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "absl/strings/str_replace.h"
@@ -24,6 +26,20 @@ namespace {
 
 constexpr absl::string_view NotReadyReason{"TLS error: Secret is not supplied by SDS"};
 
+// Largest amount of data passed to a single SSL_write(), which is also the maximum TLS record
+// payload size.
+constexpr uint64_t MaxRecordSize = 16384;
+// Slices at least this large are encrypted directly out of the write buffer as records of their
+// own. Runs of smaller slices are coalesced into one record to bound per-record overhead.
+constexpr uint64_t MinDirectWriteSize = 4096;
+// Maximum number of small slices coalesced into one record.
+constexpr uint64_t MaxCoalescedSlices = 16;
+// During the first bytes of a connection, while the TCP congestion window is still small, records
+// follow slice boundaries so that small writes aren't held back into larger records the peer can
+// only decrypt once fully received. Afterwards every record is full-size, which minimizes the
+// per-record framing, MAC and SSL_write() overhead for bulk transfers.
+constexpr uint64_t RecordSizeRampBytes = 128 * 1024;
+
 // This SslSocket will be used when SSL secret is not fetched from SDS server.
 class NotReadySslSocket : public Network::TransportSocket {
 public:
@@ -56,12 +72,34 @@ SslSocket::SslSocket(Envoy::Ssl::ContextSharedPtr ctx, InitialState state,
   }
 }
 
+SslSocket::~SslSocket() { unregisterPrivateKeyMethod(); }
+
 void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& callbacks) {
   ASSERT(!callbacks_);
   callbacks_ = &callbacks;
 
   BIO* bio = BIO_new_socket(callbacks_->ioHandle().fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+
+  if (ctx_->privateKeyMethodProvider() != nullptr) {
+    ctx_->privateKeyMethodProvider()->registerPrivateKeyMethod(
+        ssl_.get(), *this, callbacks_->connection().dispatcher());
+  }
+}
+
+void SslSocket::unregisterPrivateKeyMethod() {
+  if (callbacks_ != nullptr && ctx_->privateKeyMethodProvider() != nullptr) {
+    ctx_->privateKeyMethodProvider()->unregisterPrivateKeyMethod(ssl_.get());
+  }
+}
+
+void SslSocket::onPrivateKeyMethodComplete() {
+  ASSERT(!handshake_complete_);
+  // Resume the handshake, which picks up the result of the private key operation.
+  if (doHandshake() == PostIoAction::Close) {
+    ENVOY_CONN_LOG(debug, "handshake failed after private key operation", callbacks_->connection());
+    callbacks_->connection().close(Network::ConnectionCloseType::NoFlush);
+  }
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -131,6 +169,9 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
     ctx_->logHandshake(ssl_.get());
+    if (ctx_->kernelTlsOffload()) {
+      enableKernelTlsOffload();
+    }
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -143,6 +184,8 @@ PostIoAction SslSocket::doHandshake() {
     switch (err) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
+    // The handshake resumes from onPrivateKeyMethodComplete().
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
       return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
@@ -178,6 +221,89 @@ void SslSocket::drainErrorQueue() {
   }
 }
 
+void SslSocket::enableKernelTlsOffload() {
+  ASSERT(!kernel_tls_tx_);
+  kernel_tls_tx_ = KernelTls::enableTransmitOffload(ssl_.get(), callbacks_->ioHandle().fd());
+  ENVOY_CONN_LOG(debug, "kernel TLS transmit offload: {}", callbacks_->connection(),
+                 kernel_tls_tx_);
+  if (kernel_tls_tx_) {
+    ctx_->stats().kernel_tls_offload_.inc();
+  } else {
+    ctx_->stats().kernel_tls_offload_unavailable_.inc();
+  }
+}
+
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel frames and encrypts whatever is written to the socket, so this is the same write
+  // loop as a plain TCP socket.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = write_buffer.write(callbacks_->ioHandle());
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "kernel TLS write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+        return {PostIoAction::Close, total_bytes_written, false};
+      }
+      break;
+    }
+    ENVOY_CONN_LOG(trace, "kernel TLS write returns: {}", callbacks_->connection(), result.rc_);
+    total_bytes_written += result.rc_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
+uint64_t SslSocket::nextRecordSize(const Buffer::Instance& write_buffer) const {
+  if (bytes_written_ >= RecordSizeRampBytes) {
+    return std::min(write_buffer.length(), MaxRecordSize);
+  }
+
+  Buffer::RawSlice slices[MaxCoalescedSlices];
+  const uint64_t num_slices =
+      std::min(write_buffer.getRawSlices(slices, MaxCoalescedSlices), MaxCoalescedSlices);
+  uint64_t record_size = 0;
+  for (uint64_t i = 0; i < num_slices; i++) {
+    if (slices[i].len_ >= MinDirectWriteSize) {
+      if (record_size == 0) {
+        record_size = std::min(slices[i].len_, MaxRecordSize);
+      }
+      break;
+    }
+    if (record_size + slices[i].len_ > MaxRecordSize) {
+      break;
+    }
+    record_size += slices[i].len_;
+  }
+
+  if (record_size == 0) {
+    // Only empty slices were returned, fall back to coalescing a full record.
+    record_size = std::min(write_buffer.length(), MaxRecordSize);
+  }
+  return record_size;
+}
+
+const void* SslSocket::recordData(const Buffer::Instance& write_buffer, uint64_t record_size) {
+  // The record is either the start of the first slice, or spans several slices and is copied to
+  // the record buffer. Unlike linearize(), this copies the record only rather than all the slices
+  // it touches. A retried SSL_write() after SSL_ERROR_WANT_WRITE sees the same pointer and data
+  // either way, since the front of the write buffer is not drained in between.
+  Buffer::RawSlice slice;
+  if (write_buffer.getRawSlices(&slice, 1) > 0 && slice.len_ >= record_size) {
+    return slice.mem_;
+  }
+  ASSERT(record_size <= MaxRecordSize);
+  if (record_buffer_ == nullptr) {
+    record_buffer_ = std::make_unique<uint8_t[]>(MaxRecordSize);
+  }
+  write_buffer.copyOut(0, record_size, record_buffer_.get());
+  return record_buffer_.get();
+}
+
 Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_stream) {
   ASSERT(!shutdown_sent_ || write_buffer.length() == 0);
   if (!handshake_complete_) {
@@ -187,12 +313,16 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    bytes_to_write = nextRecordSize(write_buffer);
   }
 
   uint64_t total_bytes_written = 0;
@@ -202,15 +332,16 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
 
     // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
     // it again with the same parameters. This is done by tracking last write size, but not write
-    // data, since linearize() will return the same undrained data anyway.
+    // data, since recordData() will return the same undrained data anyway.
     ASSERT(bytes_to_write <= write_buffer.length());
-    int rc = SSL_write(ssl_.get(), write_buffer.linearize(bytes_to_write), bytes_to_write);
+    int rc = SSL_write(ssl_.get(), recordData(write_buffer, bytes_to_write), bytes_to_write);
     ENVOY_CONN_LOG(trace, "ssl write returns: {}", callbacks_->connection(), rc);
     if (rc > 0) {
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
+      bytes_written_ += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      bytes_to_write = nextRecordSize(write_buffer);
     } else {
       int err = SSL_get_error(ssl_.get(), rc);
       switch (err) {
@@ -240,6 +371,13 @@ void SslSocket::onConnected() { ASSERT(!handshake_complete_); }
 void SslSocket::shutdownSsl() {
   ASSERT(handshake_complete_);
   if (!shutdown_sent_ && callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_tx_) {
+      // BoringSSL no longer owns the write side, so the alert is sent through the kernel.
+      const bool sent = KernelTls::sendCloseNotify(callbacks_->ioHandle().fd());
+      ENVOY_CONN_LOG(debug, "kernel TLS shutdown: sent={}", callbacks_->connection(), sent);
+      shutdown_sent_ = true;
+      return;
+    }
     int rc = SSL_shutdown(ssl_.get());
     ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
     drainErrorQueue();
@@ -356,6 +494,9 @@ std::vector<std::string> SslSocket::dnsSansPeerCertificate() const {
 }
 
 void SslSocket::closeSocket(Network::ConnectionEvent) {
+  // A pending private key operation must not resume the handshake of a closed connection.
+  unregisterPrivateKeyMethod();
+
   // Attempt to send a shutdown before closing the socket. It's possible this won't go out if
   // there is no room on the socket. We can extend the state machine to handle this at some point
   // if needed.
@@ -466,19 +607,45 @@ ServerSslSocketFactory::ServerSslSocketFactory(Envoy::Ssl::ServerContextConfigPt
                                                const std::vector<std::string>& server_names)
     : manager_(manager), stats_scope_(stats_scope), stats_(generateStats("server", stats_scope)),
       config_(std::move(config)), server_names_(server_names),
-      ssl_ctx_(manager_.createSslServerContext(stats_scope_, *config_, server_names_)) {
+      ssl_ctx_(config_->lazyLoadCertificates()
+                   ? nullptr
+                   : manager_.createSslServerContext(stats_scope_, *config_, server_names_)),
+      lazy_load_pending_(config_->lazyLoadCertificates()) {
   config_->setSecretUpdateCallback([this]() { onAddOrUpdateSecret(); });
 }
 
+Envoy::Ssl::ServerContextSharedPtr ServerSslSocketFactory::lazyLoadContext() const {
+  absl::WriterMutexLock l(&ssl_ctx_mu_);
+  if (!lazy_load_pending_) {
+    return ssl_ctx_;
+  }
+  lazy_load_pending_ = false;
+  ENVOY_LOG(debug, "Loading certificates of lazily loaded TLS context.");
+  stats_.downstream_context_lazy_load_.inc();
+  try {
+    ssl_ctx_ = manager_.createSslServerContext(stats_scope_, *config_, server_names_);
+  } catch (const EnvoyException& e) {
+    // The connections of this filter chain fail until the next secret update.
+    ENVOY_LOG(warn, "Failed to load lazily loaded TLS context: {}", e.what());
+    stats_.downstream_context_lazy_load_error_.inc();
+  }
+  return ssl_ctx_;
+}
+
 Network::TransportSocketPtr
 ServerSslSocketFactory::createTransportSocket(Network::TransportSocketOptionsSharedPtr) const {
   // onAddOrUpdateSecret() could be invoked in the middle of checking the existence of ssl_ctx and
   // creating SslSocket using ssl_ctx. Capture ssl_ctx_ into a local variable so that we check and
   // use the same ssl_ctx to create SslSocket.
   Envoy::Ssl::ServerContextSharedPtr ssl_ctx;
+  bool lazy_load_pending;
   {
     absl::ReaderMutexLock l(&ssl_ctx_mu_);
     ssl_ctx = ssl_ctx_;
+    lazy_load_pending = lazy_load_pending_;
+  }
+  if (lazy_load_pending) {
+    ssl_ctx = lazyLoadContext();
   }
   if (ssl_ctx) {
     return std::make_unique<SslSocket>(std::move(ssl_ctx), InitialState::Server, nullptr);
@@ -495,7 +662,12 @@ void ServerSslSocketFactory::onAddOrUpdateSecret() {
   ENVOY_LOG(debug, "Secret is updated.");
   {
     absl::WriterMutexLock l(&ssl_ctx_mu_);
-    ssl_ctx_ = manager_.createSslServerContext(stats_scope_, *config_, server_names_);
+    if (config_->lazyLoadCertificates() && ssl_ctx_ == nullptr) {
+      // Nothing uses the context yet, so it is loaded from the updated secrets when it is needed.
+      lazy_load_pending_ = true;
+    } else {
+      ssl_ctx_ = manager_.createSslServerContext(stats_scope_, *config_, server_names_);
+    }
   }
   stats_.ssl_context_update_by_sds_.inc();
 }
@@ -6,6 +6,7 @@
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/secret/secret_callbacks.h"
+#include "envoy/ssl/private_key.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
@@ -27,7 +28,9 @@ namespace Tls {
 #define ALL_SSL_SOCKET_FACTORY_STATS(COUNTER)                                 \
   COUNTER(ssl_context_update_by_sds)                                          \
   COUNTER(upstream_context_secrets_not_ready)                                 \
-  COUNTER(downstream_context_secrets_not_ready)
+  COUNTER(downstream_context_secrets_not_ready)                               \
+  COUNTER(downstream_context_lazy_load)                                       \
+  COUNTER(downstream_context_lazy_load_error)
 // clang-format on
 
 /**
@@ -41,10 +44,12 @@ enum class InitialState { Client, Server };
 
 class SslSocket : public Network::TransportSocket,
                   public Envoy::Ssl::ConnectionInfo,
+                  public Envoy::Ssl::PrivateKeyConnectionCallbacks,
                   protected Logger::Loggable<Logger::Id::connection> {
 public:
   SslSocket(Envoy::Ssl::ContextSharedPtr ctx, InitialState state,
             Network::TransportSocketOptionsSharedPtr transport_socket_options);
+  ~SslSocket();
 
   // Ssl::Connection
   bool peerCertificatePresented() const override;
@@ -72,19 +77,42 @@ public:
   void onConnected() override;
   const Ssl::ConnectionInfo* ssl() const override { return this; }
 
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override;
+
   SSL* rawSslForTest() const { return ssl_.get(); }
 
 private:
   Network::PostIoAction doHandshake();
   void drainErrorQueue();
   void shutdownSsl();
+  void enableKernelTlsOffload();
+  void unregisterPrivateKeyMethod();
+  /**
+   * @return the number of bytes from the front of the write buffer to pass to the next
+   *         SSL_write(). Records follow slice boundaries during the initial ramp of the
+   *         connection, and are full-size afterwards.
+   */
+  uint64_t nextRecordSize(const Buffer::Instance& write_buffer) const;
+  /**
+   * @return a pointer to the first record_size bytes of the write buffer, which are copied to the
+   *         record buffer only when the record spans more than one slice.
+   */
+  const void* recordData(const Buffer::Instance& write_buffer, uint64_t record_size);
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
 
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImplSharedPtr ctx_;
   bssl::UniquePtr<SSL> ssl_;
   bool handshake_complete_{};
   bool shutdown_sent_{};
+  // Set once the kernel encrypts outgoing records, after which writes bypass SSL_write().
+  bool kernel_tls_tx_{};
   uint64_t bytes_to_retry_{};
+  // Bytes passed to SSL_write() so far, to tell when the initial ramp of the connection is over.
+  uint64_t bytes_written_{};
+  // Holds a record that spans several slices of the write buffer, allocated on first use.
+  std::unique_ptr<uint8_t[]> record_buffer_;
   std::string failure_reason_;
   mutable std::string cached_sha_256_peer_certificate_digest_;
   mutable std::string cached_url_encoded_pem_encoded_peer_certificate_;
@@ -130,13 +158,19 @@ public:
   void onAddOrUpdateSecret() override;
 
 private:
+  // Creates the context of a factory that loads its certificates lazily, unless another connection
+  // already tried since the last secret update.
+  Envoy::Ssl::ServerContextSharedPtr lazyLoadContext() const;
+
   Ssl::ContextManager& manager_;
   Stats::Scope& stats_scope_;
   SslSocketFactoryStats stats_;
   Envoy::Ssl::ServerContextConfigPtr config_;
   const std::vector<std::string> server_names_;
   mutable absl::Mutex ssl_ctx_mu_;
-  Envoy::Ssl::ServerContextSharedPtr ssl_ctx_ GUARDED_BY(ssl_ctx_mu_);
+  mutable Envoy::Ssl::ServerContextSharedPtr ssl_ctx_ GUARDED_BY(ssl_ctx_mu_);
+  // True until the first connection of a lazily loaded factory creates the context.
+  mutable bool lazy_load_pending_ GUARDED_BY(ssl_ctx_mu_);
 };
 
 } // namespace Tls
@@ -0,0 +1,347 @@
+#include "extensions/transport_sockets/tls/thread_pool_private_key_provider.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/protobuf/utility.h"
+
+#include "openssl/digest.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+struct ThreadPoolPrivateKeyMethodProvider::Operation {
+  // Inputs, immutable once the operation is queued.
+  bssl::UniquePtr<EVP_PKEY> key_;
+  bool decrypt_{};
+  uint16_t signature_algorithm_{};
+  std::vector<uint8_t> input_;
+  MonotonicTime queued_time_;
+
+  // Written by the signing thread before the completion is posted to the dispatcher.
+  std::vector<uint8_t> output_;
+  bool success_{};
+
+  // Only accessed on the dispatcher thread of the connection.
+  ThreadPoolPrivateKeyMethodProvider* provider_{};
+  Envoy::Ssl::PrivateKeyConnectionCallbacks* callbacks_{};
+  bool done_{};
+
+  Thread::MutexBasicLockable lock_;
+  // Cleared when the connection unregisters, after which the completion is not posted anymore.
+  Event::Dispatcher* dispatcher_ GUARDED_BY(lock_){};
+};
+
+struct ThreadPoolPrivateKeyMethodProvider::ConnectionState {
+  ThreadPoolPrivateKeyMethodProvider& provider_;
+  Envoy::Ssl::PrivateKeyConnectionCallbacks& callbacks_;
+  Event::Dispatcher& dispatcher_;
+  OperationSharedPtr pending_;
+};
+
+namespace {
+
+int connectionStateIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int ssl_context_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(ssl_context_index >= 0, "");
+    return ssl_context_index;
+  }());
+}
+
+} // namespace
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::api::v2::auth::PrivateKeyProvider::ThreadPool& config,
+    Thread::ThreadFactory& thread_factory, TimeSource& time_source, Stats::Scope& scope)
+    : max_pending_operations_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pending_operations, 1024)),
+      time_source_(time_source),
+      stats_({ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(
+          POOL_COUNTER_PREFIX(scope, "ssl.private_key_thread_pool."),
+          POOL_GAUGE_PREFIX(scope, "ssl.private_key_thread_pool."),
+          POOL_HISTOGRAM_PREFIX(scope, "ssl.private_key_thread_pool."))}) {
+  const uint32_t threads = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, threads, 1);
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.emplace_back(thread_factory.createThread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+ThreadPoolPrivateKeyMethodProvider::~ThreadPoolPrivateKeyMethodProvider() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    queue_event_.notifyAll();
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Envoy::Ssl::PrivateKeyConnectionCallbacks& callbacks,
+    Event::Dispatcher& dispatcher) {
+  ASSERT(connectionState(ssl) == nullptr);
+  SSL_set_ex_data(ssl, connectionStateIndex(),
+                  new ConnectionState{*this, callbacks, dispatcher, nullptr});
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr) {
+    return;
+  }
+  if (state->pending_ != nullptr) {
+    Thread::LockGuard lock(state->pending_->lock_);
+    state->pending_->dispatcher_ = nullptr;
+  }
+  SSL_set_ex_data(ssl, connectionStateIndex(), nullptr);
+  delete state;
+}
+
+const SSL_PRIVATE_KEY_METHOD*
+ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() const {
+  static const SSL_PRIVATE_KEY_METHOD method = {
+      ThreadPoolPrivateKeyMethodProvider::sign,
+      ThreadPoolPrivateKeyMethodProvider::decrypt,
+      ThreadPoolPrivateKeyMethodProvider::complete,
+  };
+  return &method;
+}
+
+ThreadPoolPrivateKeyMethodProvider::ConnectionState*
+ThreadPoolPrivateKeyMethodProvider::connectionState(SSL* ssl) {
+  return static_cast<ConnectionState*>(SSL_get_ex_data(ssl, connectionStateIndex()));
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyMethodProvider::sign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                         uint16_t signature_algorithm, const uint8_t* in,
+                                         size_t in_len) {
+  ConnectionState* state = connectionState(ssl);
+  EVP_PKEY* key = SSL_get_privatekey(ssl);
+  if (state == nullptr || key == nullptr ||
+      EVP_PKEY_id(key) != SSL_get_signature_algorithm_key_type(signature_algorithm)) {
+    return ssl_private_key_failure;
+  }
+
+  auto operation = std::make_shared<Operation>();
+  EVP_PKEY_up_ref(key);
+  operation->key_.reset(key);
+  operation->signature_algorithm_ = signature_algorithm;
+  operation->input_.assign(in, in + in_len);
+  return state->provider_.submit(*state, std::move(operation), out, out_len, max_out);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::decrypt(SSL* ssl, uint8_t* out,
+                                                                     size_t* out_len,
+                                                                     size_t max_out,
+                                                                     const uint8_t* in,
+                                                                     size_t in_len) {
+  ConnectionState* state = connectionState(ssl);
+  EVP_PKEY* key = SSL_get_privatekey(ssl);
+  if (state == nullptr || key == nullptr || EVP_PKEY_id(key) != EVP_PKEY_RSA) {
+    return ssl_private_key_failure;
+  }
+
+  auto operation = std::make_shared<Operation>();
+  EVP_PKEY_up_ref(key);
+  operation->key_.reset(key);
+  operation->decrypt_ = true;
+  operation->input_.assign(in, in + in_len);
+  return state->provider_.submit(*state, std::move(operation), out, out_len, max_out);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::complete(SSL* ssl, uint8_t* out,
+                                                                      size_t* out_len,
+                                                                      size_t max_out) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr || state->pending_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!state->pending_->done_) {
+    return ssl_private_key_retry;
+  }
+
+  OperationSharedPtr operation = std::move(state->pending_);
+  return copyResult(*operation, out, out_len, max_out);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::submit(ConnectionState& state,
+                                                                    OperationSharedPtr operation,
+                                                                    uint8_t* out, size_t* out_len,
+                                                                    size_t max_out) {
+  ASSERT(state.pending_ == nullptr);
+  stats_.operations_.inc();
+
+  {
+    Thread::LockGuard lock(lock_);
+    if (queue_.size() < max_pending_operations_) {
+      operation->queued_time_ = time_source_.monotonicTime();
+      operation->provider_ = this;
+      operation->callbacks_ = &state.callbacks_;
+      {
+        Thread::LockGuard operation_lock(operation->lock_);
+        operation->dispatcher_ = &state.dispatcher_;
+      }
+      state.pending_ = operation;
+      queue_.push_back(std::move(operation));
+      stats_.pending_.inc();
+      queue_event_.notifyOne();
+      return ssl_private_key_retry;
+    }
+  }
+
+  // The signing threads are saturated. Blocking this worker is preferable to growing the queue
+  // without bound, as handshakes queued behind a long backlog would time out anyway.
+  ENVOY_LOG(debug, "private key operation queue is full, performing the operation synchronously");
+  stats_.overflow_.inc();
+  operation->success_ = perform(*operation);
+  if (!operation->success_) {
+    stats_.failed_.inc();
+  }
+  return copyResult(*operation, out, out_len, max_out);
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::perform(Operation& operation) {
+  EVP_PKEY* key = operation.key_.get();
+
+  if (operation.decrypt_) {
+    RSA* rsa = EVP_PKEY_get0_RSA(key);
+    if (rsa == nullptr) {
+      return false;
+    }
+    size_t out_len;
+    operation.output_.resize(RSA_size(rsa));
+    if (!RSA_decrypt(rsa, &out_len, operation.output_.data(), operation.output_.size(),
+                     operation.input_.data(), operation.input_.size(), RSA_NO_PADDING)) {
+      return false;
+    }
+    operation.output_.resize(out_len);
+    return true;
+  }
+
+  // This mirrors what BoringSSL does itself when no private key method is installed.
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pctx;
+  const EVP_MD* md = SSL_get_signature_algorithm_digest(operation.signature_algorithm_);
+  if (!EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, key)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(operation.signature_algorithm_) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1 /* salt length is digest length */))) {
+    return false;
+  }
+  size_t out_len = EVP_PKEY_size(key);
+  operation.output_.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), operation.output_.data(), &out_len, operation.input_.data(),
+                      operation.input_.size())) {
+    return false;
+  }
+  operation.output_.resize(out_len);
+  return true;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::copyResult(const Operation& operation,
+                                                                        uint8_t* out,
+                                                                        size_t* out_len,
+                                                                        size_t max_out) {
+  if (!operation.success_ || operation.output_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(operation.output_.begin(), operation.output_.end(), out);
+  *out_len = operation.output_.size();
+  return ssl_private_key_success;
+}
+
+void ThreadPoolPrivateKeyMethodProvider::onComplete(const OperationSharedPtr& operation) {
+  {
+    Thread::LockGuard lock(operation->lock_);
+    if (operation->dispatcher_ == nullptr) {
+      // The connection went away while its completion was queued on the dispatcher.
+      return;
+    }
+  }
+
+  // The connection is still registered, so its TLS context keeps the provider alive.
+  ThreadPoolPrivateKeyMethodProvider& provider = *operation->provider_;
+  operation->done_ = true;
+  provider.stats_.latency_us_.recordValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(provider.time_source_.monotonicTime() -
+                                                            operation->queued_time_)
+          .count());
+  // The handshake is resumed synchronously, which may close the connection and unregister it.
+  operation->callbacks_->onPrivateKeyMethodComplete();
+}
+
+void ThreadPoolPrivateKeyMethodProvider::threadRoutine() {
+  while (true) {
+    OperationSharedPtr operation;
+    {
+      Thread::LockGuard lock(lock_);
+      while (queue_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        queue_event_.wait(lock_);
+      }
+      if (exit_) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+      stats_.pending_.dec();
+    }
+
+    operation->success_ = perform(*operation);
+    if (!operation->success_) {
+      stats_.failed_.inc();
+    }
+
+    Thread::LockGuard lock(operation->lock_);
+    if (operation->dispatcher_ != nullptr) {
+      // The connection may unregister before this runs, which onComplete() checks again.
+      operation->dispatcher_->post([operation]() -> void { onComplete(operation); });
+    }
+  }
+}
+
+ThreadPoolPrivateKeyMethodProviderManager::ThreadPoolPrivateKeyMethodProviderManager(
+    Thread::ThreadFactory& thread_factory, TimeSource& time_source, Stats::Scope& scope)
+    : thread_factory_(thread_factory), time_source_(time_source), scope_(scope) {}
+
+ThreadPoolPrivateKeyMethodProviderSharedPtr ThreadPoolPrivateKeyMethodProviderManager::getProvider(
+    const envoy::api::v2::auth::PrivateKeyProvider::ThreadPool& config) {
+  // The configuration has no map fields, so equal configurations serialize identically.
+  const std::string key = config.SerializeAsString();
+  auto it = providers_.find(key);
+  if (it != providers_.end()) {
+    ThreadPoolPrivateKeyMethodProviderSharedPtr provider = it->second.lock();
+    if (provider != nullptr) {
+      return provider;
+    }
+  }
+
+  for (auto expired = providers_.begin(); expired != providers_.end();) {
+    if (expired->second.expired()) {
+      providers_.erase(expired++);
+    } else {
+      ++expired;
+    }
+  }
+  auto provider = std::make_shared<ThreadPoolPrivateKeyMethodProvider>(config, thread_factory_,
+                                                                       time_source_, scope_);
+  providers_[key] = provider;
+  return provider;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/v2/auth/cert.pb.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/ssl/private_key.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+// clang-format off
+#define ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(COUNTER, GAUGE, HISTOGRAM)                      \
+  COUNTER(operations)                                                                              \
+  COUNTER(overflow)                                                                                \
+  COUNTER(failed)                                                                                  \
+  GAUGE(pending)                                                                                   \
+  HISTOGRAM(latency_us)
+// clang-format on
+
+/**
+ * Wrapper struct for thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyProviderStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                             GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * Performs the private key operations of handshakes on a pool of threads, using the private key
+ * loaded into the SSL_CTX of the selected certificate. Connections are notified on their own
+ * dispatcher once their operation completes. When too many operations are already waiting, new
+ * ones are performed synchronously instead so that the queue stays bounded.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public Envoy::Ssl::PrivateKeyMethodProvider,
+                                           Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::api::v2::auth::PrivateKeyProvider::ThreadPool& config,
+      Thread::ThreadFactory& thread_factory, TimeSource& time_source, Stats::Scope& scope);
+  ~ThreadPoolPrivateKeyMethodProvider();
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Envoy::Ssl::PrivateKeyConnectionCallbacks& callbacks,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  const SSL_PRIVATE_KEY_METHOD* getBoringSslPrivateKeyMethod() const override;
+
+  const ThreadPoolPrivateKeyProviderStats& stats() const { return stats_; }
+
+private:
+  struct Operation;
+  typedef std::shared_ptr<Operation> OperationSharedPtr;
+  struct ConnectionState;
+
+  static ssl_private_key_result_t sign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                       uint16_t signature_algorithm, const uint8_t* in,
+                                       size_t in_len);
+  static ssl_private_key_result_t decrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                          const uint8_t* in, size_t in_len);
+  static ssl_private_key_result_t complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out);
+  static ConnectionState* connectionState(SSL* ssl);
+  static bool perform(Operation& operation);
+  static ssl_private_key_result_t copyResult(const Operation& operation, uint8_t* out,
+                                             size_t* out_len, size_t max_out);
+
+  ssl_private_key_result_t submit(ConnectionState& state, OperationSharedPtr operation,
+                                  uint8_t* out, size_t* out_len, size_t max_out);
+  static void onComplete(const OperationSharedPtr& operation);
+  void threadRoutine();
+
+  const uint32_t max_pending_operations_;
+  TimeSource& time_source_;
+  ThreadPoolPrivateKeyProviderStats stats_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar queue_event_;
+  std::deque<OperationSharedPtr> queue_ GUARDED_BY(lock_);
+  bool exit_ GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+typedef std::shared_ptr<ThreadPoolPrivateKeyMethodProvider>
+    ThreadPoolPrivateKeyMethodProviderSharedPtr;
+
+/**
+ * Shares thread pool private key providers between the TLS contexts of the server, so that all
+ * contexts with the same thread pool configuration use a single pool of threads rather than each
+ * starting its own. Registered with the singleton manager and only used on the main thread.
+ */
+class ThreadPoolPrivateKeyMethodProviderManager : public Singleton::Instance {
+public:
+  ThreadPoolPrivateKeyMethodProviderManager(Thread::ThreadFactory& thread_factory,
+                                            TimeSource& time_source, Stats::Scope& scope);
+
+  /**
+   * @return the provider for the given configuration. The provider is created if no live provider
+   *         has an equal configuration.
+   */
+  ThreadPoolPrivateKeyMethodProviderSharedPtr
+  getProvider(const envoy::api::v2::auth::PrivateKeyProvider::ThreadPool& config);
+
+private:
+  Thread::ThreadFactory& thread_factory_;
+  TimeSource& time_source_;
+  Stats::Scope& scope_;
+  // Keyed by the serialized configuration.
+  absl::flat_hash_map<std::string, std::weak_ptr<ThreadPoolPrivateKeyMethodProvider>> providers_;
+};
+
+typedef std::shared_ptr<ThreadPoolPrivateKeyMethodProviderManager>
+    ThreadPoolPrivateKeyMethodProviderManagerSharedPtr;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -6,6 +6,7 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/timespan.h"
 
+#include "common/common/fmt.h"
 #include "common/network/connection_impl.h"
 #include "common/network/utility.h"
 
@@ -17,6 +18,11 @@ namespace Server {
 ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
     : logger_(logger), dispatcher_(dispatcher), disable_listeners_(false) {}
 
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             uint32_t worker_index)
+    : logger_(logger), dispatcher_(dispatcher), worker_index_(worker_index),
+      disable_listeners_(false) {}
+
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
   ActiveListenerPtr l(new ActiveListener(*this, config));
   if (disable_listeners_) {
@@ -25,6 +31,29 @@ void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
   listeners_.emplace_back(config.socket().localAddress(), std::move(l));
 }
 
+void ConnectionHandlerImpl::updateListener(uint64_t listener_tag,
+                                           Network::ListenerConfig& config) {
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_tag_ == listener_tag) {
+      listener.second->updateListenerConfig(config);
+      return;
+    }
+  }
+  addListener(config);
+}
+
+void ConnectionHandlerImpl::removeFilterChains(
+    const std::vector<const Network::FilterChain*>& filter_chains) {
+  const std::unordered_set<const Network::FilterChain*> removed(filter_chains.begin(),
+                                                                filter_chains.end());
+  for (auto& listener : listeners_) {
+    listener.second->removeFilterChains(removed);
+  }
+  // The filter chains may be destroyed as soon as this returns, so the connections that were
+  // created from them are destroyed now rather than on the next dispatcher iteration.
+  dispatcher_.clearDeferredDeleteList();
+}
+
 void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
   for (auto listener = listeners_.begin(); listener != listeners_.end();) {
     if (listener->second->listener_tag_ == listener_tag) {
@@ -38,14 +67,14 @@ void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
 void ConnectionHandlerImpl::stopListeners(uint64_t listener_tag) {
   for (auto& listener : listeners_) {
     if (listener.second->listener_tag_ == listener_tag) {
-      listener.second->listener_.reset();
+      listener.second->stopListening();
     }
   }
 }
 
 void ConnectionHandlerImpl::stopListeners() {
   for (auto& listener : listeners_) {
-    listener.second->listener_.reset();
+    listener.second->stopListening();
   }
 }
 
@@ -70,13 +99,17 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
   parent_.dispatcher_.deferredDelete(std::move(removed));
   ASSERT(parent_.num_connections_ > 0);
   parent_.num_connections_--;
+  ASSERT(num_listener_connections_ > 0);
+  num_listener_connections_--;
 }
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerConfig& config)
     : ActiveListener(
           parent,
-          parent.dispatcher_.createListener(config.socket(), *this, config.bindToPort(),
+          parent.dispatcher_.createListener(config.workerSocket(parent.worker_index_.value_or(0)),
+                                            *this,
+                                            config.bindToPort(),
                                             config.handOffRestoredDestinationConnections()),
           config) {}
 
@@ -85,10 +118,20 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
                                                       Network::ListenerConfig& config)
     : parent_(parent), listener_(std::move(listener)),
       stats_(generateStats(config.listenerScope())),
+      per_handler_scope_(config.listenerScope().createScope(
+          parent.worker_index_.has_value() ? fmt::format("worker_{}.", parent.worker_index_.value())
+                                           : "main_thread.")),
+      per_handler_stats_(generatePerHandlerStats(*per_handler_scope_)),
       listener_filters_timeout_(config.listenerFiltersTimeout()),
-      listener_tag_(config.listenerTag()), config_(config) {}
+      listener_tag_(config.listenerTag()), config_(&config) {
+  if (listener_ != nullptr) {
+    config_->connectionBalancer().registerHandler(*this);
+  }
+}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
+  stopListening();
+
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
   while (!sockets_.empty()) {
@@ -103,6 +146,34 @@ ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
   parent_.dispatcher_.clearDeferredDeleteList();
 }
 
+void ConnectionHandlerImpl::ActiveListener::stopListening() {
+  if (listener_ != nullptr) {
+    config_->connectionBalancer().unregisterHandler(*this);
+    listener_.reset();
+  }
+}
+
+void ConnectionHandlerImpl::ActiveListener::updateListenerConfig(Network::ListenerConfig& config) {
+  if (listener_ != nullptr) {
+    config_->connectionBalancer().unregisterHandler(*this);
+    config.connectionBalancer().registerHandler(*this);
+  }
+  config_ = &config;
+  listener_filters_timeout_ = config.listenerFiltersTimeout();
+  listener_tag_ = config.listenerTag();
+}
+
+void ConnectionHandlerImpl::ActiveListener::removeFilterChains(
+    const std::unordered_set<const Network::FilterChain*>& filter_chains) {
+  for (auto connection = connections_.begin(); connection != connections_.end();) {
+    // Closing the connection removes it from the list.
+    ActiveConnection& active_connection = **connection++;
+    if (filter_chains.count(active_connection.filter_chain_) > 0) {
+      active_connection.connection_->close(Network::ConnectionCloseType::NoFlush);
+    }
+  }
+}
+
 Network::Listener*
 ConnectionHandlerImpl::findListenerByAddress(const Network::Address::Instance& address) {
   ActiveListener* listener = findActiveListenerByAddress(address);
@@ -188,8 +259,9 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
       // Hands off connections redirected by iptables to the listener associated with the
       // original destination address. Pass 'hand_off_restored_destination_connections' as false to
       // prevent further redirection.
-      new_listener->onAccept(std::move(socket_),
-                             false /* hand_off_restored_destination_connections */);
+      // The socket is not rebalanced again since it has already been through listener filters.
+      new_listener->onAcceptWorker(std::move(socket_),
+                                   false /* hand_off_restored_destination_connections */);
     } else {
       // Set default transport protocol if none of the listener filters did it.
       if (socket_->detectedTransportProtocol().empty()) {
@@ -209,11 +281,51 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
 
 void ConnectionHandlerImpl::ActiveListener::onAccept(
     Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
+  // Balance the socket before any listener filters run so that no per connection state needs to
+  // move between workers.
+  Network::BalancedConnectionHandler& target_handler =
+      config_->connectionBalancer().pickTargetHandler(*this);
+  if (&target_handler != this) {
+    per_handler_stats_.downstream_cx_rebalanced_.inc();
+    target_handler.post(std::move(socket));
+    return;
+  }
+
+  onAcceptWorker(std::move(socket), hand_off_restored_destination_connections);
+}
+
+void ConnectionHandlerImpl::ActiveListener::post(Network::ConnectionSocketPtr&& socket) {
+  // The dispatcher copies the posted callback, so the socket is wrapped in a shared_ptr that can
+  // be captured.
+  auto socket_to_rebalance = std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  ConnectionHandlerImpl& parent = parent_;
+  const uint64_t listener_tag = listener_tag_;
+  parent.dispatcher_.post([socket_to_rebalance, &parent, listener_tag]() -> void {
+    // A listener that was stopped while the socket was in flight still takes the connection, as
+    // it would have had it accepted the socket itself. If the listener has been removed the
+    // socket is closed when it goes out of scope.
+    for (const auto& listener : parent.listeners_) {
+      ActiveListener& active_listener = *listener.second;
+      if (active_listener.listener_tag_ == listener_tag) {
+        // The socket has arrived, so its reservation is replaced by the connection it becomes.
+        ASSERT(active_listener.num_listener_connections_ > 0);
+        active_listener.num_listener_connections_--;
+        active_listener.onAcceptWorker(
+            std::move(*socket_to_rebalance),
+            active_listener.config_->handOffRestoredDestinationConnections());
+        return;
+      }
+    }
+  });
+}
+
+void ConnectionHandlerImpl::ActiveListener::onAcceptWorker(
+    Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
   auto active_socket = std::make_unique<ActiveSocket>(*this, std::move(socket),
                                                       hand_off_restored_destination_connections);
 
   // Create and run the filters
-  config_.filterChainFactory().createListenerFilterChain(*active_socket);
+  config_->filterChainFactory().createListenerFilterChain(*active_socket);
   active_socket->continueFilterChain(true);
 
   // Move active_socket to the sockets_ list if filter iteration needs to continue later.
@@ -226,7 +338,7 @@ void ConnectionHandlerImpl::ActiveListener::onAccept(
 
 void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSocketPtr&& socket) {
   // Find matching filter chain.
-  const auto filter_chain = config_.filterChainManager().findFilterChain(*socket);
+  const auto filter_chain = config_->filterChainManager().findFilterChain(*socket);
   if (filter_chain == nullptr) {
     ENVOY_LOG_TO_LOGGER(parent_.logger_, debug,
                         "closing connection: no matching filter chain found");
@@ -238,9 +350,9 @@ void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSoc
   auto transport_socket = filter_chain->transportSocketFactory().createTransportSocket(nullptr);
   Network::ConnectionPtr new_connection =
       parent_.dispatcher_.createServerConnection(std::move(socket), std::move(transport_socket));
-  new_connection->setBufferLimits(config_.perConnectionBufferLimitBytes());
+  new_connection->setBufferLimits(config_->perConnectionBufferLimitBytes());
 
-  const bool empty_filter_chain = !config_.filterChainFactory().createNetworkFilterChain(
+  const bool empty_filter_chain = !config_->filterChainFactory().createNetworkFilterChain(
       *new_connection, filter_chain->networkFilterFactories());
   if (empty_filter_chain) {
     ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, debug, "closing connection: no filters",
@@ -249,17 +361,22 @@ void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSoc
     return;
   }
 
-  onNewConnection(std::move(new_connection));
+  addConnection(std::move(new_connection), filter_chain);
 }
 
 void ConnectionHandlerImpl::ActiveListener::onNewConnection(
     Network::ConnectionPtr&& new_connection) {
+  addConnection(std::move(new_connection), nullptr);
+}
+
+void ConnectionHandlerImpl::ActiveListener::addConnection(
+    Network::ConnectionPtr&& new_connection, const Network::FilterChain* filter_chain) {
   ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, debug, "new connection", *new_connection);
 
   // If the connection is already closed, we can just let this connection immediately die.
   if (new_connection->state() != Network::Connection::State::Closed) {
-    ActiveConnectionPtr active_connection(
-        new ActiveConnection(*this, std::move(new_connection), parent_.dispatcher_.timeSource()));
+    ActiveConnectionPtr active_connection(new ActiveConnection(
+        *this, std::move(new_connection), filter_chain, parent_.dispatcher_.timeSource()));
     active_connection->moveIntoList(std::move(active_connection), connections_);
     parent_.num_connections_++;
   }
@@ -267,8 +384,9 @@ void ConnectionHandlerImpl::ActiveListener::onNewConnection(
 
 ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listener,
                                                           Network::ConnectionPtr&& new_connection,
+                                                          const Network::FilterChain* filter_chain,
                                                           TimeSource& time_source)
-    : listener_(listener), connection_(std::move(new_connection)),
+    : listener_(listener), connection_(std::move(new_connection)), filter_chain_(filter_chain),
       conn_length_(new Stats::Timespan(listener_.stats_.downstream_cx_length_ms_, time_source)) {
   // We just universally set no delay on connections. Theoretically we might at some point want
   // to make this configurable.
@@ -276,10 +394,14 @@ ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listen
   connection_->addConnectionCallbacks(*this);
   listener_.stats_.downstream_cx_total_.inc();
   listener_.stats_.downstream_cx_active_.inc();
+  listener_.per_handler_stats_.downstream_cx_total_.inc();
+  listener_.per_handler_stats_.downstream_cx_active_.inc();
+  listener_.num_listener_connections_++;
 }
 
 ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
   listener_.stats_.downstream_cx_active_.dec();
+  listener_.per_handler_stats_.downstream_cx_active_.dec();
   listener_.stats_.downstream_cx_destroy_.inc();
   conn_length_->complete();
 }
@@ -288,5 +410,9 @@ ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
+PerHandlerListenerStats ConnectionHandlerImpl::generatePerHandlerStats(Stats::Scope& scope) {
+  return {ALL_PER_HANDLER_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+}
+
 } // namespace Server
 } // namespace Envoy
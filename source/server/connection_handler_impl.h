@@ -4,10 +4,13 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <unordered_set>
+#include <vector>
 
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -19,6 +22,7 @@
 #include "common/common/linked_object.h"
 #include "common/common/non_copyable.h"
 
+#include "absl/types/optional.h"
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -42,6 +46,20 @@ struct ListenerStats {
   ALL_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+// clang-format off
+#define ALL_PER_HANDLER_LISTENER_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(downstream_cx_total)                                                                     \
+  COUNTER(downstream_cx_rebalanced)                                                                \
+  GAUGE  (downstream_cx_active)
+// clang-format on
+
+/**
+ * Wrapper struct for per-handler listener stats. @see stats_macros.h
+ */
+struct PerHandlerListenerStats {
+  ALL_PER_HANDLER_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Server side connection handler. This is used both by workers as well as the
  * main thread for non-threaded listeners.
@@ -49,10 +67,19 @@ struct ListenerStats {
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
   ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param worker_index supplies the index of the worker owning the handler. Listeners that have
+   *        a listen socket per worker are bound to the socket of this worker, and per worker
+   *        listener stats are scoped by it. Handlers without an index run on the main thread.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        uint32_t worker_index);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
   void addListener(Network::ListenerConfig& config) override;
+  void updateListener(uint64_t listener_tag, Network::ListenerConfig& config) override;
+  void removeFilterChains(const std::vector<const Network::FilterChain*>& filter_chains) override;
   void removeListeners(uint64_t listener_tag) override;
   void stopListeners(uint64_t listener_tag) override;
   void stopListeners() override;
@@ -73,7 +100,8 @@ private:
   /**
    * Wrapper for an active listener owned by this handler.
    */
-  struct ActiveListener : public Network::ListenerCallbacks {
+  struct ActiveListener : public Network::ListenerCallbacks,
+                          public Network::BalancedConnectionHandler {
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
@@ -86,6 +114,34 @@ private:
                   bool hand_off_restored_destination_connections) override;
     void onNewConnection(Network::ConnectionPtr&& new_connection) override;
 
+    // Network::BalancedConnectionHandler
+    uint64_t numConnections() const override { return num_listener_connections_; }
+    void incNumConnections() override { ++num_listener_connections_; }
+    void post(Network::ConnectionSocketPtr&& socket) override;
+
+    /**
+     * Run the listener filters on a socket that has been assigned to this handler, either by
+     * accepting it or by being rebalanced from another worker.
+     */
+    void onAcceptWorker(Network::ConnectionSocketPtr&& socket,
+                        bool hand_off_restored_destination_connections);
+
+    /**
+     * Stop accepting new connections and stop taking part in connection balancing.
+     */
+    void stopListening();
+
+    /**
+     * Switch to a new version of the listener configuration, keeping the listen socket, the
+     * sockets running listener filters and the connections.
+     */
+    void updateListenerConfig(Network::ListenerConfig& config);
+
+    /**
+     * Close the connections created from any of the given filter chains.
+     */
+    void removeFilterChains(const std::unordered_set<const Network::FilterChain*>& filter_chains);
+
     /**
      * Remove and destroy an active connection.
      * @param connection supplies the connection to remove.
@@ -97,14 +153,26 @@ private:
      */
     void newConnection(Network::ConnectionSocketPtr&& socket);
 
+    /**
+     * Take ownership of a new connection created from filter_chain.
+     */
+    void addConnection(Network::ConnectionPtr&& new_connection,
+                       const Network::FilterChain* filter_chain);
+
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
+    Stats::ScopePtr per_handler_scope_;
+    PerHandlerListenerStats per_handler_stats_;
+    // Connections owned by this handler plus sockets rebalanced to it that have not arrived yet.
+    // This is read by the connection balancer from other workers.
+    std::atomic<uint64_t> num_listener_connections_{};
     std::list<ActiveSocketPtr> sockets_;
     std::list<ActiveConnectionPtr> connections_;
-    const std::chrono::milliseconds listener_filters_timeout_;
-    const uint64_t listener_tag_;
-    Network::ListenerConfig& config_;
+    // These change when the listener configuration is updated in place.
+    std::chrono::milliseconds listener_filters_timeout_;
+    uint64_t listener_tag_;
+    Network::ListenerConfig* config_;
   };
 
   typedef std::unique_ptr<ActiveListener> ActiveListenerPtr;
@@ -116,7 +184,7 @@ private:
                             public Event::DeferredDeletable,
                             public Network::ConnectionCallbacks {
     ActiveConnection(ActiveListener& listener, Network::ConnectionPtr&& new_connection,
-                     TimeSource& time_system);
+                     const Network::FilterChain* filter_chain, TimeSource& time_system);
     ~ActiveConnection();
 
     // Network::ConnectionCallbacks
@@ -132,6 +200,8 @@ private:
 
     ActiveListener& listener_;
     Network::ConnectionPtr connection_;
+    // The filter chain the connection was created from, if any.
+    const Network::FilterChain* const filter_chain_;
     Stats::TimespanPtr conn_length_;
   };
 
@@ -177,9 +247,11 @@ private:
   };
 
   static ListenerStats generateStats(Stats::Scope& scope);
+  static PerHandlerListenerStats generatePerHandlerStats(Stats::Scope& scope);
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const absl::optional<uint32_t> worker_index_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
   std::atomic<uint64_t> num_connections_{};
   bool disable_listeners_;
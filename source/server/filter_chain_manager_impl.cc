@@ -0,0 +1,358 @@
+#include "server/filter_chain_manager_impl.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/empty_string.h"
+#include "common/common/fmt.h"
+#include "common/network/address_impl.h"
+#include "common/network/cidr_range.h"
+#include "common/network/utility.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Server {
+
+constexpr FilterChainManagerImpl::NodeIndex FilterChainManagerImpl::NoMatch;
+
+FilterChainManagerImpl::FilterChainManagerImpl(
+    const Network::Address::InstanceConstSharedPtr& address)
+    : address_(address) {}
+
+bool FilterChainManagerImpl::isWildcardServerName(const std::string& name) {
+  return absl::StartsWith(name, "*.");
+}
+
+void FilterChainManagerImpl::addFilterChain(
+    uint16_t destination_port, const std::vector<std::string>& destination_ips,
+    const std::vector<std::string>& server_names, const std::string& transport_protocol,
+    const std::vector<std::string>& application_protocols,
+    envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
+    const Network::FilterChainSharedPtr& filter_chain) {
+  filter_chains_.push_back(filter_chain);
+  DestinationPort& port = destination_ports_[destination_port];
+  ASSERT(port.destination_ips_trie_ == nullptr);
+
+  std::vector<NodeIndex> server_names_list;
+  if (destination_ips.empty()) {
+    server_names_list.push_back(nodeFor(
+        port.destination_ips_.emplace(EMPTY_STRING, NoMatch).first->second, server_names_nodes_));
+  } else {
+    for (const auto& destination_ip : destination_ips) {
+      server_names_list.push_back(nodeFor(
+          port.destination_ips_.emplace(destination_ip, NoMatch).first->second,
+          server_names_nodes_));
+    }
+  }
+
+  for (const NodeIndex server_names_node : server_names_list) {
+    std::vector<NodeIndex> transport_protocols_list;
+    if (server_names.empty()) {
+      transport_protocols_list.push_back(
+          nodeFor(server_names_nodes_[server_names_node].any_, transport_protocols_nodes_));
+    } else {
+      for (const auto& server_name : server_names) {
+        transport_protocols_list.push_back(
+            isWildcardServerName(server_name)
+                ? wildcardServerNameNode(server_names_node, server_name)
+                : serverNameNode(server_names_node, server_name));
+      }
+    }
+    for (const NodeIndex transport_protocols_node : transport_protocols_list) {
+      addFilterChainForTransportProtocol(transport_protocols_node, transport_protocol,
+                                         application_protocols, source_type, filter_chain.get());
+    }
+  }
+}
+
+void FilterChainManagerImpl::compile() {
+  for (auto& port : destination_ports_) {
+    DestinationPort& destination_port = port.second;
+    std::vector<std::pair<NodeIndex, std::vector<Network::Address::CidrRange>>> list;
+    for (const auto& entry : destination_port.destination_ips_) {
+      std::vector<Network::Address::CidrRange> subnets;
+      if (entry.first == EMPTY_STRING) {
+        if (Network::Address::ipFamilySupported(AF_INET)) {
+          subnets.push_back(Network::Address::CidrRange::create("0.0.0.0/0"));
+        }
+        if (Network::Address::ipFamilySupported(AF_INET6)) {
+          subnets.push_back(Network::Address::CidrRange::create("::/0"));
+        }
+      } else {
+        subnets.push_back(Network::Address::CidrRange::create(entry.first));
+      }
+      list.emplace_back(entry.second, std::move(subnets));
+    }
+    destination_port.destination_ips_trie_ =
+        std::make_unique<Network::LcTrie::LcTrie<NodeIndex>>(list, true);
+    // The CIDR strings are not needed for lookups.
+    destination_port.destination_ips_.clear();
+  }
+
+  // The tree is immutable from here on.
+  server_names_nodes_.shrink_to_fit();
+  wildcard_nodes_.shrink_to_fit();
+  transport_protocols_nodes_.shrink_to_fit();
+  application_protocols_nodes_.shrink_to_fit();
+  source_types_nodes_.shrink_to_fit();
+  filter_chains_.shrink_to_fit();
+}
+
+absl::string_view FilterChainManagerImpl::intern(absl::string_view value) {
+  return *strings_.emplace(std::string(value)).first;
+}
+
+template <class Node>
+FilterChainManagerImpl::NodeIndex FilterChainManagerImpl::nodeFor(NodeIndex& slot,
+                                                                  std::vector<Node>& nodes) {
+  if (slot == NoMatch) {
+    slot = nodes.size();
+    nodes.emplace_back();
+  }
+  return slot;
+}
+
+template <class Node>
+FilterChainManagerImpl::NodeIndex
+FilterChainManagerImpl::nodeFor(absl::flat_hash_map<absl::string_view, NodeIndex>& map,
+                                absl::string_view key, std::vector<Node>& nodes) {
+  const auto existing = map.find(key);
+  if (existing != map.end()) {
+    return existing->second;
+  }
+  // The map may live in one of nodes, so it must not be accessed after adding the node.
+  const NodeIndex index = nodes.size();
+  map.emplace(intern(key), index);
+  nodes.emplace_back();
+  return index;
+}
+
+template <class Node>
+FilterChainManagerImpl::NodeIndex FilterChainManagerImpl::nodeFor(ProtocolsNode& node,
+                                                                  absl::string_view protocol,
+                                                                  std::vector<Node>& nodes) {
+  return protocol.empty() ? nodeFor(node.any_, nodes) : nodeFor(node.exact_, protocol, nodes);
+}
+
+FilterChainManagerImpl::NodeIndex
+FilterChainManagerImpl::serverNameNode(NodeIndex server_names, const std::string& server_name) {
+  ServerNamesNode& node = server_names_nodes_[server_names];
+  return server_name.empty() ? nodeFor(node.any_, transport_protocols_nodes_)
+                             : nodeFor(node.exact_, server_name, transport_protocols_nodes_);
+}
+
+FilterChainManagerImpl::NodeIndex
+FilterChainManagerImpl::wildcardServerNameNode(NodeIndex server_names,
+                                               const std::string& server_name) {
+  // "*.example.com" is stored as the label "com" followed by the label "example".
+  NodeIndex node = nodeFor(server_names_nodes_[server_names].wildcard_root_, wildcard_nodes_);
+  const std::vector<absl::string_view> labels =
+      absl::StrSplit(absl::string_view(server_name).substr(2), '.');
+  for (auto label = labels.rbegin(); label != labels.rend(); ++label) {
+    node = nodeFor(wildcard_nodes_[node].children_, *label, wildcard_nodes_);
+  }
+  return nodeFor(wildcard_nodes_[node].match_, transport_protocols_nodes_);
+}
+
+void FilterChainManagerImpl::addFilterChainForTransportProtocol(
+    NodeIndex transport_protocols, const std::string& transport_protocol,
+    const std::vector<std::string>& application_protocols, uint32_t source_type,
+    const Network::FilterChain* filter_chain) {
+  const NodeIndex application_protocols_node = nodeFor(
+      transport_protocols_nodes_[transport_protocols], transport_protocol,
+      application_protocols_nodes_);
+
+  std::vector<NodeIndex> source_types_list;
+  ProtocolsNode& node = application_protocols_nodes_[application_protocols_node];
+  if (application_protocols.empty()) {
+    source_types_list.push_back(nodeFor(node.any_, source_types_nodes_));
+  } else {
+    for (const auto& application_protocol : application_protocols) {
+      source_types_list.push_back(nodeFor(node, application_protocol, source_types_nodes_));
+    }
+  }
+
+  for (const NodeIndex source_types : source_types_list) {
+    SourceTypesNode& source_types_node = source_types_nodes_[source_types];
+    if (source_types_node[source_type] != nullptr) {
+      // We should never get here once all fields in FilterChainMatch are implemented. At this
+      // point, this can become an ASSERT. In principle, we could verify the various missing fields
+      // earlier, but best to have defense-in-depth here, since any mistake leads to potential
+      // heap-use-after-free when filter chains are unexpectedly destructed.
+      throw EnvoyException(fmt::format("error adding listener '{}': multiple filter chains with "
+                                       "effectively equivalent matching rules are defined",
+                                       address_->asString()));
+    }
+    source_types_node[source_type] = filter_chain;
+  }
+}
+
+const Network::FilterChain*
+FilterChainManagerImpl::findFilterChain(const Network::ConnectionSocket& socket) const {
+  const auto& address = socket.localAddress();
+
+  // Match on destination port (only for IP addresses).
+  if (address->type() == Network::Address::Type::Ip) {
+    const auto port_match = destination_ports_.find(address->ip()->port());
+    if (port_match != destination_ports_.end()) {
+      return findFilterChainForDestinationIP(port_match->second, socket);
+    }
+  }
+
+  // Match on catch-all port 0.
+  const auto port_match = destination_ports_.find(0);
+  if (port_match != destination_ports_.end()) {
+    return findFilterChainForDestinationIP(port_match->second, socket);
+  }
+
+  return nullptr;
+}
+
+const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinationIP(
+    const DestinationPort& destination_port, const Network::ConnectionSocket& socket) const {
+  ASSERT(destination_port.destination_ips_trie_ != nullptr);
+  // Use invalid IP address (matching only filter chains without IP requirements) for UDS.
+  static const auto& fake_address = Network::Utility::parseInternetAddress("255.255.255.255");
+
+  auto address = socket.localAddress();
+  if (address->type() != Network::Address::Type::Ip) {
+    address = fake_address;
+  }
+
+  // Match on both: exact IP and wider CIDR ranges using LcTrie.
+  const auto& data = destination_port.destination_ips_trie_->getData(address);
+  if (!data.empty()) {
+    ASSERT(data.size() == 1);
+    return findFilterChainForServerName(server_names_nodes_[data.back()], socket);
+  }
+
+  return nullptr;
+}
+
+const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName(
+    const ServerNamesNode& node, const Network::ConnectionSocket& socket) const {
+  const absl::string_view server_name = socket.requestedServerName();
+
+  // Match on exact server name, i.e. "www.example.com" for "www.example.com".
+  const auto server_name_exact_match = node.exact_.find(server_name);
+  if (server_name_exact_match != node.exact_.end()) {
+    return findFilterChainForTransportProtocol(
+        transport_protocols_nodes_[server_name_exact_match->second], socket);
+  }
+
+  // Match on the most specific wildcard domain, i.e. "*.example.com" before "*.com" for
+  // "www.example.com".
+  if (node.wildcard_root_ != NoMatch) {
+    const NodeIndex server_name_wildcard_match =
+        findWildcardServerName(node.wildcard_root_, server_name);
+    if (server_name_wildcard_match != NoMatch) {
+      return findFilterChainForTransportProtocol(
+          transport_protocols_nodes_[server_name_wildcard_match], socket);
+    }
+  }
+
+  // Match on a filter chain without server name requirements.
+  if (node.any_ != NoMatch) {
+    return findFilterChainForTransportProtocol(transport_protocols_nodes_[node.any_], socket);
+  }
+
+  return nullptr;
+}
+
+FilterChainManagerImpl::NodeIndex
+FilterChainManagerImpl::findWildcardServerName(NodeIndex root,
+                                               absl::string_view server_name) const {
+  // Walk the labels of the server name from right to left, remembering the last (i.e. longest)
+  // wildcard domain seen. The first label never matches, as "*.example.com" doesn't match
+  // "example.com", and neither does the empty label after a trailing dot.
+  NodeIndex match = NoMatch;
+  NodeIndex node = root;
+  size_t end = server_name.size();
+  while (end > 0) {
+    const size_t dot = server_name.rfind('.', end - 1);
+    if (dot == absl::string_view::npos || dot == 0) {
+      break;
+    }
+    const auto& children = wildcard_nodes_[node].children_;
+    const auto child = children.find(server_name.substr(dot + 1, end - dot - 1));
+    if (child == children.end()) {
+      break;
+    }
+    node = child->second;
+    if (dot < server_name.size() - 1 && wildcard_nodes_[node].match_ != NoMatch) {
+      match = wildcard_nodes_[node].match_;
+    }
+    end = dot;
+  }
+  return match;
+}
+
+const Network::FilterChain* FilterChainManagerImpl::findFilterChainForTransportProtocol(
+    const ProtocolsNode& node, const Network::ConnectionSocket& socket) const {
+  // Match on exact transport protocol, e.g. "tls".
+  const auto transport_protocol_match = node.exact_.find(socket.detectedTransportProtocol());
+  if (transport_protocol_match != node.exact_.end()) {
+    return findFilterChainForApplicationProtocols(
+        application_protocols_nodes_[transport_protocol_match->second], socket);
+  }
+
+  // Match on a filter chain without transport protocol requirements.
+  if (node.any_ != NoMatch) {
+    return findFilterChainForApplicationProtocols(application_protocols_nodes_[node.any_], socket);
+  }
+
+  return nullptr;
+}
+
+const Network::FilterChain* FilterChainManagerImpl::findFilterChainForApplicationProtocols(
+    const ProtocolsNode& node, const Network::ConnectionSocket& socket) const {
+  // Match on exact application protocol, e.g. "h2" or "http/1.1".
+  for (const auto& application_protocol : socket.requestedApplicationProtocols()) {
+    const auto application_protocol_match = node.exact_.find(application_protocol);
+    if (application_protocol_match != node.exact_.end()) {
+      return findFilterChainForSourceTypes(source_types_nodes_[application_protocol_match->second],
+                                           socket);
+    }
+  }
+
+  // Match on a filter chain without application protocol requirements.
+  if (node.any_ != NoMatch) {
+    return findFilterChainForSourceTypes(source_types_nodes_[node.any_], socket);
+  }
+
+  return nullptr;
+}
+
+const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceTypes(
+    const SourceTypesNode& node, const Network::ConnectionSocket& socket) const {
+  const Network::FilterChain* filter_chain_local =
+      node[envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
+               FilterChainMatch_ConnectionSourceType_LOCAL];
+
+  const Network::FilterChain* filter_chain_external =
+      node[envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
+               FilterChainMatch_ConnectionSourceType_EXTERNAL];
+
+  // isLocalConnection can be expensive. Call it only if LOCAL or EXTERNAL are defined.
+  const bool is_local_connection = (filter_chain_local || filter_chain_external)
+                                       ? Network::Utility::isLocalConnection(socket)
+                                       : false;
+
+  if (is_local_connection) {
+    if (filter_chain_local) {
+      return filter_chain_local;
+    }
+  } else {
+    if (filter_chain_external) {
+      return filter_chain_external;
+    }
+  }
+
+  return node[envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
+                  FilterChainMatch_ConnectionSourceType_ANY];
+}
+
+} // namespace Server
+} // namespace Envoy
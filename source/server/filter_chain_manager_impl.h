@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/v2/listener/listener.pb.h"
+#include "envoy/network/address.h"
+#include "envoy/network/filter.h"
+#include "envoy/network/listen_socket.h"
+#include "envoy/network/transport_socket.h"
+
+#include "common/network/lc_trie.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_set.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Server {
+
+class FilterChainImpl : public Network::FilterChain {
+public:
+  FilterChainImpl(Network::TransportSocketFactoryPtr&& transport_socket_factory,
+                  std::vector<Network::FilterFactoryCb> filters_factory)
+      : transport_socket_factory_(std::move(transport_socket_factory)),
+        filters_factory_(std::move(filters_factory)) {}
+
+  // Network::FilterChain
+  const Network::TransportSocketFactory& transportSocketFactory() const override {
+    return *transport_socket_factory_;
+  }
+
+  const std::vector<Network::FilterFactoryCb>& networkFilterFactories() const override {
+    return filters_factory_;
+  }
+
+private:
+  const Network::TransportSocketFactoryPtr transport_socket_factory_;
+  const std::vector<Network::FilterFactoryCb> filters_factory_;
+};
+
+/**
+ * Selects the filter chain of accepted connections. Filter chains are added together with their
+ * matching rules and then compiled into an immutable match tree. Each level of the tree is stored
+ * in a flat vector of nodes that refer to each other by index, and every string key is interned
+ * once per tree, so that nodes only hold views of them. Wildcard server names are kept in a trie of
+ * domain labels, which finds the most specific wildcard in a single pass over the server name.
+ */
+class FilterChainManagerImpl : public Network::FilterChainManager {
+public:
+  /**
+   * @param address supplies the address of the listener, used in error messages.
+   */
+  FilterChainManagerImpl(const Network::Address::InstanceConstSharedPtr& address);
+
+  /**
+   * Add a filter chain to the match tree. Throws EnvoyException if another filter chain with
+   * effectively equivalent matching rules was already added.
+   */
+  void addFilterChain(uint16_t destination_port, const std::vector<std::string>& destination_ips,
+                      const std::vector<std::string>& server_names,
+                      const std::string& transport_protocol,
+                      const std::vector<std::string>& application_protocols,
+                      envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
+                      const Network::FilterChainSharedPtr& filter_chain);
+
+  /**
+   * Build the destination IP lookup tables once all filter chains have been added. Must be called
+   * before findFilterChain().
+   */
+  void compile();
+
+  static bool isWildcardServerName(const std::string& name);
+
+  // Network::FilterChainManager
+  const Network::FilterChain*
+  findFilterChain(const Network::ConnectionSocket& socket) const override;
+
+private:
+  // Index of a node in one of the node vectors below, or NoMatch if there is no such node.
+  typedef uint32_t NodeIndex;
+  static constexpr NodeIndex NoMatch = UINT32_MAX;
+
+  // Filter chains indexed by envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType.
+  typedef std::array<const Network::FilterChain*, 3> SourceTypesNode;
+
+  // Transport or application protocols, each mapping to a node of the next level.
+  struct ProtocolsNode {
+    absl::flat_hash_map<absl::string_view, NodeIndex> exact_;
+    NodeIndex any_{NoMatch};
+  };
+
+  // Server names, each mapping to a transport protocols node.
+  struct ServerNamesNode {
+    absl::flat_hash_map<absl::string_view, NodeIndex> exact_;
+    NodeIndex wildcard_root_{NoMatch};
+    NodeIndex any_{NoMatch};
+  };
+
+  // A domain label of the wildcard trie, e.g. "example" in "*.example.com" is a child of "com".
+  // A label that ends a wildcard server name maps to a transport protocols node.
+  struct WildcardNode {
+    absl::flat_hash_map<absl::string_view, NodeIndex> children_;
+    NodeIndex match_{NoMatch};
+  };
+
+  struct DestinationPort {
+    // CIDR ranges mapping to server names nodes. Only used until compile() builds the trie.
+    absl::flat_hash_map<std::string, NodeIndex> destination_ips_;
+    std::unique_ptr<Network::LcTrie::LcTrie<NodeIndex>> destination_ips_trie_;
+  };
+
+  absl::string_view intern(absl::string_view value);
+  // Return the index of the node that slot, key or protocol refers to, adding it to nodes first if
+  // needed. slot must not be stored in nodes itself, as adding a node can move it.
+  template <class Node> static NodeIndex nodeFor(NodeIndex& slot, std::vector<Node>& nodes);
+  template <class Node>
+  NodeIndex nodeFor(absl::flat_hash_map<absl::string_view, NodeIndex>& map, absl::string_view key,
+                    std::vector<Node>& nodes);
+  template <class Node>
+  NodeIndex nodeFor(ProtocolsNode& node, absl::string_view protocol, std::vector<Node>& nodes);
+  NodeIndex serverNameNode(NodeIndex server_names, const std::string& server_name);
+  NodeIndex wildcardServerNameNode(NodeIndex server_names, const std::string& server_name);
+  void addFilterChainForTransportProtocol(NodeIndex transport_protocols,
+                                          const std::string& transport_protocol,
+                                          const std::vector<std::string>& application_protocols,
+                                          uint32_t source_type,
+                                          const Network::FilterChain* filter_chain);
+
+  const Network::FilterChain*
+  findFilterChainForDestinationIP(const DestinationPort& destination_port,
+                                  const Network::ConnectionSocket& socket) const;
+  const Network::FilterChain*
+  findFilterChainForServerName(const ServerNamesNode& node,
+                               const Network::ConnectionSocket& socket) const;
+  NodeIndex findWildcardServerName(NodeIndex root, absl::string_view server_name) const;
+  const Network::FilterChain*
+  findFilterChainForTransportProtocol(const ProtocolsNode& node,
+                                      const Network::ConnectionSocket& socket) const;
+  const Network::FilterChain*
+  findFilterChainForApplicationProtocols(const ProtocolsNode& node,
+                                         const Network::ConnectionSocket& socket) const;
+  const Network::FilterChain*
+  findFilterChainForSourceTypes(const SourceTypesNode& node,
+                                const Network::ConnectionSocket& socket) const;
+
+  const Network::Address::InstanceConstSharedPtr address_;
+  absl::flat_hash_map<uint16_t, DestinationPort> destination_ports_;
+  std::vector<ServerNamesNode> server_names_nodes_;
+  std::vector<WildcardNode> wildcard_nodes_;
+  std::vector<ProtocolsNode> transport_protocols_nodes_;
+  std::vector<ProtocolsNode> application_protocols_nodes_;
+  std::vector<SourceTypesNode> source_types_nodes_;
+  // Backing storage of all the string keys used by the nodes above. Elements of a node_hash_set
+  // never move, so views of them stay valid as more strings are interned.
+  absl::node_hash_set<std::string> strings_;
+  std::vector<Network::FilterChainSharedPtr> filter_chains_;
+};
+
+} // namespace Server
+} // namespace Envoy
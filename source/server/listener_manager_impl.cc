@@ -7,9 +7,10 @@
 
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/assert.h"
-#include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/config/utility.h"
+#include "common/network/cidr_range.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/resolver_impl.h"
@@ -25,7 +26,7 @@
 #include "extensions/filters/network/well_known_names.h"
 #include "extensions/transport_sockets/well_known_names.h"
 
-#include "absl/strings/match.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -100,14 +101,15 @@ ProdListenerComponentFactory::createListenerFilterFactoryList_(
 
 Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
     Network::Address::InstanceConstSharedPtr address, Network::Address::SocketType socket_type,
-    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) {
+    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port, uint32_t worker_index) {
   ASSERT(address->type() == Network::Address::Type::Ip ||
          address->type() == Network::Address::Type::Pipe);
   ASSERT(socket_type == Network::Address::SocketType::Stream ||
          socket_type == Network::Address::SocketType::Datagram);
 
-  // For each listener config we share a single socket among all threaded listeners.
-  // First we try to get the socket from our parent if applicable.
+  // For each listener config we share a single socket among all threaded listeners, unless the
+  // listener uses SO_REUSEPORT in which case there is one socket per worker. First we try to get
+  // the socket from our parent if applicable.
   if (address->type() == Network::Address::Type::Pipe) {
     if (socket_type != Network::Address::SocketType::Stream) {
       // This could be implemented in the future, since Unix domain sockets
@@ -117,7 +119,7 @@ Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
           fmt::format("socket type {} not supported for pipes", toString(socket_type)));
     }
     const std::string addr = fmt::format("unix://{}", address->asString());
-    const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+    const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
     Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
     if (io_handle->isOpen()) {
       ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
@@ -130,7 +132,7 @@ Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
                                  ? Network::Utility::TCP_SCHEME
                                  : Network::Utility::UDP_SCHEME;
   const std::string addr = absl::StrCat(scheme, address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
   if (fd != -1) {
     ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
     Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
@@ -154,26 +156,51 @@ ProdListenerComponentFactory::createDrainManager(envoy::api::v2::Listener::Drain
 
 ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::string& version_info,
                            ListenerManagerImpl& parent, const std::string& name, bool modifiable,
-                           bool workers_started, uint64_t hash)
+                           bool workers_started, uint64_t hash, const ListenerImpl* origin)
     : parent_(parent), address_(Network::Address::resolveProtoAddress(config.address())),
       socket_type_(Network::Utility::protobufAddressSocketType(config.address())),
-      global_scope_(parent_.server_.stats().createScope("")),
-      listener_scope_(
-          parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
+      global_scope_(origin != nullptr
+                        ? origin->global_scope_
+                        : Stats::ScopeSharedPtr(parent_.server_.stats().createScope(""))),
+      listener_scope_(origin != nullptr ? origin->listener_scope_
+                                        : Stats::ScopeSharedPtr(parent_.server_.stats().createScope(
+                                              fmt::format("listener.{}.", address_->asString())))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      reuse_port_(config.reuse_port() && bind_to_port_),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
-      listener_tag_(parent_.factory_.nextListenerTag()), name_(name), modifiable_(modifiable),
-      workers_started_(workers_started), hash_(hash),
-      dynamic_init_manager_(fmt::format("Listener {}", name)),
+      listener_tag_(origin != nullptr ? origin->listener_tag_ : parent_.factory_.nextListenerTag()),
+      name_(name), modifiable_(modifiable), workers_started_(workers_started), hash_(hash),
+      updates_in_place_(origin != nullptr),
+      dynamic_init_manager_(std::make_shared<Init::ManagerImpl>(fmt::format("Listener {}", name))),
       init_watcher_(std::make_unique<Init::WatcherImpl>(
           "ListenerImpl", [this] { parent_.onListenerWarmed(*this); })),
-      local_drain_manager_(parent.factory_.createDrainManager(config.drain_type())),
+      local_drain_manager_(origin != nullptr ? origin->local_drain_manager_
+                                             : std::shared_ptr<DrainManager>(
+                                                   parent.factory_.createDrainManager(
+                                                       config.drain_type()))),
       config_(config), version_info_(version_info),
       listener_filters_timeout_(
-          PROTOBUF_GET_MS_OR_DEFAULT(config, listener_filters_timeout, 15000)) {
+          PROTOBUF_GET_MS_OR_DEFAULT(config, listener_filters_timeout, 15000)),
+      filter_chain_manager_(address_) {
+  if (reuse_port_) {
+    if (address_->type() != Network::Address::Type::Ip) {
+      throw EnvoyException(fmt::format(
+          "error adding listener '{}': reuse_port is only supported for IP listeners",
+          address_->asString()));
+    }
+    addListenSocketOptions(Network::SocketOptionFactory::buildReusePortOptions());
+  }
+  if (config.has_connection_balance_config()) {
+    // Currently exact balance is the only supported type and there are no options.
+    ASSERT(config.connection_balance_config().has_exact_balance());
+    connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+  } else {
+    connection_balancer_ = std::make_unique<Network::NopConnectionBalancerImpl>();
+  }
+
   if (config.has_transparent()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildIpTransparentOptions());
   }
@@ -218,7 +245,8 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
   std::unordered_set<envoy::api::v2::listener::FilterChainMatch, MessageUtil, MessageUtil>
       filter_chains;
 
-  for (const auto& filter_chain : config.filter_chains()) {
+  // Iterate over the copy of the configuration, which the filter chain entries refer to.
+  for (const auto& filter_chain : config_.filter_chains()) {
     const auto& filter_chain_match = filter_chain.filter_chain_match();
     if (filter_chains.find(filter_chain_match) != filter_chains.end()) {
       throw EnvoyException(fmt::format("error adding listener '{}': multiple filter chains with "
@@ -227,25 +255,6 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
     }
     filter_chains.insert(filter_chain_match);
 
-    // If the cluster doesn't have transport socket configured, then use the default "raw_buffer"
-    // transport socket or BoringSSL-based "tls" transport socket if TLS settings are configured.
-    // We copy by value first then override if necessary.
-    auto transport_socket = filter_chain.transport_socket();
-    if (!filter_chain.has_transport_socket()) {
-      if (filter_chain.has_tls_context()) {
-        transport_socket.set_name(Extensions::TransportSockets::TransportSocketNames::get().Tls);
-        MessageUtil::jsonConvert(filter_chain.tls_context(), *transport_socket.mutable_config());
-      } else {
-        transport_socket.set_name(
-            Extensions::TransportSockets::TransportSocketNames::get().RawBuffer);
-      }
-    }
-
-    auto& config_factory = Config::Utility::getAndCheckFactory<
-        Server::Configuration::DownstreamTransportSocketConfigFactory>(transport_socket.name());
-    ProtobufTypes::MessagePtr message =
-        Config::Utility::translateToFactoryConfig(transport_socket, config_factory);
-
     // Validate IP addresses.
     std::vector<std::string> destination_ips;
     for (const auto& destination_ip : filter_chain_match.prefix_ranges()) {
@@ -258,7 +267,8 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
 
     // Reject partial wildcards, we don't match on them.
     for (const auto& server_name : server_names) {
-      if (server_name.find('*') != std::string::npos && !isWildcardServerName(server_name)) {
+      if (server_name.find('*') != std::string::npos &&
+          !FilterChainManagerImpl::isWildcardServerName(server_name)) {
         throw EnvoyException(
             fmt::format("error adding listener '{}': partial wildcards are not supported in "
                         "\"server_names\"",
@@ -269,26 +279,66 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
     std::vector<std::string> application_protocols(
         filter_chain_match.application_protocols().begin(),
         filter_chain_match.application_protocols().end());
-    Server::Configuration::TransportSocketFactoryContextImpl factory_context(
-        parent_.server_.admin(), parent_.server_.sslContextManager(), *listener_scope_,
-        parent_.server_.clusterManager(), parent_.server_.localInfo(), parent_.server_.dispatcher(),
-        parent_.server_.random(), parent_.server_.stats(), parent_.server_.singletonManager(),
-        parent_.server_.threadLocal(), parent_.server_.api());
-    factory_context.setInitManager(initManager());
-    addFilterChain(
+
+    // A listener that is updated in place reuses the filter chains that did not change, together
+    // with their transport socket factories and network filter factories.
+    const uint64_t filter_chain_hash = MessageUtil::hash(filter_chain);
+    const FilterChainEntry* reusable_filter_chain =
+        origin != nullptr ? origin->findReusableFilterChain(filter_chain, filter_chain_hash)
+                          : nullptr;
+    FilterChainEntry entry{&filter_chain, nullptr, nullptr};
+    if (reusable_filter_chain != nullptr) {
+      entry.context_ = reusable_filter_chain->context_;
+      entry.filter_chain_ = reusable_filter_chain->filter_chain_;
+    } else {
+      // If the cluster doesn't have transport socket configured, then use the default
+      // "raw_buffer" transport socket or BoringSSL-based "tls" transport socket if TLS settings
+      // are configured. We copy by value first then override if necessary.
+      auto transport_socket = filter_chain.transport_socket();
+      if (!filter_chain.has_transport_socket()) {
+        if (filter_chain.has_tls_context()) {
+          transport_socket.set_name(Extensions::TransportSockets::TransportSocketNames::get().Tls);
+          MessageUtil::jsonConvert(filter_chain.tls_context(), *transport_socket.mutable_config());
+        } else {
+          transport_socket.set_name(
+              Extensions::TransportSockets::TransportSocketNames::get().RawBuffer);
+        }
+      }
+
+      auto& config_factory = Config::Utility::getAndCheckFactory<
+          Server::Configuration::DownstreamTransportSocketConfigFactory>(transport_socket.name());
+      ProtobufTypes::MessagePtr message =
+          Config::Utility::translateToFactoryConfig(transport_socket, config_factory);
+
+      Server::Configuration::TransportSocketFactoryContextImpl factory_context(
+          parent_.server_.admin(), parent_.server_.sslContextManager(), *listener_scope_,
+          parent_.server_.clusterManager(), parent_.server_.localInfo(),
+          parent_.server_.dispatcher(), parent_.server_.random(), parent_.server_.stats(),
+          parent_.server_.singletonManager(), parent_.server_.threadLocal(),
+          parent_.server_.api());
+      factory_context.setInitManager(initManager());
+      entry.context_ = std::make_shared<FilterChainFactoryContextImpl>(
+          parent_.server_, global_scope_, listener_scope_, local_drain_manager_,
+          dynamic_init_manager_, workers_started_, config_.metadata());
+      entry.filter_chain_ = std::make_shared<FilterChainImpl>(
+          config_factory.createTransportSocketFactory(*message, factory_context, server_names),
+          parent_.factory_.createNetworkFilterFactoryList(filter_chain.filters(), *entry.context_));
+    }
+
+    filter_chain_manager_.addFilterChain(
         PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0), destination_ips,
         server_names, filter_chain_match.transport_protocol(), application_protocols,
-        filter_chain_match.source_type(),
-        config_factory.createTransportSocketFactory(*message, factory_context, server_names),
-        parent_.factory_.createNetworkFilterFactoryList(filter_chain.filters(), *this));
+        filter_chain_match.source_type(), entry.filter_chain_);
+    filter_chains_by_hash_.emplace(filter_chain_hash, filter_chains_.size());
+    filter_chains_.push_back(std::move(entry));
 
     need_tls_inspector |= filter_chain_match.transport_protocol() == "tls" ||
                           (filter_chain_match.transport_protocol().empty() &&
                            (!server_names.empty() || !application_protocols.empty()));
   }
 
-  // Convert DestinationIPsMap to DestinationIPsTrie for faster lookups.
-  convertDestinationIPsMapToTrie();
+  // Build the destination IP lookup tables of the filter chain match tree.
+  filter_chain_manager_.compile();
 
   // Automatically inject TLS Inspector if it wasn't configured explicitly and it's needed.
   if (need_tls_inspector) {
@@ -322,297 +372,79 @@ ListenerImpl::~ListenerImpl() {
   // active. This is done here explicitly by resetting the watcher and then clearing the factory
   // vector for clarity.
   init_watcher_.reset();
-  destination_ports_map_.clear();
-}
-
-bool ListenerImpl::isWildcardServerName(const std::string& name) {
-  return absl::StartsWith(name, "*.");
 }
 
-void ListenerImpl::addFilterChain(
-    uint16_t destination_port, const std::vector<std::string>& destination_ips,
-    const std::vector<std::string>& server_names, const std::string& transport_protocol,
-    const std::vector<std::string>& application_protocols,
-    const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    Network::TransportSocketFactoryPtr&& transport_socket_factory,
-    std::vector<Network::FilterFactoryCb> filters_factory) {
-  const auto filter_chain = std::make_shared<FilterChainImpl>(std::move(transport_socket_factory),
-                                                              std::move(filters_factory));
-  addFilterChainForDestinationPorts(destination_ports_map_, destination_port, destination_ips,
-                                    server_names, transport_protocol, application_protocols,
-                                    source_type, filter_chain);
-}
-
-void ListenerImpl::addFilterChainForDestinationPorts(
-    DestinationPortsMap& destination_ports_map, uint16_t destination_port,
-    const std::vector<std::string>& destination_ips, const std::vector<std::string>& server_names,
-    const std::string& transport_protocol, const std::vector<std::string>& application_protocols,
-    const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ports_map.find(destination_port) == destination_ports_map.end()) {
-    destination_ports_map[destination_port] =
-        std::make_pair<DestinationIPsMap, DestinationIPsTriePtr>(DestinationIPsMap{}, nullptr);
-  }
-  addFilterChainForDestinationIPs(destination_ports_map[destination_port].first, destination_ips,
-                                  server_names, transport_protocol, application_protocols,
-                                  source_type, filter_chain);
-}
-
-void ListenerImpl::addFilterChainForDestinationIPs(
-    DestinationIPsMap& destination_ips_map, const std::vector<std::string>& destination_ips,
-    const std::vector<std::string>& server_names, const std::string& transport_protocol,
-    const std::vector<std::string>& application_protocols,
-    const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ips.empty()) {
-    addFilterChainForServerNames(destination_ips_map[EMPTY_STRING], server_names,
-                                 transport_protocol, application_protocols, source_type,
-                                 filter_chain);
-  } else {
-    for (const auto& destination_ip : destination_ips) {
-      addFilterChainForServerNames(destination_ips_map[destination_ip], server_names,
-                                   transport_protocol, application_protocols, source_type,
-                                   filter_chain);
-    }
-  }
+bool ListenerImpl::createNetworkFilterChain(
+    Network::Connection& connection,
+    const std::vector<Network::FilterFactoryCb>& filter_factories) {
+  return Configuration::FilterChainUtility::buildFilterChain(connection, filter_factories);
 }
 
-void ListenerImpl::addFilterChainForServerNames(
-    ServerNamesMap& server_names_map, const std::vector<std::string>& server_names,
-    const std::string& transport_protocol, const std::vector<std::string>& application_protocols,
-    const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (server_names.empty()) {
-    addFilterChainForApplicationProtocols(server_names_map[EMPTY_STRING][transport_protocol],
-                                          application_protocols, source_type, filter_chain);
-  } else {
-    for (const auto& server_name : server_names) {
-      if (isWildcardServerName(server_name)) {
-        // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
-        addFilterChainForApplicationProtocols(
-            server_names_map[server_name.substr(1)][transport_protocol], application_protocols,
-            source_type, filter_chain);
-      } else {
-        addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
-                                              application_protocols, source_type, filter_chain);
-      }
-    }
-  }
+bool ListenerImpl::createListenerFilterChain(Network::ListenerFilterManager& manager) {
+  return Configuration::FilterChainUtility::buildFilterChain(manager, listener_filter_factories_);
 }
 
-void ListenerImpl::addFilterChainForApplicationProtocols(
-    ApplicationProtocolsMap& application_protocols_map,
-    const std::vector<std::string>& application_protocols,
-    const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (application_protocols.empty()) {
-    addFilterChainForSourceTypes(application_protocols_map[EMPTY_STRING], source_type,
-                                 filter_chain);
-  } else {
-    for (const auto& application_protocol : application_protocols) {
-      addFilterChainForSourceTypes(application_protocols_map[application_protocol], source_type,
-                                   filter_chain);
-    }
-  }
+bool ListenerImpl::canUpdateInPlace(const envoy::api::v2::Listener& config) const {
+  envoy::api::v2::Listener current_config = config_;
+  current_config.clear_filter_chains();
+  envoy::api::v2::Listener new_config = config;
+  new_config.clear_filter_chains();
+  return Protobuf::util::MessageDifferencer::Equivalent(current_config, new_config);
 }
 
-void ListenerImpl::addFilterChainForSourceTypes(
-    SourceTypesArray& source_types_array,
-    const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (source_types_array[source_type] != nullptr) {
-    // We should never get here once all fields in FilterChainMatch are implemented. At this point,
-    // this can become an ASSERT. In principle, we could verify the various missing fields earlier,
-    // but best to have defense-in-depth here, since any mistake leads to potential
-    // heap-use-after-free when filter chains are unexpectedly destructed.
-    throw EnvoyException(fmt::format("error adding listener '{}': multiple filter chains with "
-                                     "effectively equivalent matching rules are defined",
-                                     address_->asString()));
+const ListenerImpl::FilterChainEntry*
+ListenerImpl::findReusableFilterChain(const envoy::api::v2::listener::FilterChain& config,
+                                      uint64_t hash) const {
+  const auto it = filter_chains_by_hash_.find(hash);
+  if (it == filter_chains_by_hash_.end()) {
+    return nullptr;
   }
-  source_types_array[source_type] = filter_chain;
+  const FilterChainEntry& entry = filter_chains_[it->second];
+  return Protobuf::util::MessageDifferencer::Equivalent(*entry.config_, config) ? &entry : nullptr;
 }
 
-void ListenerImpl::convertDestinationIPsMapToTrie() {
-  for (auto& port : destination_ports_map_) {
-    auto& destination_ips_pair = port.second;
-    auto& destination_ips_map = destination_ips_pair.first;
-    std::vector<std::pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>> list;
-    for (const auto& entry : destination_ips_map) {
-      std::vector<Network::Address::CidrRange> subnets;
-      if (entry.first == EMPTY_STRING) {
-        if (Network::Address::ipFamilySupported(AF_INET)) {
-          subnets.push_back(Network::Address::CidrRange::create("0.0.0.0/0"));
-        }
-        if (Network::Address::ipFamilySupported(AF_INET6)) {
-          subnets.push_back(Network::Address::CidrRange::create("::/0"));
-        }
-      } else {
-        subnets.push_back(Network::Address::CidrRange::create(entry.first));
-      }
-      list.push_back(
-          std::make_pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>(
-              std::make_shared<ServerNamesMap>(entry.second),
-              std::vector<Network::Address::CidrRange>(subnets)));
-    }
-    destination_ips_pair.second = std::make_unique<DestinationIPsTrie>(list, true);
+std::vector<const Network::FilterChain*>
+ListenerImpl::removedFilterChains(const ListenerImpl& updated_listener) const {
+  absl::flat_hash_set<const Network::FilterChain*> reused_filter_chains;
+  for (const auto& entry : updated_listener.filter_chains_) {
+    reused_filter_chains.insert(entry.filter_chain_.get());
   }
-}
-
-const Network::FilterChain*
-ListenerImpl::findFilterChain(const Network::ConnectionSocket& socket) const {
-  const auto& address = socket.localAddress();
-
-  // Match on destination port (only for IP addresses).
-  if (address->type() == Network::Address::Type::Ip) {
-    const auto port_match = destination_ports_map_.find(address->ip()->port());
-    if (port_match != destination_ports_map_.end()) {
-      return findFilterChainForDestinationIP(*port_match->second.second, socket);
+  std::vector<const Network::FilterChain*> removed_filter_chains;
+  for (const auto& entry : filter_chains_) {
+    if (!reused_filter_chains.contains(entry.filter_chain_.get())) {
+      removed_filter_chains.push_back(entry.filter_chain_.get());
     }
   }
-
-  // Match on catch-all port 0.
-  const auto port_match = destination_ports_map_.find(0);
-  if (port_match != destination_ports_map_.end()) {
-    return findFilterChainForDestinationIP(*port_match->second.second, socket);
-  }
-
-  return nullptr;
+  return removed_filter_chains;
 }
 
-const Network::FilterChain*
-ListenerImpl::findFilterChainForDestinationIP(const DestinationIPsTrie& destination_ips_trie,
-                                              const Network::ConnectionSocket& socket) const {
-  // Use invalid IP address (matching only filter chains without IP requirements) for UDS.
-  static const auto& fake_address = Network::Utility::parseInternetAddress("255.255.255.255");
-
-  auto address = socket.localAddress();
-  if (address->type() != Network::Address::Type::Ip) {
-    address = fake_address;
-  }
-
-  // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = destination_ips_trie.getData(address);
-  if (!data.empty()) {
-    ASSERT(data.size() == 1);
-    return findFilterChainForServerName(*data.back(), socket);
-  }
-
-  return nullptr;
-}
-
-const Network::FilterChain*
-ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_map,
-                                           const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
-
-  // Match on exact server name, i.e. "www.example.com" for "www.example.com".
-  const auto server_name_exact_match = server_names_map.find(server_name);
-  if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
-  }
-
-  // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
-  size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
-    const auto server_name_wildcard_match = server_names_map.find(wildcard);
-    if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
+void ListenerImpl::startDrainingFilterChains(
+    const std::vector<const Network::FilterChain*>& filter_chains,
+    const DrainManager& drain_manager) {
+  const absl::flat_hash_set<const Network::FilterChain*> draining_filter_chains(
+      filter_chains.begin(), filter_chains.end());
+  for (const auto& entry : filter_chains_) {
+    if (draining_filter_chains.contains(entry.filter_chain_.get())) {
+      entry.context_->startDraining(drain_manager);
     }
-    pos = server_name.find('.', pos + 1);
-  }
-
-  // Match on a filter chain without server name requirements.
-  const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
-  if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
   }
-
-  return nullptr;
 }
 
-const Network::FilterChain* ListenerImpl::findFilterChainForTransportProtocol(
-    const TransportProtocolsMap& transport_protocols_map,
-    const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
-
-  // Match on exact transport protocol, e.g. "tls".
-  const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
-  if (transport_protocol_match != transport_protocols_map.end()) {
-    return findFilterChainForApplicationProtocols(transport_protocol_match->second, socket);
-  }
-
-  // Match on a filter chain without transport protocol requirements.
-  const auto any_protocol_match = transport_protocols_map.find(EMPTY_STRING);
-  if (any_protocol_match != transport_protocols_map.end()) {
-    return findFilterChainForApplicationProtocols(any_protocol_match->second, socket);
-  }
-
-  return nullptr;
-}
-
-const Network::FilterChain* ListenerImpl::findFilterChainForApplicationProtocols(
-    const ApplicationProtocolsMap& application_protocols_map,
-    const Network::ConnectionSocket& socket) const {
-  // Match on exact application protocol, e.g. "h2" or "http/1.1".
-  for (const auto& application_protocol : socket.requestedApplicationProtocols()) {
-    const auto application_protocol_match = application_protocols_map.find(application_protocol);
-    if (application_protocol_match != application_protocols_map.end()) {
-      return findFilterChainForSourceTypes(application_protocol_match->second, socket);
-    }
-  }
-
-  // Match on a filter chain without application protocol requirements.
-  const auto any_protocol_match = application_protocols_map.find(EMPTY_STRING);
-  if (any_protocol_match != application_protocols_map.end()) {
-    return findFilterChainForSourceTypes(any_protocol_match->second, socket);
-  }
-
-  return nullptr;
-}
-
-const Network::FilterChain*
-ListenerImpl::findFilterChainForSourceTypes(const SourceTypesArray& source_types,
-                                            const Network::ConnectionSocket& socket) const {
-
-  auto filter_chain_local =
-      source_types[envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
-                       FilterChainMatch_ConnectionSourceType_LOCAL];
-
-  auto filter_chain_external =
-      source_types[envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
-                       FilterChainMatch_ConnectionSourceType_EXTERNAL];
-
-  // isLocalConnection can be expensive. Call it only if LOCAL or EXTERNAL are defined.
-  const bool is_local_connection = (filter_chain_local || filter_chain_external)
-                                       ? Network::Utility::isLocalConnection(socket)
-                                       : false;
-
-  if (is_local_connection) {
-    if (filter_chain_local) {
-      return filter_chain_local.get();
-    }
+Init::Manager& FilterChainFactoryContextImpl::initManager() {
+  // Same as ListenerImpl::initManager(), the init manager of the listener that created the filter
+  // chain is kept alive by this context.
+  if (workers_started_) {
+    return *dynamic_init_manager_;
   } else {
-    if (filter_chain_external) {
-      return filter_chain_external.get();
-    }
+    return server_.initManager();
   }
-
-  auto filter_chain_any =
-      source_types[envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
-                       FilterChainMatch_ConnectionSourceType_ANY];
-
-  return filter_chain_any.get();
 }
 
-bool ListenerImpl::createNetworkFilterChain(
-    Network::Connection& connection,
-    const std::vector<Network::FilterFactoryCb>& filter_factories) {
-  return Configuration::FilterChainUtility::buildFilterChain(connection, filter_factories);
-}
-
-bool ListenerImpl::createListenerFilterChain(Network::ListenerFilterManager& manager) {
-  return Configuration::FilterChainUtility::buildFilterChain(manager, listener_filter_factories_);
+bool FilterChainFactoryContextImpl::drainClose() const {
+  // A removed filter chain drains on its own, otherwise it drains with its listener.
+  const DrainManager* drain_manager = drain_manager_;
+  return (drain_manager != nullptr && drain_manager->drainClose()) ||
+         local_drain_manager_->drainClose() || server_.drainManager().drainClose();
 }
 
 bool ListenerImpl::drainClose() const {
@@ -633,40 +465,78 @@ void ListenerImpl::initialize() {
   // per listener init manager. See ~ListenerImpl() for why we gate the onListenerWarmed() call
   // by resetting the watcher.
   if (workers_started_) {
-    dynamic_init_manager_.initialize(*init_watcher_);
+    dynamic_init_manager_->initialize(*init_watcher_);
   }
 }
 
 Init::Manager& ListenerImpl::initManager() {
   // See initialize() for why we choose different init managers to return.
   if (workers_started_) {
-    return dynamic_init_manager_;
+    return *dynamic_init_manager_;
   } else {
     return parent_.server_.initManager();
   }
 }
 
-void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
-  ASSERT(!socket_);
-  socket_ = socket;
-  // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
-    // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
-                                            envoy::api::v2::core::SocketOption::STATE_BOUND);
-    const std::string message =
-        fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
-    if (!ok) {
-      ENVOY_LOG(warn, "{}", message);
-      throw EnvoyException(message);
-    } else {
-      ENVOY_LOG(debug, "{}", message);
+Network::Socket& ListenerImpl::workerSocket(uint32_t worker_index) {
+  // Without reuse_port, all the workers share the single socket of the listener.
+  if (!reuse_port_) {
+    return *sockets_[0];
+  }
+  // Falling back to another worker's socket would make two workers accept on the same socket.
+  if (worker_index >= sockets_.size()) {
+    throw EnvoyException(fmt::format("listener '{}' has no listen socket for worker {} of {}",
+                                     name_, worker_index, sockets_.size()));
+  }
+  return *sockets_[worker_index];
+}
+
+void ListenerImpl::setSockets(const std::vector<Network::SocketSharedPtr>& sockets) {
+  ASSERT(sockets_.empty());
+  ASSERT(!sockets.empty());
+  sockets_ = sockets;
+  for (const auto& socket : sockets_) {
+    // Server config validation sets nullptr sockets.
+    if (socket && listen_socket_options_) {
+      // 'pre_bind = false' as bind() is never done after this.
+      bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket,
+                                              envoy::api::v2::core::SocketOption::STATE_BOUND);
+      const std::string message =
+          fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
+      if (!ok) {
+        ENVOY_LOG(warn, "{}", message);
+        throw EnvoyException(message);
+      } else {
+        ENVOY_LOG(debug, "{}", message);
+      }
+
+      // Add the options to the socket so that STATE_LISTENING options can be
+      // set in the worker after listen()/evconnlistener_new() is called.
+      socket->addOptions(listen_socket_options_);
     }
+  }
+}
 
-    // Add the options to the socket_ so that STATE_LISTENING options can be
-    // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+std::vector<Network::SocketSharedPtr>
+ListenerManagerImpl::createListenSockets(ListenerImpl& listener) {
+  std::vector<Network::SocketSharedPtr> sockets;
+  sockets.push_back(factory_.createListenSocket(listener.address(), listener.socketType(),
+                                                listener.listenSocketOptions(),
+                                                listener.bindToPort(), 0));
+  if (!listener.reusePort() || sockets[0] == nullptr) {
+    return sockets;
   }
+
+  // With SO_REUSEPORT every worker gets its own socket bound to the same address and the kernel
+  // distributes incoming connections between them. If the listener is bound to port 0 the other
+  // sockets must use the port picked by the kernel for the first one.
+  const Network::Address::InstanceConstSharedPtr address = sockets[0]->localAddress();
+  for (uint32_t i = 1; i < workers_.size(); i++) {
+    sockets.push_back(factory_.createListenSocket(address, listener.socketType(),
+                                                  listener.listenSocketOptions(),
+                                                  listener.bindToPort(), i));
+  }
+  return sockets;
 }
 
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
@@ -679,7 +549,7 @@ ListenerManagerImpl::ListenerManagerImpl(Instance& server,
           "listeners", [this] { return dumpListenerConfigs(); })),
       enable_dispatcher_stats_(enable_dispatcher_stats) {
   for (uint32_t i = 0; i < server.options().concurrency(); i++) {
-    workers_.emplace_back(worker_factory.createWorker(server.overloadManager()));
+    workers_.emplace_back(worker_factory.createWorker(i, server.overloadManager()));
   }
 }
 
@@ -748,8 +618,17 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     return false;
   }
 
-  ListenerImplPtr new_listener(
-      new ListenerImpl(config, version_info, *this, name, modifiable, workers_started_, hash));
+  // Once workers have started, an active listener of which only the filter chains change is
+  // updated in place: the workers keep its listen sockets and the connections of the filter chains
+  // that did not change, instead of draining the whole listener.
+  const ListenerImpl* origin = nullptr;
+  if (workers_started_ && existing_active_listener != active_listeners_.end() &&
+      (*existing_active_listener)->canUpdateInPlace(config)) {
+    origin = existing_active_listener->get();
+  }
+
+  ListenerImplPtr new_listener(new ListenerImpl(config, version_info, *this, name, modifiable,
+                                                workers_started_, hash, origin));
   ListenerImpl& new_listener_ref = *new_listener;
 
   // We mandate that a listener with the same name must have the same configured address. This
@@ -767,17 +646,28 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // The set of listen sockets differs depending on reuse_port, so it cannot be changed in place.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message =
+        fmt::format("error updating listener: '{}' cannot change reuse_port in place", name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
-    new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setSockets((*existing_warming_listener)->getSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
-    new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->setSockets((*existing_active_listener)->getSockets());
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -806,22 +696,18 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
+    // Draining sockets are only reused if they were created with the same reuse_port setting.
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->reusePort() == listener.listener_->reusePort();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->setSockets(existing_draining_listener->listener_->getSockets());
+    } else {
+      new_listener->setSockets(createListenSockets(*new_listener));
     }
-
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->socketType(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -894,6 +780,58 @@ void ListenerManagerImpl::drainListener(ListenerImplPtr&& listener) {
   updateWarmingActiveGauges();
 }
 
+void ListenerManagerImpl::drainFilterChains(ListenerImplPtr&& listener,
+                                            ListenerImpl& updated_listener) {
+  std::list<DrainingFilterChains>::iterator draining_it = draining_filter_chains_.emplace(
+      draining_filter_chains_.begin(), std::move(listener), workers_.size());
+  draining_it->filter_chains_ = draining_it->listener_->removedFilterChains(updated_listener);
+  updateFilterChainsDrainingGauge();
+
+  // Even if no filter chain has been removed, the listener is kept until the workers have switched
+  // to its new version.
+  if (draining_it->filter_chains_.empty()) {
+    removeFilterChainsFromWorkers(draining_it);
+    return;
+  }
+
+  // Start the drain sequence of the removed filter chains, which completes at whatever the server
+  // configured drain times are.
+  draining_it->listener_->debugLog("draining filter chains");
+  draining_it->drain_manager_ =
+      factory_.createDrainManager(draining_it->listener_->config().drain_type());
+  draining_it->listener_->startDrainingFilterChains(draining_it->filter_chains_,
+                                                    *draining_it->drain_manager_);
+  draining_it->drain_manager_->startDrainSequence(
+      [this, draining_it]() -> void { removeFilterChainsFromWorkers(draining_it); });
+}
+
+void ListenerManagerImpl::removeFilterChainsFromWorkers(
+    std::list<DrainingFilterChains>::iterator draining_it) {
+  draining_it->listener_->debugLog("removing filter chains");
+  for (const auto& worker : workers_) {
+    worker->removeFilterChains(draining_it->filter_chains_, [this, draining_it]() -> void {
+      // Same as in drainListener(), the completion is called on the worker thread.
+      server_.dispatcher().post([this, draining_it]() -> void {
+        if (--draining_it->workers_pending_removal_ == 0) {
+          draining_it->listener_->debugLog("filter chains removal complete");
+          draining_filter_chains_.erase(draining_it);
+          updateFilterChainsDrainingGauge();
+        }
+      });
+    });
+  }
+}
+
+void ListenerManagerImpl::updateFilterChainsDrainingGauge() {
+  uint64_t draining_filter_chains = 0;
+  for (const auto& draining : draining_filter_chains_) {
+    draining_filter_chains += draining.filter_chains_.size();
+  }
+  // Using set() avoids a multiple modifiers problem during the multiple processes phase of hot
+  // restart.
+  stats_.total_filter_chains_draining_.set(draining_filter_chains);
+}
+
 ListenerManagerImpl::ListenerList::iterator
 ListenerManagerImpl::getListenerByName(ListenerList& listeners, const std::string& name) {
   auto ret = listeners.end();
@@ -918,7 +856,7 @@ std::vector<std::reference_wrapper<Network::ListenerConfig>> ListenerManagerImpl
 }
 
 void ListenerManagerImpl::addListenerToWorker(Worker& worker, ListenerImpl& listener) {
-  worker.addListener(listener, [this, &listener](bool success) -> void {
+  auto completion = [this, &listener](bool success) -> void {
     // The add listener completion runs on the worker thread. Post back to the main thread to
     // avoid locking.
     server_.dispatcher().post([this, success, &listener]() -> void {
@@ -940,7 +878,13 @@ void ListenerManagerImpl::addListenerToWorker(Worker& worker, ListenerImpl& list
         stats_.listener_create_success_.inc();
       }
     });
-  });
+  };
+  // A listener that updates another in place has the same tag.
+  if (listener.updatesInPlace()) {
+    worker.updateListener(listener.listenerTag(), listener, completion);
+  } else {
+    worker.addListener(listener, completion);
+  }
 }
 
 void ListenerManagerImpl::onListenerWarmed(ListenerImpl& listener) {
@@ -954,7 +898,12 @@ void ListenerManagerImpl::onListenerWarmed(ListenerImpl& listener) {
   auto existing_warming_listener = getListenerByName(warming_listeners_, listener.name());
   (*existing_warming_listener)->debugLog("warm complete. updating active listener");
   if (existing_active_listener != active_listeners_.end()) {
-    drainListener(std::move(*existing_active_listener));
+    if (listener.updatesInPlace()) {
+      stats_.listener_in_place_updated_.inc();
+      drainFilterChains(std::move(*existing_active_listener), listener);
+    } else {
+      drainListener(std::move(*existing_active_listener));
+    }
     *existing_active_listener = std::move(*existing_warming_listener);
   } else {
     active_listeners_.emplace_back(std::move(*existing_warming_listener));
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "envoy/api/v2/listener/listener.pb.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/filter.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/server/instance.h"
@@ -13,11 +15,12 @@
 
 #include "common/common/logger.h"
 #include "common/init/manager_impl.h"
-#include "common/network/cidr_range.h"
-#include "common/network/lc_trie.h"
 
+#include "server/filter_chain_manager_impl.h"
 #include "server/lds_api.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Server {
 
@@ -64,7 +67,7 @@ public:
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               Network::Address::SocketType socket_type,
                                               const Network::Socket::OptionsSharedPtr& options,
-                                              bool bind_to_port) override;
+                                              bool bind_to_port, uint32_t worker_index) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -86,9 +89,11 @@ typedef std::unique_ptr<ListenerImpl> ListenerImplPtr;
   COUNTER(listener_removed)                                                                        \
   COUNTER(listener_create_success)                                                                 \
   COUNTER(listener_create_failure)                                                                 \
+  COUNTER(listener_in_place_updated)                                                               \
   GAUGE  (total_listeners_warming)                                                                 \
   GAUGE  (total_listeners_active)                                                                  \
-  GAUGE  (total_listeners_draining)
+  GAUGE  (total_listeners_draining)                                                                \
+  GAUGE  (total_filter_chains_draining)
 // clang-format on
 
 /**
@@ -137,7 +142,19 @@ private:
     uint64_t workers_pending_removal_;
   };
 
+  struct DrainingFilterChains {
+    DrainingFilterChains(ListenerImplPtr&& listener, uint64_t workers_pending_removal)
+        : listener_(std::move(listener)), workers_pending_removal_(workers_pending_removal) {}
+
+    // Declared first so that it outlives the filter chains that refer to it.
+    DrainManagerPtr drain_manager_;
+    ListenerImplPtr listener_;
+    std::vector<const Network::FilterChain*> filter_chains_;
+    uint64_t workers_pending_removal_;
+  };
+
   void addListenerToWorker(Worker& worker, ListenerImpl& listener);
+  std::vector<Network::SocketSharedPtr> createListenSockets(ListenerImpl& listener);
   ProtobufTypes::MessagePtr dumpListenerConfigs();
   static ListenerManagerStats generateStats(Stats::Scope& scope);
   static bool hasListenerWithAddress(const ListenerList& list,
@@ -156,6 +173,17 @@ private:
    */
   void drainListener(ListenerImplPtr&& listener);
 
+  /**
+   * Drain the filter chains of a listener that has been updated in place and that the new version
+   * of the listener does not reuse. The listener is kept until the workers have switched to the
+   * new version and closed the connections of the removed filter chains.
+   * @param listener supplies the listener that has been updated in place.
+   * @param updated_listener supplies the new version of the listener.
+   */
+  void drainFilterChains(ListenerImplPtr&& listener, ListenerImpl& updated_listener);
+  void removeFilterChainsFromWorkers(std::list<DrainingFilterChains>::iterator draining_it);
+  void updateFilterChainsDrainingGauge();
+
   /**
    * Get a listener by name. This routine is used because listeners have inherent order in static
    * configuration and especially for tests. Thus, we can't use a map.
@@ -175,6 +203,8 @@ private:
   // connections are drained. Then after that time period the listener is removed from all workers
   // and any remaining connections are closed.
   std::list<DrainingListener> draining_listeners_;
+  // Listeners that have been updated in place and whose removed filter chains are being drained.
+  std::list<DrainingFilterChains> draining_filter_chains_;
   std::list<WorkerPtr> workers_;
   bool workers_started_{};
   Stats::ScopePtr scope_;
@@ -184,6 +214,72 @@ private:
   const bool enable_dispatcher_stats_{};
 };
 
+/**
+ * Factory context of the network filters of a filter chain. Filter chains that did not change are
+ * reused by the next version of their listener when it is updated in place, so this context only
+ * holds listener state that is shared between the versions of the listener.
+ */
+class FilterChainFactoryContextImpl : public Configuration::FactoryContext,
+                                      public Network::DrainDecision {
+public:
+  FilterChainFactoryContextImpl(Instance& server, const Stats::ScopeSharedPtr& global_scope,
+                                const Stats::ScopeSharedPtr& listener_scope,
+                                const std::shared_ptr<DrainManager>& local_drain_manager,
+                                const std::shared_ptr<Init::ManagerImpl>& dynamic_init_manager,
+                                bool workers_started,
+                                const envoy::api::v2::core::Metadata& listener_metadata)
+      : server_(server), global_scope_(global_scope), listener_scope_(listener_scope),
+        local_drain_manager_(local_drain_manager), dynamic_init_manager_(dynamic_init_manager),
+        workers_started_(workers_started), listener_metadata_(listener_metadata) {}
+
+  /**
+   * Start draining the connections of the filter chain after it has been removed from its
+   * listener.
+   * @param drain_manager supplies the drain manager of the removed filter chains. It must outlive
+   *        this context.
+   */
+  void startDraining(const DrainManager& drain_manager) { drain_manager_ = &drain_manager; }
+
+  // Server::Configuration::FactoryContext
+  AccessLog::AccessLogManager& accessLogManager() override { return server_.accessLogManager(); }
+  Upstream::ClusterManager& clusterManager() override { return server_.clusterManager(); }
+  Event::Dispatcher& dispatcher() override { return server_.dispatcher(); }
+  Network::DrainDecision& drainDecision() override { return *this; }
+  bool healthCheckFailed() override { return server_.healthCheckFailed(); }
+  Tracing::HttpTracer& httpTracer() override { return httpContext().tracer(); }
+  Http::Context& httpContext() override { return server_.httpContext(); }
+  Init::Manager& initManager() override;
+  const LocalInfo::LocalInfo& localInfo() const override { return server_.localInfo(); }
+  Envoy::Runtime::RandomGenerator& random() override { return server_.random(); }
+  Envoy::Runtime::Loader& runtime() override { return server_.runtime(); }
+  Stats::Scope& scope() override { return *global_scope_; }
+  Singleton::Manager& singletonManager() override { return server_.singletonManager(); }
+  OverloadManager& overloadManager() override { return server_.overloadManager(); }
+  ThreadLocal::Instance& threadLocal() override { return server_.threadLocal(); }
+  Admin& admin() override { return server_.admin(); }
+  Stats::Scope& listenerScope() override { return *listener_scope_; }
+  const envoy::api::v2::core::Metadata& listenerMetadata() const override {
+    return listener_metadata_;
+  }
+  TimeSource& timeSource() override { return api().timeSource(); }
+  Api::Api& api() override { return server_.api(); }
+  ServerLifecycleNotifier& lifecycleNotifier() override { return server_.lifecycleNotifier(); }
+
+  // Network::DrainDecision
+  bool drainClose() const override;
+
+private:
+  Instance& server_;
+  const Stats::ScopeSharedPtr global_scope_;
+  const Stats::ScopeSharedPtr listener_scope_;
+  const std::shared_ptr<DrainManager> local_drain_manager_;
+  const std::shared_ptr<Init::ManagerImpl> dynamic_init_manager_;
+  const bool workers_started_;
+  const envoy::api::v2::core::Metadata listener_metadata_;
+  // Set on the main thread once the filter chain is removed, read on the workers.
+  std::atomic<const DrainManager*> drain_manager_{nullptr};
+};
+
 // TODO(mattklein123): Consider getting rid of pre-worker start and post-worker start code by
 //                     initializing all listeners after workers are started.
 
@@ -193,7 +289,6 @@ private:
 class ListenerImpl : public Network::ListenerConfig,
                      public Configuration::ListenerFactoryContext,
                      public Network::DrainDecision,
-                     public Network::FilterChainManager,
                      public Network::FilterChainFactory,
                      Logger::Loggable<Logger::Id::config> {
 public:
@@ -207,10 +302,13 @@ public:
    * @param workers_started supplies whether the listener is being added before or after workers
    *        have been started. This controls various behavior related to init management.
    * @param hash supplies the hash to use for duplicate checking.
+   * @param origin supplies the active listener that this listener updates in place, or nullptr.
+   *        The new listener takes over the tag, stats scopes and drain manager of the origin, and
+   *        reuses its filter chains that did not change. @see canUpdateInPlace().
    */
   ListenerImpl(const envoy::api::v2::Listener& config, const std::string& version_info,
                ListenerManagerImpl& parent, const std::string& name, bool modifiable,
-               bool workers_started, uint64_t hash);
+               bool workers_started, uint64_t hash, const ListenerImpl* origin);
   ~ListenerImpl();
 
   /**
@@ -219,6 +317,32 @@ public:
   bool blockUpdate(uint64_t new_hash) { return new_hash == hash_ || !modifiable_; }
   bool blockRemove() { return !modifiable_; }
 
+  /**
+   * @return TRUE if the listener can be updated in place to the given configuration, which is the
+   *         case when only its filter chains differ.
+   */
+  bool canUpdateInPlace(const envoy::api::v2::Listener& config) const;
+
+  /**
+   * @return TRUE if the listener updates the active listener with the same name in place.
+   */
+  bool updatesInPlace() const { return updates_in_place_; }
+
+  /**
+   * @return the filter chains of this listener that an in place update of it does not reuse.
+   * @param updated_listener supplies the new version of the listener.
+   */
+  std::vector<const Network::FilterChain*>
+  removedFilterChains(const ListenerImpl& updated_listener) const;
+
+  /**
+   * Start draining the connections of some of the filter chains of this listener.
+   * @param filter_chains supplies the filter chains to drain.
+   * @param drain_manager supplies the drain manager to use. It must outlive the listener.
+   */
+  void startDrainingFilterChains(const std::vector<const Network::FilterChain*>& filter_chains,
+                                 const DrainManager& drain_manager);
+
   /**
    * Called when a listener failed to be actually created on a worker.
    * @return TRUE if we have seen more than one worker failure.
@@ -232,20 +356,26 @@ public:
   Network::Address::InstanceConstSharedPtr address() const { return address_; }
   Network::Address::SocketType socketType() const { return socket_type_; }
   const envoy::api::v2::Listener& config() { return config_; }
-  const Network::SocketSharedPtr& getSocket() const { return socket_; }
+  const std::vector<Network::SocketSharedPtr>& getSockets() const { return sockets_; }
+  bool reusePort() const { return reuse_port_; }
   void debugLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
-  void setSocket(const Network::SocketSharedPtr& socket);
-  void setSocketAndOptions(const Network::SocketSharedPtr& socket);
+  /**
+   * Set the listen sockets of the listener. The first socket is used as socket(). Listeners that
+   * use SO_REUSEPORT have one socket for each worker, all other listeners have a single socket
+   * shared by all workers.
+   */
+  void setSockets(const std::vector<Network::SocketSharedPtr>& sockets);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
 
   // Network::ListenerConfig
-  Network::FilterChainManager& filterChainManager() override { return *this; }
+  Network::FilterChainManager& filterChainManager() override { return filter_chain_manager_; }
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
-  Network::Socket& socket() override { return *socket_; }
-  const Network::Socket& socket() const override { return *socket_; }
+  Network::Socket& socket() override { return *sockets_[0]; }
+  const Network::Socket& socket() const override { return *sockets_[0]; }
+  Network::Socket& workerSocket(uint32_t worker_index) override;
   bool bindToPort() override { return bind_to_port_; }
   bool handOffRestoredDestinationConnections() const override {
     return hand_off_restored_destination_connections_;
@@ -259,6 +389,7 @@ public:
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() const override { return listener_tag_; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
 
   // Server::Configuration::ListenerFactoryContext
   AccessLog::AccessLogManager& accessLogManager() override {
@@ -306,10 +437,6 @@ public:
   // Network::DrainDecision
   bool drainClose() const override;
 
-  // Network::FilterChainManager
-  const Network::FilterChain*
-  findFilterChain(const Network::ConnectionSocket& socket) const override;
-
   // Network::FilterChainFactory
   bool createNetworkFilterChain(Network::Connection& connection,
                                 const std::vector<Network::FilterFactoryCb>& factories) override;
@@ -318,86 +445,26 @@ public:
   SystemTime last_updated_;
 
 private:
-  typedef std::array<Network::FilterChainSharedPtr, 3> SourceTypesArray;
-  typedef std::unordered_map<std::string, SourceTypesArray> ApplicationProtocolsMap;
-  typedef std::unordered_map<std::string, ApplicationProtocolsMap> TransportProtocolsMap;
-  // Both exact server names and wildcard domains are part of the same map, in which wildcard
-  // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
-  // between exact and wildcard entries.
-  typedef std::unordered_map<std::string, TransportProtocolsMap> ServerNamesMap;
-  typedef std::unordered_map<std::string, ServerNamesMap> DestinationIPsMap;
-  typedef std::shared_ptr<ServerNamesMap> ServerNamesMapSharedPtr;
-  typedef Network::LcTrie::LcTrie<ServerNamesMapSharedPtr> DestinationIPsTrie;
-  typedef std::unique_ptr<DestinationIPsTrie> DestinationIPsTriePtr;
-  typedef std::unordered_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>
-      DestinationPortsMap;
-
-  void
-  addFilterChain(uint16_t destination_port, const std::vector<std::string>& destination_ips,
-                 const std::vector<std::string>& server_names,
-                 const std::string& transport_protocol,
-                 const std::vector<std::string>& application_protocols,
-                 const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-                 Network::TransportSocketFactoryPtr&& transport_socket_factory,
-                 std::vector<Network::FilterFactoryCb> filters_factory);
-  void addFilterChainForDestinationPorts(
-      DestinationPortsMap& destination_ports_map, uint16_t destination_port,
-      const std::vector<std::string>& destination_ips, const std::vector<std::string>& server_names,
-      const std::string& transport_protocol, const std::vector<std::string>& application_protocols,
-      const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForDestinationIPs(
-      DestinationIPsMap& destination_ips_map, const std::vector<std::string>& destination_ips,
-      const std::vector<std::string>& server_names, const std::string& transport_protocol,
-      const std::vector<std::string>& application_protocols,
-      const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForServerNames(
-      ServerNamesMap& server_names_map, const std::vector<std::string>& server_names,
-      const std::string& transport_protocol, const std::vector<std::string>& application_protocols,
-      const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForApplicationProtocols(
-      ApplicationProtocolsMap& application_protocol_map,
-      const std::vector<std::string>& application_protocols,
-      const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForSourceTypes(
-      SourceTypesArray& source_types_array,
-      const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-      const Network::FilterChainSharedPtr& filter_chain);
-
-  void convertDestinationIPsMapToTrie();
-
-  const Network::FilterChain*
-  findFilterChainForDestinationIP(const DestinationIPsTrie& destination_ips_trie,
-                                  const Network::ConnectionSocket& socket) const;
-  const Network::FilterChain*
-  findFilterChainForServerName(const ServerNamesMap& server_names_map,
-                               const Network::ConnectionSocket& socket) const;
-  const Network::FilterChain*
-  findFilterChainForTransportProtocol(const TransportProtocolsMap& transport_protocols_map,
-                                      const Network::ConnectionSocket& socket) const;
-  const Network::FilterChain*
-  findFilterChainForApplicationProtocols(const ApplicationProtocolsMap& application_protocols_map,
-                                         const Network::ConnectionSocket& socket) const;
-  const Network::FilterChain*
-  findFilterChainForSourceTypes(const SourceTypesArray& source_types,
-                                const Network::ConnectionSocket& socket) const;
-
-  static bool isWildcardServerName(const std::string& name);
-
-  // Mapping of FilterChain's configured destination ports, IPs, server names, transport protocols
-  // and application protocols, using structures defined above.
-  DestinationPortsMap destination_ports_map_;
+  // A filter chain with the factory context of its network filters, both of which are shared with
+  // the next version of the listener if the filter chain is reused.
+  struct FilterChainEntry {
+    const envoy::api::v2::listener::FilterChain* config_;
+    std::shared_ptr<FilterChainFactoryContextImpl> context_;
+    Network::FilterChainSharedPtr filter_chain_;
+  };
+
+  const FilterChainEntry*
+  findReusableFilterChain(const envoy::api::v2::listener::FilterChain& config, uint64_t hash) const;
 
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
   Network::Address::SocketType socket_type_;
-  Network::SocketSharedPtr socket_;
-  Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
-  Stats::ScopePtr listener_scope_; // Stats with listener named scope.
+  std::vector<Network::SocketSharedPtr> sockets_;
+  // Both scopes are shared with the versions of the listener that update it in place.
+  Stats::ScopeSharedPtr global_scope_;   // Stats with global named scope, needed for LDS cleanup.
+  Stats::ScopeSharedPtr listener_scope_; // Stats with listener named scope.
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
   const uint64_t listener_tag_;
@@ -405,42 +472,30 @@ private:
   const bool modifiable_;
   const bool workers_started_;
   const uint64_t hash_;
+  const bool updates_in_place_;
 
   // This init manager is populated with targets from the filter chain factories, namely
-  // RdsRouteConfigSubscription::init_target_, so the listener can wait for route configs.
-  Init::ManagerImpl dynamic_init_manager_;
+  // RdsRouteConfigSubscription::init_target_, so the listener can wait for route configs. It is
+  // shared with the factory contexts of the filter chains, which may outlive the listener.
+  std::shared_ptr<Init::ManagerImpl> dynamic_init_manager_;
 
   // This init watcher, if available, notifies the "parent" listener manager when listener
   // initialization is complete. It may be reset to cancel interest.
   std::unique_ptr<Init::WatcherImpl> init_watcher_;
   std::vector<Network::ListenerFilterFactoryCb> listener_filter_factories_;
-  DrainManagerPtr local_drain_manager_;
+  std::shared_ptr<DrainManager> local_drain_manager_;
   bool saw_listener_create_failure_{};
   const envoy::api::v2::Listener config_;
   const std::string version_info_;
   Network::Socket::OptionsSharedPtr listen_socket_options_;
   const std::chrono::milliseconds listener_filters_timeout_;
-};
-
-class FilterChainImpl : public Network::FilterChain {
-public:
-  FilterChainImpl(Network::TransportSocketFactoryPtr&& transport_socket_factory,
-                  std::vector<Network::FilterFactoryCb> filters_factory)
-      : transport_socket_factory_(std::move(transport_socket_factory)),
-        filters_factory_(std::move(filters_factory)) {}
-
-  // Network::FilterChain
-  const Network::TransportSocketFactory& transportSocketFactory() const override {
-    return *transport_socket_factory_;
-  }
-
-  const std::vector<Network::FilterFactoryCb>& networkFilterFactories() const override {
-    return filters_factory_;
-  }
-
-private:
-  const Network::TransportSocketFactoryPtr transport_socket_factory_;
-  const std::vector<Network::FilterFactoryCb> filters_factory_;
+  Network::ConnectionBalancerPtr connection_balancer_;
+  std::vector<FilterChainEntry> filter_chains_;
+  // Indexes of filter_chains_ by the hash of their configuration. Only the first of filter chains
+  // with colliding hashes is indexed, which only means that the others can't be reused.
+  absl::flat_hash_map<uint64_t, size_t> filter_chains_by_hash_;
+  // Declared last so that the filter chains are destroyed before the rest of the listener.
+  FilterChainManagerImpl filter_chain_manager_;
 };
 
 } // namespace Server
@@ -13,12 +13,12 @@
 namespace Envoy {
 namespace Server {
 
-WorkerPtr ProdWorkerFactory::createWorker(OverloadManager& overload_manager) {
+WorkerPtr ProdWorkerFactory::createWorker(uint32_t index, OverloadManager& overload_manager) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
-  return WorkerPtr{new WorkerImpl(
-      tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)},
-      overload_manager, api_)};
+  return WorkerPtr{new WorkerImpl(tls_, hooks_, std::move(dispatcher),
+                                  Network::ConnectionHandlerPtr{
+                                      new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher, index)},
+                                  overload_manager, api_)};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, ListenerHooks& hooks,
@@ -48,6 +48,31 @@ void WorkerImpl::addListener(Network::ListenerConfig& listener, AddListenerCompl
   });
 }
 
+void WorkerImpl::updateListener(uint64_t overridden_listener_tag,
+                                Network::ListenerConfig& listener,
+                                AddListenerCompletion completion) {
+  // Updating a listener in place only creates a listener on the worker if the worker never had the
+  // overridden one, which can fail the same way as in addListener().
+  dispatcher_->post([this, overridden_listener_tag, &listener, completion]() -> void {
+    try {
+      handler_->updateListener(overridden_listener_tag, listener);
+      hooks_.onWorkerListenerAdded();
+      completion(true);
+    } catch (const Network::CreateListenerException& e) {
+      completion(false);
+    }
+  });
+}
+
+void WorkerImpl::removeFilterChains(const std::vector<const Network::FilterChain*>& filter_chains,
+                                    std::function<void()> completion) {
+  ASSERT(thread_);
+  dispatcher_->post([this, filter_chains, completion]() -> void {
+    handler_->removeFilterChains(filter_chains);
+    completion();
+  });
+}
+
 uint64_t WorkerImpl::numConnections() {
   uint64_t ret = 0;
   if (handler_) {
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "envoy/api/api.h"
 #include "envoy/network/connection_handler.h"
@@ -23,7 +24,7 @@ public:
       : tls_(tls), api_(api), hooks_(hooks) {}
 
   // Server::WorkerFactory
-  WorkerPtr createWorker(OverloadManager& overload_manager) override;
+  WorkerPtr createWorker(uint32_t index, OverloadManager& overload_manager) override;
 
 private:
   ThreadLocal::Instance& tls_;
@@ -42,6 +43,10 @@ public:
 
   // Server::Worker
   void addListener(Network::ListenerConfig& listener, AddListenerCompletion completion) override;
+  void updateListener(uint64_t overridden_listener_tag, Network::ListenerConfig& listener,
+                      AddListenerCompletion completion) override;
+  void removeFilterChains(const std::vector<const Network::FilterChain*>& filter_chains,
+                          std::function<void()> completion) override;
   uint64_t numConnections() override;
   void removeListener(Network::ListenerConfig& listener, std::function<void()> completion) override;
   void start(GuardDog& guard_dog) override;
@@ -0,0 +1,111 @@
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "common/common/atomic_token_bucket_impl.h"
+
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+class AtomicTokenBucketImplTest : public testing::Test {
+protected:
+  Event::SimulatedTimeSystem time_system_;
+};
+
+// Verifies AtomicTokenBucket initialization.
+TEST_F(AtomicTokenBucketImplTest, Initialization) {
+  AtomicTokenBucketImpl token_bucket{1, time_system_, -1.0};
+
+  EXPECT_EQ(1, token_bucket.consume(1, false));
+  EXPECT_EQ(0, token_bucket.consume(1, false));
+}
+
+// Verifies AtomicTokenBucket's maximum capacity.
+TEST_F(AtomicTokenBucketImplTest, MaxBucketSize) {
+  AtomicTokenBucketImpl token_bucket{3, time_system_, 1};
+
+  EXPECT_EQ(3, token_bucket.consume(3, false));
+  time_system_.setMonotonicTime(std::chrono::seconds(10));
+  EXPECT_EQ(0, token_bucket.consume(4, false));
+  EXPECT_EQ(3, token_bucket.consume(3, false));
+}
+
+// Verifies that AtomicTokenBucket can consume and refill tokens.
+TEST_F(AtomicTokenBucketImplTest, Consume) {
+  AtomicTokenBucketImpl token_bucket{10, time_system_, 1};
+
+  EXPECT_EQ(0, token_bucket.consume(20, false));
+  EXPECT_EQ(9, token_bucket.consume(9, false));
+
+  EXPECT_EQ(1, token_bucket.consume(1, false));
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(999));
+  EXPECT_EQ(0, token_bucket.consume(1, false));
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(5999));
+  EXPECT_EQ(0, token_bucket.consume(6, false));
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(6000));
+  EXPECT_EQ(6, token_bucket.consume(6, false));
+  EXPECT_EQ(0, token_bucket.consume(1, false));
+}
+
+// Verifies that AtomicTokenBucket can consume fewer tokens than asked for.
+TEST_F(AtomicTokenBucketImplTest, PartialConsume) {
+  AtomicTokenBucketImpl token_bucket{16, time_system_, 16};
+
+  EXPECT_EQ(16, token_bucket.consume(18, true));
+  EXPECT_EQ(0, token_bucket.consume(1, true));
+  time_system_.setMonotonicTime(std::chrono::milliseconds(62));
+  EXPECT_EQ(0, token_bucket.consume(1, true));
+  time_system_.setMonotonicTime(std::chrono::milliseconds(63));
+  EXPECT_EQ(1, token_bucket.consume(2, true));
+}
+
+// Verifies the time until the next token is available.
+TEST_F(AtomicTokenBucketImplTest, NextTokenAvailable) {
+  AtomicTokenBucketImpl token_bucket{10, time_system_, 5};
+  EXPECT_EQ(9, token_bucket.consume(9, false));
+  EXPECT_EQ(0, token_bucket.nextTokenAvailable().count());
+  EXPECT_EQ(1, token_bucket.consume(1, false));
+  EXPECT_EQ(200, token_bucket.nextTokenAvailable().count());
+  time_system_.setMonotonicTime(std::chrono::milliseconds(150));
+  EXPECT_EQ(50, token_bucket.nextTokenAvailable().count());
+}
+
+// Verifies that AtomicTokenBucket can be reset.
+TEST_F(AtomicTokenBucketImplTest, Reset) {
+  AtomicTokenBucketImpl token_bucket{1, time_system_, 1};
+  token_bucket.reset(0);
+  EXPECT_EQ(0, token_bucket.consume(1, false));
+  time_system_.setMonotonicTime(std::chrono::seconds(1));
+  EXPECT_EQ(1, token_bucket.consume(1, false));
+
+  token_bucket.reset(1);
+  EXPECT_EQ(1, token_bucket.consume(1, false));
+  EXPECT_EQ(0, token_bucket.consume(1, false));
+}
+
+// Verifies that threads consuming from the same bucket do not get more tokens than it holds.
+TEST_F(AtomicTokenBucketImplTest, ConcurrentConsume) {
+  AtomicTokenBucketImpl token_bucket{10000, time_system_, 1};
+  std::atomic<uint64_t> consumed{};
+  std::vector<Thread::ThreadPtr> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&]() -> void {
+      for (int j = 0; j < 5000; j++) {
+        consumed += token_bucket.consume(1, false);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(10000, consumed.load());
+}
+
+} // namespace Envoy
@@ -0,0 +1,91 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/brotli_compressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "brotli/decode.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Compressor {
+namespace {
+
+class BrotliCompressorImplTest : public testing::Test {
+protected:
+  BrotliCompressorImplTest()
+      : decoder_(BrotliDecoderCreateInstance(nullptr, nullptr, nullptr),
+                 &BrotliDecoderDestroyInstance) {}
+
+  // Decodes the data compressed so far, and returns whether the decoder has reached the end of
+  // the stream.
+  bool decompress(const std::string& compressed, std::string& decompressed) {
+    size_t avail_in = compressed.size();
+    const uint8_t* next_in = reinterpret_cast<const uint8_t*>(compressed.data());
+    BrotliDecoderResult result;
+    do {
+      uint8_t chunk[4096];
+      size_t avail_out = sizeof(chunk);
+      uint8_t* next_out = chunk;
+      result = BrotliDecoderDecompressStream(decoder_.get(), &avail_in, &next_in, &avail_out,
+                                             &next_out, nullptr);
+      EXPECT_NE(BROTLI_DECODER_RESULT_ERROR, result);
+      decompressed.append(reinterpret_cast<char*>(chunk), sizeof(chunk) - avail_out);
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+    EXPECT_EQ(0, avail_in);
+    return result == BROTLI_DECODER_RESULT_SUCCESS;
+  }
+
+  std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> decoder_;
+};
+
+// Every flush makes the data compressed so far decodable, and the stream ends when it is
+// finished.
+TEST_F(BrotliCompressorImplTest, CompressFlushThenFinish) {
+  BrotliCompressorImpl compressor(5);
+  Buffer::OwnedImpl buffer;
+  std::string original;
+  std::string decompressed;
+
+  for (uint64_t i = 1; i < 10; i++) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, 4096 * i, i);
+    original += buffer.toString();
+    compressor.compress(buffer, State::Flush);
+    EXPECT_FALSE(decompress(buffer.toString(), decompressed));
+    EXPECT_EQ(original, decompressed);
+    buffer.drain(buffer.length());
+  }
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, 100);
+  original += buffer.toString();
+  compressor.compress(buffer, State::Finish);
+  EXPECT_TRUE(decompress(buffer.toString(), decompressed));
+  EXPECT_EQ(original, decompressed);
+}
+
+// Output that does not fit in one chunk is written in several.
+TEST_F(BrotliCompressorImplTest, CompressWithSmallChunkSize) {
+  BrotliCompressorImpl compressor(11, 8);
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, 8192);
+  const std::string original = buffer.toString();
+
+  compressor.compress(buffer, State::Finish);
+  std::string decompressed;
+  EXPECT_TRUE(decompress(buffer.toString(), decompressed));
+  EXPECT_EQ(original, decompressed);
+}
+
+TEST_F(BrotliCompressorImplTest, CallingFinishOnly) {
+  BrotliCompressorImpl compressor(0);
+  Buffer::OwnedImpl buffer;
+  compressor.compress(buffer, State::Finish);
+  EXPECT_NE(0, buffer.length());
+
+  std::string decompressed;
+  EXPECT_TRUE(decompress(buffer.toString(), decompressed));
+  EXPECT_EQ("", decompressed);
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Envoy
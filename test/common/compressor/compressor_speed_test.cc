@@ -0,0 +1,132 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/fmt.h"
+#include "common/compressor/brotli_compressor_impl.h"
+#include "common/compressor/zlib_compressor_impl.h"
+#include "common/compressor/zstd_compressor_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Compressor {
+
+// A JSON API response of range(0) records, the kind of payload that the gzip filter mostly
+// compresses.
+static std::string jsonPayload(uint32_t records) {
+  std::string payload = "[";
+  for (uint32_t i = 0; i < records; i++) {
+    payload += fmt::format(
+        R"({}{{"id": {}, "name": "user-{}", "email": "user-{}@example.com", "active": {}, )"
+        R"("created_at": "2019-03-{:02}T10:{:02}:00Z", "roles": ["reader", "writer"]}})",
+        i == 0 ? "" : ",", i, i * 7919 % 100000, i, i % 3 == 0 ? "true" : "false", i % 28 + 1,
+        i % 60);
+  }
+  return payload + "]";
+}
+
+// Strings that the records share, as a client and server would agree on out of band.
+static const char JsonDictionary[] =
+    R"({"id": , "name": "user-", "email": "user-@example.com", "active": true, "active": false, )"
+    R"("created_at": "2019-03-T10::00Z", "roles": ["reader", "writer"]})";
+
+// Compresses the payload as a single response, with a new compressor from create_compressor for
+// every response, and reports the compressed to uncompressed size ratio along with the throughput.
+template <class CreateCompressor>
+static void compressPayload(benchmark::State& state, CreateCompressor create_compressor) {
+  const std::string payload = jsonPayload(state.range(0));
+  uint64_t compressed_bytes = 0;
+  for (auto _ : state) {
+    CompressorPtr compressor = create_compressor();
+    Buffer::OwnedImpl buffer(payload);
+    compressor->compress(buffer, State::Finish);
+    compressed_bytes = buffer.length();
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+  state.counters["ratio"] = static_cast<double>(compressed_bytes) / payload.size();
+}
+
+static void compressPayload(benchmark::State& state, ZlibCompressorImpl::CompressionLevel level,
+                            int64_t window_bits, bool dictionary) {
+  compressPayload(state, [level, window_bits, dictionary]() -> CompressorPtr {
+    auto compressor = std::make_unique<ZlibCompressorImpl>();
+    compressor->init(level, ZlibCompressorImpl::CompressionStrategy::Standard, window_bits, 8);
+    if (dictionary) {
+      compressor->setDictionary(JsonDictionary);
+    }
+    return compressor;
+  });
+}
+
+static void compressPayloadWithBrotli(benchmark::State& state, uint32_t quality) {
+  compressPayload(state, [quality]() -> CompressorPtr {
+    return std::make_unique<BrotliCompressorImpl>(quality);
+  });
+}
+
+static void compressPayloadWithZstd(benchmark::State& state, int level) {
+  compressPayload(
+      state, [level]() -> CompressorPtr { return std::make_unique<ZstdCompressorImpl>(level); });
+}
+
+static void BM_GzipSpeed(benchmark::State& state) {
+  compressPayload(state, ZlibCompressorImpl::CompressionLevel::Speed, 31, false);
+}
+BENCHMARK(BM_GzipSpeed)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_GzipStandard(benchmark::State& state) {
+  compressPayload(state, ZlibCompressorImpl::CompressionLevel::Standard, 31, false);
+}
+BENCHMARK(BM_GzipStandard)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_GzipBest(benchmark::State& state) {
+  compressPayload(state, ZlibCompressorImpl::CompressionLevel::Best, 31, false);
+}
+BENCHMARK(BM_GzipBest)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_DeflateStandard(benchmark::State& state) {
+  compressPayload(state, ZlibCompressorImpl::CompressionLevel::Standard, 15, false);
+}
+BENCHMARK(BM_DeflateStandard)->Arg(1)->Arg(10)->Arg(1000);
+
+// Dictionaries mostly help small payloads, whose few records cannot reference each other.
+static void BM_DeflateStandardWithDictionary(benchmark::State& state) {
+  compressPayload(state, ZlibCompressorImpl::CompressionLevel::Standard, 15, true);
+}
+BENCHMARK(BM_DeflateStandardWithDictionary)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_BrotliSpeed(benchmark::State& state) { compressPayloadWithBrotli(state, 1); }
+BENCHMARK(BM_BrotliSpeed)->Arg(1)->Arg(10)->Arg(1000);
+
+// The default quality of the gzip filter's br content-coding.
+static void BM_BrotliStandard(benchmark::State& state) { compressPayloadWithBrotli(state, 5); }
+BENCHMARK(BM_BrotliStandard)->Arg(1)->Arg(10)->Arg(1000);
+
+// Quality 11 is meant for static content that is compressed once, and is far too slow to compress
+// responses on the fly.
+static void BM_BrotliBest(benchmark::State& state) { compressPayloadWithBrotli(state, 11); }
+BENCHMARK(BM_BrotliBest)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_ZstdSpeed(benchmark::State& state) { compressPayloadWithZstd(state, 1); }
+BENCHMARK(BM_ZstdSpeed)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_ZstdStandard(benchmark::State& state) { compressPayloadWithZstd(state, 3); }
+BENCHMARK(BM_ZstdStandard)->Arg(1)->Arg(10)->Arg(1000);
+
+static void BM_ZstdBest(benchmark::State& state) { compressPayloadWithZstd(state, 19); }
+BENCHMARK(BM_ZstdBest)->Arg(1)->Arg(10)->Arg(1000);
+
+} // namespace Compressor
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
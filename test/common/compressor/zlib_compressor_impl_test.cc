@@ -204,6 +204,33 @@ TEST_F(ZlibCompressorImplTest, CompressWithNotCommonParams) {
   expectValidFinishedBuffer(accumulation_buffer, input_size);
 }
 
+// Exercises compressing a new stream after resetting a compressor, both after finishing a stream
+// and in the middle of one.
+TEST_F(ZlibCompressorImplTest, CompressAfterReset) {
+  Buffer::OwnedImpl buffer;
+
+  ZlibCompressorImplTester compressor;
+  compressor.init(ZlibCompressorImpl::CompressionLevel::Standard,
+                  ZlibCompressorImpl::CompressionStrategy::Standard, gzip_window_bits,
+                  memory_level);
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size);
+  compressor.finish(buffer);
+  expectValidFinishedBuffer(buffer, default_input_size);
+  drainBuffer(buffer);
+
+  compressor.reset();
+  EXPECT_EQ(0, compressor.checksum());
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size);
+  compressor.compressThenFlush(buffer);
+  drainBuffer(buffer);
+
+  compressor.reset();
+  TestUtility::feedBufferWithRandomCharacters(buffer, 2 * default_input_size);
+  compressor.finish(buffer);
+  expectValidFinishedBuffer(buffer, 2 * default_input_size);
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace Envoy
\ No newline at end of file
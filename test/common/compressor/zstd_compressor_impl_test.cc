@@ -0,0 +1,86 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zstd_compressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+#include "zstd.h"
+
+namespace Envoy {
+namespace Compressor {
+namespace {
+
+class ZstdCompressorImplTest : public testing::Test {
+protected:
+  ZstdCompressorImplTest() : dctx_(ZSTD_createDCtx(), &ZSTD_freeDCtx) {}
+
+  // Decodes the data compressed so far, and returns whether the decoder has reached the end of
+  // the frame.
+  bool decompress(const std::string& compressed, std::string& decompressed) {
+    ZSTD_inBuffer input = {compressed.data(), compressed.size(), 0};
+    size_t result;
+    bool output_full;
+    do {
+      char chunk[4096];
+      ZSTD_outBuffer output = {chunk, sizeof(chunk), 0};
+      result = ZSTD_decompressStream(dctx_.get(), &output, &input);
+      EXPECT_FALSE(ZSTD_isError(result)) << ZSTD_getErrorName(result);
+      decompressed.append(chunk, output.pos);
+      output_full = output.pos == output.size;
+    } while (input.pos < input.size || output_full);
+    return result == 0;
+  }
+
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx_;
+};
+
+// Every flush makes the data compressed so far decodable, and the frame ends when it is finished.
+TEST_F(ZstdCompressorImplTest, CompressFlushThenFinish) {
+  ZstdCompressorImpl compressor(3);
+  Buffer::OwnedImpl buffer;
+  std::string original;
+  std::string decompressed;
+
+  for (uint64_t i = 1; i < 10; i++) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, 4096 * i, i);
+    original += buffer.toString();
+    compressor.compress(buffer, State::Flush);
+    EXPECT_FALSE(decompress(buffer.toString(), decompressed));
+    EXPECT_EQ(original, decompressed);
+    buffer.drain(buffer.length());
+  }
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, 100);
+  original += buffer.toString();
+  compressor.compress(buffer, State::Finish);
+  EXPECT_TRUE(decompress(buffer.toString(), decompressed));
+  EXPECT_EQ(original, decompressed);
+}
+
+// Output that does not fit in one chunk is written in several.
+TEST_F(ZstdCompressorImplTest, CompressWithSmallChunkSize) {
+  ZstdCompressorImpl compressor(19, 8);
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, 8192);
+  const std::string original = buffer.toString();
+
+  compressor.compress(buffer, State::Finish);
+  std::string decompressed;
+  EXPECT_TRUE(decompress(buffer.toString(), decompressed));
+  EXPECT_EQ(original, decompressed);
+}
+
+TEST_F(ZstdCompressorImplTest, CallingFinishOnly) {
+  ZstdCompressorImpl compressor(1);
+  Buffer::OwnedImpl buffer;
+  compressor.compress(buffer, State::Finish);
+  EXPECT_NE(0, buffer.length());
+
+  std::string decompressed;
+  EXPECT_TRUE(decompress(buffer.toString(), decompressed));
+  EXPECT_EQ("", decompressed);
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Envoy
@@ -251,6 +251,38 @@ TEST_F(ZlibDecompressorImplTest, CompressDecompressOfMultipleSlices) {
   EXPECT_EQ(original_text, decompressed_text);
 }
 
+// Exercises a zlib stream compressed with a preset dictionary.
+TEST_F(ZlibDecompressorImplTest, CompressDecompressWithDictionary) {
+  const std::string dictionary =
+      R"({"id": "", "name": "", "description": "", "created_at": "", "updated_at": ""})";
+  const std::string original_text =
+      R"({"id": "1", "name": "a", "description": "b", "created_at": "c", "updated_at": "d"})";
+  const int64_t zlib_window_bits = 15;
+
+  const auto compress = [&](const std::string& dictionary) {
+    Envoy::Compressor::ZlibCompressorImpl compressor;
+    compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                    Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                    zlib_window_bits, memory_level);
+    if (!dictionary.empty()) {
+      compressor.setDictionary(dictionary);
+    }
+    Buffer::OwnedImpl buffer(original_text);
+    compressor.compress(buffer, Compressor::State::Finish);
+    return buffer.toString();
+  };
+  const std::string compressed = compress(dictionary);
+  EXPECT_LT(compressed.size(), compress("").size());
+
+  ZlibDecompressorImpl decompressor;
+  decompressor.init(zlib_window_bits);
+  decompressor.setDictionary(dictionary);
+  Buffer::OwnedImpl input(compressed);
+  Buffer::OwnedImpl output;
+  decompressor.decompress(input, output);
+  EXPECT_EQ(original_text, output.toString());
+}
+
 } // namespace
 } // namespace Decompressor
 } // namespace Envoy
@@ -644,6 +644,61 @@ TEST_F(Http1ConnPoolImplTest, ConcurrentConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a connection is prefetched for the next request and then used by it.
+ */
+TEST_F(Http1ConnPoolImplTest, Prefetch) {
+  cluster_->per_upstream_prefetch_ratio_ = 2;
+  cluster_->resetResourceManager(2, 1024, 1024, 1, 1);
+  InSequence s;
+
+  // The first request creates a connection for itself and prefetches a second one.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  // The prefetched connection serves the next request without waiting for a handshake.
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+
+  // The connection circuit breaker stops further prefetching.
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_unused_.value());
+}
+
+/**
+ * Test that a prefetched connection closed before serving a request is counted as unused.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchUnused) {
+  cluster_->per_upstream_prefetch_ratio_ = 1.5;
+  InSequence s;
+
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  r1.completeResponse(false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_unused_.value());
+}
+
 TEST_F(Http1ConnPoolImplTest, DrainCallback) {
   InSequence s;
   ReadyWatcher drained;
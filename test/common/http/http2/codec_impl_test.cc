@@ -385,6 +385,29 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   response_encoder_->encodeTrailers(TestHeaderMapImpl{{"trailing", "header"}});
 }
 
+// Verify that the frames sent by a single sendPendingFrames() call are written at once.
+TEST_P(Http2CodecImplTest, PendingFramesAreWrittenAtOnce) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  // The body fits in the smallest initial windows, and is sent as 3 DATA frames of the default
+  // maximum size, each with a 9 byte frame header.
+  const uint64_t frame_size = 16384;
+  EXPECT_CALL(client_connection_, write(_, _))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ(3 * (frame_size + 9), data.length());
+        server_wrapper_.dispatch(data, *server_);
+      }));
+  EXPECT_CALL(request_decoder_, decodeData(_, false)).Times(2);
+  EXPECT_CALL(request_decoder_, decodeData(_, true));
+  Buffer::OwnedImpl body(std::string(3 * frame_size, 'a'));
+  request_encoder_->encodeData(body, true);
+}
+
 TEST_P(Http2CodecImplTest, SmallMetadataVecTest) {
   allow_metadata_ = true;
   initialize();
@@ -543,6 +543,67 @@ TEST_F(Http2ConnPoolImplTest, DrainPrimary) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+// Verifies that the replacement for a primary client that is about to run out of streams is
+// established ahead of time and promoted once the primary is drained.
+TEST_F(Http2ConnPoolImplTest, Prefetch) {
+  cluster_->max_requests_per_connection_ = 3;
+  cluster_->per_upstream_prefetch_ratio_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+
+  // The second stream leaves one stream on the primary client for two active streams.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 0, true);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+  EXPECT_CALL(*test_clients_[1].connect_timer_, disableTimer());
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The primary client uses up its streams and the prefetched client takes over.
+  ActiveTestRequest r3(*this, 0, true);
+  ActiveTestRequest r4(*this, 1, true);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+
+  completeRequest(r1);
+  completeRequest(r2);
+  completeRequest(r3);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  completeRequestCloseUpstream(1, r4);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_unused_.value());
+}
+
+// Verifies that a prefetched client that the pool closes while it is connecting is not counted as a
+// connect failure.
+TEST_F(Http2ConnPoolImplTest, DrainConnectingPrefetchedClient) {
+  cluster_->max_requests_per_connection_ = 3;
+  cluster_->per_upstream_prefetch_ratio_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 0, true);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  EXPECT_CALL(*test_clients_[1].connect_timer_, disableTimer());
+  pool_.drainConnections();
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_unused_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_connect_fail_.value());
+  EXPECT_EQ(0U, host_->stats().cx_connect_fail_.value());
+
+  // The primary client is closed once its requests complete.
+  completeRequest(r1);
+  completeRequest(r2);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+}
+
 TEST_F(Http2ConnPoolImplTest, DrainPrimaryNoActiveRequest) {
   InSequence s;
   pool_.max_streams_ = 1;
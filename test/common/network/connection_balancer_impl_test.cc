@@ -0,0 +1,67 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class MockBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  MOCK_CONST_METHOD0(numConnections, uint64_t());
+  MOCK_METHOD0(incNumConnections, void());
+  void post(ConnectionSocketPtr&& socket) override { post_(socket.get()); }
+
+  MOCK_METHOD1(post_, void(ConnectionSocket* socket));
+};
+
+TEST(NopConnectionBalancerImplTest, KeepsCurrentHandler) {
+  NopConnectionBalancerImpl balancer;
+  NiceMock<MockBalancedConnectionHandler> handler;
+  balancer.registerHandler(handler);
+  EXPECT_CALL(handler, incNumConnections()).Times(0);
+  EXPECT_EQ(&handler, &balancer.pickTargetHandler(handler));
+  balancer.unregisterHandler(handler);
+}
+
+TEST(ExactConnectionBalancerImplTest, PicksLeastLoadedHandler) {
+  ExactConnectionBalancerImpl balancer;
+  NiceMock<MockBalancedConnectionHandler> handler1;
+  NiceMock<MockBalancedConnectionHandler> handler2;
+  NiceMock<MockBalancedConnectionHandler> handler3;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  ON_CALL(handler1, numConnections()).WillByDefault(Return(3));
+  ON_CALL(handler2, numConnections()).WillByDefault(Return(1));
+  ON_CALL(handler3, numConnections()).WillByDefault(Return(2));
+
+  // The least loaded handler is picked and its count is bumped for the socket in flight.
+  EXPECT_CALL(handler2, incNumConnections());
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler1));
+
+  // The current handler wins ties and is not bumped since it handles the socket itself.
+  ON_CALL(handler1, numConnections()).WillByDefault(Return(1));
+  EXPECT_CALL(handler1, incNumConnections()).Times(0);
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+
+  // Unregistered handlers are no longer considered.
+  balancer.unregisterHandler(handler2);
+  ON_CALL(handler1, numConnections()).WillByDefault(Return(3));
+  EXPECT_CALL(handler3, incNumConnections());
+  EXPECT_EQ(&handler3, &balancer.pickTargetHandler(handler1));
+
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler3);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,93 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "envoy/network/listener.h"
+
+#include "common/common/assert.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/udp_listener_impl.h"
+#include "common/network/utility.h"
+
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+
+class CountingUdpListenerCallbacks : public UdpListenerCallbacks {
+public:
+  // Network::UdpListenerCallbacks
+  void onData(const UdpData& data) override {
+    ++datagrams_;
+    bytes_ += data.buffer_->length();
+  }
+  void onWriteReady(const Socket&) override {}
+  void onError(const ErrorCode&, int) override { RELEASE_ASSERT(false, "unexpected UDP error"); }
+
+  uint64_t datagrams_{};
+  uint64_t bytes_{};
+};
+
+// Sends range(0) datagrams of range(1) bytes over loopback per iteration and measures how long
+// the listener takes to deliver all of them.
+static void BM_UdpListenerReceive(benchmark::State& state) {
+  const uint64_t batch_size = state.range(0);
+  const std::string payload(state.range(1), 'a');
+
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher();
+  UdpListenSocket server_socket(Test::getCanonicalLoopbackAddress(Address::IpVersion::v4), nullptr,
+                                true);
+  CountingUdpListenerCallbacks callbacks;
+  UdpListenerImpl listener(dynamic_cast<Event::DispatcherImpl&>(*dispatcher), server_socket,
+                           callbacks);
+
+  UdpListenSocket client_socket(Test::getCanonicalLoopbackAddress(Address::IpVersion::v4), nullptr,
+                                true);
+  sockaddr_in server_addr{};
+  server_addr.sin_family = AF_INET;
+  server_addr.sin_port = htons(server_socket.localAddress()->ip()->port());
+  server_addr.sin_addr.s_addr = server_socket.localAddress()->ip()->ipv4()->address();
+
+  for (auto _ : state) {
+    const uint64_t expected = callbacks.datagrams_ + batch_size;
+    for (uint64_t i = 0; i < batch_size; ++i) {
+      const ssize_t rc =
+          ::sendto(client_socket.ioHandle().fd(), payload.data(), payload.size(), 0,
+                   reinterpret_cast<const struct sockaddr*>(&server_addr), sizeof(server_addr));
+      RELEASE_ASSERT(rc == static_cast<ssize_t>(payload.size()), "sendto failed");
+    }
+    while (callbacks.datagrams_ < expected) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  state.SetItemsProcessed(callbacks.datagrams_);
+  state.SetBytesProcessed(callbacks.bytes_);
+}
+BENCHMARK(BM_UdpListenerReceive)
+    ->ArgPair(1, 64)
+    ->ArgPair(16, 64)
+    ->ArgPair(64, 64)
+    ->ArgPair(64, 1200)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace Network
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -7,10 +7,12 @@
 #include "common/network/utility.h"
 
 #include "test/common/network/listener_impl_test_base.h"
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -505,6 +507,118 @@ TEST_P(UdpListenerImplTest, UdpListenerRecvFromError) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+/**
+ * Tests that a zero length datagram is delivered to the callbacks, and doesn't stop the read loop.
+ */
+TEST_P(UdpListenerImplTest, UdpListenerZeroLengthDatagram) {
+  SocketPtr server_socket =
+      getSocket(Address::SocketType::Datagram, Network::Test::getCanonicalLoopbackAddress(version_),
+                nullptr, true);
+  ASSERT_NE(server_socket, nullptr);
+
+  Network::MockUdpListenerCallbacks listener_callbacks;
+  Network::TestUdpListenerImpl listener(dispatcherImpl(), *server_socket.get(), listener_callbacks);
+  EXPECT_CALL(listener, doRecvFrom(_, _))
+      .WillRepeatedly(Invoke([&](sockaddr_storage& peer_addr, socklen_t& addr_len) {
+        return listener.doRecvFrom_(peer_addr, addr_len);
+      }));
+
+  SocketPtr client_socket =
+      getSocket(Address::SocketType::Datagram, Network::Test::getCanonicalLoopbackAddress(version_),
+                nullptr, false);
+  sockaddr_storage server_addr;
+  socklen_t addr_len;
+  getSocketAddressInfo(*client_socket.get(), server_socket->localAddress()->ip()->port(),
+                       server_addr, addr_len);
+  ASSERT_GT(addr_len, 0);
+
+  const std::string last("last");
+  ASSERT_EQ(0, ::sendto(client_socket->ioHandle().fd(), "", 0, 0,
+                        reinterpret_cast<const struct sockaddr*>(&server_addr), addr_len));
+  ASSERT_EQ(last.length(),
+            ::sendto(client_socket->ioHandle().fd(), last.c_str(), last.length(), 0,
+                     reinterpret_cast<const struct sockaddr*>(&server_addr), addr_len));
+
+  EXPECT_CALL(listener_callbacks, onData_(_))
+      .WillOnce(Invoke([&](const UdpData& data) -> void {
+        ASSERT_NE(nullptr, data.peer_address_);
+        EXPECT_EQ(0, data.buffer_->length());
+      }))
+      .WillOnce(Invoke([&](const UdpData& data) -> void {
+        EXPECT_EQ(last, data.buffer_->toString());
+        dispatcher_->exit();
+      }));
+  EXPECT_CALL(listener_callbacks, onWriteReady_(_)).Times(testing::AnyNumber());
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
+#if defined(__linux__)
+/**
+ * Tests that datagrams returned by a single recvmmsg() call are handed out one at a time, and
+ * that the ring is only refilled once it has been drained.
+ */
+TEST_P(UdpListenerImplTest, UdpListenerBatchedReceive) {
+  SocketPtr server_socket =
+      getSocket(Address::SocketType::Datagram, Network::Test::getCanonicalLoopbackAddress(version_),
+                nullptr, true);
+  ASSERT_NE(server_socket, nullptr);
+
+  Network::MockUdpListenerCallbacks listener_callbacks;
+  Network::TestUdpListenerImpl listener(dispatcherImpl(), *server_socket.get(), listener_callbacks);
+
+  Api::MockLinuxOsSysCalls linux_os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls(&linux_os_sys_calls);
+
+  sockaddr_storage client_addr;
+  socklen_t client_addr_len;
+  getSocketAddressInfo(*server_socket.get(), 12345, client_addr, client_addr_len);
+  ASSERT_GT(client_addr_len, 0);
+
+  // The empty datagram is delivered like the others.
+  const std::vector<std::string> payloads{"first", "", "third"};
+  EXPECT_CALL(linux_os_sys_calls, recvmmsg(server_socket->ioHandle().fd(), _, _, 0, nullptr))
+      .WillOnce(Invoke([&](int, struct mmsghdr* msgvec, unsigned int vlen, int,
+                           struct timespec*) -> Api::SysCallIntResult {
+        EXPECT_GE(vlen, payloads.size());
+        for (size_t i = 0; i < payloads.size(); ++i) {
+          EXPECT_GE(msgvec[i].msg_hdr.msg_iov[0].iov_len, payloads[i].size());
+          memcpy(msgvec[i].msg_hdr.msg_iov[0].iov_base, payloads[i].data(), payloads[i].size());
+          msgvec[i].msg_len = payloads[i].size();
+          memcpy(msgvec[i].msg_hdr.msg_name, &client_addr, client_addr_len);
+          msgvec[i].msg_hdr.msg_namelen = client_addr_len;
+          msgvec[i].msg_hdr.msg_controllen = 0;
+        }
+        return {static_cast<int>(payloads.size()), 0};
+      }))
+      .WillOnce(Return(Api::SysCallIntResult{-1, EAGAIN}));
+
+  sockaddr_storage peer_addr;
+  socklen_t addr_len = 0;
+
+  UdpListenerImpl::ReceiveResult result = listener.doRecvFrom_(peer_addr, addr_len);
+  EXPECT_EQ(5, result.result_.rc_);
+  EXPECT_EQ("first", result.buffer_->toString());
+  EXPECT_EQ(client_addr_len, addr_len);
+  EXPECT_EQ(0, memcmp(&client_addr, &peer_addr, addr_len));
+
+  result = listener.doRecvFrom_(peer_addr, addr_len);
+  EXPECT_EQ(0, result.result_.rc_);
+  ASSERT_NE(nullptr, result.buffer_);
+  EXPECT_EQ(0, result.buffer_->length());
+  EXPECT_EQ(client_addr_len, addr_len);
+
+  result = listener.doRecvFrom_(peer_addr, addr_len);
+  EXPECT_EQ(5, result.result_.rc_);
+  EXPECT_EQ("third", result.buffer_->toString());
+
+  result = listener.doRecvFrom_(peer_addr, addr_len);
+  EXPECT_EQ(-1, result.result_.rc_);
+  EXPECT_EQ(EAGAIN, result.result_.errno_);
+  EXPECT_EQ(nullptr, result.buffer_);
+}
+#endif
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
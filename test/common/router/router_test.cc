@@ -2374,6 +2374,96 @@ TEST_F(RouterTest, UpstreamTimingSingleRequest) {
             std::chrono::milliseconds(32));
 }
 
+// Verify that the time between sending the request and receiving the response headers is recorded
+// in the host's latency monitor.
+TEST_F(RouterTest, UpstreamLatencyRecorded) {
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  test_time_.sleep(std::chrono::milliseconds(75));
+  EXPECT_CALL(cm_.conn_pool_.host_->latency_monitor_,
+              putResponseTime(std::chrono::microseconds(75000), test_time_.monotonicTime()));
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+}
+
+// Verify that an attempt which times out is recorded as a failure in the host's latency monitor.
+TEST_F(RouterTest, UpstreamLatencyTimeoutRecorded) {
+  NiceMock<Http::MockStreamEncoder> encoder;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  test_time_.sleep(std::chrono::milliseconds(50));
+  EXPECT_CALL(cm_.conn_pool_.host_->latency_monitor_, putResponseTime(_, _)).Times(0);
+  EXPECT_CALL(cm_.conn_pool_.host_->latency_monitor_,
+              putFailure(std::chrono::microseconds(50000), test_time_.monotonicTime()));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  response_timeout_->callback_();
+}
+
+// Verify that an attempt reset by the upstream is recorded as a failure in the host's latency
+// monitor, while local circuit breaking is not.
+TEST_F(RouterTest, UpstreamLatencyResetRecorded) {
+  NiceMock<Http::MockStreamEncoder> encoder;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  test_time_.sleep(std::chrono::milliseconds(5));
+  EXPECT_CALL(cm_.conn_pool_.host_->latency_monitor_,
+              putFailure(std::chrono::microseconds(5000), test_time_.monotonicTime()));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  encoder.stream_.resetStream(Http::StreamResetReason::RemoteReset);
+}
+
+TEST_F(RouterTest, UpstreamLatencyOverflowNotRecorded) {
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolFailure(Http::ConnectionPool::PoolFailureReason::Overflow,
+                                absl::string_view(), cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+
+  EXPECT_CALL(cm_.conn_pool_.host_->latency_monitor_, putFailure(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  Http::TestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+}
+
 // Verify that upstream timing information is set into the StreamInfo when a
 // retry occurs (and not before).
 TEST_F(RouterTest, UpstreamTimingRetry) {
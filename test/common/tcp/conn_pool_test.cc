@@ -792,6 +792,40 @@ TEST_F(TcpConnPoolImplTest, ConcurrentConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that assigning a connection prefetches another one, which then serves the next request.
+ */
+TEST_F(TcpConnPoolImplTest, Prefetch) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1, 1);
+
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c1.releaseConn();
+
+  cluster_->per_upstream_prefetch_ratio_ = 2;
+  conn_pool_.expectConnCreate();
+  ActiveTestConn c2(*this, 0, ActiveTestConn::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  EXPECT_CALL(*conn_pool_.test_conns_[1].connect_timer_, disableTimer());
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  ActiveTestConn c3(*this, 1, ActiveTestConn::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+
+  // The connection circuit breaker stops further prefetching.
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest()).Times(2);
+  c2.releaseConn();
+  c3.releaseConn();
+
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_unused_.value());
+}
+
 /**
  * Tests ConnectionState lifecycle with multiple concurrent connections.
  */
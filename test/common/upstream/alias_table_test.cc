@@ -0,0 +1,90 @@
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "common/upstream/alias_table.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+TEST(AliasTableTest, Empty) {
+  AliasTable table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(0, table.size());
+
+  AliasTable empty_weights_table(std::vector<double>{});
+  EXPECT_TRUE(empty_weights_table.empty());
+
+  AliasTable zero_weights_table({0, 0});
+  EXPECT_TRUE(zero_weights_table.empty());
+}
+
+TEST(AliasTableTest, SingleEntry) {
+  AliasTable table({42});
+  EXPECT_FALSE(table.empty());
+  EXPECT_EQ(1, table.size());
+  EXPECT_EQ(0, table.pick(0));
+  EXPECT_EQ(0, table.pick(std::numeric_limits<uint64_t>::max()));
+}
+
+// Validate that with equal weights every column is kept, so picks are a plain modulo.
+TEST(AliasTableTest, Unweighted) {
+  AliasTable table({3, 3, 3, 3});
+  for (uint64_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(i % 4, table.pick((0xFFFFFFFFULL << 32) | i));
+  }
+}
+
+// Validate that the low bits select the column and the high bits flip the coin between the column
+// and its alias.
+TEST(AliasTableTest, Alias) {
+  // Scaled weights are 2/3 and 4/3, so column 0 keeps itself 2/3 of the time and otherwise
+  // defers to entry 1, while column 1 always keeps itself.
+  AliasTable table({1, 2});
+  EXPECT_EQ(0, table.pick(0));
+  EXPECT_EQ(0, table.pick(0x80000000ULL << 32));
+  EXPECT_EQ(1, table.pick(0xC0000000ULL << 32));
+  EXPECT_EQ(1, table.pick(1));
+  EXPECT_EQ(1, table.pick((0xFFFFFFFFULL << 32) | 1));
+}
+
+// Entries with zero weight are never picked.
+TEST(AliasTableTest, ZeroWeight) {
+  AliasTable table({0, 1, 0, 1});
+  std::mt19937_64 random;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    const uint32_t picked = table.pick(random());
+    EXPECT_TRUE(picked == 1 || picked == 3);
+  }
+}
+
+// Validate that picks are distributed proportionally to weight.
+TEST(AliasTableTest, Weighted) {
+  constexpr uint32_t num_entries = 128;
+  constexpr uint32_t picks_per_weight = 1000;
+  std::vector<double> weights;
+  uint64_t total_weight = 0;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    weights.push_back(i + 1);
+    total_weight += i + 1;
+  }
+
+  AliasTable table(weights);
+  std::mt19937_64 random;
+  std::vector<uint64_t> pick_count(num_entries);
+  for (uint64_t i = 0; i < total_weight * picks_per_weight; ++i) {
+    ++pick_count[table.pick(random())];
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    const double expected = (i + 1) * picks_per_weight;
+    EXPECT_NEAR(expected, pick_count[i], 5 * std::sqrt(expected)) << "entry " << i;
+  }
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "common/runtime/runtime_impl.h"
+#include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/ring_hash_lb.h"
 #include "common/upstream/upstream_impl.h"
@@ -69,6 +70,20 @@ public:
   std::unique_ptr<MaglevLoadBalancer> maglev_lb_;
 };
 
+class LeastRequestTester : public BaseTester {
+public:
+  // Half of the hosts are weighted so that the weighted pick is used.
+  LeastRequestTester(uint64_t num_hosts, bool weighted_p2c) : BaseTester(num_hosts, 50, 2) {
+    stats_.max_host_weight_.set(2UL);
+    envoy::api::v2::Cluster::LeastRequestLbConfig config;
+    config.set_weighted_p2c(weighted_p2c);
+    lr_lb_ = std::make_unique<LeastRequestLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                        random_, common_config_, config);
+  }
+
+  std::unique_ptr<LeastRequestLoadBalancer> lr_lb_;
+};
+
 uint64_t hashInt(uint64_t i) {
   // Hack to hash an integer.
   return HashUtil::xxHash64(absl::string_view(reinterpret_cast<const char*>(&i), sizeof(i)));
@@ -362,6 +377,49 @@ BENCHMARK(BM_MaglevLoadBalancerWeighted)
     ->Args({500, 95, 75, 25, 10000})
     ->Unit(benchmark::kMillisecond);
 
+void BM_LeastRequestLoadBalancerChooseHost(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const bool weighted_p2c = state.range(1) != 0;
+  LeastRequestTester tester(num_hosts, weighted_p2c);
+  // Give hosts a spread of active requests so that candidate comparisons are meaningful.
+  const HostVector& hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  for (uint64_t i = 0; i < hosts.size(); i++) {
+    hosts[i]->stats().rq_active_.set(i % 8);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.lr_lb_->chooseHost(nullptr));
+  }
+}
+BENCHMARK(BM_LeastRequestLoadBalancerChooseHost)
+    ->Args({10, 0})
+    ->Args({100, 0})
+    ->Args({10000, 0})
+    ->Args({10, 1})
+    ->Args({100, 1})
+    ->Args({10000, 1});
+
+void BM_LeastRequestLoadBalancerBuild(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const uint64_t num_hosts = state.range(0);
+    const bool weighted_p2c = state.range(1) != 0;
+    state.ResumeTiming();
+
+    // We time both host set creation and the initial schedule/alias table build, since the
+    // load balancer is initialized in its constructor.
+    LeastRequestTester tester(num_hosts, weighted_p2c);
+  }
+}
+BENCHMARK(BM_LeastRequestLoadBalancerBuild)
+    ->Args({10, 0})
+    ->Args({100, 0})
+    ->Args({10000, 0})
+    ->Args({10, 1})
+    ->Args({100, 1})
+    ->Args({10000, 1})
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -1356,6 +1356,99 @@ TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
 INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, LeastRequestLoadBalancerTest,
                          ::testing::Values(true, false));
 
+class WeightedP2CLeastRequestLoadBalancerTest : public LoadBalancerTestBase {
+public:
+  envoy::api::v2::Cluster::LeastRequestLbConfig weightedP2CConfig() {
+    envoy::api::v2::Cluster::LeastRequestLbConfig config = least_request_lb_config_;
+    config.set_weighted_p2c(true);
+    return config;
+  }
+
+  LeastRequestLoadBalancer lb_{priority_set_,  nullptr, stats_, runtime_, random_,
+                               common_config_, weightedP2CConfig()};
+};
+
+TEST_P(WeightedP2CLeastRequestLoadBalancerTest, NoHosts) {
+  stats_.max_host_weight_.set(2UL);
+  EXPECT_EQ(nullptr, lb_.chooseHost(nullptr));
+}
+
+// With all weights 1 the regular unweighted P2C pick is used.
+TEST_P(WeightedP2CLeastRequestLoadBalancerTest, Unweighted) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(2);
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(WeightedP2CLeastRequestLoadBalancerTest, WeightImbalance) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  stats_.max_host_weight_.set(2UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  // The first random value is used for priority selection. The low bits of the following values
+  // select alias table columns and the high bits of 0 always keep the column.
+
+  // Both hosts are idle, so the host with the larger weight wins: (0 + 1) / 2 < (0 + 1) / 1.
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Active requests are normalized by weight: (1 + 1) / 2 == (0 + 1) / 1, so the first candidate
+  // is kept.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1)).WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // (3 + 1) / 2 > (0 + 1) / 1.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(3);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1)).WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+
+  // The same host can be sampled for every choice.
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Column 0 defers to host 1 when the coin is above its 2/3 threshold.
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(0xC0000000ULL << 32))
+      .WillOnce(Return(0xC0000000ULL << 32));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(WeightedP2CLeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  stats_.max_host_weight_.set(2UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Remove and verify the alias table is rebuilt so that we get the other host.
+  HostVector empty;
+  HostVector hosts_removed;
+  hosts_removed.push_back(hostSet().hosts_[1]);
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 1);
+  hostSet().healthy_hosts_.erase(hostSet().healthy_hosts_.begin() + 1);
+  hostSet().runCallbacks(empty, hosts_removed);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, WeightedP2CLeastRequestLoadBalancerTest,
+                         ::testing::Values(true, false));
+
 class RandomLoadBalancerTest : public LoadBalancerTestBase {
 public:
   RandomLoadBalancer lb_{priority_set_, nullptr, stats_, runtime_, random_, common_config_};
@@ -592,6 +592,57 @@ TEST_F(OutlierDetectorImplTest, RemoveWhileEjected) {
   interval_timer_->callback_();
 }
 
+// Validate that success rate detection keeps working for the remaining hosts after a host is
+// removed from the middle of the host set.
+TEST_F(OutlierDetectorImplTest, SuccessRateAfterHostRemoved) {
+  EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
+  addHosts({
+      "tcp://127.0.0.1:80",
+      "tcp://127.0.0.1:81",
+      "tcp://127.0.0.1:82",
+      "tcp://127.0.0.1:83",
+      "tcp://127.0.0.1:84",
+      "tcp://127.0.0.1:85",
+  });
+
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, empty_outlier_detection_, dispatcher_, runtime_, time_system_, event_logger_));
+  detector->addChangedStateCb([&](HostSharedPtr host) -> void { checker_.check(host); });
+
+  HostSharedPtr removed_host = hosts_[1];
+  hosts_.erase(hosts_.begin() + 1);
+  cluster_.prioritySet().getMockHostSet(0)->runCallbacks({}, {removed_host});
+
+  // Give 4 of the remaining hosts a perfect SR, and the last one a SR of 50% without consecutive
+  // errors.
+  for (uint32_t i = 0; i < 4; i++) {
+    loadRq(hosts_[i], 200, 200);
+  }
+  for (uint32_t i = 0; i < 100; i++) {
+    loadRq(hosts_[4], 1, 200);
+    loadRq(hosts_[4], 1, 500);
+  }
+  // The removed host is no longer considered.
+  loadRq(removed_host, 200, 500);
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(10000));
+  EXPECT_CALL(checker_, check(hosts_[4]));
+  EXPECT_CALL(*event_logger_,
+              logEject(std::static_pointer_cast<const HostDescription>(hosts_[4]), _,
+                       envoy::data::cluster::v2alpha::OutlierEjectionType::SUCCESS_RATE, true));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  ON_CALL(runtime_.snapshot_, getInteger("outlier_detection.success_rate_stdev_factor", 1900))
+      .WillByDefault(Return(1900));
+  interval_timer_->callback_();
+  EXPECT_EQ(50, hosts_[4]->outlierDetector().successRate());
+  EXPECT_EQ(100, hosts_[0]->outlierDetector().successRate());
+  EXPECT_EQ(90, detector->successRateAverage());
+  EXPECT_EQ(52, detector->successRateEjectionThreshold());
+  EXPECT_TRUE(hosts_[4]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+  EXPECT_FALSE(removed_host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+}
+
 TEST_F(OutlierDetectorImplTest, Overflow) {
   EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
   addHosts({"tcp://127.0.0.1:80", "tcp://127.0.0.1:81"});
@@ -848,11 +899,7 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
 }
 
 TEST(OutlierUtility, SRThreshold) {
-  std::vector<HostSuccessRatePair> data = {
-      HostSuccessRatePair(nullptr, 50),  HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100), HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100),
-  };
+  std::vector<double> data = {50, 100, 100, 100, 100};
   double sum = 450;
 
   Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(sum, data, 1.9);
@@ -0,0 +1,249 @@
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#include "common/upstream/peak_ewma_lb.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+class PeakEwmaHostMonitorImplTest : public testing::Test {
+public:
+  PeakEwmaHostMonitorImpl monitor_{std::chrono::seconds(10)};
+  Event::SimulatedTimeSystem time_system_;
+};
+
+TEST_F(PeakEwmaHostMonitorImplTest, NoEstimate) {
+  EXPECT_EQ(0, monitor_.latencyEstimate(time_system_.monotonicTime()));
+}
+
+TEST_F(PeakEwmaHostMonitorImplTest, DecayTime) {
+  EXPECT_EQ(std::chrono::milliseconds(10000), PeakEwmaHostMonitorImpl::decayTime(absl::nullopt));
+
+  envoy::api::v2::Cluster::PeakEwmaLbConfig config;
+  EXPECT_EQ(std::chrono::milliseconds(10000), PeakEwmaHostMonitorImpl::decayTime(config));
+  config.mutable_decay_time()->set_seconds(3);
+  EXPECT_EQ(std::chrono::milliseconds(3000), PeakEwmaHostMonitorImpl::decayTime(config));
+}
+
+// Latency above the estimate replaces it immediately, while lower latency is averaged in.
+TEST_F(PeakEwmaHostMonitorImplTest, Peak) {
+  monitor_.putResponseTime(std::chrono::milliseconds(10), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(10000, monitor_.latencyEstimate(time_system_.monotonicTime()));
+
+  monitor_.putResponseTime(std::chrono::milliseconds(20), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(20000, monitor_.latencyEstimate(time_system_.monotonicTime()));
+
+  // No time has elapsed, so the lower latency has no weight yet.
+  monitor_.putResponseTime(std::chrono::milliseconds(5), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(20000, monitor_.latencyEstimate(time_system_.monotonicTime()));
+
+  time_system_.sleep(std::chrono::seconds(10));
+  monitor_.putResponseTime(std::chrono::milliseconds(5), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(20000 * std::exp(-1.0) + 5000 * (1 - std::exp(-1.0)),
+                   monitor_.latencyEstimate(time_system_.monotonicTime()));
+}
+
+// The estimate decays towards zero while no responses are recorded.
+TEST_F(PeakEwmaHostMonitorImplTest, IdleDecay) {
+  monitor_.putResponseTime(std::chrono::milliseconds(20), time_system_.monotonicTime());
+  const MonotonicTime start = time_system_.monotonicTime();
+
+  EXPECT_DOUBLE_EQ(20000 * std::exp(-0.5),
+                   monitor_.latencyEstimate(start + std::chrono::seconds(5)));
+  EXPECT_DOUBLE_EQ(20000 * std::exp(-2.0),
+                   monitor_.latencyEstimate(start + std::chrono::seconds(20)));
+
+  // Reading the estimate does not change it.
+  EXPECT_DOUBLE_EQ(20000, monitor_.latencyEstimate(start));
+}
+
+// Responses recorded out of order, e.g. by different workers, do not move time backwards.
+TEST_F(PeakEwmaHostMonitorImplTest, OutOfOrder) {
+  const MonotonicTime start = time_system_.monotonicTime();
+  monitor_.putResponseTime(std::chrono::milliseconds(20), start + std::chrono::seconds(10));
+  monitor_.putResponseTime(std::chrono::milliseconds(10), start);
+  EXPECT_DOUBLE_EQ(20000, monitor_.latencyEstimate(start + std::chrono::seconds(10)));
+}
+
+// Failures are recorded as at least a fixed penalty, or twice the current estimate.
+TEST_F(PeakEwmaHostMonitorImplTest, Failure) {
+  monitor_.putFailure(std::chrono::milliseconds(5), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(1000000, monitor_.latencyEstimate(time_system_.monotonicTime()));
+
+  monitor_.putFailure(std::chrono::milliseconds(5), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(2000000, monitor_.latencyEstimate(time_system_.monotonicTime()));
+
+  // A timeout longer than the penalty is recorded as is.
+  monitor_.putFailure(std::chrono::seconds(15), time_system_.monotonicTime());
+  EXPECT_DOUBLE_EQ(15000000, monitor_.latencyEstimate(time_system_.monotonicTime()));
+}
+
+class PeakEwmaLoadBalancerTest : public testing::TestWithParam<bool> {
+public:
+  PeakEwmaLoadBalancerTest() : stats_(ClusterInfoImpl::generateStats(stats_store_)) {
+    info_->lb_type_ = LoadBalancerType::PeakEwma;
+  }
+
+  // Run all tests against both priority 0 and priority 1 host sets, to ensure
+  // all the load balancers have equivalent functonality for failover host sets.
+  MockHostSet& hostSet() { return GetParam() ? host_set_ : failover_host_set_; }
+
+  void init(uint32_t num_hosts, uint32_t weight = 1) {
+    for (uint32_t i = 0; i < num_hosts; ++i) {
+      hostSet().healthy_hosts_.push_back(
+          makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 80 + i), weight));
+    }
+    hostSet().hosts_ = hostSet().healthy_hosts_;
+    hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+  }
+
+  void putResponseTime(uint32_t host_index, std::chrono::milliseconds response_time) {
+    hostSet().healthy_hosts_[host_index]->latencyMonitor().putResponseTime(
+        response_time, time_system_.monotonicTime());
+  }
+
+  // The first random value is used for priority selection, the following ones pick candidates.
+  void expectCandidates(uint64_t first, uint64_t second) {
+    EXPECT_CALL(random_, random())
+        .WillOnce(Return(0))
+        .WillOnce(Return(first))
+        .WillOnce(Return(second));
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<MockPrioritySet> priority_set_;
+  MockHostSet& host_set_ = *priority_set_.getMockHostSet(0);
+  MockHostSet& failover_host_set_ = *priority_set_.getMockHostSet(1);
+  std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+  envoy::api::v2::Cluster::CommonLbConfig common_config_;
+  Event::SimulatedTimeSystem time_system_;
+  PeakEwmaLoadBalancer lb_{priority_set_, nullptr,       stats_,      runtime_,
+                           random_,       common_config_, absl::nullopt, time_system_};
+};
+
+TEST_P(PeakEwmaLoadBalancerTest, NoHosts) { EXPECT_EQ(nullptr, lb_.chooseHost(nullptr)); }
+
+TEST_P(PeakEwmaLoadBalancerTest, LowerLatencyWins) {
+  init(2);
+  putResponseTime(0, std::chrono::milliseconds(10));
+  putResponseTime(1, std::chrono::milliseconds(100));
+
+  expectCandidates(0, 1);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  expectCandidates(1, 0);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, ActiveRequests) {
+  init(2);
+  putResponseTime(0, std::chrono::milliseconds(10));
+  putResponseTime(1, std::chrono::milliseconds(100));
+
+  // 10ms * (20 + 1) > 100ms * (0 + 1).
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(20);
+  expectCandidates(0, 1);
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // 10ms * (5 + 1) < 100ms * (0 + 1).
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(5);
+  expectCandidates(1, 0);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, UnknownLatency) {
+  init(2);
+  putResponseTime(1, std::chrono::milliseconds(100));
+
+  // An idle host without an estimate is preferred so that it gets probed.
+  expectCandidates(1, 0);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+
+  // Once it has outstanding requests it is avoided until it responds.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(1);
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(10);
+  expectCandidates(0, 1);
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, Weighted) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 4)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {});
+  putResponseTime(0, std::chrono::milliseconds(10));
+  putResponseTime(1, std::chrono::milliseconds(30));
+
+  // 30ms / 4 < 10ms / 1.
+  expectCandidates(0, 1);
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, IdleDecay) {
+  init(2);
+  putResponseTime(0, std::chrono::milliseconds(10));
+  putResponseTime(1, std::chrono::seconds(1));
+
+  expectCandidates(0, 1);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+
+  // Host 0 keeps responding in 10ms while host 1 receives no traffic, so its estimate eventually
+  // decays below that of host 0 and it is retried.
+  time_system_.sleep(std::chrono::seconds(60));
+  putResponseTime(0, std::chrono::milliseconds(10));
+  expectCandidates(0, 1);
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+// A host failing fast is avoided rather than looking like the fastest host.
+TEST_P(PeakEwmaLoadBalancerTest, Failure) {
+  init(2);
+  putResponseTime(0, std::chrono::milliseconds(100));
+  hostSet().healthy_hosts_[1]->latencyMonitor().putFailure(std::chrono::milliseconds(1),
+                                                           time_system_.monotonicTime());
+
+  expectCandidates(1, 0);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, ChoiceCount) {
+  init(3);
+  putResponseTime(0, std::chrono::milliseconds(30));
+  putResponseTime(1, std::chrono::milliseconds(20));
+  putResponseTime(2, std::chrono::milliseconds(10));
+
+  envoy::api::v2::Cluster::PeakEwmaLbConfig config;
+  config.mutable_choice_count()->set_value(3);
+  PeakEwmaLoadBalancer lb_3{priority_set_, nullptr, stats_,      runtime_,
+                            random_,       common_config_, config, time_system_};
+
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(0))
+      .WillOnce(Return(2))
+      .WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_3.chooseHost(nullptr));
+}
+
+INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, PeakEwmaLoadBalancerTest,
+                         ::testing::Values(true, false));
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
@@ -17,6 +17,7 @@
 #include "test/mocks/filesystem/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "absl/types/optional.h"
 #include "gmock/gmock.h"
@@ -176,7 +177,8 @@ public:
 
     lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_,
                                      runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                     least_request_lb_config_, common_config_));
+                                     least_request_lb_config_, peak_ewma_lb_config_,
+                                     common_config_, time_system_));
   }
 
   void zoneAwareInit(const std::vector<HostURLMetadataMap>& host_metadata_per_locality,
@@ -223,7 +225,8 @@ public:
 
     lb_.reset(new SubsetLoadBalancer(
         lb_type_, priority_set_, &local_priority_set_, stats_, stats_store_, runtime_, random_,
-        subset_info_, ring_hash_lb_config_, least_request_lb_config_, common_config_));
+        subset_info_, ring_hash_lb_config_, least_request_lb_config_, peak_ewma_lb_config_,
+        common_config_, time_system_));
   }
 
   HostSharedPtr makeHost(const std::string& url, const HostMetadata& metadata) {
@@ -388,7 +391,9 @@ public:
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
   envoy::api::v2::Cluster::RingHashLbConfig ring_hash_lb_config_;
   envoy::api::v2::Cluster::LeastRequestLbConfig least_request_lb_config_;
+  envoy::api::v2::Cluster::PeakEwmaLbConfig peak_ewma_lb_config_;
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
+  Event::SimulatedTimeSystem time_system_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Runtime::MockRandomGenerator> random_;
   Stats::IsolatedStoreImpl stats_store_;
@@ -876,6 +881,59 @@ TEST_P(SubsetLoadBalancerTest, UpdateRemovingUnknownHost) {
   EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context));
 }
 
+// Validate that subsets with the same values for different keys are distinct.
+TEST_P(SubsetLoadBalancerTest, SameValueDifferentKeys) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK));
+
+  std::vector<std::set<std::string>> subset_keys = {{"version"}, {"stage"}};
+  EXPECT_CALL(subset_info_, subsetKeys()).WillRepeatedly(ReturnRef(subset_keys));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"stage", "1.0"}}},
+  });
+
+  TestLoadBalancerContext context_version({{"version", "1.0"}});
+  TestLoadBalancerContext context_stage({{"stage", "1.0"}});
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_version));
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_version));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_stage));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_stage));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+
+  modifyHosts({makeHost("tcp://127.0.0.1:82", {{"stage", "1.0"}, {"version", "1.0"}})}, {});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_version));
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_version));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_stage));
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_stage));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+}
+
+// Validate that criteria matching only some of the keys of a subset, or more keys than any
+// subset, do not select a subset.
+TEST_P(SubsetLoadBalancerTest, PartialAndExtraCriteria) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK));
+
+  std::vector<std::set<std::string>> subset_keys = {{"stage", "version"}};
+  EXPECT_CALL(subset_info_, subsetKeys()).WillRepeatedly(ReturnRef(subset_keys));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"stage", "prod"}, {"version", "1.0"}, {"xlarge", "true"}}},
+  });
+
+  TestLoadBalancerContext context_partial({{"version", "1.0"}});
+  TestLoadBalancerContext context_full({{"stage", "prod"}, {"version", "1.0"}});
+  TestLoadBalancerContext context_extra(
+      {{"stage", "prod"}, {"version", "1.0"}, {"xlarge", "true"}});
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_partial));
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_full));
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_extra));
+  EXPECT_EQ(1U, stats_.lb_subsets_selected_.value());
+}
+
 TEST_F(SubsetLoadBalancerTest, UpdateModifyingOnlyHostHealth) {
   EXPECT_CALL(subset_info_, fallbackPolicy())
       .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK));
@@ -1048,7 +1106,8 @@ TEST_F(SubsetLoadBalancerTest, IgnoresHostsWithoutMetadata) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
 
   TestLoadBalancerContext context_version({{"version", "1.0"}});
 
@@ -1075,6 +1134,10 @@ TEST_P(SubsetLoadBalancerTest, LoadBalancerTypesRingHash) {
 
 TEST_P(SubsetLoadBalancerTest, LoadBalancerTypesMaglev) { doLbTypeTest(LoadBalancerType::Maglev); }
 
+TEST_P(SubsetLoadBalancerTest, LoadBalancerTypesPeakEwma) {
+  doLbTypeTest(LoadBalancerType::PeakEwma);
+}
+
 TEST_F(SubsetLoadBalancerTest, ZoneAwareFallback) {
   EXPECT_CALL(subset_info_, fallbackPolicy())
       .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::ANY_ENDPOINT));
@@ -1453,7 +1516,8 @@ TEST_F(SubsetLoadBalancerTest, DisabledLocalityWeightAwareness) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
 
   TestLoadBalancerContext context({{"version", "1.1"}});
 
@@ -1476,7 +1540,8 @@ TEST_F(SubsetLoadBalancerTest, DoesNotCheckHostHealth) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
 }
 
 TEST_F(SubsetLoadBalancerTest, EnabledLocalityWeightAwareness) {
@@ -1499,7 +1564,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledLocalityWeightAwareness) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
 
   TestLoadBalancerContext context({{"version", "1.1"}});
 
@@ -1531,7 +1597,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledScaleLocalityWeights) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
   TestLoadBalancerContext context({{"version", "1.1"}});
 
   // Since we scale the locality weights by number of hosts removed, we expect to see the second
@@ -1573,7 +1640,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledScaleLocalityWeightsRounding) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
   TestLoadBalancerContext context({{"version", "1.0"}});
 
   // We expect to see a 33/66 split because 2 * 1 / 2 = 1 and 2 * 3 / 4 = 1.5 -> 2
@@ -1603,7 +1671,8 @@ TEST_F(SubsetLoadBalancerTest, ScaleLocalityWeightsWithNoLocalityWeights) {
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_, runtime_,
                                    random_, subset_info_, ring_hash_lb_config_,
-                                   least_request_lb_config_, common_config_));
+                                   least_request_lb_config_, peak_ewma_lb_config_, common_config_,
+                                   time_system_));
 }
 
 TEST_P(SubsetLoadBalancerTest, GaugesUpdatedOnDestroy) {
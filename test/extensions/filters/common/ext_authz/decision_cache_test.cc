@@ -0,0 +1,298 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "extensions/filters/common/ext_authz/decision_cache.h"
+
+#include "test/extensions/filters/common/ext_authz/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::Ref;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+namespace {
+
+class DecisionCacheTest : public testing::Test {
+public:
+  void setUp(const std::string& yaml) {
+    envoy::config::common::ext_authz::v2alpha::DecisionCache proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_unique<DecisionCacheConfig>(proto_config, "test.", stats_);
+    cache_ = std::make_unique<DecisionCache>(*config_, time_system_);
+    client_ = new MockClient();
+    caching_client_ = std::make_unique<CachingClient>(ClientPtr{client_}, *cache_, *config_);
+  }
+
+  envoy::service::auth::v2::CheckRequest request(const std::string& authorization,
+                                                 const std::string& path) {
+    envoy::service::auth::v2::CheckRequest request;
+    auto* http = request.mutable_attributes()->mutable_request()->mutable_http();
+    http->set_method("GET");
+    http->set_host("example.com");
+    http->set_path(path);
+    (*http->mutable_headers())["authorization"] = authorization;
+    return request;
+  }
+
+  // Checks a request that is not cached, for which the service returns the given response.
+  void checkUncached(const envoy::service::auth::v2::CheckRequest& request,
+                     const Response& response) {
+    EXPECT_CALL(*client_, check(Ref(*caching_client_), _, _))
+        .WillOnce(Invoke([&response](RequestCallbacks& callbacks,
+                                     const envoy::service::auth::v2::CheckRequest&,
+                                     Tracing::Span&) {
+          callbacks.onComplete(std::make_unique<Response>(response));
+        }));
+    EXPECT_CALL(callbacks_, onComplete_(_))
+        .WillOnce(Invoke([&response](ResponsePtr& result) {
+          EXPECT_EQ(response.status, result->status);
+        }));
+    caching_client_->check(callbacks_, request, Tracing::NullSpan::instance());
+  }
+
+  // Checks a request that is cached, and returns its decision.
+  Response checkCached(const envoy::service::auth::v2::CheckRequest& request) {
+    Response cached{};
+    EXPECT_CALL(*client_, check(_, _, _)).Times(0);
+    EXPECT_CALL(callbacks_, onComplete_(_)).WillOnce(Invoke([&cached](ResponsePtr& result) {
+      cached = *result;
+    }));
+    caching_client_->check(callbacks_, request, Tracing::NullSpan::instance());
+    testing::Mock::VerifyAndClearExpectations(client_);
+    return cached;
+  }
+
+  uint64_t counter(const std::string& name) { return stats_.counter("test." + name).value(); }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_;
+  std::unique_ptr<DecisionCacheConfig> config_;
+  std::unique_ptr<DecisionCache> cache_;
+  MockClient* client_{};
+  std::unique_ptr<CachingClient> caching_client_;
+  MockRequestCallbacks callbacks_;
+};
+
+TEST_F(DecisionCacheTest, AllowedRequestsAreCachedByKey) {
+  setUp(R"EOF(
+headers: [Authorization]
+ttl: 60s
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  ok.headers_to_add.emplace_back(Http::LowerCaseString("x-user"), "alice");
+  checkUncached(request("alice", "/a"), ok);
+  EXPECT_EQ(1U, counter("cache_miss"));
+  EXPECT_EQ(1U, counter("cache_insert"));
+
+  // The cached headers are returned.
+  const Response cached = checkCached(request("alice", "/a"));
+  EXPECT_EQ(CheckStatus::OK, cached.status);
+  ASSERT_EQ(1U, cached.headers_to_add.size());
+  EXPECT_EQ("alice", cached.headers_to_add[0].second);
+  EXPECT_EQ(1U, counter("cache_hit"));
+
+  Response denied{};
+  denied.status = CheckStatus::Denied;
+  checkUncached(request("bob", "/a"), denied);
+  // Denials are not cached by default.
+  checkUncached(request("bob", "/a"), denied);
+
+  // Decisions expire.
+  time_system_.sleep(std::chrono::seconds(60));
+  checkUncached(request("alice", "/a"), ok);
+  EXPECT_EQ(4U, counter("cache_miss"));
+}
+
+TEST_F(DecisionCacheTest, KeyMustIdentifyTheClient) {
+  EXPECT_THROW_WITH_MESSAGE(
+      setUp("ttl: 60s"), EnvoyException,
+      "ext_authz decision cache: the key needs headers, source_principal or source_address");
+}
+
+// The decision for a resource is never reused for another one, even if no header is configured.
+TEST_F(DecisionCacheTest, MethodHostAndPathArePartOfTheKey) {
+  setUp(R"EOF(
+source_address: true
+ttl: 60s
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  checkUncached(request("alice", "/a"), ok);
+  checkUncached(request("alice", "/b"), ok);
+
+  auto other_method = request("alice", "/a");
+  other_method.mutable_attributes()->mutable_request()->mutable_http()->set_method("POST");
+  checkUncached(other_method, ok);
+  auto other_host = request("alice", "/a");
+  other_host.mutable_attributes()->mutable_request()->mutable_http()->set_host("example.org");
+  checkUncached(other_host, ok);
+
+  // The configured headers are not part of the key.
+  checkCached(request("bob", "/a"));
+}
+
+TEST_F(DecisionCacheTest, ContextExtensionsArePartOfTheKey) {
+  setUp(R"EOF(
+headers: [authorization]
+ttl: 60s
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  auto route_a = request("alice", "/");
+  (*route_a.mutable_attributes()->mutable_context_extensions())["route"] = "a";
+  auto route_b = request("alice", "/");
+  (*route_b.mutable_attributes()->mutable_context_extensions())["route"] = "b";
+
+  checkUncached(route_a, ok);
+  checkUncached(route_b, ok);
+  checkCached(route_a);
+}
+
+TEST_F(DecisionCacheTest, DenialsAndErrors) {
+  setUp(R"EOF(
+headers: [authorization]
+ttl: 60s
+denied_ttl: 5s
+)EOF");
+  Response denied{};
+  denied.status = CheckStatus::Denied;
+  denied.status_code = Http::Code::Unauthorized;
+  denied.body = "go away";
+  checkUncached(request("bob", "/"), denied);
+  const Response cached = checkCached(request("bob", "/"));
+  EXPECT_EQ(CheckStatus::Denied, cached.status);
+  EXPECT_EQ(Http::Code::Unauthorized, cached.status_code);
+  EXPECT_EQ("go away", cached.body);
+
+  time_system_.sleep(std::chrono::seconds(5));
+  Response error{};
+  error.status = CheckStatus::Error;
+  checkUncached(request("bob", "/"), error);
+  checkUncached(request("bob", "/"), error);
+  EXPECT_EQ(1U, counter("cache_insert"));
+}
+
+TEST_F(DecisionCacheTest, TtlHeader) {
+  setUp(R"EOF(
+headers: [authorization]
+ttl: 60s
+ttl_header: x-auth-ttl
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  ok.headers_to_add.emplace_back(Http::LowerCaseString("x-auth-ttl"), "10");
+  checkUncached(request("alice", "/"), ok);
+
+  // The header is not part of the decision.
+  const Response cached = checkCached(request("alice", "/"));
+  EXPECT_TRUE(cached.headers_to_add.empty());
+  time_system_.sleep(std::chrono::seconds(10));
+  checkUncached(request("alice", "/"), ok);
+
+  // A TTL of 0 prevents caching.
+  Response uncacheable{};
+  uncacheable.status = CheckStatus::OK;
+  uncacheable.headers_to_append.emplace_back(Http::LowerCaseString("x-auth-ttl"), "0");
+  checkUncached(request("bob", "/"), uncacheable);
+  checkUncached(request("bob", "/"), uncacheable);
+
+  // Invalid values are ignored.
+  Response invalid{};
+  invalid.status = CheckStatus::OK;
+  invalid.headers_to_add.emplace_back(Http::LowerCaseString("x-auth-ttl"), "soon");
+  checkUncached(request("carol", "/"), invalid);
+  checkCached(request("carol", "/"));
+}
+
+TEST_F(DecisionCacheTest, LeastRecentlyUsedDecisionsAreEvicted) {
+  setUp(R"EOF(
+headers: [authorization]
+ttl: 60s
+max_entries: 2
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  checkUncached(request("alice", "/"), ok);
+  checkUncached(request("bob", "/"), ok);
+  checkCached(request("alice", "/"));
+
+  checkUncached(request("carol", "/"), ok);
+  EXPECT_EQ(2U, cache_->size());
+  EXPECT_EQ(1U, counter("cache_evicted"));
+  checkCached(request("alice", "/"));
+  checkUncached(request("bob", "/"), ok);
+}
+
+TEST_F(DecisionCacheTest, DifferentPrincipalsMiss) {
+  setUp(R"EOF(
+source_principal: true
+ttl: 60s
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  auto alice = request("", "/");
+  alice.mutable_attributes()->mutable_source()->set_principal("spiffe://alice");
+  auto bob = request("", "/");
+  bob.mutable_attributes()->mutable_source()->set_principal("spiffe://bob");
+
+  checkUncached(alice, ok);
+  checkUncached(bob, ok);
+  checkCached(alice);
+  checkCached(bob);
+}
+
+TEST_F(DecisionCacheTest, SourceAttributes) {
+  setUp(R"EOF(
+source_principal: true
+source_address: true
+ttl: 60s
+)EOF");
+  Response ok{};
+  ok.status = CheckStatus::OK;
+  envoy::service::auth::v2::CheckRequest alice;
+  auto* source = alice.mutable_attributes()->mutable_source();
+  source->set_principal("spiffe://alice");
+  source->mutable_address()->mutable_socket_address()->set_address("10.0.0.1");
+  envoy::service::auth::v2::CheckRequest other_address = alice;
+  other_address.mutable_attributes()->mutable_source()->mutable_address()
+      ->mutable_socket_address()->set_address("10.0.0.2");
+
+  checkUncached(alice, ok);
+  checkUncached(other_address, ok);
+  // The port of the peer is not part of the key.
+  source->mutable_address()->mutable_socket_address()->set_port_value(1234);
+  checkCached(alice);
+}
+
+TEST_F(DecisionCacheTest, Cancel) {
+  setUp(R"EOF(
+headers: [authorization]
+ttl: 60s
+)EOF");
+  EXPECT_CALL(*client_, check(_, _, _));
+  caching_client_->check(callbacks_, request("alice", "/"), Tracing::NullSpan::instance());
+  EXPECT_CALL(*client_, cancel());
+  caching_client_->cancel();
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
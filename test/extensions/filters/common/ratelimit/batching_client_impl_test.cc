@@ -0,0 +1,266 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "extensions/filters/common/ratelimit/batching_client_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+namespace {
+
+class MockRequestCallbacks : public RequestCallbacks {
+public:
+  void complete(LimitStatus status, Http::HeaderMapPtr&& headers) {
+    complete_(status, headers.get());
+  }
+
+  MOCK_METHOD2(complete_, void(LimitStatus status, const Http::HeaderMap* headers));
+};
+
+class RateLimitBatchingClientTest : public testing::Test {
+public:
+  void setUp(const std::string& yaml) {
+    envoy::config::ratelimit::v2::RateLimitServiceConfig proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_shared<const BatchingConfig>(proto_config, std::chrono::milliseconds(20),
+                                                     stats_);
+    async_client_ = new Grpc::MockAsyncClient();
+    batcher_ = std::make_unique<ThreadLocalBatcher>(Grpc::AsyncClientPtr{async_client_},
+                                                    dispatcher_, config_);
+  }
+
+  std::unique_ptr<BatchingClientImpl> newClient() {
+    return std::make_unique<BatchingClientImpl>(*batcher_);
+  }
+
+  // Expects a request with the given descriptors, whose response is then given by respond().
+  void expectRequest(const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                     const std::string& domain = "foo") {
+    envoy::service::ratelimit::v2::RateLimitRequest request;
+    GrpcClientImpl::createRequest(request, domain, descriptors);
+    EXPECT_CALL(*async_client_, send(_, ProtoEq(request), _, _, _))
+        .WillOnce(Invoke([this](const Protobuf::MethodDescriptor&, const Protobuf::Message&,
+                                Grpc::AsyncRequestCallbacks& callbacks, Tracing::Span&,
+                                const absl::optional<std::chrono::milliseconds>& timeout)
+                             -> Grpc::AsyncRequest* {
+          EXPECT_EQ(std::chrono::milliseconds(20), timeout.value());
+          request_callbacks_ = &callbacks;
+          return &async_request_;
+        }));
+  }
+
+  void respond(const std::string& yaml) {
+    auto response = std::make_unique<envoy::service::ratelimit::v2::RateLimitResponse>();
+    MessageUtil::loadFromYaml(yaml, *response);
+    request_callbacks_->onSuccessUntyped(std::move(response), span_);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_.counter("ratelimit_client." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Stats::IsolatedStoreImpl stats_;
+  BatchingConfigConstSharedPtr config_;
+  Grpc::MockAsyncClient* async_client_{};
+  Grpc::MockAsyncRequest async_request_;
+  Grpc::AsyncRequestCallbacks* request_callbacks_{};
+  std::unique_ptr<ThreadLocalBatcher> batcher_;
+  NiceMock<Tracing::MockSpan> span_;
+  MockRequestCallbacks callbacks1_;
+  MockRequestCallbacks callbacks2_;
+  MockRequestCallbacks callbacks3_;
+};
+
+TEST_F(RateLimitBatchingClientTest, WindowCombinesRequests) {
+  setUp(R"EOF(
+batch_window: 0.001s
+)EOF");
+  auto client1 = newClient();
+  auto client2 = newClient();
+  auto* window_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*window_timer, enableTimer(std::chrono::milliseconds(1)));
+  client1->limit(callbacks1_, "foo", {{{{"a", "1"}}}}, Tracing::NullSpan::instance());
+  client2->limit(callbacks2_, "foo", {{{{"b", "1"}}}, {{{"b", "2"}}}},
+                 Tracing::NullSpan::instance());
+
+  expectRequest({{{{"a", "1"}}}, {{{"b", "1"}}}, {{{"b", "2"}}}});
+  window_timer->invokeCallback();
+  EXPECT_EQ(1U, counter("batch_rq_total"));
+  EXPECT_EQ(2U, counter("batched_rq_total"));
+
+  // Each client is judged from its own descriptors, and gets the headers of the response.
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::OK, _))
+      .WillOnce(Invoke([](LimitStatus, const Http::HeaderMap* headers) {
+        EXPECT_EQ("bar", headers->get(Http::LowerCaseString("x-foo"))->value().getStringView());
+      }));
+  EXPECT_CALL(callbacks2_, complete_(LimitStatus::OverLimit, _));
+  respond(R"EOF(
+overall_code: OVER_LIMIT
+statuses: [{code: OK}, {code: OK}, {code: OVER_LIMIT}]
+headers: [{key: x-foo, value: bar}]
+)EOF");
+}
+
+TEST_F(RateLimitBatchingClientTest, FullBatchIsSentAtOnce) {
+  setUp(R"EOF(
+batch_window: 0.001s
+max_batch_descriptors: 2
+)EOF");
+  auto client1 = newClient();
+  auto client2 = newClient();
+  auto* window_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  client1->limit(callbacks1_, "foo", {{{{"a", "1"}}}}, Tracing::NullSpan::instance());
+
+  expectRequest({{{{"a", "1"}}}, {{{"b", "1"}}}});
+  EXPECT_CALL(*window_timer, disableTimer());
+  client2->limit(callbacks2_, "foo", {{{{"b", "1"}}}}, Tracing::NullSpan::instance());
+
+  // Without a status per descriptor, the overall code applies to every client.
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::OverLimit, _));
+  EXPECT_CALL(callbacks2_, complete_(LimitStatus::OverLimit, _));
+  respond("overall_code: OVER_LIMIT");
+}
+
+TEST_F(RateLimitBatchingClientTest, CancelledClientsAreSkipped) {
+  setUp(R"EOF(
+batch_window: 0.001s
+)EOF");
+  auto client1 = newClient();
+  auto client2 = newClient();
+  auto client3 = newClient();
+  auto* window_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  client1->limit(callbacks1_, "foo", {{{{"a", "1"}}}}, Tracing::NullSpan::instance());
+  client2->limit(callbacks2_, "foo", {{{{"b", "1"}}}}, Tracing::NullSpan::instance());
+  client3->limit(callbacks3_, "foo", {{{{"c", "1"}}}}, Tracing::NullSpan::instance());
+
+  // A client cancelled before the end of the window is not sent.
+  client1->cancel();
+  expectRequest({{{{"b", "1"}}}, {{{"c", "1"}}}});
+  window_timer->invokeCallback();
+
+  // A client cancelled afterwards does not cancel the request of the others.
+  EXPECT_CALL(async_request_, cancel()).Times(0);
+  client2->cancel();
+  EXPECT_CALL(callbacks3_, complete_(LimitStatus::OverLimit, _));
+  respond(R"EOF(
+overall_code: OVER_LIMIT
+statuses: [{code: OK}, {code: OVER_LIMIT}]
+)EOF");
+}
+
+TEST_F(RateLimitBatchingClientTest, EmptyBatchIsDropped) {
+  setUp(R"EOF(
+batch_window: 0.001s
+)EOF");
+  auto client = newClient();
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  client->limit(callbacks1_, "foo", {{{{"a", "1"}}}}, Tracing::NullSpan::instance());
+  EXPECT_CALL(*async_client_, send(_, _, _, _, _)).Times(0);
+  client->cancel();
+
+  // The next request starts a new batch.
+  auto* window_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  client->limit(callbacks1_, "foo", {{{{"a", "2"}}}}, Tracing::NullSpan::instance());
+  EXPECT_TRUE(window_timer->enabled_);
+  client->cancel();
+}
+
+TEST_F(RateLimitBatchingClientTest, FailureIsReportedToAllClients) {
+  setUp(R"EOF(
+batch_window: 0.001s
+)EOF");
+  auto client1 = newClient();
+  auto client2 = newClient();
+  auto* window_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  client1->limit(callbacks1_, "foo", {{{{"a", "1"}}}}, Tracing::NullSpan::instance());
+  client2->limit(callbacks2_, "foo", {{{{"b", "1"}}}}, Tracing::NullSpan::instance());
+  expectRequest({{{{"a", "1"}}}, {{{"b", "1"}}}});
+  window_timer->invokeCallback();
+
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::Error, nullptr));
+  EXPECT_CALL(callbacks2_, complete_(LimitStatus::Error, nullptr));
+  request_callbacks_->onFailure(Grpc::Status::Unavailable, "", span_);
+}
+
+TEST_F(RateLimitBatchingClientTest, OverLimitDescriptorsAreCached) {
+  setUp(R"EOF(
+over_limit_cache_ttl: 1s
+)EOF");
+  auto client = newClient();
+
+  // Without a window, every request is sent at once.
+  expectRequest({{{{"a", "1"}}}, {{{"b", "1"}}}});
+  client->limit(callbacks1_, "foo", {{{{"a", "1"}}}, {{{"b", "1"}}}},
+                Tracing::NullSpan::instance());
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::OverLimit, _));
+  respond(R"EOF(
+overall_code: OVER_LIMIT
+statuses: [{code: OK}, {code: OVER_LIMIT}]
+)EOF");
+  EXPECT_EQ(1U, counter("over_limit_cache_miss"));
+
+  // A request with the over limit descriptor is limited without calling the service.
+  EXPECT_CALL(*async_client_, send(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::OverLimit, _));
+  client->limit(callbacks1_, "foo", {{{{"c", "1"}}}, {{{"b", "1"}}}},
+                Tracing::NullSpan::instance());
+  EXPECT_EQ(1U, counter("over_limit_cache_hit"));
+  testing::Mock::VerifyAndClearExpectations(async_client_);
+
+  // The same descriptor in another domain is not cached.
+  expectRequest({{{{"b", "1"}}}}, "bar");
+  client->limit(callbacks1_, "bar", {{{{"b", "1"}}}}, Tracing::NullSpan::instance());
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::OK, _));
+  respond("{overall_code: OK, statuses: [{code: OK}]}");
+
+  // The decision expires after the TTL.
+  time_system_.sleep(std::chrono::seconds(1));
+  expectRequest({{{{"b", "1"}}}});
+  client->limit(callbacks1_, "foo", {{{{"b", "1"}}}}, Tracing::NullSpan::instance());
+  EXPECT_CALL(callbacks1_, complete_(LimitStatus::OK, _));
+  respond("{overall_code: OK, statuses: [{code: OK}]}");
+  EXPECT_EQ(1U, counter("over_limit_cache_hit"));
+  EXPECT_EQ(3U, counter("over_limit_cache_miss"));
+}
+
+TEST_F(RateLimitBatchingClientTest, OutstandingRequestsAreCancelledOnDestruction) {
+  setUp(R"EOF(
+over_limit_cache_ttl: 1s
+)EOF");
+  auto client = newClient();
+  expectRequest({{{{"a", "1"}}}});
+  client->limit(callbacks1_, "foo", {{{{"a", "1"}}}}, Tracing::NullSpan::instance());
+  client->cancel();
+
+  EXPECT_CALL(async_request_, cancel());
+  batcher_.reset();
+}
+
+} // namespace
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,28 @@
+#include "extensions/filters/common/ratelimit/descriptor_key.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+namespace {
+
+TEST(DescriptorKeyTest, Unambiguous) {
+  const Envoy::RateLimit::Descriptor descriptor{{{"a", "b"}, {"c", "d"}}};
+  EXPECT_EQ(descriptorKey("domain", descriptor), descriptorKey("domain", descriptor));
+  EXPECT_NE(descriptorKey("domain", descriptor), descriptorKey("other", descriptor));
+
+  // Entries whose concatenations are equal still give different keys.
+  EXPECT_NE(descriptorKey("domain", descriptor),
+            descriptorKey("domain", {{{"a", "bc"}, {"", "d"}}}));
+  EXPECT_NE(descriptorKey("domain", descriptor), descriptorKey("domainab", {{{"c", "d"}}}));
+}
+
+} // namespace
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace {
+
+class AdaptiveConcurrencyFilterTest : public testing::Test {
+protected:
+  AdaptiveConcurrencyFilterTest() {
+    envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency proto_config;
+    MessageUtil::loadFromYaml(R"EOF(
+min_rtt_request_count: 1
+min_concurrency: 1
+)EOF",
+                              proto_config);
+    // The timers of the controller, which it owns.
+    new NiceMock<Event::MockTimer>(&dispatcher_);
+    new NiceMock<Event::MockTimer>(&dispatcher_);
+    controller_ = std::make_shared<GradientController>(GradientControllerConfig(proto_config),
+                                                       dispatcher_, "test.", stats_);
+  }
+
+  struct Stream {
+    Stream(const GradientControllerSharedPtr& controller, TimeSource& time_source)
+        : filter_(controller, time_source) {
+      filter_.setDecoderFilterCallbacks(decoder_callbacks_);
+      filter_.setEncoderFilterCallbacks(encoder_callbacks_);
+    }
+    ~Stream() { filter_.onDestroy(); }
+
+    AdaptiveConcurrencyFilter filter_;
+    NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+    NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  };
+
+  std::unique_ptr<Stream> newStream() {
+    return std::make_unique<Stream>(controller_, time_system_);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Stats::IsolatedStoreImpl stats_;
+  GradientControllerSharedPtr controller_;
+  Http::TestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/"}};
+  Http::TestHeaderMapImpl response_headers_{{":status", "200"}};
+};
+
+TEST_F(AdaptiveConcurrencyFilterTest, RequestsOverTheLimitAreBlocked) {
+  auto stream = newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream->filter_.decodeHeaders(request_headers_, true));
+
+  auto blocked = newStream();
+  Http::TestHeaderMapImpl local_response_headers{
+      {":status", "503"}, {"content-length", "25"}, {"content-type", "text/plain"}};
+  EXPECT_CALL(blocked->decoder_callbacks_,
+              encodeHeaders_(HeaderMapEqualRef(&local_response_headers), false));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            blocked->filter_.decodeHeaders(request_headers_, true));
+  EXPECT_EQ(1U, stats_.counter("test.rq_blocked").value());
+  // The local reply of a blocked request is not sampled.
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            blocked->filter_.encodeHeaders(local_response_headers, true));
+  blocked.reset();
+  EXPECT_EQ(1, stats_.gauge("test.min_rtt_calculation_active").value());
+
+  // The response of the forwarded request ends it, and measures the minimum RTT.
+  time_system_.sleep(std::chrono::milliseconds(5));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream->filter_.encodeHeaders(response_headers_, true));
+  EXPECT_EQ(5, stats_.gauge("test.min_rtt_msecs").value());
+  EXPECT_EQ(0, stats_.gauge("test.min_rtt_calculation_active").value());
+
+  auto next = newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            next->filter_.decodeHeaders(request_headers_, true));
+}
+
+TEST_F(AdaptiveConcurrencyFilterTest, ResetRequestsAreNotSampled) {
+  auto stream = newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream->filter_.decodeHeaders(request_headers_, true));
+  stream.reset();
+  EXPECT_EQ(1, stats_.gauge("test.min_rtt_calculation_active").value());
+
+  // The request that was reset is no longer outstanding.
+  stream = newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream->filter_.decodeHeaders(request_headers_, true));
+  EXPECT_EQ(0U, stats_.counter("test.rq_blocked").value());
+}
+
+} // namespace
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
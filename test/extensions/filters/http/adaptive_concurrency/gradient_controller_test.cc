@@ -0,0 +1,173 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace {
+
+class GradientControllerTest : public testing::Test {
+protected:
+  void setUpController(const std::string& yaml) {
+    envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    // The controller creates the minimum RTT timer first, which matches the newest expectation.
+    sample_reset_timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
+    min_rtt_calc_timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
+    controller_ = std::make_unique<GradientController>(GradientControllerConfig(proto_config),
+                                                       dispatcher_, "test.", stats_);
+  }
+
+  // Forwards requests one after the other, and samples the given latency for each one.
+  void sampleLatency(std::chrono::milliseconds latency, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      EXPECT_TRUE(controller_->forwardingDecision());
+      controller_->recordLatencySample(latency);
+    }
+  }
+
+  uint64_t gauge(const std::string& name) { return stats_.gauge("test." + name).value(); }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Stats::IsolatedStoreImpl stats_;
+  Event::MockTimer* sample_reset_timer_{};
+  Event::MockTimer* min_rtt_calc_timer_{};
+  std::unique_ptr<GradientController> controller_;
+};
+
+const std::string Config = R"EOF(
+min_rtt_request_count: 5
+min_concurrency: 2
+max_concurrency_limit: 100
+)EOF";
+
+TEST_F(GradientControllerTest, MinRTTIsMeasuredFirst) {
+  setUpController(Config);
+  EXPECT_TRUE(min_rtt_calc_timer_->enabled_);
+  EXPECT_TRUE(sample_reset_timer_->enabled_);
+  EXPECT_EQ(1, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(2, gauge("concurrency_limit"));
+
+  // The limit is the minimum concurrency during the measurement.
+  EXPECT_TRUE(controller_->forwardingDecision());
+  EXPECT_TRUE(controller_->forwardingDecision());
+  EXPECT_FALSE(controller_->forwardingDecision());
+  controller_->recordLatencySample(std::chrono::milliseconds(10));
+  controller_->cancelLatencySample();
+
+  // The sample window does not change the limit until the minimum RTT is known.
+  sampleLatency(std::chrono::milliseconds(30), 2);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(2, controller_->concurrencyLimit());
+  EXPECT_EQ(1, gauge("min_rtt_calculation_active"));
+
+  sampleLatency(std::chrono::milliseconds(20), 2);
+  EXPECT_EQ(20, gauge("min_rtt_msecs"));
+  EXPECT_EQ(0, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(2, controller_->concurrencyLimit());
+}
+
+TEST_F(GradientControllerTest, LimitFollowsLatencies) {
+  setUpController(Config);
+  sampleLatency(std::chrono::milliseconds(10), 5);
+
+  // Latencies at the minimum RTT increase the limit: 2 * 1.25 + sqrt(2 * 1.25).
+  sampleLatency(std::chrono::milliseconds(10), 2);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(4, controller_->concurrencyLimit());
+  EXPECT_EQ(4, gauge("concurrency_limit"));
+  EXPECT_EQ(10, gauge("sample_rtt_msecs"));
+
+  // 4 * 1.25 + sqrt(4 * 1.25).
+  sampleLatency(std::chrono::milliseconds(10), 4);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(7, controller_->concurrencyLimit());
+
+  // A window without samples leaves the limit unchanged.
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(7, controller_->concurrencyLimit());
+
+  // The aggregate percentile is the median, so the outlier does not matter, and latencies within
+  // the buffer still increase the limit: 7 * 12.5 / 11 + sqrt(7 * 12.5 / 11).
+  sampleLatency(std::chrono::milliseconds(11), 2);
+  sampleLatency(std::chrono::milliseconds(1000), 1);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(10, controller_->concurrencyLimit());
+  EXPECT_EQ(11, gauge("sample_rtt_msecs"));
+
+  // Queueing halves the limit at most: 10 * 0.5 + sqrt(10 * 0.5).
+  sampleLatency(std::chrono::milliseconds(100), 3);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(7, controller_->concurrencyLimit());
+  EXPECT_EQ(100, gauge("sample_rtt_msecs"));
+}
+
+TEST_F(GradientControllerTest, LimitIsBounded) {
+  setUpController(R"EOF(
+min_rtt_request_count: 1
+min_concurrency: 2
+max_concurrency_limit: 5
+)EOF");
+  sampleLatency(std::chrono::milliseconds(10), 1);
+
+  for (int i = 0; i < 3; i++) {
+    sampleLatency(std::chrono::milliseconds(10), 1);
+    sample_reset_timer_->invokeCallback();
+  }
+  EXPECT_EQ(5, controller_->concurrencyLimit());
+
+  for (int i = 0; i < 5; i++) {
+    sampleLatency(std::chrono::seconds(1), 1);
+    sample_reset_timer_->invokeCallback();
+  }
+  EXPECT_EQ(2, controller_->concurrencyLimit());
+}
+
+TEST_F(GradientControllerTest, MinRTTIsRemeasured) {
+  setUpController(Config);
+  sampleLatency(std::chrono::milliseconds(10), 5);
+  sampleLatency(std::chrono::milliseconds(10), 2);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(4, controller_->concurrencyLimit());
+
+  EXPECT_CALL(*min_rtt_calc_timer_, enableTimer(std::chrono::milliseconds(30000))).Times(2);
+  min_rtt_calc_timer_->invokeCallback();
+  EXPECT_EQ(2, controller_->concurrencyLimit());
+  EXPECT_EQ(1, gauge("min_rtt_calculation_active"));
+
+  // Too few requests completed, so the measurement restarts, and the limit to restore is kept.
+  sampleLatency(std::chrono::milliseconds(40), 4);
+  min_rtt_calc_timer_->invokeCallback();
+  EXPECT_EQ(2, controller_->concurrencyLimit());
+
+  sampleLatency(std::chrono::milliseconds(20), 5);
+  EXPECT_EQ(20, gauge("min_rtt_msecs"));
+  EXPECT_EQ(0, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(4, controller_->concurrencyLimit());
+
+  // Latencies are now compared with the new minimum RTT: 4 * 1.25 + sqrt(4 * 1.25).
+  sampleLatency(std::chrono::milliseconds(20), 4);
+  sample_reset_timer_->invokeCallback();
+  EXPECT_EQ(7, controller_->concurrencyLimit());
+}
+
+} // namespace
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,316 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+class CacheFilterTest : public testing::Test {
+protected:
+  CacheFilterTest() : api_(Api::createApiForTest()) {
+    time_system_.setSystemTime(std::chrono::hours(24 * 365 * 40));
+    envoy::config::filter::http::cache::v2alpha::Cache proto_config;
+    proto_config.mutable_max_body_bytes()->set_value(1024);
+    config_ = std::make_shared<CacheFilterConfig>(proto_config, "test.", stats_, time_system_, tls_,
+                                                  *api_, random_);
+  }
+
+  struct Stream {
+    Stream(const CacheFilterConfigSharedPtr& config)
+        : filter_(std::make_shared<CacheFilter>(config)) {
+      filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+      filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+    }
+    ~Stream() { filter_->onDestroy(); }
+
+    std::shared_ptr<CacheFilter> filter_;
+    NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+    NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  };
+
+  std::string now() {
+    return DateFormatter("%a, %d %b %Y %H:%M:%S GMT").fromTime(time_system_.systemTime());
+  }
+
+  // Sends a response through the filter of a stream that missed.
+  void respond(Stream& stream, Http::TestHeaderMapImpl&& response_headers,
+               const std::string& body) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->encodeHeaders(response_headers, body.empty()));
+    if (!body.empty()) {
+      Buffer::OwnedImpl data(body);
+      EXPECT_EQ(Http::FilterDataStatus::Continue, stream.filter_->encodeData(data, true));
+    }
+  }
+
+  // Expects the stream to be served from the cache.
+  void expectServed(Stream& stream, const std::string& status, const std::string& body) {
+    EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, body.empty()))
+        .WillOnce(Invoke([status](Http::HeaderMap& headers, bool) {
+          EXPECT_EQ(status, headers.Status()->value().getStringView());
+          EXPECT_NE(nullptr, headers.get(CacheHeaders::get().Age));
+        }));
+    if (!body.empty()) {
+      EXPECT_CALL(stream.decoder_callbacks_, encodeData(_, true))
+          .WillOnce(Invoke([body](Buffer::Instance& data, bool) {
+            EXPECT_EQ(body, data.toString());
+          }));
+    }
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_.counter("test.cache." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  CacheFilterConfigSharedPtr config_;
+  Http::TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}};
+};
+
+TEST_F(CacheFilterTest, MissThenHit) {
+  {
+    Stream stream(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->decodeHeaders(request_headers_, true));
+    respond(stream,
+            {{":status", "200"}, {"date", now()}, {"cache-control", "max-age=10"}},
+            "body");
+  }
+  EXPECT_EQ(1, counter("miss"));
+  EXPECT_EQ(1, counter("insert"));
+
+  time_system_.sleep(std::chrono::seconds(5));
+  {
+    Stream stream(config_);
+    expectServed(stream, "200", "body");
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              stream.filter_->decodeHeaders(request_headers_, true));
+  }
+  EXPECT_EQ(1, counter("hit"));
+
+  // The response is stale once its max-age has passed.
+  time_system_.sleep(std::chrono::seconds(5));
+  {
+    Stream stream(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->decodeHeaders(request_headers_, true));
+  }
+  EXPECT_EQ(2, counter("miss"));
+}
+
+TEST_F(CacheFilterTest, UncacheableRequest) {
+  Http::TestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":authority", "host"}, {":path", "/"}};
+  Stream stream(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream.filter_->decodeHeaders(request_headers, true));
+  respond(stream, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  EXPECT_EQ(1, counter("uncacheable"));
+  EXPECT_EQ(0, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, UncacheableResponse) {
+  {
+    Stream stream(config_);
+    stream.filter_->decodeHeaders(request_headers_, true);
+    respond(stream, {{":status", "200"}, {"cache-control", "no-store, max-age=10"}}, "body");
+  }
+  EXPECT_EQ(0, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, BodyTooLarge) {
+  {
+    Stream stream(config_);
+    stream.filter_->decodeHeaders(request_headers_, true);
+    respond(stream, {{":status", "200"}, {"cache-control", "max-age=10"}}, std::string(2048, 'a'));
+  }
+  EXPECT_EQ(0, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, KeyedOnConnectionScheme) {
+  NiceMock<Network::MockConnection> connection;
+  NiceMock<Ssl::MockConnectionInfo> ssl;
+  ON_CALL(connection, ssl()).WillByDefault(Return(&ssl));
+  {
+    Stream stream(config_);
+    ON_CALL(stream.decoder_callbacks_, connection()).WillByDefault(Return(&connection));
+    stream.filter_->decodeHeaders(request_headers_, true);
+    respond(stream, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  }
+
+  // The scheme that a plaintext client claims is not trusted.
+  Http::TestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"x-forwarded-proto", "https"}};
+  {
+    Stream stream(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->decodeHeaders(request_headers, true));
+  }
+
+  Stream stream(config_);
+  ON_CALL(stream.decoder_callbacks_, connection()).WillByDefault(Return(&connection));
+  expectServed(stream, "200", "body");
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            stream.filter_->decodeHeaders(request_headers_, true));
+}
+
+TEST_F(CacheFilterTest, VaryVariants) {
+  for (const std::string encoding : {"gzip", "br"}) {
+    Http::TestHeaderMapImpl request_headers{
+        {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"accept-encoding", encoding}};
+    Stream stream(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->decodeHeaders(request_headers, true));
+    respond(stream,
+            {{":status", "200"}, {"cache-control", "max-age=10"}, {"vary", "accept-encoding"}},
+            encoding);
+  }
+  EXPECT_EQ(2, counter("insert"));
+
+  // Both variants are served, not only the latest one.
+  for (const std::string encoding : {"gzip", "br"}) {
+    Http::TestHeaderMapImpl request_headers{
+        {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"accept-encoding", encoding}};
+    Stream stream(config_);
+    expectServed(stream, "200", encoding);
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              stream.filter_->decodeHeaders(request_headers, true));
+  }
+  EXPECT_EQ(2, counter("hit"));
+
+  Http::TestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"accept-encoding", "deflate"}};
+  Stream stream(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream.filter_->decodeHeaders(request_headers, true));
+}
+
+TEST_F(CacheFilterTest, NotModifiedForClientValidator) {
+  {
+    Stream stream(config_);
+    stream.filter_->decodeHeaders(request_headers_, true);
+    respond(stream, {{":status", "200"}, {"cache-control", "max-age=10"}, {"etag", "\"a\""}},
+            "body");
+  }
+
+  Http::TestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"if-none-match", "\"a\""}};
+  Stream stream(config_);
+  expectServed(stream, "304", "");
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            stream.filter_->decodeHeaders(request_headers, true));
+}
+
+TEST_F(CacheFilterTest, Validate) {
+  {
+    Stream stream(config_);
+    stream.filter_->decodeHeaders(request_headers_, true);
+    respond(stream,
+            {{":status", "200"}, {"cache-control", "max-age=10"}, {"etag", "\"a\""}, {"x", "1"}},
+            "body");
+  }
+  time_system_.sleep(std::chrono::seconds(20));
+
+  {
+    Stream stream(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->decodeHeaders(request_headers_, true));
+    EXPECT_EQ("\"a\"", request_headers_.get_("if-none-match"));
+    EXPECT_EQ(1, counter("validate"));
+
+    // The 304 response is replaced by the refreshed stored response.
+    EXPECT_CALL(stream.encoder_callbacks_, addEncodedData(_, false))
+        .WillOnce(Invoke(
+            [](Buffer::Instance& data, bool) { EXPECT_EQ("body", data.toString()); }));
+    Http::TestHeaderMapImpl response_headers{
+        {":status", "304"}, {"cache-control", "max-age=10"}, {"x", "2"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->encodeHeaders(response_headers, true));
+    EXPECT_EQ("200", response_headers.get_(":status"));
+    EXPECT_EQ("2", response_headers.get_("x"));
+    EXPECT_EQ("\"a\"", response_headers.get_("etag"));
+    EXPECT_EQ(1, counter("validated"));
+  }
+
+  // The refreshed response is fresh again.
+  Http::TestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}};
+  Stream stream(config_);
+  expectServed(stream, "200", "body");
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            stream.filter_->decodeHeaders(request_headers, true));
+}
+
+TEST_F(CacheFilterTest, CoalesceMisses) {
+  Stream filler(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            filler.filter_->decodeHeaders(request_headers_, true));
+
+  Http::TestHeaderMapImpl request_headers1{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}};
+  Http::TestHeaderMapImpl request_headers2{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}};
+  auto waiter1 = std::make_unique<Stream>(config_);
+  Stream waiter2(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter1->filter_->decodeHeaders(request_headers1, true));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter2.filter_->decodeHeaders(request_headers2, true));
+  EXPECT_EQ(2, counter("coalesced"));
+  // A waiter that is destroyed before the fill ends is not resumed.
+  waiter1.reset();
+
+  expectServed(waiter2, "200", "body");
+  EXPECT_CALL(waiter2.decoder_callbacks_, continueDecoding()).Times(0);
+  respond(filler, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  EXPECT_EQ(1, counter("hit"));
+}
+
+TEST_F(CacheFilterTest, CoalescedMissResumedWhenResponseIsNotStored) {
+  Stream filler(config_);
+  filler.filter_->decodeHeaders(request_headers_, true);
+
+  Http::TestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}};
+  Stream waiter(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter.filter_->decodeHeaders(request_headers, true));
+
+  EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding());
+  respond(filler, {{":status", "500"}}, "error");
+  EXPECT_EQ(2, counter("miss"));
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
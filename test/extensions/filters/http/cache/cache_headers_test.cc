@@ -0,0 +1,105 @@
+#include <chrono>
+
+#include "extensions/filters/http/cache/cache_headers.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+TEST(CacheHeadersUtilsTest, RequestCacheControl) {
+  RequestCacheControl cache_control = CacheHeadersUtils::requestCacheControl(
+      Http::TestHeaderMapImpl{{"cache-control", "no-cache, max-age=10"}});
+  EXPECT_FALSE(cache_control.no_store_);
+  EXPECT_TRUE(cache_control.no_cache_);
+  EXPECT_EQ(std::chrono::seconds(10), cache_control.max_age_.value());
+
+  cache_control =
+      CacheHeadersUtils::requestCacheControl(Http::TestHeaderMapImpl{{"pragma", "no-cache"}});
+  EXPECT_TRUE(cache_control.no_cache_);
+  EXPECT_FALSE(cache_control.max_age_.has_value());
+
+  // Pragma is ignored when the request has a Cache-Control header.
+  cache_control = CacheHeadersUtils::requestCacheControl(
+      Http::TestHeaderMapImpl{{"pragma", "no-cache"}, {"cache-control", "no-store"}});
+  EXPECT_TRUE(cache_control.no_store_);
+  EXPECT_FALSE(cache_control.no_cache_);
+}
+
+TEST(CacheHeadersUtilsTest, IsCacheableRequest) {
+  EXPECT_TRUE(CacheHeadersUtils::isCacheableRequest(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {":authority", "host"}, {":path", "/"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableRequest(
+      Http::TestHeaderMapImpl{{":method", "POST"}, {":authority", "host"}, {":path", "/"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableRequest(Http::TestHeaderMapImpl{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"authorization", "a"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableRequest(Http::TestHeaderMapImpl{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"cache-control", "no-store"}}));
+}
+
+TEST(CacheHeadersUtilsTest, IsCacheableResponse) {
+  EXPECT_TRUE(CacheHeadersUtils::isCacheableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=10"}}));
+  EXPECT_TRUE(CacheHeadersUtils::isCacheableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"etag", "\"a\""}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableResponse(Http::TestHeaderMapImpl{{":status", "200"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableResponse(
+      Http::TestHeaderMapImpl{{":status", "500"}, {"cache-control", "max-age=10"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "private, max-age=10"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "no-store, max-age=10"}}));
+  EXPECT_FALSE(CacheHeadersUtils::isCacheableResponse(Http::TestHeaderMapImpl{
+      {":status", "200"}, {"cache-control", "max-age=10"}, {"vary", "*"}}));
+}
+
+TEST(CacheHeadersUtilsTest, FreshnessLifetime) {
+  EXPECT_EQ(std::chrono::seconds(20),
+            CacheHeadersUtils::freshnessLifetime(
+                Http::TestHeaderMapImpl{{"cache-control", "max-age=10, s-maxage=20"}}));
+  EXPECT_EQ(std::chrono::seconds(10), CacheHeadersUtils::freshnessLifetime(Http::TestHeaderMapImpl{
+                                          {"cache-control", "max-age=10"},
+                                          {"date", "Sun, 06 Nov 1994 08:49:37 GMT"},
+                                          {"expires", "Sun, 06 Nov 1994 09:49:37 GMT"}}));
+  EXPECT_EQ(std::chrono::seconds(3600),
+            CacheHeadersUtils::freshnessLifetime(
+                Http::TestHeaderMapImpl{{"date", "Sun, 06 Nov 1994 08:49:37 GMT"},
+                                        {"expires", "Sun, 06 Nov 1994 09:49:37 GMT"}}));
+  EXPECT_EQ(std::chrono::seconds(0),
+            CacheHeadersUtils::freshnessLifetime(Http::TestHeaderMapImpl{
+                {"date", "Sun, 06 Nov 1994 08:49:37 GMT"}, {"expires", "0"}}));
+}
+
+TEST(CacheHeadersUtilsTest, InitialAge) {
+  Http::TestHeaderMapImpl headers{{"date", "Sun, 06 Nov 1994 08:49:37 GMT"}, {"age", "5"}};
+  const SystemTime date = CacheHeadersUtils::httpTime(headers.Date()).value();
+  EXPECT_EQ(std::chrono::seconds(5), CacheHeadersUtils::initialAge(headers, date));
+  EXPECT_EQ(std::chrono::seconds(8),
+            CacheHeadersUtils::initialAge(headers, date + std::chrono::seconds(8)));
+}
+
+TEST(CacheHeadersUtilsTest, VaryHeaders) {
+  EXPECT_EQ(std::vector<std::string>({"accept-encoding", "user-agent"}),
+            CacheHeadersUtils::varyHeaders(
+                Http::TestHeaderMapImpl{{"vary", "Accept-Encoding, User-Agent"}})
+                .value());
+  EXPECT_TRUE(CacheHeadersUtils::varyHeaders(Http::TestHeaderMapImpl{}).value().empty());
+  EXPECT_FALSE(
+      CacheHeadersUtils::varyHeaders(Http::TestHeaderMapImpl{{"vary", "Accept, *"}}).has_value());
+}
+
+TEST(CacheHeadersUtilsTest, IfNoneMatch) {
+  EXPECT_TRUE(CacheHeadersUtils::ifNoneMatch("\"a\", \"b\"", "\"b\""));
+  EXPECT_TRUE(CacheHeadersUtils::ifNoneMatch("W/\"a\"", "\"a\""));
+  EXPECT_TRUE(CacheHeadersUtils::ifNoneMatch("*", "\"a\""));
+  EXPECT_FALSE(CacheHeadersUtils::ifNoneMatch("\"a\"", "\"b\""));
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,145 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/http/header_map_impl.h"
+
+#include "extensions/filters/http/cache/file_cache.h"
+#include "extensions/filters/http/cache/memory_cache.h"
+#include "extensions/filters/http/cache/tiered_cache.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+CachedResponseConstSharedPtr makeResponse(const std::string& body) {
+  return std::make_shared<CachedResponse>(
+      Http::HeaderMapPtr{
+          new Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=10"}}},
+      std::string(body), SystemTime(std::chrono::seconds(1000)),
+      VaryValues{{"accept-encoding", "gzip"}});
+}
+
+class FileCacheTest : public testing::Test {
+protected:
+  FileCacheTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher()),
+        path_(TestEnvironment::temporaryPath("file_cache_test")) {
+    TestEnvironment::removePath(path_);
+    TestEnvironment::createPath(path_);
+  }
+
+  ~FileCacheTest() { TestEnvironment::removePath(path_); }
+
+  std::unique_ptr<FileCache> createCache(uint64_t max_size_bytes) {
+    return std::make_unique<FileCache>(api_->fileSystem(), api_->threadFactory(), path_,
+                                       max_size_bytes, "test");
+  }
+
+  // Runs the dispatcher until the lookup completes.
+  CachedResponseConstSharedPtr lookup(HttpCache& cache, const std::string& key) {
+    CachedResponseConstSharedPtr result;
+    bool done = false;
+    cache.lookup(key, *dispatcher_, [&](CachedResponseConstSharedPtr response) -> void {
+      result = std::move(response);
+      done = true;
+      dispatcher_->exit();
+    });
+    if (!done) {
+      dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+    }
+    return result;
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  const std::string path_;
+};
+
+TEST_F(FileCacheTest, EncodeDecode) {
+  CachedResponseConstSharedPtr response = makeResponse("body");
+  const std::string data = FileCache::encode("key", *response);
+
+  CachedResponseConstSharedPtr decoded = FileCache::decode(data, "key");
+  ASSERT_NE(nullptr, decoded);
+  EXPECT_TRUE(TestUtility::headerMapEqualIgnoreOrder(response->headers(), decoded->headers()));
+  EXPECT_EQ("body", decoded->body());
+  EXPECT_EQ(response->responseTime(), decoded->responseTime());
+  EXPECT_EQ(response->varyValues(), decoded->varyValues());
+
+  EXPECT_EQ(nullptr, FileCache::decode(data, "other key"));
+  EXPECT_EQ(nullptr, FileCache::decode(data.substr(0, data.size() - 1), "key"));
+  EXPECT_EQ(nullptr, FileCache::decode("garbage", "key"));
+}
+
+TEST_F(FileCacheTest, MissingDirectory) {
+  EXPECT_THROW_WITH_MESSAGE(FileCache(api_->fileSystem(), api_->threadFactory(),
+                                      path_ + "/missing", 1024, "test"),
+                            EnvoyException,
+                            "cache directory does not exist: " + path_ + "/missing");
+}
+
+TEST_F(FileCacheTest, InsertLookupRemove) {
+  std::unique_ptr<FileCache> cache = createCache(1024 * 1024);
+  EXPECT_EQ(nullptr, lookup(*cache, "a"));
+
+  // Operations are performed in order, so the lookup sees the response inserted before it.
+  cache->insert("a", makeResponse("body"));
+  CachedResponseConstSharedPtr response = lookup(*cache, "a");
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ("body", response->body());
+
+  cache->remove("a");
+  EXPECT_EQ(nullptr, lookup(*cache, "a"));
+}
+
+TEST_F(FileCacheTest, SurvivesRestart) {
+  // Pending writes are completed by the destructor.
+  createCache(1024 * 1024)->insert("a", makeResponse("body"));
+  // A temporary file left over by an interrupted write is deleted.
+  TestEnvironment::writeStringToFileForTest("file_cache_test/0000000000000000.tmp.0.1", "partial");
+
+  std::unique_ptr<FileCache> cache = createCache(1024 * 1024);
+  CachedResponseConstSharedPtr response = lookup(*cache, "a");
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ("body", response->body());
+  EXPECT_FALSE(api_->fileSystem().fileExists(path_ + "/0000000000000000.tmp.0.1"));
+}
+
+TEST_F(FileCacheTest, EvictLeastRecentlyUsed) {
+  const uint64_t file_size = FileCache::encode("a", *makeResponse(std::string(100, 'a'))).size();
+  std::unique_ptr<FileCache> cache = createCache(2 * file_size);
+  cache->insert("a", makeResponse(std::string(100, 'a')));
+  cache->insert("b", makeResponse(std::string(100, 'b')));
+  EXPECT_NE(nullptr, lookup(*cache, "a"));
+
+  cache->insert("c", makeResponse(std::string(100, 'c')));
+  EXPECT_NE(nullptr, lookup(*cache, "a"));
+  EXPECT_EQ(nullptr, lookup(*cache, "b"));
+  EXPECT_NE(nullptr, lookup(*cache, "c"));
+}
+
+TEST_F(FileCacheTest, TieredCopiesToMemory) {
+  auto memory = std::make_shared<MemoryCache>(1024 * 1024, 1);
+  createCache(1024 * 1024)->insert("a", makeResponse("body"));
+  TieredCache cache(memory, createCache(1024 * 1024));
+  EXPECT_EQ(nullptr, memory->get("a"));
+
+  CachedResponseConstSharedPtr response = lookup(cache, "a");
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ(response, memory->get("a"));
+  EXPECT_EQ(response, lookup(cache, "a"));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
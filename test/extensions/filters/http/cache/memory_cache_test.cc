@@ -0,0 +1,74 @@
+#include <chrono>
+#include <string>
+
+#include "common/http/header_map_impl.h"
+
+#include "extensions/filters/http/cache/memory_cache.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+CachedResponseConstSharedPtr makeResponse(const std::string& body) {
+  return std::make_shared<CachedResponse>(
+      Http::HeaderMapPtr{
+          new Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=10"}}},
+      std::string(body), SystemTime(), VaryValues());
+}
+
+} // namespace
+
+TEST(MemoryCacheTest, InsertLookupRemove) {
+  MemoryCache cache(1024 * 1024, 4);
+  EXPECT_EQ(nullptr, cache.get("a"));
+
+  CachedResponseConstSharedPtr response = makeResponse("body");
+  cache.insert("a", response);
+  EXPECT_EQ(response, cache.get("a"));
+  EXPECT_EQ(response->byteSize(), cache.sizeBytes());
+
+  CachedResponseConstSharedPtr replacement = makeResponse("other body");
+  cache.insert("a", replacement);
+  EXPECT_EQ(replacement, cache.get("a"));
+  EXPECT_EQ(replacement->byteSize(), cache.sizeBytes());
+
+  cache.remove("a");
+  EXPECT_EQ(nullptr, cache.get("a"));
+  EXPECT_EQ(0, cache.sizeBytes());
+}
+
+TEST(MemoryCacheTest, EvictLeastRecentlyUsed) {
+  const uint64_t response_size = makeResponse(std::string(100, 'a'))->byteSize();
+  MemoryCache cache(3 * response_size, 1);
+  cache.insert("a", makeResponse(std::string(100, 'a')));
+  cache.insert("b", makeResponse(std::string(100, 'b')));
+  cache.insert("c", makeResponse(std::string(100, 'c')));
+  // Makes "b" the least recently used response.
+  EXPECT_NE(nullptr, cache.get("a"));
+
+  cache.insert("d", makeResponse(std::string(100, 'd')));
+  EXPECT_NE(nullptr, cache.get("a"));
+  EXPECT_EQ(nullptr, cache.get("b"));
+  EXPECT_NE(nullptr, cache.get("c"));
+  EXPECT_NE(nullptr, cache.get("d"));
+  EXPECT_EQ(3 * response_size, cache.sizeBytes());
+}
+
+TEST(MemoryCacheTest, ResponseLargerThanShard) {
+  MemoryCache cache(1024, 2);
+  cache.insert("a", makeResponse(std::string(1024, 'a')));
+  EXPECT_EQ(nullptr, cache.get("a"));
+  EXPECT_EQ(0, cache.sizeBytes());
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -14,6 +14,7 @@
 #include "common/network/address_impl.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ext_authz/decision_cache.h"
 #include "extensions/filters/http/ext_authz/ext_authz.h"
 #include "extensions/filters/http/well_known_names.h"
 
@@ -26,6 +27,7 @@
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -1118,6 +1120,128 @@ TEST_F(HttpFilterTestParam, ResetDuringCall) {
   filter_->onDestroy();
 }
 
+class HttpFilterDecisionCacheTest : public HttpFilterTestBase<testing::Test> {
+public:
+  HttpFilterDecisionCacheTest() {
+    initialize("");
+    envoy::config::common::ext_authz::v2alpha::DecisionCache cache_config;
+    MessageUtil::loadFromYaml(R"EOF(
+headers: [authorization]
+ttl: 60s
+denied_ttl: 60s
+)EOF",
+                              cache_config);
+    cache_config_ = std::make_unique<Filters::Common::ExtAuthz::DecisionCacheConfig>(
+        cache_config, "ext_authz.", stats_store_);
+    cache_ =
+        std::make_unique<Filters::Common::ExtAuthz::DecisionCache>(*cache_config_, time_system_);
+  }
+
+  // Authorizes a request with a new filter whose client goes through the cache. The service
+  // returns the response, unless it is nullptr, in which case it must not be called.
+  Http::FilterHeadersStatus authorize(Http::TestHeaderMapImpl& headers,
+                                      const Filters::Common::ExtAuthz::Response* response) {
+    client_ = new Filters::Common::ExtAuthz::MockClient();
+    filter_ = std::make_unique<Filter>(
+        config_, std::make_unique<Filters::Common::ExtAuthz::CachingClient>(
+                     Filters::Common::ExtAuthz::ClientPtr{client_}, *cache_, *cache_config_));
+    filter_->setDecoderFilterCallbacks(filter_callbacks_);
+    prepareCheck();
+    if (response != nullptr) {
+      EXPECT_CALL(*client_, check(_, _, _))
+          .WillOnce(WithArgs<0>(
+              Invoke([response](Filters::Common::ExtAuthz::RequestCallbacks& callbacks) -> void {
+                callbacks.onComplete(
+                    std::make_unique<Filters::Common::ExtAuthz::Response>(*response));
+              })));
+    } else {
+      EXPECT_CALL(*client_, check(_, _, _)).Times(0);
+    }
+    return filter_->decodeHeaders(headers, false);
+  }
+
+  Http::TestHeaderMapImpl request(const std::string& authorization, const std::string& path) {
+    return Http::TestHeaderMapImpl{{":method", "GET"},
+                                   {":authority", "host"},
+                                   {":path", path},
+                                   {"authorization", authorization}};
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("ext_authz." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  std::unique_ptr<Filters::Common::ExtAuthz::DecisionCacheConfig> cache_config_;
+  std::unique_ptr<Filters::Common::ExtAuthz::DecisionCache> cache_;
+};
+
+// Test that a cached decision to allow a request adds the same headers to the request as the
+// response of the service, without calling it.
+TEST_F(HttpFilterDecisionCacheTest, CachedOkResponse) {
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::OK;
+  response.headers_to_add = Http::HeaderVector{{Http::LowerCaseString{"x-user"}, "alice"}};
+
+  auto headers = request("alice", "/a");
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, authorize(headers, &response));
+  EXPECT_EQ("alice", headers.get_("x-user"));
+
+  headers = request("alice", "/a");
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, authorize(headers, nullptr));
+  EXPECT_EQ("alice", headers.get_("x-user"));
+  EXPECT_EQ(1U, counter("cache_hit"));
+  EXPECT_EQ(2U, filter_callbacks_.clusterInfo()->statsScope().counter("ext_authz.ok").value());
+}
+
+// Test that the decision for a request is not reused for another path, or other credentials.
+TEST_F(HttpFilterDecisionCacheTest, OtherRequestsCallTheService) {
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::OK;
+
+  auto headers = request("alice", "/a");
+  authorize(headers, &response);
+  headers = request("alice", "/b");
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, authorize(headers, &response));
+  headers = request("bob", "/a");
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, authorize(headers, &response));
+  EXPECT_EQ(0U, counter("cache_hit"));
+  EXPECT_EQ(3U, counter("cache_miss"));
+}
+
+// Test that a cached denial is sent to the client like the response of the service.
+TEST_F(HttpFilterDecisionCacheTest, CachedDeniedResponse) {
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::Denied;
+  response.status_code = Http::Code::Forbidden;
+
+  Http::TestHeaderMapImpl response_headers{{":status", "403"}};
+  EXPECT_CALL(filter_callbacks_, encodeHeaders_(HeaderMapEqualRef(&response_headers), true))
+      .Times(2);
+  EXPECT_CALL(filter_callbacks_, continueDecoding()).Times(0);
+  auto headers = request("bob", "/a");
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            authorize(headers, &response));
+  headers = request("bob", "/a");
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark, authorize(headers, nullptr));
+  EXPECT_EQ(1U, counter("cache_hit"));
+  EXPECT_EQ(2U,
+            filter_callbacks_.clusterInfo()->statsScope().counter("ext_authz.denied").value());
+}
+
+// Test that errors are not cached.
+TEST_F(HttpFilterDecisionCacheTest, ErrorsAreNotCached) {
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::Error;
+
+  auto headers = request("alice", "/a");
+  authorize(headers, &response);
+  headers = request("alice", "/a");
+  authorize(headers, &response);
+  EXPECT_EQ(0U, counter("cache_insert"));
+  EXPECT_EQ(2U, counter("cache_miss"));
+}
+
 } // namespace
 } // namespace ExtAuthz
 } // namespace HttpFilters
@@ -1,17 +1,23 @@
 #include <memory>
 
+#include "common/common/fmt.h"
 #include "common/compressor/zlib_compressor_impl.h"
 #include "common/decompressor/zlib_decompressor_impl.h"
 #include "common/protobuf/utility.h"
 
 #include "extensions/filters/http/gzip/gzip_filter.h"
+#include "extensions/filters/http/well_known_names.h"
 
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/escaping.h"
+#include "brotli/decode.h"
 #include "gtest/gtest.h"
+#include "zstd.h"
 
 using testing::Return;
 
@@ -51,6 +57,8 @@ protected:
     return filter_->isAcceptEncodingAllowed(headers);
   }
 
+  Codec* negotiateCodec(Http::HeaderMap& headers) { return filter_->negotiateCodec(headers); }
+
   bool isMinimumContentLength(Http::HeaderMap& headers) {
     return filter_->isMinimumContentLength(headers);
   }
@@ -64,8 +72,18 @@ protected:
     Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
     envoy::config::filter::http::gzip::v2::Gzip gzip;
     MessageUtil::loadFromJson(json, gzip);
-    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_));
+    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_, *api_, tls_));
     filter_ = std::make_unique<GzipFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+  }
+
+  void routeConfig(const std::string& json) {
+    envoy::config::filter::http::gzip::v2::GzipPerRoute gzip;
+    MessageUtil::loadFromJson(json, gzip);
+    route_config_ = std::make_unique<GzipRouteConfig>(gzip);
+    ON_CALL(decoder_callbacks_.route_->route_entry_,
+            perFilterConfig(HttpFilterNames::get().EnvoyGzip))
+        .WillByDefault(Return(route_config_.get()));
   }
 
   void verifyCompressedData() {
@@ -121,6 +139,42 @@ protected:
     EXPECT_EQ(1, stats_.counter("test.gzip.not_compressed").value());
   }
 
+  // Compresses a response with a new filter that shares the config of the previous one.
+  void doNextResponseCompression() {
+    filter_ = std::make_unique<GzipFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+    Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+    expected_str_.clear();
+    feedBuffer(256);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+    Decompressor::ZlibDecompressorImpl decompressor;
+    decompressor.init(31);
+    Buffer::OwnedImpl decompressed_data;
+    decompressor.decompress(data_, decompressed_data);
+    EXPECT_EQ(expected_str_, decompressed_data.toString());
+    drainBuffer();
+  }
+
+  // Compresses a response with the coding negotiated for accept_encoding, checks that it is the
+  // expected content_coding, and returns the compressed body.
+  std::string doCodecResponseCompression(const std::string& accept_encoding,
+                                         const std::string& content_coding) {
+    doRequest({{":method", "get"}, {"accept-encoding", accept_encoding}}, true);
+    Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+    feedBuffer(256);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ(content_coding, headers.get_("content-encoding"));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+    const std::string compressed = data_.toString();
+    drainBuffer();
+    return compressed;
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  std::unique_ptr<GzipRouteConfig> route_config_;
   GzipFilterConfigSharedPtr config_;
   std::unique_ptr<GzipFilter> filter_;
   Buffer::OwnedImpl data_;
@@ -129,6 +183,7 @@ protected:
   std::string expected_str_;
   Stats::IsolatedStoreImpl stats_;
   NiceMock<Runtime::MockLoader> runtime_;
+  Api::ApiPtr api_{Api::createApiForTest()};
 };
 
 // Test if Runtime Feature is Disabled
@@ -708,6 +763,245 @@ TEST_F(GzipFilterTest, RemoveAcceptEncodingHeader) {
   }
 }
 
+// Verifies the q-value negotiation between several content-codings.
+TEST_F(GzipFilterTest, NegotiateCodec) {
+  setUpFilter(R"EOF({"codecs": [{"type": "DEFLATE"}, {"type": "GZIP"}]})EOF");
+  const auto negotiate = [this](const std::string& accept_encoding) -> std::string {
+    Http::TestHeaderMapImpl headers = {{"accept-encoding", accept_encoding}};
+    Codec* codec = negotiateCodec(headers);
+    return codec != nullptr ? codec->name() : "";
+  };
+  EXPECT_EQ("gzip", negotiate("gzip"));
+  EXPECT_EQ("deflate", negotiate("deflate"));
+  // Equal q-values are broken by the order of the configured codings.
+  EXPECT_EQ("deflate", negotiate("gzip, deflate"));
+  EXPECT_EQ("gzip", negotiate("gzip, deflate;q=0.5"));
+  EXPECT_EQ("gzip", negotiate("GZIP;Q=0.8, deflate;q=0.5, br"));
+  EXPECT_EQ("gzip", negotiate("deflate;q=0, *"));
+  EXPECT_EQ("deflate", negotiate("br, *;q=0.1"));
+  EXPECT_EQ("", negotiate("br, identity"));
+  EXPECT_EQ("", negotiate("deflate;q=0, gzip;q=0.000"));
+  EXPECT_EQ(2, stats_.counter("test.gzip.header_wildcard").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.header_identity").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.header_not_valid").value());
+}
+
+// Verifies the negotiation of the br and zstd content-codings.
+TEST_F(GzipFilterTest, NegotiateBrotliAndZstd) {
+  setUpFilter(R"EOF({"codecs": [{"type": "BROTLI"}, {"type": "ZSTD"}, {"type": "GZIP"}]})EOF");
+  const auto negotiate = [this](const std::string& accept_encoding) -> std::string {
+    Http::TestHeaderMapImpl headers = {{"accept-encoding", accept_encoding}};
+    Codec* codec = negotiateCodec(headers);
+    return codec != nullptr ? codec->name() : "";
+  };
+  EXPECT_EQ("br", negotiate("gzip, deflate, br"));
+  EXPECT_EQ("zstd", negotiate("gzip, zstd"));
+  EXPECT_EQ("zstd", negotiate("br;q=0.5, zstd"));
+  EXPECT_EQ("gzip", negotiate("gzip, br;q=0.5"));
+  EXPECT_EQ("br", negotiate("*"));
+}
+
+// Verifies that responses are compressed with brotli, with stats of their own.
+TEST_F(GzipFilterTest, BrotliCompression) {
+  setUpFilter(R"EOF({"codecs": [{"type": "BROTLI", "level": 1}, {"type": "GZIP"}]})EOF");
+  const std::string compressed = doCodecResponseCompression("gzip, br", "br");
+
+  std::string decompressed(expected_str_.size(), '\0');
+  size_t decompressed_size = decompressed.size();
+  EXPECT_EQ(BROTLI_DECODER_RESULT_SUCCESS,
+            BrotliDecoderDecompress(
+                compressed.size(), reinterpret_cast<const uint8_t*>(compressed.data()),
+                &decompressed_size, reinterpret_cast<uint8_t*>(&decompressed[0])));
+  EXPECT_EQ(expected_str_, decompressed.substr(0, decompressed_size));
+  EXPECT_EQ(1, stats_.counter("test.gzip.br.compressed").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.br.compressor_created").value());
+  EXPECT_EQ(256, stats_.counter("test.gzip.br.total_uncompressed_bytes").value());
+  EXPECT_EQ(compressed.size(), stats_.counter("test.gzip.br.total_compressed_bytes").value());
+  EXPECT_EQ(0, stats_.counter("test.gzip.gzip.compressed").value());
+}
+
+// Verifies that responses are compressed with zstd, with stats of their own.
+TEST_F(GzipFilterTest, ZstdCompression) {
+  setUpFilter(R"EOF({"codecs": [{"type": "ZSTD"}, {"type": "GZIP"}]})EOF");
+  const std::string compressed = doCodecResponseCompression("gzip, zstd", "zstd");
+
+  std::string decompressed(expected_str_.size(), '\0');
+  const size_t decompressed_size =
+      ZSTD_decompress(&decompressed[0], decompressed.size(), compressed.data(), compressed.size());
+  ASSERT_FALSE(ZSTD_isError(decompressed_size)) << ZSTD_getErrorName(decompressed_size);
+  EXPECT_EQ(expected_str_, decompressed.substr(0, decompressed_size));
+  EXPECT_EQ(1, stats_.counter("test.gzip.zstd.compressed").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.zstd.compressor_created").value());
+  EXPECT_EQ(256, stats_.counter("test.gzip.zstd.total_uncompressed_bytes").value());
+  EXPECT_EQ(compressed.size(), stats_.counter("test.gzip.zstd.total_compressed_bytes").value());
+}
+
+// Verifies the validation of the level of each content-coding.
+TEST_F(GzipFilterTest, CodecLevel) {
+  EXPECT_THROW_WITH_MESSAGE(setUpFilter(R"EOF({"codecs": [{"type": "BROTLI", "level": 12}]})EOF"),
+                            EnvoyException,
+                            "gzip filter: the br content-coding takes a level from 0 to 11");
+  EXPECT_THROW_WITH_MESSAGE(setUpFilter(R"EOF({"codecs": [{"type": "ZSTD", "level": 0}]})EOF"),
+                            EnvoyException,
+                            "gzip filter: the zstd content-coding takes a level from 1 to 19");
+  EXPECT_THROW_WITH_MESSAGE(setUpFilter(R"EOF({"codecs": [{"type": "GZIP", "level": 3}]})EOF"),
+                            EnvoyException,
+                            "gzip filter: the gzip content-coding takes its level from "
+                            "compression_level");
+  EXPECT_THROW_WITH_MESSAGE(
+      setUpFilter(
+          R"EOF({"codecs": [{"type": "ZSTD", "dictionary": {"inline_string": "abc"}}]})EOF"),
+      EnvoyException, "gzip filter: the zstd content-coding does not support dictionaries");
+}
+
+// Verifies that responses are compressed with the negotiated coding and its dictionary.
+TEST_F(GzipFilterTest, DeflateWithDictionary) {
+  const std::string dictionary = R"({"id": "", "name": "", "description": ""})";
+  setUpFilter(fmt::format(R"EOF({{"codecs": [{{"type": "DEFLATE", "content_coding": "X-Deflate-Api",
+                                              "dictionary": {{"inline_string": "{}"}}}}]}})EOF",
+                          absl::CEscape(dictionary)));
+  // Clients without the dictionary, including the ones that accept any coding, don't get it.
+  for (const std::string accept_encoding : {"gzip, deflate", "*"}) {
+    Http::TestHeaderMapImpl headers = {{"accept-encoding", accept_encoding}};
+    EXPECT_EQ(nullptr, negotiateCodec(headers));
+  }
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip;q=0.5, x-deflate-api"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+  feedBuffer(256);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ("x-deflate-api", headers.get_("content-encoding"));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+
+  Decompressor::ZlibDecompressorImpl decompressor;
+  decompressor.init(15);
+  decompressor.setDictionary(dictionary);
+  decompressor.decompress(data_, decompressed_data_);
+  EXPECT_EQ(expected_str_, decompressed_data_.toString());
+  EXPECT_EQ(1, stats_.counter("test.gzip.x-deflate-api.compressed").value());
+  EXPECT_EQ(256, stats_.counter("test.gzip.x-deflate-api.total_uncompressed_bytes").value());
+}
+
+// Verifies that a dictionary can't be used with the standard deflate content-coding.
+TEST_F(GzipFilterTest, DictionaryWithStandardCoding) {
+  EXPECT_THROW_WITH_MESSAGE(
+      setUpFilter(
+          R"EOF({"codecs": [{"type": "DEFLATE", "dictionary": {"inline_string": "abc"}}]})EOF"),
+      EnvoyException,
+      "gzip filter: a codec with a dictionary can't use the standard 'deflate' content-coding, "
+      "set a content_coding of its own");
+}
+
+// Verifies that the gzip coding rejects dictionaries.
+TEST_F(GzipFilterTest, GzipWithDictionary) {
+  EXPECT_THROW_WITH_MESSAGE(
+      setUpFilter(
+          R"EOF({"codecs": [{"type": "GZIP", "dictionary": {"inline_string": "abc"}}]})EOF"),
+      EnvoyException, "gzip filter: the gzip content-coding does not support dictionaries");
+}
+
+// Verifies that the compressor of a response is reset and reused by the next response with the same
+// compressor parameters.
+TEST_F(GzipFilterTest, CompressorReuse) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  doResponseCompression({{":method", "get"}, {"content-length", "256"}});
+  doNextResponseCompression();
+  doNextResponseCompression();
+  EXPECT_EQ(1, stats_.counter("test.gzip.gzip.compressor_created").value());
+  EXPECT_EQ(2, stats_.counter("test.gzip.gzip.compressor_reused").value());
+}
+
+// Verifies that the compressor of a response that did not finish is reset before it is reused.
+TEST_F(GzipFilterTest, CompressorReuseAfterUnfinishedResponse) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+  feedBuffer(128);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, false));
+  drainBuffer();
+  doNextResponseCompression();
+  EXPECT_EQ(1, stats_.counter("test.gzip.gzip.compressor_reused").value());
+}
+
+// Verifies that compressors are not reused when the pool is disabled.
+TEST_F(GzipFilterTest, CompressorPoolDisabled) {
+  setUpFilter(R"EOF({"compressor_pool_size": 0})EOF");
+  doNextResponseCompression();
+  doNextResponseCompression();
+  EXPECT_EQ(2, stats_.counter("test.gzip.gzip.compressor_created").value());
+  EXPECT_EQ(0, stats_.counter("test.gzip.gzip.compressor_reused").value());
+}
+
+// Verifies that routes can override the window size and memory level, and that compressors with
+// different parameters are not shared.
+TEST_F(GzipFilterTest, RouteCompressorParameters) {
+  routeConfig(R"EOF({"window_bits": 15, "memory_level": 9})EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  doResponseCompression({{":method", "get"}, {"content-length", "256"}});
+  doNextResponseCompression();
+  EXPECT_EQ(1, stats_.counter("test.gzip.gzip.compressor_reused").value());
+
+  ON_CALL(decoder_callbacks_.route_->route_entry_,
+          perFilterConfig(HttpFilterNames::get().EnvoyGzip))
+      .WillByDefault(Return(nullptr));
+  doNextResponseCompression();
+  EXPECT_EQ(2, stats_.counter("test.gzip.gzip.compressor_created").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.gzip.compressor_reused").value());
+}
+
+// Verifies that routes can disable compression.
+TEST_F(GzipFilterTest, RouteDisabled) {
+  routeConfig(R"EOF({"disabled": true})EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}});
+}
+
+// Verifies that a response without content-length whose whole body is in a short first data frame
+// is not compressed, and that its headers are held until then.
+TEST_F(GzipFilterTest, LengthFromFirstDataFrameTooSmall) {
+  setUpFilter(R"EOF({"length_from_first_data_frame": true})EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->encodeHeaders(headers, false));
+  feedBuffer(10);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+  EXPECT_EQ("", headers.get_("content-encoding"));
+  EXPECT_EQ(expected_str_, data_.toString());
+  EXPECT_EQ(1, stats_.counter("test.gzip.not_compressed").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.content_length_too_small").value());
+}
+
+// Verifies that a response without content-length nor chunked transfer-encoding is compressed when
+// its body does not fit in its first data frame.
+TEST_F(GzipFilterTest, LengthFromFirstDataFrameCompression) {
+  setUpFilter(R"EOF({"length_from_first_data_frame": true})EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->encodeHeaders(headers, false));
+  feedBuffer(10);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, false));
+  EXPECT_EQ(Http::Headers::get().ContentEncodingValues.Gzip, headers.get_("content-encoding"));
+  Buffer::OwnedImpl compressed(data_);
+  drainBuffer();
+  feedBuffer(10);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+  compressed.add(data_);
+  decompressor_.decompress(compressed, decompressed_data_);
+  EXPECT_EQ(expected_str_, decompressed_data_.toString());
+  EXPECT_EQ(1, stats_.counter("test.gzip.compressed").value());
+}
+
+// Verifies that held headers are released without compression when the response has no body.
+TEST_F(GzipFilterTest, LengthFromFirstDataFrameTrailersOnly) {
+  setUpFilter(R"EOF({"length_from_first_data_frame": true})EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->encodeHeaders(headers, false));
+  Http::TestHeaderMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+  EXPECT_EQ("", headers.get_("content-encoding"));
+  EXPECT_EQ(1, stats_.counter("test.gzip.not_compressed").value());
+}
+
 } // namespace Gzip
 } // namespace HttpFilters
 } // namespace Extensions
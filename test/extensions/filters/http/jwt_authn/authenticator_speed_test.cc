@@ -0,0 +1,79 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <string>
+
+#include "common/common/assert.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/jwt_authn/authenticator.h"
+#include "extensions/filters/http/jwt_authn/filter_config.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+#include "test/mocks/server/mocks.h"
+
+#include "benchmark/benchmark.h"
+
+using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
+using ::google::jwt_verify::Status;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+class AuthenticatorSpeedTest {
+public:
+  AuthenticatorSpeedTest(bool jwt_cache) {
+    JwtAuthentication proto_config;
+    MessageUtil::loadFromYaml(ExampleConfig, proto_config);
+    // Use local keys, so that every request is verified without fetching them.
+    auto& provider = (*proto_config.mutable_providers())[std::string(ProviderName)];
+    provider.clear_remote_jwks();
+    provider.mutable_local_jwks()->set_inline_string(PublicKey);
+    if (jwt_cache) {
+      proto_config.mutable_jwt_cache_config();
+    }
+    filter_config_ = std::make_shared<FilterConfig>(proto_config, "", factory_context_);
+  }
+
+  // Authenticates a request with the same good token.
+  void verify() {
+    Http::HeaderMapImpl headers;
+    headers.addCopy(Http::LowerCaseString("authorization"), "Bearer " + std::string(GoodToken));
+    auto auth = filter_config_->create(nullptr, absl::make_optional<std::string>(ProviderName),
+                                       false);
+    auth->verify(headers, filter_config_->getExtractor().extract(headers), nullptr,
+                 [](const Status& status) { RELEASE_ASSERT(status == Status::Ok, ""); });
+  }
+
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context_;
+  FilterConfigSharedPtr filter_config_;
+};
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
+
+// Compares the verification of the signature of a token with a hit in the JWT cache.
+static void BM_VerifyJwt(benchmark::State& state) {
+  Envoy::Extensions::HttpFilters::JwtAuthn::AuthenticatorSpeedTest context(state.range(0) != 0);
+
+  for (auto _ : state) {
+    context.verify();
+  }
+}
+BENCHMARK(BM_VerifyJwt)->Arg(0)->Arg(1);
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -9,8 +9,11 @@
 #include "test/extensions/filters/http/jwt_authn/mock.h"
 #include "test/extensions/filters/http/jwt_authn/test_common.h"
 #include "test/mocks/server/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_replace.h"
+
 #include "gtest/gtest.h"
 
 using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
@@ -44,7 +47,8 @@ public:
     fetcher_.reset(raw_fetcher_);
     auth_ = Authenticator::create(
         check_audience, provider, !provider, filter_config_->getCache().getJwksCache(),
-        filter_config_->cm(), [this](Upstream::ClusterManager&) { return std::move(fetcher_); },
+        filter_config_->getCache().getJwtCache(), filter_config_->cm(),
+        [this](Upstream::ClusterManager&) { return std::move(fetcher_); },
         filter_config_->timeSource());
     jwks_ = Jwks::createFrom(PublicKey, Jwks::JWKS);
     EXPECT_TRUE(jwks_->getStatus() == Status::Ok);
@@ -62,6 +66,8 @@ public:
     auth_->verify(headers, std::move(tokens), std::move(set_payload_cb), std::move(on_complete_cb));
   }
 
+  // Declared first, so that the time source of the factory context is simulated.
+  Event::SimulatedTimeSystem time_system_;
   JwtAuthentication proto_config_;
   FilterConfigSharedPtr filter_config_;
   MockJwksFetcher* raw_fetcher_;
@@ -398,6 +404,105 @@ TEST_F(AuthenticatorTest, TestCustomCheckAudience) {
   expectVerifyStatus(Status::JwtAudienceNotAllowed, headers);
 }
 
+// This test verifies that verified JWTs are cached, and that the claims of a cached JWT are still
+// checked.
+TEST_F(AuthenticatorTest, TestJwtCache) {
+  proto_config_.mutable_jwt_cache_config();
+  CreateAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _))
+      .WillOnce(Invoke(
+          [this](const ::envoy::api::v2::core::HttpUri&, JwksFetcher::JwksReceiver& receiver) {
+            receiver.onJwksSuccess(std::move(jwks_));
+          }));
+
+  for (int i = 0; i < 10; i++) {
+    auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    expectVerifyStatus(Status::Ok, headers);
+
+    // The payload of a cached JWT is forwarded too.
+    EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+    EXPECT_FALSE(headers.Authorization());
+  }
+  EXPECT_EQ(1U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_miss").value());
+  EXPECT_EQ(9U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_hit").value());
+
+  // Failed verifications are not cached.
+  auto headers =
+      Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+  expectVerifyStatus(Status::JwtVerificationFail, headers);
+  expectVerifyStatus(Status::JwtVerificationFail, headers);
+  EXPECT_EQ(3U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_miss").value());
+
+  // The audiences of a cached JWT are checked for each authenticator.
+  auto check_audience = std::make_unique<::google::jwt_verify::CheckAudience>(
+      std::vector<std::string>{"other_service"});
+  auth_ = Authenticator::create(
+      check_audience.get(), absl::make_optional<std::string>(ProviderName), false,
+      filter_config_->getCache().getJwksCache(), filter_config_->getCache().getJwtCache(),
+      filter_config_->cm(), [this](Upstream::ClusterManager&) { return std::move(fetcher_); },
+      filter_config_->timeSource());
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::JwtAudienceNotAllowed, headers);
+}
+
+// This test verifies that a cached JWT is verified again once the keys that verified it are
+// replaced.
+TEST_F(AuthenticatorTest, TestJwtCacheKeyRotation) {
+  proto_config_.mutable_jwt_cache_config();
+  CreateAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _))
+      .WillOnce(Invoke(
+          [this](const ::envoy::api::v2::core::HttpUri&, JwksFetcher::JwksReceiver& receiver) {
+            receiver.onJwksSuccess(std::move(jwks_));
+          }));
+
+  auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  EXPECT_EQ(1U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_hit").value());
+
+  // The keys are rotated in place, and none of the new ones signed the token.
+  const std::string rotated_keys =
+      absl::StrReplaceAll(PublicKey, {{"62a93512c9ee4c7f8067b5a216dade2763d32a47", "rotated-1"},
+                                      {"b3319a147514df7ee5e4bcdee51350cc890cc89e", "rotated-2"}});
+  filter_config_->getCache().getJwksCache().findByProvider(ProviderName)->setRemoteJwks(
+      Jwks::createFrom(rotated_keys, Jwks::JWKS));
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::JwtVerificationFail, headers);
+  EXPECT_EQ(1U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_hit").value());
+  EXPECT_EQ(2U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_miss").value());
+}
+
+// This test verifies that the remote keys are fetched again once they expire, even for a cached
+// JWT, which is then verified with the new keys.
+TEST_F(AuthenticatorTest, TestJwtCacheKeyExpiration) {
+  proto_config_.mutable_jwt_cache_config();
+  (*proto_config_.mutable_providers())[std::string(ProviderName)]
+      .mutable_remote_jwks()
+      ->mutable_cache_duration()
+      ->set_seconds(60);
+  CreateAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([](const ::envoy::api::v2::core::HttpUri&, JwksFetcher::JwksReceiver& receiver) {
+            receiver.onJwksSuccess(Jwks::createFrom(PublicKey, Jwks::JWKS));
+          }));
+
+  auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  EXPECT_EQ(1U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_hit").value());
+
+  time_system_.sleep(std::chrono::seconds(61));
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  EXPECT_EQ(1U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_hit").value());
+  EXPECT_EQ(2U, mock_factory_ctx_.scope_.counter("jwt_authn.jwt_cache_miss").value());
+}
+
 // This test verifies that when invalid JWKS is fetched, an JWKS error status is returned.
 TEST_F(AuthenticatorTest, TestInvalidPubkeyKey) {
   EXPECT_CALL(*raw_fetcher_, fetch(_, _))
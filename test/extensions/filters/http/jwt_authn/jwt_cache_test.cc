@@ -0,0 +1,100 @@
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/jwt_authn/jwks_cache.h"
+#include "extensions/filters/http/jwt_authn/jwt_cache.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
+using ::google::jwt_verify::Jwt;
+using ::google::jwt_verify::Status;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+// The "exp" claim of GoodToken and OtherGoodToken.
+const uint64_t TokenExpiration = 2001001001;
+
+class JwtCacheTest : public testing::Test {
+protected:
+  JwtCacheTest() : api_(Api::createApiForTest()) {}
+  void SetUp() override {
+    MessageUtil::loadFromYaml(ExampleConfig, config_);
+    jwks_cache_ = JwksCache::create(config_, time_system_, *api_);
+    jwks_data_ = jwks_cache_->findByProvider(ProviderName);
+  }
+
+  void createCache(uint32_t size) {
+    config_.mutable_jwt_cache_config()->mutable_jwt_cache_size()->set_value(size);
+    cache_ = JwtCache::create(config_, stats_);
+  }
+
+  void insert(const std::string& token) {
+    auto jwt = std::make_unique<Jwt>();
+    ASSERT_EQ(Status::Ok, jwt->parseFromString(token));
+    cache_->insert(token, std::move(jwt), *jwks_data_);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  JwtAuthentication config_;
+  JwksCachePtr jwks_cache_;
+  JwksCache::JwksData* jwks_data_{};
+  Stats::IsolatedStoreImpl store_;
+  JwtCacheStats stats_{JwtCache::generateStats("", store_)};
+  JwtCachePtr cache_;
+};
+
+TEST_F(JwtCacheTest, NotConfigured) { EXPECT_EQ(nullptr, JwtCache::create(config_, stats_)); }
+
+TEST_F(JwtCacheTest, Lookup) {
+  createCache(10);
+  EXPECT_EQ(nullptr, cache_->lookup(GoodToken, 0));
+  insert(GoodToken);
+
+  const auto* entry = cache_->lookup(GoodToken, 0);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ("https://example.com", entry->jwt_->iss_);
+  EXPECT_EQ(jwks_data_, entry->jwks_data_);
+  EXPECT_EQ(jwks_data_->getJwksGeneration(), entry->jwks_generation_);
+  EXPECT_EQ(nullptr, cache_->lookup(OtherGoodToken, 0));
+}
+
+// Expired JWTs are removed from the cache.
+TEST_F(JwtCacheTest, Expiration) {
+  createCache(10);
+  insert(GoodToken);
+  EXPECT_NE(nullptr, cache_->lookup(GoodToken, TokenExpiration));
+  EXPECT_EQ(nullptr, cache_->lookup(GoodToken, TokenExpiration + 1));
+  EXPECT_EQ(0U, cache_->size());
+}
+
+TEST_F(JwtCacheTest, LeastRecentlyUsedJwtsAreEvicted) {
+  createCache(2);
+  insert(GoodToken);
+  insert(OtherGoodToken);
+  EXPECT_NE(nullptr, cache_->lookup(GoodToken, 0));
+
+  insert(InvalidAudToken);
+  EXPECT_EQ(2U, cache_->size());
+  EXPECT_NE(nullptr, cache_->lookup(GoodToken, 0));
+  EXPECT_EQ(nullptr, cache_->lookup(OtherGoodToken, 0));
+  EXPECT_NE(nullptr, cache_->lookup(InvalidAudToken, 0));
+
+  // Inserting a cached token again does not evict another one.
+  insert(GoodToken);
+  EXPECT_EQ(2U, cache_->size());
+  EXPECT_NE(nullptr, cache_->lookup(InvalidAudToken, 0));
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,170 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/local_ratelimit/local_ratelimit.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/router/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+using testing::SetArgReferee;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace LocalRateLimitFilter {
+namespace {
+
+class LocalRateLimitFilterTest : public testing::Test {
+protected:
+  void setUp(const std::string& yaml) {
+    envoy::config::filter::http::local_rate_limit::v2alpha::LocalRateLimit proto_config;
+    MessageUtil::loadFromYamlAndValidate(yaml, proto_config);
+    config_ = std::make_shared<FilterConfig>(proto_config, local_info_, "test.", stats_,
+                                             time_system_);
+    filter_ = std::make_unique<Filter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    decoder_callbacks_.route_->route_entry_.rate_limit_policy_.rate_limit_policy_entry_.clear();
+    decoder_callbacks_.route_->route_entry_.rate_limit_policy_.rate_limit_policy_entry_
+        .emplace_back(route_rate_limit_);
+  }
+
+  // Makes the route rate limit action generate a descriptor with a single entry.
+  void setRequestDescriptor(const std::string& key, const std::string& value) {
+    ON_CALL(route_rate_limit_, populateDescriptors(_, _, _, _, _))
+        .WillByDefault(SetArgReferee<1>(std::vector<RateLimit::Descriptor>{{{{key, value}}}}));
+  }
+
+  Http::FilterHeadersStatus request() { return filter_->decodeHeaders(request_headers_, true); }
+
+  void expectRateLimited() {
+    Http::TestHeaderMapImpl response_headers{
+        {":status", "429"},
+        {"x-envoy-ratelimited", Http::Headers::get().EnvoyRateLimitedValues.True}};
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderMapEqualRef(&response_headers), true));
+    EXPECT_CALL(decoder_callbacks_.stream_info_,
+                setResponseFlag(StreamInfo::ResponseFlag::RateLimited));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, request());
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_.counter("test.local_rate_limit.limited." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Router::MockRateLimitPolicyEntry> route_rate_limit_;
+  FilterConfigSharedPtr config_;
+  std::unique_ptr<Filter> filter_;
+  Http::TestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/"}};
+};
+
+TEST_F(LocalRateLimitFilterTest, FilterTokenBucket) {
+  setUp(R"EOF(
+stat_prefix: limited
+token_bucket:
+  max_tokens: 2
+  fill_interval: 1s
+)EOF");
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  expectRateLimited();
+  EXPECT_EQ(2U, counter("ok"));
+  EXPECT_EQ(1U, counter("rate_limited"));
+
+  time_system_.sleep(std::chrono::seconds(1));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  expectRateLimited();
+}
+
+TEST_F(LocalRateLimitFilterTest, DescriptorTokenBuckets) {
+  setUp(R"EOF(
+stat_prefix: limited
+descriptors:
+- entries:
+  - key: generic_key
+    value: slow_path
+  token_bucket:
+    max_tokens: 1
+    tokens_per_fill: 10
+    fill_interval: 1s
+)EOF");
+
+  setRequestDescriptor("generic_key", "slow_path");
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  expectRateLimited();
+
+  // Descriptors without a token bucket are not limited.
+  setRequestDescriptor("generic_key", "fast_path");
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  }
+
+  // The bucket is refilled at 10 tokens per second.
+  setRequestDescriptor("generic_key", "slow_path");
+  time_system_.sleep(std::chrono::milliseconds(100));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  EXPECT_EQ(5U, counter("ok"));
+  EXPECT_EQ(1U, counter("rate_limited"));
+}
+
+TEST_F(LocalRateLimitFilterTest, NoRoute) {
+  setUp(R"EOF(
+stat_prefix: limited
+descriptors:
+- entries:
+  - key: generic_key
+    value: slow_path
+  token_bucket:
+    max_tokens: 1
+    fill_interval: 1s
+)EOF");
+
+  setRequestDescriptor("generic_key", "slow_path");
+  EXPECT_CALL(*decoder_callbacks_.route_, routeEntry()).WillRepeatedly(Return(nullptr));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request());
+}
+
+TEST_F(LocalRateLimitFilterTest, DuplicateDescriptor) {
+  EXPECT_THROW_WITH_MESSAGE(setUp(R"EOF(
+stat_prefix: limited
+descriptors:
+- entries:
+  - key: generic_key
+    value: slow_path
+  token_bucket:
+    max_tokens: 1
+    fill_interval: 1s
+- entries:
+  - key: generic_key
+    value: slow_path
+  token_bucket:
+    max_tokens: 2
+    fill_interval: 1s
+)EOF"),
+                            EnvoyException, "local rate limit: duplicate descriptor");
+}
+
+} // namespace
+} // namespace LocalRateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
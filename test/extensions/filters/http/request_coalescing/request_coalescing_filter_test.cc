@@ -0,0 +1,348 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/request_coalescing/request_coalescing_filter.h"
+#include "extensions/filters/http/well_known_names.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+class RequestCoalescingFilterTest : public testing::Test {
+protected:
+  RequestCoalescingFilterTest() { setUpConfig(""); }
+
+  void setUpConfig(const std::string& yaml) {
+    envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing proto_config;
+    if (!yaml.empty()) {
+      MessageUtil::loadFromYaml(yaml, proto_config);
+    }
+    config_ = std::make_shared<RequestCoalescingConfig>(proto_config, "test.", stats_, tls_);
+  }
+
+  static const RequestCoalescingRouteConfig* routeConfig(bool enabled) {
+    static const RequestCoalescingRouteConfig* configs[] = {newRouteConfig(false),
+                                                            newRouteConfig(true)};
+    return configs[enabled];
+  }
+
+  static const RequestCoalescingRouteConfig* newRouteConfig(bool enabled) {
+    envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescingPerRoute
+        proto_config;
+    proto_config.set_enabled(enabled);
+    return new RequestCoalescingRouteConfig(proto_config);
+  }
+
+  struct Stream {
+    // By default, the stream is routed to a route that enables coalescing.
+    Stream(const RequestCoalescingConfigSharedPtr& config,
+           const Router::RouteSpecificFilterConfig* route_config = routeConfig(true))
+        : filter_(config) {
+      ON_CALL(decoder_callbacks_.route_->route_entry_,
+              perFilterConfig(HttpFilterNames::get().RequestCoalescing))
+          .WillByDefault(Return(route_config));
+      filter_.setDecoderFilterCallbacks(decoder_callbacks_);
+      filter_.setEncoderFilterCallbacks(encoder_callbacks_);
+    }
+    ~Stream() { filter_.onDestroy(); }
+
+    RequestCoalescingFilter filter_;
+    NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+    NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  };
+
+  Http::FilterHeadersStatus request(Stream& stream, Http::TestHeaderMapImpl&& headers) {
+    return stream.filter_.decodeHeaders(headers, true);
+  }
+
+  Http::FilterHeadersStatus request(Stream& stream) {
+    return request(stream, {{":method", "GET"}, {":authority", "host"}, {":path", "/"}});
+  }
+
+  // Sends a response through the filter of a stream that was sent upstream.
+  void respond(Stream& stream, Http::TestHeaderMapImpl&& headers, const std::string& body) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_.encodeHeaders(headers, body.empty()));
+    if (!body.empty()) {
+      Buffer::OwnedImpl data(body);
+      EXPECT_EQ(Http::FilterDataStatus::Continue, stream.filter_.encodeData(data, true));
+    }
+  }
+
+  // Expects the stream to be answered with a copy of a response.
+  void expectServed(Stream& stream, const std::string& status, const std::string& body) {
+    EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, body.empty()))
+        .WillOnce(Invoke([status](Http::HeaderMap& headers, bool) {
+          EXPECT_EQ(status, headers.Status()->value().getStringView());
+        }));
+    if (!body.empty()) {
+      EXPECT_CALL(stream.decoder_callbacks_, encodeData(_, true))
+          .WillOnce(Invoke([body](Buffer::Instance& data, bool) {
+            EXPECT_EQ(body, data.toString());
+          }));
+    }
+    EXPECT_CALL(stream.decoder_callbacks_, continueDecoding()).Times(0);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_.counter("test.request_coalescing." + name).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  RequestCoalescingConfigSharedPtr config_;
+};
+
+TEST_F(RequestCoalescingFilterTest, CoalesceIdenticalRequests) {
+  Stream leader(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(leader));
+
+  auto waiter1 = std::make_unique<Stream>(config_);
+  Stream waiter2(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, request(*waiter1));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, request(waiter2));
+  EXPECT_EQ(1, counter("upstream"));
+  EXPECT_EQ(2, counter("coalesced"));
+  // A waiter that is destroyed before the response is complete is not answered.
+  waiter1.reset();
+
+  expectServed(waiter2, "200", "body");
+  respond(leader, {{":status", "200"}}, "body");
+
+  // The flight ended, so the next request is sent upstream.
+  Stream next(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(next));
+  EXPECT_EQ(2, counter("upstream"));
+}
+
+TEST_F(RequestCoalescingFilterTest, ResponseWithTrailers) {
+  Stream leader(config_);
+  request(leader);
+  Stream waiter(config_);
+  request(waiter);
+
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeData(_, false));
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeTrailers_(_))
+      .WillOnce(Invoke([](Http::HeaderMap& trailers) {
+        EXPECT_EQ("0", trailers.get(Http::LowerCaseString("grpc-status"))->value().getStringView());
+      }));
+  Http::TestHeaderMapImpl headers{{":status", "200"}};
+  leader.filter_.encodeHeaders(headers, false);
+  Buffer::OwnedImpl data("body");
+  leader.filter_.encodeData(data, false);
+  Http::TestHeaderMapImpl trailers{{"grpc-status", "0"}};
+  leader.filter_.encodeTrailers(trailers);
+}
+
+TEST_F(RequestCoalescingFilterTest, DifferentRequestsAreNotCoalesced) {
+  setUpConfig("key_headers: [\"accept-language\"]");
+  Stream leader(config_);
+  request(leader, {{":method", "GET"},
+                   {":authority", "host"},
+                   {":path", "/"},
+                   {"accept-language", "en"}});
+
+  Stream other_path(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            request(other_path, {{":method", "GET"}, {":authority", "host"}, {":path", "/a"}}));
+  Stream other_method(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            request(other_method, {{":method", "HEAD"}, {":authority", "host"}, {":path", "/"}}));
+  Stream other_key_header(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            request(other_key_header, {{":method", "GET"},
+                                       {":authority", "host"},
+                                       {":path", "/"},
+                                       {"accept-language", "fr"}}));
+  Stream absent_key_header(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(absent_key_header));
+  Stream same(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            request(same, {{":method", "GET"},
+                           {":authority", "host"},
+                           {":path", "/"},
+                           {"accept-language", "en"}}));
+  EXPECT_EQ(5, counter("upstream"));
+}
+
+TEST_F(RequestCoalescingFilterTest, RequestsThatAreNotCoalesced) {
+  Stream leader(config_);
+  request(leader);
+
+  Stream post(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            request(post, {{":method", "POST"}, {":authority", "host"}, {":path", "/"}}));
+  Stream credentials(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            request(credentials, {{":method", "GET"},
+                                  {":authority", "host"},
+                                  {":path", "/"},
+                                  {"authorization", "Bearer token"}}));
+  Stream with_body(config_);
+  Http::TestHeaderMapImpl headers{{":method", "GET"}, {":authority", "host"}, {":path", "/"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, with_body.filter_.decodeHeaders(headers, false));
+  EXPECT_EQ(0, counter("coalesced"));
+}
+
+TEST_F(RequestCoalescingFilterTest, CredentialsInKey) {
+  setUpConfig("key_headers: [\"cookie\"]");
+  Stream leader(config_);
+  request(leader, {{":method", "GET"}, {":authority", "host"}, {":path", "/"}, {"cookie", "a=b"}});
+  Stream waiter(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            request(waiter, {{":method", "GET"},
+                             {":authority", "host"},
+                             {":path", "/"},
+                             {"cookie", "a=b"}}));
+}
+
+TEST_F(RequestCoalescingFilterTest, RouteNotEnabled) {
+  Stream leader(config_);
+  request(leader);
+  Stream no_route_config(config_, nullptr);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(no_route_config));
+  Stream disabled(config_, routeConfig(false));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(disabled));
+
+  // Requests of routes that don't enable coalescing don't lead flights either.
+  Stream leader_not_enabled(config_, nullptr);
+  request(leader_not_enabled,
+          {{":method", "GET"}, {":authority", "host"}, {":path", "/other"}});
+  Stream waiter(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            request(waiter, {{":method", "GET"}, {":authority", "host"}, {":path", "/other"}}));
+  EXPECT_EQ(2, counter("upstream"));
+  EXPECT_EQ(0, counter("coalesced"));
+}
+
+TEST_F(RequestCoalescingFilterTest, ResponsesThatAreNotShared) {
+  const std::vector<Http::TestHeaderMapImpl> responses{
+      {{":status", "200"}, {"set-cookie", "session=1"}},
+      {{":status", "200"}, {"cache-control", "max-age=60, Private"}},
+      {{":status", "200"}, {"cache-control", "private=\"set-cookie\""}},
+      {{":status", "200"}, {"cache-control", "no-store"}},
+      {{":status", "200"}, {"vary", "accept-encoding"}},
+      {{":status", "200"}, {"vary", "*"}},
+  };
+  for (const Http::TestHeaderMapImpl& response : responses) {
+    Stream leader(config_);
+    request(leader);
+    Stream waiter(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, request(waiter));
+
+    // The waiter sends its own request upstream, and gets its own response.
+    EXPECT_CALL(waiter.decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+    EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding());
+    respond(leader, Http::TestHeaderMapImpl(response), "body");
+  }
+  EXPECT_EQ(responses.size(), counter("not_shareable"));
+}
+
+TEST_F(RequestCoalescingFilterTest, VaryOnKeyHeaders) {
+  setUpConfig("key_headers: [\"accept-encoding\"]");
+  Stream leader(config_);
+  request(leader, {{":method", "GET"},
+                   {":authority", "host"},
+                   {":path", "/"},
+                   {"accept-encoding", "gzip"}});
+  Stream waiter(config_);
+  request(waiter, {{":method", "GET"},
+                   {":authority", "host"},
+                   {":path", "/"},
+                   {"accept-encoding", "gzip"}});
+
+  // The waiters don't have the credential headers that are not part of the key.
+  expectServed(waiter, "200", "body");
+  respond(leader, {{":status", "200"}, {"vary", "Accept-Encoding, authorization"}}, "body");
+  EXPECT_EQ(0, counter("not_shareable"));
+}
+
+TEST_F(RequestCoalescingFilterTest, AuthorizedResponses) {
+  setUpConfig("key_headers: [\"authorization\"]");
+  Http::TestHeaderMapImpl headers{{":method", "GET"},
+                                  {":authority", "host"},
+                                  {":path", "/"},
+                                  {"authorization", "Bearer token"}};
+  {
+    Stream leader(config_);
+    request(leader, Http::TestHeaderMapImpl(headers));
+    Stream waiter(config_);
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              request(waiter, Http::TestHeaderMapImpl(headers)));
+
+    EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding());
+    respond(leader, {{":status", "200"}, {"cache-control", "max-age=60"}}, "body");
+    EXPECT_EQ(1, counter("not_shareable"));
+  }
+
+  // A response that shared caches may store can be shared.
+  Stream leader(config_);
+  request(leader, Http::TestHeaderMapImpl(headers));
+  Stream waiter(config_);
+  request(waiter, Http::TestHeaderMapImpl(headers));
+  expectServed(waiter, "200", "body");
+  respond(leader, {{":status", "200"}, {"cache-control", "public, max-age=60"}}, "body");
+  EXPECT_EQ(1, counter("not_shareable"));
+}
+
+TEST_F(RequestCoalescingFilterTest, TooManyWaiters) {
+  setUpConfig("max_waiters: 1");
+  Stream leader(config_);
+  request(leader);
+  Stream waiter(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, request(waiter));
+  Stream overflow(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(overflow));
+  EXPECT_EQ(1, counter("too_many_waiters"));
+}
+
+TEST_F(RequestCoalescingFilterTest, BodyTooLarge) {
+  setUpConfig("max_body_bytes: 4");
+  Stream leader(config_);
+  request(leader);
+  Stream waiter(config_);
+  request(waiter);
+
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding());
+  respond(leader, {{":status", "200"}}, "large body");
+  EXPECT_EQ(1, counter("body_too_large"));
+}
+
+TEST_F(RequestCoalescingFilterTest, LeaderReset) {
+  auto leader = std::make_unique<Stream>(config_);
+  request(*leader);
+  Stream waiter(config_);
+  request(waiter);
+
+  EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding());
+  leader.reset();
+  EXPECT_EQ(1, counter("leader_reset"));
+
+  // The waiter that was resumed leads no flight, so an identical request is sent upstream.
+  Stream next(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, request(next));
+}
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -4,6 +4,7 @@
 #include "extensions/filters/network/ext_authz/config.h"
 
 #include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -49,6 +50,28 @@ TEST(ExtAuthzFilterConfigTest, ExtAuthzCorrectProto) {
   cb(connection);
 }
 
+TEST(ExtAuthzFilterConfigTest, DecisionCacheNeedsPeerIdentity) {
+  std::string yaml = R"EOF(
+  grpc_service:
+    google_grpc:
+      target_uri: ext_authz_server
+      stat_prefix: google
+  stat_prefix: name
+  decision_cache:
+    headers: [authorization]
+    ttl: 60s
+)EOF";
+
+  ExtAuthzConfigFactory factory;
+  ProtobufTypes::MessagePtr proto_config = factory.createEmptyConfigProto();
+  MessageUtil::loadFromYaml(yaml, *proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_THROW_WITH_MESSAGE(
+      factory.createFilterFactoryFromProto(*proto_config, context), EnvoyException,
+      "ext_authz decision cache: the key needs source_principal or source_address");
+}
+
 } // namespace ExtAuthz
 } // namespace NetworkFilters
 } // namespace Extensions
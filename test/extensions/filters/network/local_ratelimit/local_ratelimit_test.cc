@@ -0,0 +1,79 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/network/local_ratelimit/local_ratelimit.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace LocalRateLimitFilter {
+namespace {
+
+class LocalRateLimitTestBase : public testing::Test {
+public:
+  LocalRateLimitTestBase() {
+    envoy::config::filter::network::local_rate_limit::v2alpha::LocalRateLimit proto_config;
+    MessageUtil::loadFromYamlAndValidate(R"EOF(
+stat_prefix: local_rate_limit_stats
+token_bucket:
+  max_tokens: 1
+  fill_interval: 0.2s
+)EOF",
+                                         proto_config);
+    config_ = std::make_shared<Config>(proto_config, stats_, time_system_);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_;
+  ConfigSharedPtr config_;
+};
+
+class LocalRateLimitFilterTest : public LocalRateLimitTestBase {
+public:
+  struct ActiveFilter {
+    ActiveFilter(const ConfigSharedPtr& config) : filter_(config) {
+      filter_.initializeReadFilterCallbacks(read_filter_callbacks_);
+    }
+
+    NiceMock<Network::MockReadFilterCallbacks> read_filter_callbacks_;
+    Filter filter_;
+  };
+};
+
+TEST_F(LocalRateLimitFilterTest, Denied) {
+  ActiveFilter active_filter1(config_);
+  EXPECT_EQ(Network::FilterStatus::Continue, active_filter1.filter_.onNewConnection());
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Network::FilterStatus::Continue, active_filter1.filter_.onData(data, false));
+
+  ActiveFilter active_filter2(config_);
+  EXPECT_CALL(active_filter2.read_filter_callbacks_.connection_,
+              close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_EQ(Network::FilterStatus::StopIteration, active_filter2.filter_.onNewConnection());
+  EXPECT_EQ(1, stats_.counter("local_rate_limit.local_rate_limit_stats.rate_limited").value());
+
+  // The bucket refills a token every 200ms.
+  time_system_.sleep(std::chrono::milliseconds(200));
+  ActiveFilter active_filter3(config_);
+  EXPECT_EQ(Network::FilterStatus::Continue, active_filter3.filter_.onNewConnection());
+}
+
+} // namespace
+} // namespace LocalRateLimitFilter
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
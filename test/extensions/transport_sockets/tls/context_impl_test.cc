@@ -337,6 +337,50 @@ TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
                           "at most one certificate of a given type may be specified");
 }
 
+// Server contexts with the same configuration, server names and scope are shared.
+TEST_F(SslContextImplTest, SharedServerContexts) {
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+  )EOF";
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl config1(tls_context, factory_context_);
+  ServerContextConfigImpl config2(tls_context, factory_context_);
+  tls_context.mutable_common_tls_context()->set_alpn_protocols("h2");
+  ServerContextConfigImpl config3(tls_context, factory_context_);
+  Stats::IsolatedStoreImpl store2;
+
+  Envoy::Ssl::ServerContextSharedPtr context1 =
+      manager_.createSslServerContext(store_, config1, {"www.example.com"});
+  Envoy::Ssl::ServerContextSharedPtr context2 =
+      manager_.createSslServerContext(store_, config2, {"www.example.com"});
+  EXPECT_EQ(context1, context2);
+  EXPECT_NE(context1, manager_.createSslServerContext(store_, config2, {"api.example.com"}));
+  EXPECT_NE(context1, manager_.createSslServerContext(store2, config2, {"www.example.com"}));
+  EXPECT_NE(context1, manager_.createSslServerContext(store_, config3, {"www.example.com"}));
+
+  size_t contexts = 0;
+  manager_.iterateContexts([&contexts](const Envoy::Ssl::Context&) { contexts++; });
+  EXPECT_EQ(1, contexts);
+
+  EXPECT_NE(ContextManagerImpl::serverContextKey(store_, config1, {}),
+            ContextManagerImpl::serverContextKey(store_, config3, {}));
+  EXPECT_EQ(ContextManagerImpl::serverContextKey(store_, config1, {}),
+            ContextManagerImpl::serverContextKey(store_, config2, {}));
+
+  // Every field of the configuration is part of the key.
+  tls_context.mutable_common_tls_context()->clear_alpn_protocols();
+  tls_context.mutable_require_sni()->set_value(true);
+  ServerContextConfigImpl config4(tls_context, factory_context_);
+  EXPECT_NE(ContextManagerImpl::serverContextKey(store_, config1, {}),
+            ContextManagerImpl::serverContextKey(store_, config4, {}));
+}
+
 class SslServerContextImplTicketTest : public SslContextImplTest {
 public:
   void loadConfig(ServerContextConfigImpl& cfg) {
@@ -461,6 +505,32 @@ TEST_F(SslServerContextImplTicketTest, TicketKeySdsFail) {
   EXPECT_THROW_WITH_MESSAGE(loadConfigV2(cfg), EnvoyException, "SDS not supported yet");
 }
 
+TEST_F(SslServerContextImplTicketTest, TicketKeyRotationSuccess) {
+  const std::string yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  session_ticket_key_rotation:
+    seed:
+      filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a"
+    rotation_interval: 60s
+    accepted_previous_keys: 0
+)EOF";
+  EXPECT_NO_THROW(loadConfigYaml(yaml));
+}
+
+TEST_F(SslServerContextImplTicketTest, TicketKeyRotationSeedTooShort) {
+  envoy::api::v2::auth::DownstreamTlsContext cfg;
+  cfg.mutable_session_ticket_key_rotation()->mutable_seed()->set_inline_string(
+      std::string(31, 'a'));
+  EXPECT_THROW_WITH_MESSAGE(
+      loadConfigV2(cfg), EnvoyException,
+      "TLS session ticket key seed is too short. Length 31, expected at least 32.");
+}
+
 TEST_F(SslServerContextImplTicketTest, CRLSuccess) {
   const std::string yaml = R"EOF(
   common_tls_context:
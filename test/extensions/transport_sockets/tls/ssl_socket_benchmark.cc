@@ -0,0 +1,154 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <utility>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/transport_sockets/tls/context_config_impl.h"
+#include "extensions/transport_sockets/tls/context_manager_impl.h"
+#include "extensions/transport_sockets/tls/ssl_socket.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "openssl/pem.h"
+#include "openssl/x509.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+// Returns a PEM encoded self-signed ECDSA certificate and its private key, so the benchmark does
+// not depend on test data files.
+std::pair<std::string, std::string> generateSelfSignedCertificate() {
+  bssl::UniquePtr<EC_KEY> ec_key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  RELEASE_ASSERT(ec_key != nullptr && EC_KEY_generate_key(ec_key.get()), "");
+  bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+  RELEASE_ASSERT(EVP_PKEY_assign_EC_KEY(key.get(), ec_key.release()), "");
+
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_get_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_get_notAfter(cert.get()), 24 * 60 * 60);
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const uint8_t*>("benchmark"), -1, -1, 0);
+  X509_set_issuer_name(cert.get(), name);
+  X509_set_pubkey(cert.get(), key.get());
+  RELEASE_ASSERT(X509_sign(cert.get(), key.get(), EVP_sha256()), "");
+
+  auto to_string = [](BIO* bio) {
+    const uint8_t* data;
+    size_t length;
+    RELEASE_ASSERT(BIO_mem_contents(bio, &data, &length), "");
+    return std::string(reinterpret_cast<const char*>(data), length);
+  };
+  bssl::UniquePtr<BIO> cert_bio(BIO_new(BIO_s_mem()));
+  bssl::UniquePtr<BIO> key_bio(BIO_new(BIO_s_mem()));
+  RELEASE_ASSERT(PEM_write_bio_X509(cert_bio.get(), cert.get()), "");
+  RELEASE_ASSERT(
+      PEM_write_bio_PrivateKey(key_bio.get(), key.get(), nullptr, nullptr, 0, nullptr, nullptr),
+      "");
+  return {to_string(cert_bio.get()), to_string(key_bio.get())};
+}
+
+// Encrypts 1MiB per iteration, built from slices of range(0) bytes, from a client SslSocket to a
+// server SslSocket over a socket pair.
+static void BM_SslSocketWrite(benchmark::State& state) {
+  const uint64_t slice_size = state.range(0);
+  constexpr uint64_t total_size = 1024 * 1024;
+
+  Event::SimulatedTimeSystem time_system;
+  Stats::IsolatedStoreImpl stats_store;
+  Api::ApiPtr api = Api::createApiForTest(stats_store, time_system);
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+
+  const auto certificate = generateSelfSignedCertificate();
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  auto* tls_certificate = server_tls_context.mutable_common_tls_context()->add_tls_certificates();
+  tls_certificate->mutable_certificate_chain()->set_inline_string(certificate.first);
+  tls_certificate->mutable_private_key()->set_inline_string(certificate.second);
+  ServerContextConfigImpl server_cfg(server_tls_context, factory_context);
+  ClientContextConfigImpl client_cfg(envoy::api::v2::auth::UpstreamTlsContext(), factory_context);
+
+  ContextManagerImpl manager(time_system);
+  SslSocket server(manager.createSslServerContext(stats_store, server_cfg, {}),
+                   InitialState::Server, nullptr);
+  SslSocket client(manager.createSslClientContext(stats_store, client_cfg), InitialState::Client,
+                   nullptr);
+
+  int fds[2];
+  RELEASE_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "");
+  for (int fd : fds) {
+    RELEASE_ASSERT(fcntl(fd, F_SETFL, O_NONBLOCK) == 0, "");
+  }
+  Network::IoSocketHandleImpl server_handle(fds[0]);
+  Network::IoSocketHandleImpl client_handle(fds[1]);
+  NiceMock<Network::MockTransportSocketCallbacks> server_callbacks;
+  NiceMock<Network::MockTransportSocketCallbacks> client_callbacks;
+  ON_CALL(server_callbacks, ioHandle()).WillByDefault(ReturnRef(server_handle));
+  ON_CALL(client_callbacks, ioHandle()).WillByDefault(ReturnRef(client_handle));
+  server.setTransportSocketCallbacks(server_callbacks);
+  client.setTransportSocketCallbacks(client_callbacks);
+
+  const std::string slice_data(slice_size, 'a');
+  Buffer::OwnedImpl write_buffer;
+  Buffer::OwnedImpl read_buffer;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (uint64_t size = 0; size < total_size; size += slice_size) {
+      Buffer::OwnedImpl slice(slice_data);
+      write_buffer.move(slice);
+    }
+    const uint64_t expected = write_buffer.length();
+    state.ResumeTiming();
+
+    while (read_buffer.length() < expected) {
+      RELEASE_ASSERT(client.doWrite(write_buffer, false).action_ ==
+                         Network::PostIoAction::KeepOpen,
+                     "");
+      RELEASE_ASSERT(server.doRead(read_buffer).action_ == Network::PostIoAction::KeepOpen, "");
+    }
+    read_buffer.drain(read_buffer.length());
+  }
+
+  state.SetBytesProcessed(state.iterations() * total_size);
+}
+BENCHMARK(BM_SslSocketWrite)
+    ->Arg(128)
+    ->Arg(1024)
+    ->Arg(4096)
+    ->Arg(16384)
+    ->Arg(20000)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
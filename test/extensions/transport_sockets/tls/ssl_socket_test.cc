@@ -1,6 +1,11 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/network/transport_socket.h"
 
@@ -9,6 +14,7 @@
 #include "common/event/dispatcher_impl.h"
 #include "common/json/json_loader.h"
 #include "common/network/address_impl.h"
+#include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/transport_socket_options_impl.h"
 #include "common/network/utility.h"
@@ -690,6 +696,10 @@ protected:
   void testClientSessionResumption(const std::string& server_ctx_yaml,
                                    const std::string& client_ctx_yaml, bool expect_reuse,
                                    const Network::Address::IpVersion version);
+  void testKernelTlsOffload(const std::string& server_ctx_yaml, const std::string& client_ctx_yaml,
+                            bool expect_unavailable);
+  void testPrivateKeyProvider(const std::string& server_ctx_yaml,
+                              const std::string& client_ctx_yaml, bool expect_overflow);
 
   Event::DispatcherPtr dispatcher_;
 };
@@ -2179,6 +2189,350 @@ TEST_P(SslSocketTest, HalfClose) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Exchanges data in both directions, half closing each side, with kernel TLS offload enabled on
+// both ends. Whether the kernel actually takes over depends on the host, so unless offload is
+// known to be unavailable only the sum of the offload counters is checked.
+void SslSocketTest::testKernelTlsOffload(const std::string& server_ctx_yaml,
+                                         const std::string& client_ctx_yaml,
+                                         bool expect_unavailable) {
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  EXPECT_TRUE(server_cfg->kernelTlsOffload());
+  ContextManagerImpl manager(time_system_);
+  Stats::IsolatedStoreImpl server_stats_store;
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener =
+      dispatcher_->createListener(socket, listener_callbacks, true, false);
+  std::shared_ptr<Network::MockReadFilter> server_read_filter(new Network::MockReadFilter());
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  envoy::api::v2::auth::UpstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), tls_context);
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(tls_context, factory_context_);
+  Stats::IsolatedStoreImpl client_stats_store;
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager,
+                                                   client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(nullptr), nullptr);
+  client_connection->enableHalfClose(true);
+  client_connection->addReadFilter(client_read_filter);
+  client_connection->connect();
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+
+  // Large enough to span several TLS records.
+  const std::string server_data(100000, 's');
+  std::string client_received;
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr));
+        listener_callbacks.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(listener_callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->enableHalfClose(true);
+        server_connection->addReadFilter(server_read_filter);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  EXPECT_CALL(*server_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        Buffer::OwnedImpl data(server_data);
+        server_connection->write(data, true);
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(*client_read_filter, onData(_, _))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool end_stream) -> Network::FilterStatus {
+        client_received.append(data.toString());
+        data.drain(data.length());
+        if (end_stream) {
+          EXPECT_EQ(server_data, client_received);
+          Buffer::OwnedImpl buffer("world");
+          client_connection->write(buffer, true);
+        }
+        return Network::FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(*server_read_filter, onData(BufferStringEqual("world"), true));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  for (Stats::IsolatedStoreImpl* store : {&server_stats_store, &client_stats_store}) {
+    const uint64_t offloaded = store->counter("ssl.kernel_tls_offload").value();
+    const uint64_t unavailable = store->counter("ssl.kernel_tls_offload_unavailable").value();
+    EXPECT_EQ(1UL, offloaded + unavailable);
+    if (expect_unavailable) {
+      EXPECT_EQ(1UL, unavailable);
+    }
+  }
+}
+
+TEST_P(SslSocketTest, KernelTlsOffload) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    kernel_tls_offload: true
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+      cipher_suites:
+      - ECDHE-RSA-AES128-GCM-SHA256
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      kernel_tls_offload: true
+  )EOF";
+
+  testKernelTlsOffload(server_ctx_yaml, client_ctx_yaml, false);
+}
+
+// Ciphers the kernel cannot handle keep using user space TLS.
+TEST_P(SslSocketTest, KernelTlsOffloadUnsupportedCipher) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    kernel_tls_offload: true
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+      cipher_suites:
+      - ECDHE-RSA-CHACHA20-POLY1305
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      kernel_tls_offload: true
+  )EOF";
+
+  testKernelTlsOffload(server_ctx_yaml, client_ctx_yaml, true);
+}
+
+// TLS 1.3 sessions keep using user space TLS.
+TEST_P(SslSocketTest, KernelTlsOffloadTls13) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    kernel_tls_offload: true
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_3
+      tls_maximum_protocol_version: TLSv1_3
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      kernel_tls_offload: true
+      tls_params:
+        tls_maximum_protocol_version: TLSv1_3
+  )EOF";
+
+  testKernelTlsOffload(server_ctx_yaml, client_ctx_yaml, true);
+}
+
+// Completes a handshake whose server side private key operations are performed by a thread pool
+// provider, then checks where the operation ran.
+void SslSocketTest::testPrivateKeyProvider(const std::string& server_ctx_yaml,
+                                           const std::string& client_ctx_yaml,
+                                           bool expect_overflow) {
+  Stats::IsolatedStoreImpl provider_stats_store;
+  ON_CALL(factory_context_, stats()).WillByDefault(ReturnRef(provider_stats_store));
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  EXPECT_NE(nullptr, server_cfg->privateKeyMethodProvider());
+  ContextManagerImpl manager(time_system_);
+  Stats::IsolatedStoreImpl server_stats_store;
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener =
+      dispatcher_->createListener(socket, listener_callbacks, true, false);
+
+  envoy::api::v2::auth::UpstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), tls_context);
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(tls_context, factory_context_);
+  Stats::IsolatedStoreImpl client_stats_store;
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager,
+                                                   client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(nullptr), nullptr);
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr));
+        listener_callbacks.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(listener_callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  size_t connect_count = 0;
+  auto connect_second_time = [&]() {
+    if (++connect_count == 2) {
+      server_connection->close(Network::ConnectionCloseType::NoFlush);
+      client_connection->close(Network::ConnectionCloseType::NoFlush);
+      dispatcher_->exit();
+    }
+  };
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { connect_second_time(); }));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { connect_second_time(); }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.handshake").value());
+  EXPECT_EQ(1UL, provider_stats_store.counter("ssl.private_key_thread_pool.operations").value());
+  EXPECT_EQ(expect_overflow ? 1UL : 0UL,
+            provider_stats_store.counter("ssl.private_key_thread_pool.overflow").value());
+  EXPECT_EQ(0UL, provider_stats_store.counter("ssl.private_key_thread_pool.failed").value());
+  EXPECT_EQ(0UL, provider_stats_store.gauge("ssl.private_key_thread_pool.pending").value());
+}
+
+TEST_P(SslSocketTest, PrivateKeyProviderThreadPool) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    private_key_provider:
+      thread_pool:
+        threads: 2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  testPrivateKeyProvider(server_ctx_yaml, client_ctx_yaml, false);
+}
+
+// RSA key exchange decrypts the premaster secret rather than signing.
+TEST_P(SslSocketTest, PrivateKeyProviderThreadPoolRsaKeyExchange) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    private_key_provider:
+      thread_pool:
+        threads: 2
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+      cipher_suites:
+      - AES128-GCM-SHA256
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      tls_params:
+        cipher_suites:
+        - AES128-GCM-SHA256
+  )EOF";
+
+  testPrivateKeyProvider(server_ctx_yaml, client_ctx_yaml, false);
+}
+
+// Operations that do not fit in the queue are performed synchronously.
+TEST_P(SslSocketTest, PrivateKeyProviderThreadPoolOverflow) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    private_key_provider:
+      thread_pool:
+        threads: 2
+        max_pending_operations: 0
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  testPrivateKeyProvider(server_ctx_yaml, client_ctx_yaml, true);
+}
+
+// Contexts with the same thread pool configuration share a single provider.
+TEST_P(SslSocketTest, PrivateKeyProviderThreadPoolShared) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    private_key_provider:
+      thread_pool:
+        threads: 2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), tls_context);
+  ServerContextConfigImpl config1(tls_context, factory_context_);
+  ServerContextConfigImpl config2(tls_context, factory_context_);
+  EXPECT_NE(nullptr, config1.privateKeyMethodProvider());
+  EXPECT_EQ(config1.privateKeyMethodProvider(), config2.privateKeyMethodProvider());
+
+  tls_context.mutable_common_tls_context()
+      ->mutable_private_key_provider()
+      ->mutable_thread_pool()
+      ->mutable_threads()
+      ->set_value(1);
+  ServerContextConfigImpl config3(tls_context, factory_context_);
+  EXPECT_NE(config1.privateKeyMethodProvider(), config3.privateKeyMethodProvider());
+}
+
 TEST_P(SslSocketTest, ClientAuthMultipleCAs) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
@@ -2520,6 +2874,74 @@ TEST_P(SslSocketTest, TicketSessionResumptionWrongKey) {
                               GetParam());
 }
 
+// Servers that share a rotation seed derive the same ticket keys, so sessions can be resumed
+// across them.
+TEST_P(SslSocketTest, TicketSessionResumptionKeyRotation) {
+  const std::string server_ctx_yaml1 = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  session_ticket_key_rotation:
+    seed:
+      inline_string: "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+)EOF";
+
+  const std::string server_ctx_yaml2 = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  session_ticket_key_rotation:
+    seed:
+      inline_string: "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  testTicketSessionResumption(server_ctx_yaml1, {}, server_ctx_yaml2, {}, client_ctx_yaml, true,
+                              GetParam());
+}
+
+TEST_P(SslSocketTest, TicketSessionResumptionKeyRotationWrongSeed) {
+  const std::string server_ctx_yaml1 = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  session_ticket_key_rotation:
+    seed:
+      inline_string: "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+)EOF";
+
+  const std::string server_ctx_yaml2 = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  session_ticket_key_rotation:
+    seed:
+      inline_string: "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+  )EOF";
+
+  testTicketSessionResumption(server_ctx_yaml1, {}, server_ctx_yaml2, {}, client_ctx_yaml, false,
+                              GetParam());
+}
+
 // Sessions cannot be resumed even though the server certificates are the same,
 // because of the different SNI requirements.
 TEST_P(SslSocketTest, TicketSessionResumptionDifferentServerNames) {
@@ -3704,6 +4126,79 @@ TEST_P(SslSocketTest, DownstreamNotReadySslSocket) {
   EXPECT_EQ("TLS error: Secret is not supplied by SDS", transport_socket->failureReason());
 }
 
+// The certificates of a lazily loaded context are loaded by the first connection.
+TEST_P(SslSocketTest, LazyLoadCertificates) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  lazy_load_certificates: true
+)EOF";
+
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(tls_context, factory_context_);
+  ContextManagerImpl manager(time_system_);
+  Stats::IsolatedStoreImpl server_stats_store;
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  size_t contexts = 0;
+  manager.iterateContexts([&contexts](const Envoy::Ssl::Context&) { contexts++; });
+  EXPECT_EQ(0, contexts);
+
+  auto transport_socket1 = server_ssl_socket_factory.createTransportSocket(nullptr);
+  auto transport_socket2 = server_ssl_socket_factory.createTransportSocket(nullptr);
+  EXPECT_NE(nullptr, transport_socket1->ssl());
+  EXPECT_NE(nullptr, transport_socket2->ssl());
+  manager.iterateContexts([&contexts](const Envoy::Ssl::Context&) { contexts++; });
+  EXPECT_EQ(1, contexts);
+  EXPECT_EQ(1UL,
+            server_stats_store.counter("server_ssl_socket_factory.downstream_context_lazy_load")
+                .value());
+}
+
+// A lazily loaded context with invalid certificates fails the connections of its filter chain
+// instead of the listener, and is not loaded again until the next secret update.
+TEST_P(SslSocketTest, LazyLoadCertificatesError) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned2_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+  lazy_load_certificates: true
+)EOF";
+
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(tls_context, factory_context_);
+  ContextManagerImpl manager(time_system_);
+  Stats::IsolatedStoreImpl server_stats_store;
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  auto transport_socket1 = server_ssl_socket_factory.createTransportSocket(nullptr);
+  auto transport_socket2 = server_ssl_socket_factory.createTransportSocket(nullptr);
+  EXPECT_EQ(nullptr, transport_socket1->ssl());
+  EXPECT_EQ(nullptr, transport_socket2->ssl());
+  EXPECT_EQ(1UL,
+            server_stats_store.counter("server_ssl_socket_factory.downstream_context_lazy_load")
+                .value());
+  EXPECT_EQ(
+      1UL,
+      server_stats_store.counter("server_ssl_socket_factory.downstream_context_lazy_load_error")
+          .value());
+}
+
 // Validate that if upstream secrets are not yet downloaded from SDS server, Envoy creates
 // NotReadySslSocket object to handle upstream connection.
 TEST_P(SslSocketTest, UpstreamNotReadySslSocket) {
@@ -4006,6 +4501,111 @@ TEST_P(SslReadBufferLimitTest, TestBind) {
   disconnect();
 }
 
+// Connects an SslSocket client and server through a socket pair.
+class SslSocketPairTest : public SslCertsTest {
+public:
+  void SetUp() override {
+    const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+    envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+    MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+    ServerContextConfigImpl server_cfg(server_tls_context, factory_context_);
+    envoy::api::v2::auth::UpstreamTlsContext client_tls_context;
+    ClientContextConfigImpl client_cfg(client_tls_context, factory_context_);
+    server_ = std::make_unique<SslSocket>(
+        manager_.createSslServerContext(stats_store_, server_cfg, {}), InitialState::Server,
+        nullptr);
+    client_ = std::make_unique<SslSocket>(manager_.createSslClientContext(stats_store_, client_cfg),
+                                          InitialState::Client, nullptr);
+
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    for (int fd : fds) {
+      ASSERT_EQ(0, fcntl(fd, F_SETFL, O_NONBLOCK));
+    }
+    server_handle_ = std::make_unique<Network::IoSocketHandleImpl>(fds[0]);
+    client_handle_ = std::make_unique<Network::IoSocketHandleImpl>(fds[1]);
+    ON_CALL(server_callbacks_, ioHandle()).WillByDefault(ReturnRef(*server_handle_));
+    ON_CALL(client_callbacks_, ioHandle()).WillByDefault(ReturnRef(*client_handle_));
+    server_->setTransportSocketCallbacks(server_callbacks_);
+    client_->setTransportSocketCallbacks(client_callbacks_);
+  }
+
+  // Writes a buffer made of slices of the given sizes from the client to the server, and checks
+  // that the server receives it intact.
+  void transfer(const std::vector<uint64_t>& slice_sizes) {
+    Buffer::OwnedImpl write_buffer;
+    std::string expected;
+    char fill = 'a';
+    for (uint64_t size : slice_sizes) {
+      Buffer::OwnedImpl slice(std::string(size, fill));
+      fill = fill == 'z' ? 'a' : fill + 1;
+      expected.append(slice.toString());
+      write_buffer.move(slice);
+    }
+
+    // Neither end makes progress unless driven, so alternate between them until everything has
+    // been received.
+    Buffer::OwnedImpl read_buffer;
+    for (uint32_t i = 0; i < 1000 && read_buffer.length() < expected.size(); i++) {
+      EXPECT_EQ(Network::PostIoAction::KeepOpen, client_->doWrite(write_buffer, false).action_);
+      EXPECT_EQ(Network::PostIoAction::KeepOpen, server_->doRead(read_buffer).action_);
+    }
+    EXPECT_EQ(0, write_buffer.length());
+    EXPECT_EQ(expected, read_buffer.toString());
+  }
+
+  ContextManagerImpl manager_{time_system_};
+  Stats::IsolatedStoreImpl stats_store_;
+  std::unique_ptr<SslSocket> server_;
+  std::unique_ptr<SslSocket> client_;
+  std::unique_ptr<Network::IoSocketHandleImpl> server_handle_;
+  std::unique_ptr<Network::IoSocketHandleImpl> client_handle_;
+  NiceMock<Network::MockTransportSocketCallbacks> server_callbacks_;
+  NiceMock<Network::MockTransportSocketCallbacks> client_callbacks_;
+};
+
+// Writes a buffer made of slices of very different sizes through a socket pair and checks that the
+// peer receives it intact, whether each record was encrypted directly out of a slice or assembled
+// from a run of small slices.
+TEST_F(SslSocketPairTest, WriteMixedSizeSlices) {
+  transfer({1, 10, 5000, 100, 20000, 3, 16384, 7, 4095, 4096, 2, 40000});
+}
+
+// Collects the lengths of the records written by an SSL, as reported by the message callback.
+void collectRecordLengths(int write_p, int, int content_type, const void* buf, size_t len, SSL*,
+                          void* arg) {
+  if (write_p && content_type == SSL3_RT_HEADER && len == SSL3_RT_HEADER_LENGTH) {
+    const uint8_t* header = static_cast<const uint8_t*>(buf);
+    static_cast<std::vector<uint64_t>*>(arg)->push_back((header[3] << 8) | header[4]);
+  }
+}
+
+// Checks that once the initial ramp of the connection is over, records are full-size even though
+// no slice of the write buffer is large enough to hold one.
+TEST_F(SslSocketPairTest, FullSizeRecordsAfterRamp) {
+  std::vector<uint64_t> record_lengths;
+  SSL_set_msg_callback(client_->rawSslForTest(), collectRecordLengths);
+  SSL_set_msg_callback_arg(client_->rawSslForTest(), &record_lengths);
+
+  // 512KiB in slices of 5000 bytes: during the ramp, records hold runs of up to 3 slices.
+  const uint64_t total = 512 * 1024;
+  transfer(std::vector<uint64_t>(total / 5000, 5000));
+
+  // The length of a record includes the encryption overhead.
+  const uint64_t full_size_records =
+      std::count_if(record_lengths.begin(), record_lengths.end(),
+                    [](uint64_t length) { return length > 16384; });
+  EXPECT_GE(full_size_records, (total - 128 * 1024) / 16384 - 1);
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
@@ -2,6 +2,7 @@
 
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 
@@ -21,6 +22,7 @@ using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
+using testing::SaveArg;
 
 namespace Envoy {
 namespace Server {
@@ -36,15 +38,18 @@ public:
   public:
     TestListener(ConnectionHandlerTest& parent, uint64_t tag, bool bind_to_port,
                  bool hand_off_restored_destination_connections, const std::string& name,
-                 std::chrono::milliseconds listener_filters_timeout)
+                 std::chrono::milliseconds listener_filters_timeout,
+                 Network::ConnectionBalancerPtr&& connection_balancer)
         : parent_(parent), tag_(tag), bind_to_port_(bind_to_port),
           hand_off_restored_destination_connections_(hand_off_restored_destination_connections),
-          name_(name), listener_filters_timeout_(listener_filters_timeout) {}
+          name_(name), listener_filters_timeout_(listener_filters_timeout),
+          connection_balancer_(std::move(connection_balancer)) {}
 
     // Network::ListenerConfig
     Network::FilterChainManager& filterChainManager() override { return parent_.manager_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_.factory_; }
     Network::Socket& socket() override { return socket_; }
+    Network::Socket& workerSocket(uint32_t) override { return socket_; }
     const Network::Socket& socket() const override { return socket_; }
     bool bindToPort() override { return bind_to_port_; }
     bool handOffRestoredDestinationConnections() const override {
@@ -57,6 +62,7 @@ public:
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return tag_; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
 
     ConnectionHandlerTest& parent_;
     Network::MockListenSocket socket_;
@@ -65,6 +71,7 @@ public:
     const bool hand_off_restored_destination_connections_;
     const std::string name_;
     const std::chrono::milliseconds listener_filters_timeout_;
+    Network::ConnectionBalancerPtr connection_balancer_;
   };
 
   typedef std::unique_ptr<TestListener> TestListenerPtr;
@@ -72,20 +79,23 @@ public:
   TestListener* addListener(
       uint64_t tag, bool bind_to_port, bool hand_off_restored_destination_connections,
       const std::string& name,
-      std::chrono::milliseconds listener_filters_timeout = std::chrono::milliseconds(15000)) {
+      std::chrono::milliseconds listener_filters_timeout = std::chrono::milliseconds(15000),
+      Network::ConnectionBalancerPtr&& connection_balancer =
+          std::make_unique<Network::NopConnectionBalancerImpl>()) {
     TestListener* listener =
         new TestListener(*this, tag, bind_to_port, hand_off_restored_destination_connections, name,
-                         listener_filters_timeout);
+                         listener_filters_timeout, std::move(connection_balancer));
     listener->moveIntoListBack(TestListenerPtr{listener}, listeners_);
     return listener;
   }
 
   Stats::IsolatedStoreImpl stats_store_;
   NiceMock<Event::MockDispatcher> dispatcher_;
+  // Listener configs must outlive the handler that references them.
+  std::list<TestListenerPtr> listeners_;
   Network::ConnectionHandlerPtr handler_;
   NiceMock<Network::MockFilterChainManager> manager_;
   NiceMock<Network::MockFilterChainFactory> factory_;
-  std::list<TestListenerPtr> listeners_;
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -125,6 +135,97 @@ TEST_F(ConnectionHandlerTest, RemoveListener) {
   handler_->removeListeners(0);
 }
 
+TEST_F(ConnectionHandlerTest, UpdateListener) {
+  InSequence s;
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  // The new version of the listener takes over the listener and its connections.
+  TestListener* updated_listener = addListener(2, true, false, "test_listener");
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _)).Times(0);
+  handler_->updateListener(1, *updated_listener);
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  handler_->stopListeners(1);
+  handler_->removeListeners(1);
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(*listener, onDestroy());
+  EXPECT_CALL(*connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  handler_->removeListeners(2);
+  EXPECT_EQ(0UL, handler_->numConnections());
+}
+
+// A listener that the handler does not know about is added when it is updated.
+TEST_F(ConnectionHandlerTest, UpdateUnknownListener) {
+  InSequence s;
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false)).WillOnce(Return(listener));
+  TestListener* test_listener = addListener(2, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->updateListener(1, *test_listener);
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_->stopListeners(2);
+}
+
+TEST_F(ConnectionHandlerTest, RemoveFilterChains) {
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  const Network::FilterChainSharedPtr other_filter_chain =
+      Network::Test::createEmptyFilterChainWithRawBufferSockets();
+  Network::MockConnection* removed_connection = new NiceMock<Network::MockConnection>();
+  Network::MockConnection* kept_connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(manager_, findFilterChain(_))
+      .WillOnce(Return(filter_chain_.get()))
+      .WillOnce(Return(other_filter_chain.get()));
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _))
+      .WillOnce(Return(removed_connection))
+      .WillOnce(Return(kept_connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillRepeatedly(Return(true));
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(2UL, handler_->numConnections());
+
+  EXPECT_CALL(*removed_connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*kept_connection, close(_)).Times(0);
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  handler_->removeFilterChains({filter_chain_.get()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(*kept_connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
 TEST_F(ConnectionHandlerTest, DisableListener) {
   InSequence s;
 
@@ -676,6 +777,110 @@ TEST_F(ConnectionHandlerTest, ListenerFilterDisabledTimeout) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+// Validate that an accepted socket is handed to the worker with the fewest connections before
+// listener filters run, and that per worker stats are recorded.
+TEST_F(ConnectionHandlerTest, ExactConnectionBalancing) {
+  TestListener* test_listener =
+      addListener(1, true, false, "test_listener", std::chrono::milliseconds(15000),
+                  std::make_unique<Network::ExactConnectionBalancerImpl>());
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+
+  handler_.reset(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, 0));
+  Network::MockListener* listener1 = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return listener1;
+          }));
+  handler_->addListener(*test_listener);
+
+  NiceMock<Event::MockDispatcher> dispatcher2;
+  Network::ConnectionHandlerPtr handler2(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher2, 1));
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher2, createListener_(_, _, _, false)).WillOnce(Return(listener2));
+  handler2->addListener(*test_listener);
+
+  // The first worker already has a connection, so a newly accepted socket goes to the second.
+  listener_callbacks1->onNewConnection(
+      Network::ConnectionPtr{new NiceMock<Network::MockConnection>()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher2, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).Times(0);
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(1UL, stats_store_.counter("worker_0.downstream_cx_rebalanced").value());
+
+  // The connection is created on the second worker once the post runs.
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).WillOnce(Return(true));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  EXPECT_CALL(dispatcher2, createServerConnection_(_, _))
+      .WillOnce(Return(new NiceMock<Network::MockConnection>()));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  post_cb();
+  EXPECT_EQ(1UL, handler2->numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_1.downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_1.downstream_cx_active").value());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_0.downstream_cx_total").value());
+
+  // With both workers balanced the accepting worker keeps the socket.
+  EXPECT_CALL(dispatcher2, post(_)).Times(0);
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).WillOnce(Return(true));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _))
+      .WillOnce(Return(new NiceMock<Network::MockConnection>()));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(2UL, handler_->numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_0.downstream_cx_rebalanced").value());
+
+  EXPECT_CALL(*listener2, onDestroy());
+  handler2.reset();
+  EXPECT_CALL(*listener1, onDestroy());
+  handler_.reset();
+}
+
+// Validate that a socket rebalanced to a removed listener is dropped.
+TEST_F(ConnectionHandlerTest, RebalanceToRemovedListener) {
+  TestListener* test_listener =
+      addListener(1, true, false, "test_listener", std::chrono::milliseconds(15000),
+                  std::make_unique<Network::ExactConnectionBalancerImpl>());
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+
+  handler_.reset(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, 0));
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return new NiceMock<Network::MockListener>();
+          }));
+  handler_->addListener(*test_listener);
+
+  NiceMock<Event::MockDispatcher> dispatcher2;
+  Network::ConnectionHandlerPtr handler2(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher2, 1));
+  EXPECT_CALL(dispatcher2, createListener_(_, _, _, false))
+      .WillOnce(Return(new NiceMock<Network::MockListener>()));
+  handler2->addListener(*test_listener);
+
+  listener_callbacks1->onNewConnection(
+      Network::ConnectionPtr{new NiceMock<Network::MockConnection>()});
+
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher2, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  Network::MockConnectionSocket* accepted_socket = new NiceMock<Network::MockConnectionSocket>();
+  listener_callbacks1->onAccept(Network::ConnectionSocketPtr{accepted_socket}, false);
+
+  handler2->removeListeners(1);
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).Times(0);
+  post_cb();
+  EXPECT_EQ(0UL, handler2->numConnections());
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -0,0 +1,78 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/network/address_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/network/listen_socket_impl.h"
+
+#include "server/filter_chain_manager_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Server {
+
+// Builds a listener match tree with range(0) filter chains, half of them matching on an exact
+// server name and half of them on a wildcard server name, and measures the time spent selecting
+// the filter chain of accepted connections.
+static void BM_FindFilterChain(benchmark::State& state, bool wildcard) {
+  const uint32_t filter_chains = state.range(0);
+  FilterChainManagerImpl manager(
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 443));
+  for (uint32_t i = 0; i < filter_chains; i++) {
+    manager.addFilterChain(
+        0, {}, {fmt::format(i % 2 == 0 ? "www.example{}.com" : "*.example{}.com", i)}, "tls", {},
+        envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
+            FilterChainMatch_ConnectionSourceType_ANY,
+        std::make_shared<Network::MockFilterChain>());
+  }
+  manager.addFilterChain(0, {}, {}, "", {},
+                         envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
+                             FilterChainMatch_ConnectionSourceType_ANY,
+                         std::make_shared<Network::MockFilterChain>());
+  manager.compile();
+
+  const Network::Address::InstanceConstSharedPtr local_address =
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 443);
+  const Network::Address::InstanceConstSharedPtr remote_address =
+      std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1", 50000);
+  std::vector<std::unique_ptr<Network::ConnectionSocketImpl>> sockets;
+  for (uint32_t i = 0; i < filter_chains; i++) {
+    auto socket = std::make_unique<Network::ConnectionSocketImpl>(
+        std::make_unique<Network::IoSocketHandleImpl>(), local_address, remote_address);
+    socket->setDetectedTransportProtocol("tls");
+    socket->setRequestedApplicationProtocols({"h2", "http/1.1"});
+    // Odd filter chains match on "*.example<i>.com", even ones on "www.example<i>.com".
+    socket->setRequestedServerName(wildcard ? fmt::format("api.example{}.com", i | 1)
+                                            : fmt::format("www.example{}.com", i & ~1U));
+    sockets.push_back(std::move(socket));
+  }
+
+  size_t next = 0;
+  for (auto _ : state) {
+    RELEASE_ASSERT(manager.findFilterChain(*sockets[next]) != nullptr, "");
+    next = (next + 1) % sockets.size();
+  }
+}
+BENCHMARK_CAPTURE(BM_FindFilterChain, exact, false)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK_CAPTURE(BM_FindFilterChain, wildcard, true)->Arg(10)->Arg(1000)->Arg(10000);
+
+} // namespace Server
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,101 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/network/address_impl.h"
+
+#include "server/filter_chain_manager_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Server {
+
+class FilterChainManagerImplTest : public testing::Test {
+public:
+  FilterChainManagerImplTest()
+      : manager_(std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234)) {
+    ON_CALL(socket_, requestedApplicationProtocols())
+        .WillByDefault(ReturnRef(application_protocols_));
+    ON_CALL(socket_, detectedTransportProtocol()).WillByDefault(Return("tls"));
+  }
+
+  const Network::FilterChain* addFilterChain(const std::vector<std::string>& server_names) {
+    auto filter_chain = std::make_shared<Network::MockFilterChain>();
+    manager_.addFilterChain(0, {}, server_names, "", {},
+                            envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType::
+                                FilterChainMatch_ConnectionSourceType_ANY,
+                            filter_chain);
+    return filter_chain.get();
+  }
+
+  const Network::FilterChain* findFilterChain(const std::string& server_name) {
+    server_name_ = server_name;
+    ON_CALL(socket_, requestedServerName()).WillByDefault(Return(absl::string_view(server_name_)));
+    return manager_.findFilterChain(socket_);
+  }
+
+  FilterChainManagerImpl manager_;
+  NiceMock<Network::MockConnectionSocket> socket_;
+  std::vector<std::string> application_protocols_;
+  std::string server_name_;
+};
+
+TEST_F(FilterChainManagerImplTest, NoFilterChains) {
+  manager_.compile();
+  EXPECT_EQ(nullptr, findFilterChain("www.example.com"));
+}
+
+TEST_F(FilterChainManagerImplTest, WildcardServerNames) {
+  const auto* exact = addFilterChain({"www.example.com"});
+  const auto* example = addFilterChain({"*.example.com"});
+  const auto* com = addFilterChain({"*.com"});
+  const auto* catch_all = addFilterChain({});
+  manager_.compile();
+
+  EXPECT_EQ(exact, findFilterChain("www.example.com"));
+  EXPECT_EQ(example, findFilterChain("api.example.com"));
+  EXPECT_EQ(example, findFilterChain("a.b.example.com"));
+  EXPECT_EQ(com, findFilterChain("example.com"));
+  EXPECT_EQ(com, findFilterChain("www.example2.com"));
+  EXPECT_EQ(catch_all, findFilterChain("com"));
+  EXPECT_EQ(catch_all, findFilterChain("example.org"));
+  EXPECT_EQ(catch_all, findFilterChain(""));
+}
+
+TEST_F(FilterChainManagerImplTest, WildcardServerNamesWithTrailingDot) {
+  const auto* example = addFilterChain({"*.example.com."});
+  const auto* catch_all = addFilterChain({});
+  manager_.compile();
+
+  EXPECT_EQ(example, findFilterChain("www.example.com."));
+  EXPECT_EQ(catch_all, findFilterChain("www.example.com"));
+  EXPECT_EQ(catch_all, findFilterChain("example.com."));
+}
+
+TEST_F(FilterChainManagerImplTest, WildcardServerNameWithoutCatchAll) {
+  const auto* example = addFilterChain({"*.example.com"});
+  manager_.compile();
+
+  EXPECT_EQ(example, findFilterChain("www.example.com"));
+  EXPECT_EQ(nullptr, findFilterChain("www.example.org"));
+  EXPECT_EQ(nullptr, findFilterChain("example.com"));
+}
+
+TEST_F(FilterChainManagerImplTest, DuplicateServerNames) {
+  addFilterChain({"*.example.com", "www.example.com"});
+  EXPECT_THROW_WITH_MESSAGE(addFilterChain({"*.example.com"}), EnvoyException,
+                            "error adding listener '127.0.0.1:1234': multiple filter chains with "
+                            "effectively equivalent matching rules are defined");
+}
+
+} // namespace Server
+} // namespace Envoy
@@ -122,6 +122,33 @@ TEST_F(WorkerImplTest, BasicFlow) {
   });
   ci.waitReady();
 
+  // Update listener3 in place and then remove one of its filter chains.
+  NiceMock<Network::MockListenerConfig> listener3_update;
+  ON_CALL(listener3_update, listenerTag()).WillByDefault(Return(3UL));
+  EXPECT_CALL(*handler_, updateListener(3, _))
+      .WillOnce(Invoke([current_thread_id, &listener3_update](
+                           uint64_t, Network::ListenerConfig& config) -> void {
+        EXPECT_EQ(&listener3_update, &config);
+        EXPECT_NE(current_thread_id, std::this_thread::get_id());
+      }));
+  worker_.updateListener(3, listener3_update, [&ci](bool success) -> void {
+    EXPECT_TRUE(success);
+    ci.setReady();
+  });
+  ci.waitReady();
+
+  Network::MockFilterChain filter_chain;
+  const std::vector<const Network::FilterChain*> filter_chains{&filter_chain};
+  EXPECT_CALL(*handler_, removeFilterChains(filter_chains))
+      .WillOnce(InvokeWithoutArgs([current_thread_id]() -> void {
+        EXPECT_NE(current_thread_id, std::this_thread::get_id());
+      }));
+  worker_.removeFilterChains(filter_chains, [current_thread_id, &ci]() -> void {
+    EXPECT_NE(current_thread_id, std::this_thread::get_id());
+    ci.setReady();
+  });
+  ci.waitReady();
+
   EXPECT_CALL(*handler_, removeListeners(3))
       .WillOnce(InvokeWithoutArgs([current_thread_id]() -> void {
         EXPECT_NE(current_thread_id, std::this_thread::get_id());